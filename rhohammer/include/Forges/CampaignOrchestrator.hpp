@@ -0,0 +1,65 @@
+#ifndef ZENHAMMER_INCLUDE_FORGES_CAMPAIGNORCHESTRATOR_HPP_
+#define ZENHAMMER_INCLUDE_FORGES_CAMPAIGNORCHESTRATOR_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <latch>
+#include <string>
+#include <vector>
+
+// A DIMM (or channel) that is hammered by a worker of a campaign.
+struct CampaignTarget
+{
+  long dimm_id = -1;
+  size_t num_ranks = 0;
+  size_t num_bankgroups = 0;
+  size_t num_banks = 0;
+  bool samsung_row_swizzling = false;
+  // the number of the 1 GiB hugepage to map, which determines the channel/DIMM the memory of the worker is on
+  int hugepage_num = -1;
+  // the CPU core the worker is pinned to; -1 to not pin the worker
+  int cpu = -1;
+  // an optional YAML file with run configuration knobs (see RuntimeConfig) that only apply to this target
+  std::string config_filename;
+};
+
+// Runs a campaign over multiple DIMMs within one process: each target is handled by its own worker thread that is
+// pinned to a CPU core and has its own memory, program arguments, run configuration, log, and output directory
+// (dimm-<id>/). All workers share a common time budget. A worker that fails (see exit_target) only ends itself.
+class CampaignOrchestrator
+{
+private:
+  // the latch the workers of the running campaign arrive at in finish_setup; null outside of a campaign and once this
+  // worker arrived
+  static thread_local std::latch *setup_latch;
+
+  static void pin_to_cpu(int cpu);
+
+public:
+  std::vector<CampaignTarget> targets;
+
+  // the time budget of the whole campaign in seconds; 0 to use --runtime-limit
+  unsigned long runtime_limit = 0;
+
+  /// loads the targets from a YAML file, e.g.:
+  ///   runtime_limit: 3600
+  ///   targets:
+  ///     - {dimm_id: 501, geometry: [1, 4, 4], hugepage_num: 3, cpu: 2}
+  ///     - {dimm_id: 502, geometry: [2, 4, 4], samsung: true, hugepage_num: 12, cpu: 4, config: dimm502.yaml}
+  static CampaignOrchestrator load_yaml(const std::string &filename);
+
+  /// the output directory of the given target
+  static std::string get_output_dir(const CampaignTarget &target);
+
+  /// runs the given function for each target in its own thread and waits for all of them; each worker starts from
+  /// the program arguments and run configuration of the calling thread, with the target's settings applied, and the
+  /// function receives the deadline (UNIX timestamp in seconds) of the campaign; returns the number of failed workers
+  size_t run(const std::function<void(const CampaignTarget &, int64_t)> &worker);
+
+  /// called by a worker once it is done with its memory allocation and calibration; waits until all workers are, so
+  /// that the timing measurements of one DIMM's calibration are not disturbed by another DIMM being hammered; does
+  /// nothing outside of a campaign
+  static void finish_setup();
+};
+
+#endif //ZENHAMMER_INCLUDE_FORGES_CAMPAIGNORCHESTRATOR_HPP_
@@ -2,8 +2,16 @@
 #define ZENHAMMER_SRC_FORGES_FUZZYHAMMERER_HPP_
 
 #include "Fuzzer/HammeringPattern.hpp"
+#include "Fuzzer/KernelAutotuner.hpp"
 #include "Memory/Memory.hpp"
 #include "ReplayingHammerer.hpp"
+#include "Utilities/AccessTrace.hpp"
+#include "Utilities/ActivationTelemetry.hpp"
+#include "Utilities/DurableLog.hpp"
+#include "Utilities/PerfCounterGroup.hpp"
+#include "Utilities/ResultStreamWriter.hpp"
+
+#include <map>
 
 class FuzzyHammerer
 {
@@ -27,6 +35,55 @@ public:
   // note: it does not consider the bit flips triggered during the reproducibility runs
   std::unordered_map<std::string, std::unordered_map<std::string, int>> map_pattern_mappings_bitflips;
 
+  // the hammering kernel and flushing/fencing strategy used for all patterns
+  KernelChoice kernel_choice;
+
+  // hardware performance counters that are sampled around each hammering and memory checking phase
+  PerfCounterGroup perf_counters;
+
+  // the performance counters of the current pattern, summed up over all its mappings and DRAM locations
+  HammerPerfCounters pattern_perf_counters;
+
+  // the achieved activation rates of all hammering runs during this fuzzing run
+  ActivationTelemetry activation_telemetry;
+
+  // the achieved activation rates of the current pattern, summed up over all its mappings and DRAM locations
+  std::map<HAMMERING_KERNEL, ActivationRate> pattern_activation_rates;
+
+  // the activation rate of each hammering run of the current pattern; they are checkpointed, so that
+  // activation_telemetry can be rebuilt when the fuzzing run is resumed
+  std::vector<std::pair<HAMMERING_KERNEL, ActivationRate>> pattern_activation_runs;
+
+  // the REF synchronization statistics of the current pattern
+  SyncTimingSummary pattern_sync_summary;
+
+  // the binary export of the sync timing ring buffer (only if --export-sync-timings is given)
+  std::ofstream sync_timings_export;
+
+  // the access sequence of each hammered pattern, mapping, and DRAM location (only if --access-trace is given)
+  AccessTraceWriter access_trace;
+
+  static constexpr const char *ACCESS_TRACE_FILENAME = "access-trace.bin";
+
+  // an append-only log with one record per tested pattern that allows resuming an interrupted fuzzing run
+  DurableLog checkpoint_log;
+
+  static constexpr const char *CHECKPOINT_FILENAME = "fuzz-checkpoint.jsonl";
+
+  // the effective patterns and the statistics of all patterns, streamed to disk as they are produced and converted into
+  // fuzz-summary.json at the end of the run
+  ResultStreamWriter result_stream;
+
+  static constexpr const char *RESULTS_FILENAME_STEM = "fuzz-results";
+
+  void record_sync_timings(const CodeJitter &code_jitter, uint64_t sync_head);
+
+  void record_activation_rate(HAMMERING_KERNEL kernel, const HammeringData &data);
+
+  void record_access_trace(const PatternAddressMapper &mapper, const FuzzingParameterSet &fuzzing_params,
+                           size_t dram_location, const std::vector<volatile char *> &hammering_accesses,
+                           volatile char *sync_start);
+
   void n_sided_frequency_based_hammering(DramAnalyzer &dramAnalyzer, Memory &memory, int acts,
                                          unsigned long runtime_limit, size_t probes_per_pattern,
                                          bool sweep_best_pattern);
@@ -1,8 +1,15 @@
 #ifndef ZENHAMMER_SRC_FORGES_REPLAYINGHAMMERER_HPP_
 #define ZENHAMMER_SRC_FORGES_REPLAYINGHAMMERER_HPP_
 
+#include "Forges/SweepPlanner.hpp"
 #include "Fuzzer/HammeringPattern.hpp"
+#include "Fuzzer/KernelAutotuner.hpp"
 #include "Memory/Memory.hpp"
+#include "Utilities/ActivationTelemetry.hpp"
+#include "Utilities/CoverageMap.hpp"
+#include "Utilities/FlipAggregator.hpp"
+#include "Utilities/PerfCounterGroup.hpp"
+#include "Utilities/ResultStreamWriter.hpp"
 
 #include <unordered_set>
 
@@ -13,7 +20,20 @@ struct SweepSummary {
   // Number of observed corruptions from one to zero.
   size_t num_flips_o2z;
 
-  std::vector<BitFlip> observed_bitflips;
+  // the number of corrupted bytes; the bit flips themselves are only written to the result stream (if open)
+  size_t num_observed_bitflips;
+
+  // hardware performance counters summed up over all rows of the sweep
+  HammerPerfCounters perf_counters;
+
+  // the activations achieved by the hammering kernel, summed up over all rows of the sweep
+  ActivationRate activation_rate;
+
+  // the REF synchronization statistics, summed up over all rows of the sweep
+  SyncTimingSummary sync_summary;
+
+  // histograms and top rows of the bit flips of the sweep
+  FlipAggregator flip_stats;
 };
 
 class ReplayingHammerer {
@@ -24,13 +44,31 @@ class ReplayingHammerer {
   // a random number generator, required for std::shuffle
   std::mt19937 gen;
 
+  // hardware performance counters that are sampled around each hammering and memory checking phase
+  PerfCounterGroup perf_counters;
+
+  // the achieved activation rates of all hammering runs of all sweeps
+  ActivationTelemetry activation_telemetry;
+
+  // the bit flips and summaries of all sweeps, streamed to disk as they are produced
+  ResultStreamWriter result_stream;
+
+  // the index of the current sweep in the result stream
+  size_t sweep_index = 0;
+
+  // the checkpoints and the progress of the sweeps of replay_patterns_brief
+  SweepPlanner sweep_planner;
+
+  // the locations each (pattern, mapping) was already swept over on this DIMM, across runs
+  CoverageMap coverage;
+
  private:
 
   // maps: (mapping ID) -> (HammeringPattern), because there's no back-reference from mapping to HammeringPattern
   std::unordered_map<std::string, HammeringPattern> map_mapping_id_to_pattern;
 
   // the reproducibility score computed during the last invocation of hammer_pattern
-  static double last_reproducibility_score;
+  static thread_local double last_reproducibility_score;
 
   // the number of times in which hammering a pattern (at the same location) is repeated; this is only the initial
   // parameter as later we optimize this value
@@ -62,6 +100,10 @@ class ReplayingHammerer {
   std::vector<HammeringPattern> load_patterns_from_json(const std::string& json_filename,
                                                         const std::unordered_set<std::string> &pattern_ids);
 
+  // like load_patterns_from_json but only decodes the requested patterns of a PatternStore
+  std::vector<HammeringPattern> load_patterns_from_store(const std::string& store_filename,
+                                                         const std::unordered_set<std::string> &pattern_ids);
+
   PatternAddressMapper &determine_most_effective_mapping(HammeringPattern &patt,
                                                          bool optimize_hammering_num_reps,
                                                          bool offline_mode);
@@ -81,6 +123,15 @@ class ReplayingHammerer {
 
   explicit ReplayingHammerer(Memory &mem);
 
+  // the hammering kernel and flushing/fencing strategy used for sweeping
+  KernelChoice kernel_choice;
+
+  // the REF synchronization threshold (cycles) used for sweeping
+  size_t ref_threshold = 0;
+
+  // where and for how long each pattern is swept
+  SweepPlan sweep_plan;
+
   void set_params(const FuzzingParameterSet &fuzzParams);
 
   void replay_patterns(const std::string& json_filename, const std::unordered_set<std::string> &pattern_ids);
@@ -97,11 +148,9 @@ class ReplayingHammerer {
 
   void derive_FuzzingParameterSet_values(HammeringPattern &pattern, PatternAddressMapper &mapper);
 
-  SweepSummary sweep_pattern(HammeringPattern &pattern, PatternAddressMapper &mapper, size_t num_reps,
-                             size_t size_bytes);
+  SweepSummary sweep_pattern(HammeringPattern &pattern, PatternAddressMapper &mapper, size_t num_reps);
 
   SweepSummary sweep_pattern(HammeringPattern &pattern, PatternAddressMapper &mapper, size_t num_reps,
-                             size_t size_bytes,
                              const std::unordered_set<AggressorAccessPattern> &effective_aggs);
 
   static void find_direct_effective_aggs(HammeringPattern &pattern, PatternAddressMapper &mapper,
@@ -0,0 +1,72 @@
+#ifndef ZENHAMMER_INCLUDE_FORGES_SWEEPENGINE_HPP_
+#define ZENHAMMER_INCLUDE_FORGES_SWEEPENGINE_HPP_
+
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include "Fuzzer/HammeringPattern.hpp"
+#include "Fuzzer/PatternAddressMapper.hpp"
+#include "Memory/DRAMAddr.hpp"
+
+// The addresses a pattern accesses, its victim rows, and its sync rows at the current location of a sweep. Moving the
+// pattern by some rows only XORs each address with the precomputed difference between the virtual addresses of the
+// rows (see DRAMAddr::get_row_delta) instead of shifting the mapping and re-deriving everything from it.
+// The state is only rebuilt from the mapping where sliding would differ from it, i.e., if only some aggressors are
+// moved or the victims of the pattern reach the first/last row of the bank.
+class SweepEngine
+{
+private:
+  HammeringPattern &pattern;
+
+  // the mapping is only shifted when the state is rebuilt from it
+  PatternAddressMapper &mapper;
+
+  const std::unordered_set<AggressorAccessPattern> &effective_aggs;
+
+  // the number of rows the mapper is behind the current location
+  int pending_shift = 0;
+
+  // the distances between consecutive sync rows; drawn once so that the sync rows slide along with the pattern
+  std::vector<int> sync_row_gaps;
+
+  // the row of each address in accesses, victim_row_starts, and sync_rows
+  std::vector<size_t> access_rows;
+  std::vector<size_t> victim_rows;
+  std::vector<size_t> sync_row_nos;
+
+  size_t num_rebuilds = 0;
+
+  void rebuild();
+
+  static void slide(std::vector<volatile char *> &addresses, std::vector<size_t> &rows, size_t num_rows);
+
+public:
+  // the number of sync rows in the bank group next to the aggressors' one
+  static constexpr size_t NUM_SYNC_ROWS = 256;
+
+  // the hammering accesses as exported by PatternAddressMapper::export_pattern
+  std::vector<volatile char *> accesses;
+
+  // the first address of each victim row
+  std::vector<volatile char *> victim_row_starts;
+
+  std::vector<volatile char *> sync_rows;
+
+  // the row the sync rows start after, used by the jitted kernel
+  DRAMAddr sync_start;
+
+  size_t min_row = 0;
+  size_t max_row = 0;
+
+  /// starts at the current location of the mapping
+  SweepEngine(HammeringPattern &pattern, PatternAddressMapper &mapper,
+              const std::unordered_set<AggressorAccessPattern> &effective_aggs, std::mt19937 &gen);
+
+  /// moves all addresses by the given number of rows
+  void advance(size_t num_rows);
+
+  [[nodiscard]] size_t get_num_rebuilds() const;
+};
+
+#endif //ZENHAMMER_INCLUDE_FORGES_SWEEPENGINE_HPP_
@@ -0,0 +1,137 @@
+#ifndef ZENHAMMER_INCLUDE_FORGES_SWEEPPLANNER_HPP_
+#define ZENHAMMER_INCLUDE_FORGES_SWEEPPLANNER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Utilities/DurableLog.hpp"
+
+#ifdef ENABLE_JSON
+#include <nlohmann/json.hpp>
+#endif
+
+// Where and for how long each pattern is swept (see ReplayingHammerer::sweep_pattern).
+struct SweepPlan
+{
+  // the row the pattern's lowest aggressor is moved to first; -1 to start one row after the mapping's location
+  long first_row = -1;
+
+  // the number of locations the pattern is hammered at (per bank); 0 for full_sweep_rows of the run configuration
+  size_t num_rows = 0;
+
+  // the number of rows the pattern is moved between two locations
+  size_t row_stride = 1;
+
+  // the banks (#bankgroup x #banks-per-bankgroup + #bank) the pattern is swept over, one after the other; empty for
+  // only the bank of the mapping
+  std::vector<size_t> banks;
+
+  // the wall-clock time in seconds after which the sweep of a pattern is stopped; 0 for no limit
+  unsigned long time_budget = 0;
+
+  // the number of locations after which the progress is checkpointed and logged
+  size_t chunk_rows = 10000;
+
+  // whether to skip the locations the (pattern, mapping) was already hammered at according to the DIMM's coverage map
+  bool skip_covered = true;
+
+  /// overrides all settings that are present in the given YAML file
+  void load_yaml(const std::string &filepath);
+
+  /// exits if any of the settings has an unsupported value
+  void validate() const;
+
+  /// the number of locations per bank, taking full_sweep_rows and the debug mode into account
+  [[nodiscard]] size_t get_num_rows() const;
+
+  /// the number of banks the pattern is swept over
+  [[nodiscard]] size_t get_num_banks() const;
+
+  [[nodiscard]] std::string to_string() const;
+};
+
+// The counters of a chunk (or of all chunks) of a sweep.
+struct SweepCounts
+{
+  size_t num_flips = 0;
+  size_t num_flips_z2o = 0;
+  size_t num_flips_o2z = 0;
+  size_t num_observed_bitflips = 0;
+
+  void accumulate(const SweepCounts &other);
+};
+
+// Keeps track of the progress of all sweeps of a run: it checkpoints each completed chunk and sweep in
+// sweep-checkpoint.jsonl, so that a resumed run skips what was already swept, and it estimates the remaining time from
+// the measured time per location.
+class SweepPlanner
+{
+private:
+  SweepPlan plan;
+
+#ifdef ENABLE_JSON
+  DurableLog checkpoint_log;
+
+  // the counters of the completed chunks of the checkpoint log, by get_chunk_key
+  std::map<std::string, SweepCounts> completed_chunks;
+
+  // the counters of the completed sweeps of the checkpoint log, by sweep index
+  std::map<size_t, SweepCounts> completed_sweeps;
+#endif
+
+  // the seed the sync rows of all sweeps are drawn from; it is stored in the checkpoint log to be reused on resume
+  uint64_t sync_row_seed = 0;
+
+  // the number of sweeps the run consists of and the number of them that are completed
+  size_t num_planned_sweeps = 0;
+  size_t num_completed_sweeps = 0;
+
+  // the measured cost of the locations swept in this process
+  double swept_sec = 0;
+  size_t swept_rows = 0;
+
+  static std::string get_chunk_key(size_t sweep, size_t bank_idx, size_t first_row_idx);
+
+public:
+  static constexpr const char *CHECKPOINT_FILENAME = "sweep-checkpoint.jsonl";
+
+  /// starts a run of the given number of sweeps; on resume, the completed chunks are loaded from the checkpoint log
+  /// and the length the result stream had at the last checkpoint is returned (0 if there is nothing to resume)
+  uint64_t begin(const SweepPlan &sweep_plan, size_t num_sweeps, bool resume);
+
+  [[nodiscard]] const SweepPlan &get_plan() const;
+
+  /// the generator the sync rows of the given sweep and bank are drawn from; it yields the same numbers on resume
+  [[nodiscard]] std::mt19937 get_sync_row_gen(size_t sweep, size_t bank_idx) const;
+
+  /// whether the given chunk was completed before the run was resumed; if so, its counters are added to counts
+  bool is_completed(size_t sweep, size_t bank_idx, size_t first_row_idx, SweepCounts &counts) const;
+
+  /// records a completed chunk; stream_length must cover all records of the chunk (see ResultStreamWriter::flush)
+  void complete_chunk(size_t sweep, size_t bank_idx, size_t first_row_idx, size_t num_rows, double elapsed_sec,
+                      const SweepCounts &counts, uint64_t stream_length);
+
+  /// whether the given sweep was completed before the run was resumed; if so, its counters are stored in counts
+  bool is_sweep_completed(size_t sweep, SweepCounts &counts) const;
+
+  /// records a completed sweep; stream_length must cover its summary record
+  void complete_sweep(size_t sweep, const SweepCounts &counts, uint64_t stream_length);
+
+  /// the estimated number of seconds until the run is finished, given the number of locations left in the current
+  /// sweep and the seconds left in its budget (0 for no budget); -1 if nothing was measured yet
+  [[nodiscard]] double get_remaining_sec(size_t rows_left_in_sweep, double budget_left_sec) const;
+
+  void end();
+};
+
+#ifdef ENABLE_JSON
+
+void to_json(nlohmann::json &j, const SweepPlan &p);
+
+#endif
+
+#endif //ZENHAMMER_INCLUDE_FORGES_SWEEPPLANNER_HPP_
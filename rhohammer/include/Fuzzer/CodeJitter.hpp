@@ -1,11 +1,16 @@
 #ifndef CODEJITTER
 #define CODEJITTER
 
+#include <optional>
 #include <unordered_map>
 #include <vector>
 #include <iostream>
 #include "Utilities/Enums.hpp"
+#include "Utilities/Helper.hpp"
 #include "Fuzzer/FuzzingParameterSet.hpp"
+#include "Memory/SimulatedDram.hpp"
+#include "Utilities/AccessTrace.hpp"
+#include "Utilities/SyncTimingRing.hpp"
 
 #ifdef ENABLE_JITTING
 #include <asmjit/asmjit.h>
@@ -111,6 +116,8 @@ struct RefSyncData
   // last sync: after configurable number of aggressors
   uint32_t last_sync_act_count{0};
   uint32_t last_sync_tsc_delta{0};
+  // input: the REF threshold (cycles) used by code jitted with CodeJitter::RUNTIME_SYNC_REF_THRESHOLD
+  uint32_t sync_ref_threshold{0};
 };
 
 struct HammeringData
@@ -137,6 +144,24 @@ private:
   int (*fn)(HammeringData *) = nullptr;
   size_t (*fn_ref_sync)(RefSyncData *) = nullptr;
 
+  /// the unjitted hammering loop, specialized for each combination of flushing and fencing strategy
+  template <FLUSHING_STRATEGY flushing, FENCING_STRATEGY fencing>
+  void hammer_pattern_unjitted_impl(FuzzingParameterSet &fuzzing_parameters,
+                                    bool verbose,
+                                    int total_num_activations,
+                                    const std::vector<volatile char *> &aggressor_pairs,
+                                    const std::vector<volatile char *> &sync_rows,
+                                    size_t ref_threshold);
+
+  /// the unjitted hammering loop on the simulated DRAM (see SimulatedDram), whose clock replaces the TSC; there are no
+  /// caches to flush in the simulation, i.e., the flushing and fencing strategies do not matter
+  void hammer_pattern_simulated(SimulatedDram &dram,
+                                bool verbose,
+                                int total_num_activations,
+                                const std::vector<volatile char *> &aggressor_pairs,
+                                const std::vector<volatile char *> &sync_rows,
+                                size_t ref_threshold);
+
 public:
   FLUSHING_STRATEGY flushing_strategy;
 
@@ -150,6 +175,15 @@ public:
 
   size_t sync_rows_size;
 
+  /// the number of ACTs (incl. synchronization) and TSC cycles of the last hammer_pattern/hammer_pattern_unjitted call
+  HammeringData last_hammering_data;
+
+  /// the timing of all REF synchronizations done by the hammering kernels (shared by all instances of a thread)
+  static thread_local SyncTimingRing sync_timings;
+
+  /// the synchronization statistics of the last hammer_pattern/hammer_pattern_unjitted call
+  SyncTimingSummary last_sync_summary;
+
   /// constructor
   CodeJitter();
 
@@ -177,26 +211,36 @@ public:
       FENCING_STRATEGY fencing,
       std::vector<volatile char *> const &aggressors,
       DRAMAddr sync_ref_initial_aggr,
-      size_t sync_ref_threshold);
+      std::optional<size_t> sync_ref_threshold);
 
   size_t run_ref_sync(RefSyncData *ref_sync_data)
   {
     if (fn_ref_sync == nullptr)
     {
       Logger::log_error("Cannot run fn_ref_sync as it is NULL.");
-      exit(1);
+      exit_target(1);
     }
     return (*fn_ref_sync)(ref_sync_data);
   }
-  static void sync_ref_nonrepeating(DRAMAddr initial_aggressor, size_t sync_ref_threshold, asmjit::x86::Assembler &assembler);
+  // passed as sync_ref_threshold to jit_ref_sync, the jitted code compares against RefSyncData::sync_ref_threshold
+  // instead of an embedded threshold, so that the same code can be run with different thresholds
+  static constexpr std::nullopt_t RUNTIME_SYNC_REF_THRESHOLD = std::nullopt;
+
+  /// embeds the given (positive) threshold into the code; with RUNTIME_SYNC_REF_THRESHOLD, the threshold is taken
+  /// from %esi instead, which the caller must have loaded
+  static void sync_ref_nonrepeating(DRAMAddr initial_aggressor, std::optional<size_t> sync_ref_threshold,
+                                    asmjit::x86::Assembler &assembler);
 
   size_t get_next_sync_rows_idx();
 
 #ifdef ENABLE_JITTING
+  static void record_sync_timing(asmjit::x86::Assembler &assembler);
+
   void sync_ref(const std::vector<volatile char *> &sync_rows,
                 asmjit::x86::Assembler &assembler,
                 size_t num_timed_accesses);
 #endif
+  /// does the hammering without jitting, using the given flushing and fencing strategy
   void hammer_pattern_unjitted(FuzzingParameterSet &fuzzing_parameters,
                                bool verbose,
                                FLUSHING_STRATEGY flushing,
@@ -206,6 +250,15 @@ public:
                                const std::vector<volatile char *> &sync_rows,
                                size_t ref_threshold);
 
+  /// the instructions of one round of the hammering kernel in program order, i.e., the REF synchronization (starting
+  /// at sync_start) followed by the aggressor accesses and the flushes and fences of the given strategies, as issued
+  /// by jit_strict (JITTED) or hammer_pattern_unjitted (UNJITTED)
+  static std::vector<TraceAccess> get_access_sequence(HAMMERING_KERNEL kernel,
+                                                      FLUSHING_STRATEGY flushing,
+                                                      FENCING_STRATEGY fencing,
+                                                      const std::vector<volatile char *> &aggressor_pairs,
+                                                      volatile char *sync_start);
+
   void sync_ref_unjitted(const std::vector<volatile char *> &sync_rows,
                          synchronization_stats &sync_stats,
                          size_t ref_threshold, size_t sync_rounds_max) const;
@@ -25,6 +25,11 @@ class FuzzingParameterSet {
   // if this is set to any non-negative value, a fixed ACTs/tREFI value will be used instead of a random one.
   int fixed_acts_per_trefi = -1;
 
+  // the flushing/fencing strategy used for all patterns, e.g., as chosen by the KernelAutotuner
+  FLUSHING_STRATEGY fixed_flushing_strategy = FLUSHING_STRATEGY::EARLIEST_POSSIBLE;
+
+  FENCING_STRATEGY fixed_fencing_strategy = FENCING_STRATEGY::OMIT_FENCING;
+
   // initialized with -1 to add check for undefined/default value
   int num_activations_per_tREFI = -1;
 
@@ -112,6 +117,13 @@ class FuzzingParameterSet {
   void set_acts_per_trefi(int acts_per_trefi);
 
   void set_fixed_acts_per_trefi(int fixed_acts_per_trefi);
+
+  // Takes effect immediately and is kept by subsequent calls to randomize_parameters().
+  void set_fixed_strategies(FLUSHING_STRATEGY flushing, FENCING_STRATEGY fencing);
+
+  [[nodiscard]] std::string get_rng_state() const;
+
+  void set_rng_state(const std::string &state);
 };
 
 #endif //ZENHAMMER_INCLUDE_FUZZER_FUZZINGPARAMETERSET_HPP_
@@ -62,6 +62,13 @@ class HammeringPattern {
   PatternAddressMapper &get_most_effective_mapping();
 
   void remove_mappings_without_bitflips();
+
+  /// rebuilds the aggressor of each of the given number of activation slots from agg_access_patterns, in the same way
+  /// as PatternBuilder fills them
+  [[nodiscard]] std::vector<Aggressor> regenerate_aggressors(size_t num_slots) const;
+
+  /// the 64-bit FNV-1a hash of the aggressor IDs of all activation slots
+  [[nodiscard]] static uint64_t hash_aggressor_ids(const std::vector<Aggressor> &aggs);
 };
 
 #ifdef ENABLE_JSON
@@ -0,0 +1,101 @@
+#ifndef ZENHAMMER_INCLUDE_FUZZER_KERNELAUTOTUNER_HPP_
+#define ZENHAMMER_INCLUDE_FUZZER_KERNELAUTOTUNER_HPP_
+
+#include <string>
+#include <vector>
+
+#include "Fuzzer/CodeJitter.hpp"
+#include "Fuzzer/FuzzingParameterSet.hpp"
+#include "Memory/DramAnalyzer.hpp"
+#include "Utilities/Enums.hpp"
+#include "Utilities/PerfCounterGroup.hpp"
+
+#ifdef ENABLE_JSON
+#include <nlohmann/json.hpp>
+#endif
+
+// A hammering kernel together with the flushing and fencing strategy it is run with.
+struct KernelChoice
+{
+  HAMMERING_KERNEL kernel{HAMMERING_KERNEL::UNJITTED};
+
+  FLUSHING_STRATEGY flushing_strategy{FLUSHING_STRATEGY::EARLIEST_POSSIBLE};
+
+  FENCING_STRATEGY fencing_strategy{FENCING_STRATEGY::OMIT_FENCING};
+
+  // the rate (in ACTs/s) of verified activations on the calibration rows, over all trials
+  double acts_per_sec_mean{0};
+
+  double acts_per_sec_std{0};
+
+  // the fraction of the issued accesses that were confirmed to reach DRAM by the LLC miss counter; 0 if the PMU could
+  // not count them (e.g., as the LLC read miss event of the CPU does not count prefetchnta), the rates are those of the
+  // issued accesses then
+  double verified_fraction{0};
+
+  // the sustained ACT rate penalized by its variance; the autotuner picks the candidate with the highest score
+  [[nodiscard]] double get_score() const;
+
+  [[nodiscard]] std::string to_string() const;
+};
+
+// Benchmarks all available hammering kernels and flushing/fencing strategies on calibration rows and picks the one
+// with the highest sustained rate of activations. The calibration rows are a bank conflict set confirmed by timing, so
+// that every access that reaches DRAM is an activation, and only the accesses the LLC miss counter confirms to reach
+// DRAM are counted; otherwise, a kernel whose accesses are served by the caches would win. On CPUs whose LLC read miss
+// event only counts demand loads, the prefetchnta accesses of the kernels are invisible to it; this is detected by a
+// probe with a known number of DRAM accesses, and the issued accesses are used instead.
+class KernelAutotuner
+{
+private:
+  static constexpr size_t NUM_AGGRESSORS = 32;
+
+  // the first trial of each candidate is a warm-up run and not considered
+  static constexpr size_t NUM_TRIALS = 6;
+
+  static constexpr int NUM_ACTIVATIONS_PER_TRIAL = 2000000;
+
+  size_t ref_threshold;
+
+  CustomRandom cr;
+
+  FuzzingParameterSet params;
+
+  CodeJitter jitter;
+
+  std::vector<volatile char *> aggressors;
+
+  DRAMAddr sync_start;
+
+  std::vector<volatile char *> sync_rows;
+
+  PerfCounterGroup perf_counters;
+
+  // whether the LLC miss counter sees the kernels' accesses, see check_llc_miss_counter
+  bool can_verify_acts{false};
+
+  /// whether the LLC miss counter counts at least half of a known number of prefetchnta accesses that go to DRAM
+  bool check_llc_miss_counter();
+
+  KernelChoice benchmark(HAMMERING_KERNEL kernel, FLUSHING_STRATEGY flushing, FENCING_STRATEGY fencing);
+
+public:
+  /// DRAMAddr and the sync REF threshold of the DramAnalyzer must be initialized before
+  explicit KernelAutotuner(DramAnalyzer &dram_analyzer);
+
+  /// benchmarks all candidates and returns the best one
+  KernelChoice run();
+
+  /// the key under which calibration data is stored, derived from the DRAM geometry given on the command line
+  static std::string get_geometry_key(size_t num_ranks, size_t num_bankgroups, size_t num_banks, bool samsung);
+};
+
+#ifdef ENABLE_JSON
+
+void to_json(nlohmann::json &j, const KernelChoice &p);
+
+void from_json(const nlohmann::json &j, KernelChoice &p);
+
+#endif
+
+#endif //ZENHAMMER_INCLUDE_FUZZER_KERNELAUTOTUNER_HPP_
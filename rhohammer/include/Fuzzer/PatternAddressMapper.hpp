@@ -24,6 +24,13 @@ private:
                                std::vector<volatile char *> &addresses,
                                std::vector<int> &rows,std::vector<DRAMAddr> &aggr);
 
+  template <int multi_bank>
+  void export_pattern_internal_impl(std::vector<Aggressor> &aggressors,
+                                    int base_period,
+                                    std::vector<volatile char *> &addresses,
+                                    std::vector<int> &rows,
+                                    std::vector<DRAMAddr> &aggr);
+
   std::vector<DRAMAddr> victim_rows;
 
   CustomRandom cr;
@@ -32,6 +39,9 @@ private:
   // std::string instance_id;
 
 public:
+  // the number of rows above and below each aggressor that are checked for bit flips
+  static constexpr int ROW_BLAST_RADIUS = 3;
+
   // the unique identifier of this pattern-to-address mapping
   std::string instance_id;
   std::unique_ptr<CodeJitter> code_jitter;
@@ -54,7 +64,7 @@ public:
   // static size_t sc_counter;
   // static size_t bank_counter;
   // static size_t bankgroup_counter;
-  static DRAMAddr pattern_start_row;
+  static thread_local DRAMAddr pattern_start_row;
 
   // a mapping from aggressors included in this pattern to memory addresses (DRAMAddr)
   std::unordered_map<AGGRESSOR_ID_TYPE, DRAMAddr> aggressor_to_addr;
@@ -97,6 +107,11 @@ public:
 
   void shift_mapping(int rows, const std::unordered_set<AggressorAccessPattern> &aggs_to_move);
 
+  // moves all aggressors into the given bank group and bank such that the lowest one is in first_row, preserving the
+  // distances between the aggressors; returns false (and leaves the mapping unchanged) if the highest aggressor would be
+  // beyond the last row of the bank
+  [[nodiscard]] bool move_to(size_t bankgroup, size_t bank, size_t first_row);
+
   [[nodiscard]] size_t count_bitflips() const;
 };
 
@@ -0,0 +1,87 @@
+#ifndef ZENHAMMER_INCLUDE_FUZZER_PATTERNSTORE_HPP_
+#define ZENHAMMER_INCLUDE_FUZZER_PATTERNSTORE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Fuzzer/HammeringPattern.hpp"
+
+struct PatternStoreHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t num_patterns;
+  // the file offset of the index, which follows the records
+  uint64_t index_offset;
+};
+
+// An entry of the index, which is sorted by pattern ID. As old fuzz-summary.json files may contain multiple patterns
+// with the same ID (but different mappings), IDs are not necessarily unique.
+struct PatternStoreIndexEntry {
+  // the zero-padded pattern ID
+  char id[48];
+  // the file offset and length of the CBOR-encoded pattern
+  uint64_t offset;
+  uint64_t length;
+  // the number of bit flips over all mappings of the pattern, for selecting patterns without decoding them
+  uint64_t num_bitflips;
+  uint64_t num_mappings;
+};
+
+static_assert(sizeof(PatternStoreIndexEntry) == 80, "PatternStoreIndexEntry must be 80 bytes");
+
+// A read-only, memory-mapped archive of HammeringPatterns. The file consists of a PatternStoreHeader, the patterns as
+// CBOR-encoded records, and an index of PatternStoreIndexEntry sorted by ID. Patterns are only decoded when loaded,
+// hence looking up a few patterns in a large archive neither requires parsing the whole file nor keeping it in memory.
+class PatternStore {
+ private:
+  int fd{-1};
+
+  // the mapped file
+  const uint8_t *data{nullptr};
+
+  size_t data_size{0};
+
+  // a copy of the index, as the index offset in the file is not necessarily aligned to PatternStoreIndexEntry
+  std::vector<PatternStoreIndexEntry> index;
+
+ public:
+  static constexpr const char *FILE_EXTENSION = ".rps";
+
+  PatternStore() = default;
+
+  ~PatternStore();
+
+  PatternStore(const PatternStore &) = delete;
+
+  PatternStore &operator=(const PatternStore &) = delete;
+
+  /// whether the given file starts with the magic bytes of a pattern store
+  static bool is_pattern_store(const std::string &path);
+
+  /// maps the given file into memory; returns false if it is not a valid pattern store
+  bool open(const std::string &path);
+
+  void close();
+
+  [[nodiscard]] size_t size() const;
+
+  /// all index entries, sorted by ID
+  [[nodiscard]] std::vector<const PatternStoreIndexEntry *> get_entries() const;
+
+  /// the index entries of all patterns with the given ID
+  [[nodiscard]] std::vector<const PatternStoreIndexEntry *> find(const std::string &id) const;
+
+  /// the index entries of the k patterns with the most bit flips, in descending order
+  [[nodiscard]] std::vector<const PatternStoreIndexEntry *> get_top_k(size_t k) const;
+
+  /// decodes the pattern the given index entry refers to
+  [[nodiscard]] HammeringPattern load(const PatternStoreIndexEntry &entry) const;
+
+  /// converts the patterns of a fuzz-summary.json (or the old format that only consists of a pattern array) into a
+  /// pattern store; the JSON file is parsed incrementally, so only a single pattern is kept in memory at a time
+  static bool convert_from_json(const std::string &json_path, const std::string &store_path);
+};
+
+#endif //ZENHAMMER_INCLUDE_FUZZER_PATTERNSTORE_HPP_
@@ -0,0 +1,83 @@
+#ifndef ZENHAMMER_INCLUDE_FUZZER_PREFETCHBENCHMARK_HPP_
+#define ZENHAMMER_INCLUDE_FUZZER_PREFETCHBENCHMARK_HPP_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Utilities/Enums.hpp"
+#include "Utilities/PerfCounterGroup.hpp"
+#include "Utilities/Statistics.hpp"
+
+#ifdef ENABLE_JITTING
+#include <asmjit/asmjit.h>
+#endif
+
+// Characterizes how the host handles the instructions the hammering kernels are built from: the latency and issue
+// cost of prefetchnta, how many prefetches can be outstanding at once, and the access rate of a jitted loop of
+// prefetchnta accesses (like CodeJitter::jit_strict's) for each flushing and fencing strategy and padding length. Every
+// measurement is a row of a CSV file, together with the performance counters (incl. --perf-raw-events) collected
+// during the measurement if the PMU is accessible. DRAMAddr must be initialized before.
+class PrefetchBenchmark
+{
+private:
+  // the aggressors of the access loop, as in the kernel autotuning: same bank, every other row
+  static constexpr size_t NUM_AGGRESSORS = 32;
+
+  // the number of samples of the latency and outstanding-prefetch measurements
+  static constexpr size_t NUM_SAMPLES = 10000;
+
+  static constexpr size_t MAX_OUTSTANDING = 64;
+
+  static constexpr size_t NUM_ACCESSES_PER_TRIAL = 500000;
+
+  // the first trial of each access loop is a warm-up run and not considered
+  static constexpr size_t NUM_TRIALS = 6;
+
+  std::string host;
+
+  std::string cpu_model;
+
+  std::ofstream results;
+
+  PerfCounterGroup perf_counters;
+
+  std::vector<volatile char *> aggressors;
+
+  // lines in different banks and rows, so that the prefetches are only limited by the CPU
+  std::vector<volatile char *> spread_addresses;
+
+#ifdef ENABLE_JITTING
+  asmjit::JitRuntime runtime;
+
+  using AccessLoop = void (*)();
+
+  /// jits NUM_ACCESSES_PER_TRIAL prefetchnta accesses of the aggressors with the given strategies, each access
+  /// followed by the given number of nops
+  AccessLoop jit_access_loop(FLUSHING_STRATEGY flushing, FENCING_STRATEGY fencing, size_t padding_nops);
+#endif
+
+  void write_header();
+
+  /// writes a row; cycles are per access and converted into the access rate
+  void write_row(const std::string &benchmark, const std::string &flushing, const std::string &fencing,
+                 size_t padding_nops, size_t num_addresses, size_t num_accesses, double cycles_median,
+                 double cycles_p90, const PerfCounterSample &counters);
+
+  void measure_latency();
+
+  void measure_outstanding();
+
+  void measure_access_rate();
+
+public:
+  explicit PrefetchBenchmark(const std::string &results_filepath);
+
+  /// runs all benchmarks, each row is written as soon as its measurement is done
+  void run();
+
+  /// the name of the results file of this host
+  static std::string get_results_filename();
+};
+
+#endif // ZENHAMMER_INCLUDE_FUZZER_PREFETCHBENCHMARK_HPP_
@@ -7,6 +7,7 @@
 #include <sstream>
 
 #include "Utilities/Logger.hpp"
+#include "Utilities/RuntimeConfig.hpp"
 
 uint64_t static inline MB(uint64_t value) { return ((value) << 20ULL); }
 
@@ -15,27 +16,13 @@ uint64_t static inline GB(uint64_t value) { return ((value) << 30ULL); }
 [[gnu::unused]] static inline uint64_t BIT_SET(uint64_t value) { return (1ULL << (value)); }
 
 // ################### CONFIG PARAMETERS ##################
-
-// threshold to distinguish between bank conflict (t > BK_CONF_THRESH)
-// and a regular access without any bank conflict (t < BK_CONF_THRESH)
-#define BK_CONF_THRESH (430)  // worked best on DIMM 18
+// NOTE: Knobs that need tuning per host/DIMM are configured at runtime, see Utilities/RuntimeConfig.hpp.
 
 // number of bytes to be allocated
 #define MEM_SIZE (GB(1))
 #define HUGEPAGE_SZ (GB(1))
-#define MULTI_BANK 2
-#define HUGEPAGE_NUM -1  //default:-1
-#define REF_THREAD 1500
 #define NUM_MODE 1
-#define DEBUG_MODE 0
-// TODO: do not hard-code these values but pass them like in rowhammer-ref-impl
-// number of total banks in the system, calculated as #bankgroups x #banks
-#define NUM_BANKGROUPS (8)
-#define NUM_BANKS_PER_BG (4)
-#define NUM_BANKS (NUM_BANKGROUPS*NUM_BANKS_PER_BG)
-
-#ifndef FULL_SWEEP_ROWS
-#define FULL_SWEEP_ROWS 1024
-#endif
+// the average refresh interval (tREFI) in nanoseconds
+#define TREFI_NS (7800)
 
 #endif /* GLOBAL_DEFINES */
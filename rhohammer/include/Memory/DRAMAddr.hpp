@@ -59,12 +59,19 @@ struct MemConfiguration
 class DRAMAddr
 {
 private:
-  static std::map<size_t, MemConfiguration> Configs;
+  // the configuration is per thread, so that each worker of a campaign (see CampaignOrchestrator) can target a DIMM
+  // with a different geometry and memory mapping
+  static thread_local std::map<size_t, MemConfiguration> Configs;
 
-  static MemConfiguration MemConfig;
+  static thread_local MemConfiguration MemConfig;
 
-  static uint64_t base_msb;
-  static uint64_t base_pfn;
+  static thread_local uint64_t base_msb;
+  static thread_local uint64_t base_pfn;
+
+  // the XOR difference between the virtual addresses of two rows that only differ in the given row bit
+  static thread_local size_t row_bit_deltas[64];
+
+  static void initialize_row_bit_deltas();
 
   size_t subchan{};
   size_t rank{};
@@ -94,6 +101,9 @@ public:
 
   static void initialize_configs();
 
+  /// a hash (hex string) of the address mapping in use, which changes if the mapping functions change
+  static std::string get_mapping_hash();
+
   explicit DRAMAddr(void *vaddr);
 
   [[gnu::unused]] std::string to_string();
@@ -134,6 +144,25 @@ public:
     return MemConfig.DRAM_MTX[row_0_index];
   }
 
+  static size_t get_max_row()
+  {
+    return MemConfig.ROW_MASK;
+  }
+
+  /// the XOR difference between the virtual address of a location in the given row and the same location increment
+  /// rows further (incl. the wrap-around after the last row); as the mapping is linear, this is the same for all
+  /// banks/columns
+  static size_t get_row_delta(size_t row_no, size_t increment)
+  {
+    auto changed_bits = (row_no ^ ((row_no + increment) & MemConfig.ROW_MASK)) & MemConfig.ROW_MASK;
+    size_t delta = 0;
+    for (; changed_bits != 0; changed_bits &= changed_bits - 1)
+    {
+      delta ^= row_bit_deltas[__builtin_ctzl(changed_bits)];
+    }
+    return delta;
+  }
+
   void set_row(size_t row_no);
   void set_col(size_t col_no);
   void add_bank(size_t bank_increment);
@@ -8,6 +8,33 @@
 #include "Utilities/AsmPrimitives.hpp"
 #include "Utilities/CustomRandom.hpp"
 #include "Utilities/ExperimentConfig.hpp"
+#include "Utilities/Statistics.hpp"
+
+// The result of measuring the activations per REF interval with an ExperimentConfig.
+struct ActsPerRefMeasurement {
+  // the timing threshold (cycles) above which an access round is assumed to have collided with a REF
+  uint64_t ref_threshold{0};
+
+  // the activations per REF interval determined in each measured round; 0 if a round did not yield a reasonable value
+  std::vector<size_t> acts_per_round;
+
+  // the mean of the reasonable values of all rounds; 0 if there is none
+  size_t acts_per_ref{0};
+
+  // the half-width of the confidence interval of acts_per_ref at the requested confidence, and the confidence at
+  // which acts_per_ref is within the requested precision (see RuntimeConfig::calibration_confidence)
+  double acts_per_ref_half_width{0};
+
+  double confidence{0};
+
+  // the number of REFs observed in all rounds
+  size_t num_refs{0};
+
+  // the number of rounds measured to find the REF threshold, including the ones with an implausible threshold
+  size_t num_tries{0};
+
+  double duration_sec{0};
+};
 
 class DramAnalyzer {
  private:
@@ -22,6 +49,11 @@ class DramAnalyzer {
 
   void find_targets(std::vector<volatile char *> &target_bank);
 
+  /// Checks by timing that the first address conflicts with (up to) the next few same-bank addresses but not with
+  /// the address in another bank.
+  bool validate_same_bank(const std::vector<volatile char *> &same_bank, volatile char *other_bank,
+                          size_t conflict_threshold);
+
   std::uniform_int_distribution<int> dist;
 
   CustomRandom cr;
@@ -36,6 +68,15 @@ class DramAnalyzer {
   /// Finds addresses of the same bank causing bank conflicts when accessed sequentially
   void find_bank_conflicts();
 
+  /// Constructs the same-bank address sets from the address mapping (DRAMAddr) and only validates a few of them by
+  /// timing against the measured bank conflict threshold (see find_threshold); falls back to find_bank_conflicts if
+  /// the timing disagrees with the mapping.
+  void find_bank_conflicts_from_mapping();
+
+  /// Up to num_rows addresses of different rows in the first bank whose accesses conflict with the first of them by
+  /// timing (against the measured bank conflict threshold), i.e., rows of the real bank conflict set.
+  std::vector<volatile char *> get_conflicting_rows(size_t num_rows);
+
   /// Finds the SBDR threshold.
   void find_threshold();
 
@@ -46,17 +87,24 @@ class DramAnalyzer {
 
   bool check_sync_ref_threshold(size_t sync_ref_threshold);
 
+  /// Quickly checks whether a previously determined sync REF threshold still detects the REFs.
+  bool validate_sync_ref_threshold(size_t sync_ref_threshold);
+
   /// Measures the time between accessing two addresses.
   static size_t inline measure_time(volatile char *a1, volatile char *a2);
 
   /// Determine the number of possible activations within a refresh interval.
   size_t count_acts_per_ref(const ExperimentConfig &exp_cfg);
 
+  /// Measures the activations per refresh interval as described by the experiment config; also sets the REF threshold.
+  ActsPerRefMeasurement measure_acts_per_ref(const ExperimentConfig &exp_cfg);
+
   size_t count_acts_per_ref();
 
   [[nodiscard]] unsigned long get_ref_threshold() const;
 
-  std::vector<uint64_t> get_nth_highest_values(size_t N, std::vector<uint64_t> &values);
+  /// the N most frequent values, most frequent first
+  std::vector<uint64_t> get_nth_highest_values(size_t N, const LogLinearHistogram &values);
 };
 
 #endif /* DRAMANALYZER */
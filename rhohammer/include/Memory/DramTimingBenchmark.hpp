@@ -0,0 +1,76 @@
+#ifndef ZENHAMMER_INCLUDE_MEMORY_DRAMTIMINGBENCHMARK_HPP_
+#define ZENHAMMER_INCLUDE_MEMORY_DRAMTIMINGBENCHMARK_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Utilities/Statistics.hpp"
+
+// Microbenchmarks of the DRAM timing as the CPU observes it: row buffer hit and conflict latency per bank, the
+// latency of activating two banks at once in the same or in different bank groups (tRRD_L/tRRD_S), the latency of
+// activating up to eight banks at once (tFAW), and the interval and duration of REFs. Addresses are constructed with
+// DRAMAddr, which must be initialized before. All latencies are in ns and kept as distributions, which are written to a
+// JSON file so that hosts (or BIOS/firmware versions of a host) can be compared.
+class DramTimingBenchmark
+{
+private:
+  // the number of samples of each distribution
+  static constexpr size_t NUM_SAMPLES = 10000;
+
+  // the maximum number of banks activated at once for the four-activate window
+  static constexpr size_t MAX_WINDOW_BANKS = 8;
+
+  // the number of back-to-back accesses the REFs are detected in
+  static constexpr size_t NUM_REFRESH_SAMPLES = 1000000;
+
+  std::string results_filepath;
+
+  // indexed by the flat bank index (bankgroup * #banks + bank)
+  std::vector<LogLinearHistogram> row_hit_ns;
+
+  std::vector<LogLinearHistogram> row_conflict_ns;
+
+  LogLinearHistogram single_act_ns;
+
+  LogLinearHistogram same_bankgroup_acts_ns;
+
+  LogLinearHistogram different_bankgroup_acts_ns;
+
+  // indexed by the number of banks activated at once minus one
+  std::vector<LogLinearHistogram> activate_window_ns;
+
+  LogLinearHistogram refresh_interval_ns;
+
+  // the additional latency of an access that collided with a REF
+  LogLinearHistogram refresh_duration_ns;
+
+  double refresh_threshold_ns{0};
+
+  /// the cycles it takes to access addr right after opener was accessed
+  static uint64_t time_access_after(volatile char *opener, volatile char *addr);
+
+  /// the cycles it takes to access all addresses at once
+  static uint64_t time_accesses(const std::vector<volatile char *> &addrs);
+
+  /// the address of the given row in the given flat bank
+  static volatile char *get_address(size_t flat_bank, size_t row, size_t col = 0);
+
+  void measure_row_buffer();
+
+  void measure_act_spacing();
+
+  void measure_activate_window();
+
+  void measure_refresh();
+
+  void write_results() const;
+
+public:
+  explicit DramTimingBenchmark(const std::string &results_filepath);
+
+  /// runs all benchmarks and writes their results
+  void run();
+};
+
+#endif // ZENHAMMER_INCLUDE_MEMORY_DRAMTIMINGBENCHMARK_HPP_
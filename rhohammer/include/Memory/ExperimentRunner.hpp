@@ -0,0 +1,31 @@
+#ifndef ZENHAMMER_INCLUDE_MEMORY_EXPERIMENTRUNNER_HPP_
+#define ZENHAMMER_INCLUDE_MEMORY_EXPERIMENTRUNNER_HPP_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Memory/DramAnalyzer.hpp"
+#include "Utilities/ExperimentConfig.hpp"
+
+// Runs a batch of calibration experiments (see ExperimentConfig::load_all) back-to-back on the same memory and address
+// mapping, and writes one row per experiment to a CSV file so that the configs can be compared directly.
+class ExperimentRunner
+{
+private:
+  DramAnalyzer &dram_analyzer;
+
+  std::ofstream results;
+
+  void write_header();
+
+  void write_row(const ExperimentConfig &exp_cfg, const ActsPerRefMeasurement &measurement);
+
+public:
+  ExperimentRunner(DramAnalyzer &dram_analyzer, const std::string &results_filepath);
+
+  /// runs the given experiments in order; each result row is written as soon as its experiment is done
+  void run(const std::vector<ExperimentConfig> &exp_cfgs);
+};
+
+#endif // ZENHAMMER_INCLUDE_MEMORY_EXPERIMENTRUNNER_HPP_
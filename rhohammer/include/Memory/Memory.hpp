@@ -28,7 +28,8 @@ class Memory {
   // whether this memory allocation is backed up by a superage
   const bool superpage;
 
-  size_t check_memory_internal(PatternAddressMapper &mapping, const volatile char *start,
+  // the bit flips are also stored in the given mapping unless it is nullptr
+  size_t check_memory_internal(PatternAddressMapper *mapping, const volatile char *start,
                                const volatile char *end, bool reproducibility_mode, bool verbose);
 
   DATA_PATTERN data_pattern;
@@ -57,6 +58,9 @@ class Memory {
   /// Check memory
   size_t check_memory(PatternAddressMapper &mapping, bool reproducibility_mode, bool verbose);
 
+  /// Check the rows starting at the given addresses; the bit flips are only stored in flipped_bits
+  size_t check_memory(const std::vector<volatile char *> &victim_row_starts, bool verbose);
+
   [[nodiscard]] volatile char *get_starting_address() const;
 
   std::string get_flipped_rows_text_repr();
@@ -0,0 +1,130 @@
+#ifndef ZENHAMMER_INCLUDE_MEMORY_SIMULATEDDRAM_HPP_
+#define ZENHAMMER_INCLUDE_MEMORY_SIMULATEDDRAM_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <unordered_map>
+
+#include "GlobalDefines.hpp"
+#include "Memory/DRAMAddr.hpp"
+
+// The parameters of the simulated DRAM (see SimulatedDram).
+struct SimulatedDramConfig
+{
+  // seeds the vulnerability of the rows and the location of the injected bit flips
+  uint64_t seed{0};
+
+  // the average number of ACTs of its neighbouring rows after which a row flips, if it is not refreshed in-between;
+  // the threshold of each row is between 0.5x and 1.5x of it
+  size_t flip_threshold{20000};
+
+  double row_hit_ns{15};
+
+  // accessing a bank without an open row (ACT)
+  double row_miss_ns{30};
+
+  // accessing a bank with another row open (PRE + ACT)
+  double row_conflict_ns{45};
+
+  double trefi_ns{TREFI_NS};
+
+  double trfc_ns{350};
+
+  // the number of REFs after which every row was refreshed once, i.e., tREFW/tREFI
+  size_t refs_per_window{8192};
+};
+
+// A software model of the DRAM behind the memory buffer, so that the hammering code can run without real DRAM, e.g.,
+// in CI. Addresses are mapped to banks and rows with DRAMAddr (i.e., the loaded MemConfiguration). Each bank has a row
+// buffer, an access takes the hit/miss/conflict latency on a simulated clock, and every tREFI a REF closes all rows,
+// delays the access colliding with it by tRFC, and refreshes the next rows. Each ACT disturbs the two neighbouring
+// rows (only one at the first and last row of a bank); once a row received more disturbance since its last refresh than its threshold, a random bit of it is flipped
+// in the buffer itself, where Memory::check_memory finds it. Everything is deterministic for a given seed and access
+// stream. The simulation is per thread and enabled with enable().
+class SimulatedDram
+{
+private:
+  struct RowState
+  {
+    // the REF that refreshed the row when its disturbance was last updated
+    uint64_t last_refresh{0};
+
+    uint64_t disturbance{0};
+  };
+
+  static thread_local std::unique_ptr<SimulatedDram> instance;
+
+  SimulatedDramConfig config;
+
+  volatile char *start_address;
+
+  size_t size;
+
+  std::mt19937_64 gen;
+
+  double now_ns{0};
+
+  double next_ref_ns;
+
+  uint64_t num_refs{0};
+
+  uint64_t num_acts{0};
+
+  uint64_t num_flips{0};
+
+  // flips of rows that are outside of the simulated buffer, which are not injected
+  uint64_t num_dropped_flips{0};
+
+  // bank key -> open row
+  std::unordered_map<uint64_t, size_t> open_rows;
+
+  // (bank key, row) -> state, only for rows that were disturbed since their last refresh; the others are removed once
+  // per refresh window (see refresh_if_due)
+  std::unordered_map<uint64_t, RowState> rows;
+
+  /// the subchannel, rank, bank group, and bank of the address
+  static uint64_t get_bank_key(const DRAMAddr &addr);
+
+  /// the number of the last REF that refreshed the row, 0 if it was not refreshed yet
+  [[nodiscard]] uint64_t get_last_refresh(size_t row) const;
+
+  /// the flip threshold of the row, derived from the seed
+  [[nodiscard]] double get_row_threshold(uint64_t bank_key, size_t row) const;
+
+  void refresh_if_due();
+
+  void activate(uint64_t bank_key, const DRAMAddr &addr);
+
+  void disturb(uint64_t bank_key, const DRAMAddr &aggressor, size_t victim_row);
+
+  void inject_flip(const DRAMAddr &aggressor, size_t victim_row);
+
+public:
+  SimulatedDram(const SimulatedDramConfig &config, volatile char *start_address, size_t size);
+
+  /// simulates the DRAM behind [start_address, start_address + size) for this thread; DRAMAddr must be initialized
+  static void enable(const SimulatedDramConfig &config, volatile char *start_address, size_t size);
+
+  /// the simulation of this thread, nullptr if it is not enabled
+  static SimulatedDram *get();
+
+  /// accesses the address (which is assumed to miss the caches) and returns its latency in ns
+  double access(volatile char *addr);
+
+  /// the simulated time in TSC cycles, so that it can replace rdtscp in the hammering code
+  [[nodiscard]] uint64_t get_time_cycles() const;
+
+  /// the sync REF threshold in TSC cycles: above the latency of a row conflict, below the one colliding with a REF
+  [[nodiscard]] size_t get_ref_threshold() const;
+
+  [[nodiscard]] uint64_t get_num_acts() const;
+
+  [[nodiscard]] uint64_t get_num_refs() const;
+
+  [[nodiscard]] uint64_t get_num_flips() const;
+
+  [[nodiscard]] uint64_t get_num_dropped_flips() const;
+};
+
+#endif // ZENHAMMER_INCLUDE_MEMORY_SIMULATEDDRAM_HPP_
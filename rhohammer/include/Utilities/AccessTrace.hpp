@@ -0,0 +1,118 @@
+#ifndef ZENHAMMER_INCLUDE_UTILITIES_ACCESSTRACE_HPP_
+#define ZENHAMMER_INCLUDE_UTILITIES_ACCESSTRACE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Utilities/Enums.hpp"
+
+enum class TRACE_OP : uint8_t {
+  // the start of a REF synchronization; its address is the first sync row
+  SYNC = 0,
+  // a hammering access (prefetchnta)
+  ACCESS = 1,
+  // clflushopt
+  FLUSH = 2,
+  MFENCE = 3,
+  LFENCE = 4
+};
+
+std::string to_string(TRACE_OP op);
+
+// A single instruction of the access sequence, with the DRAM coordinates of its address.
+struct TraceAccess {
+  TRACE_OP op{TRACE_OP::ACCESS};
+  // the virtual address, 0 for fences
+  uint64_t addr{0};
+  uint32_t subchannel{0};
+  uint32_t rank{0};
+  uint32_t bankgroup{0};
+  uint32_t bank{0};
+  uint32_t row{0};
+  uint32_t col{0};
+
+  /// resolves the DRAM coordinates of the address with DRAMAddr, which must be initialized; addr is ignored for fences
+  static TraceAccess resolve(TRACE_OP op, volatile char *addr);
+
+  [[nodiscard]] bool has_address() const;
+
+  /// identifies the bank of the address, i.e., its subchannel, rank, bank group, and bank
+  [[nodiscard]] uint64_t get_bank_key() const;
+};
+
+// Describes where and how an access sequence was hammered.
+struct AccessTraceHeader {
+  std::string pattern_id;
+  std::string mapping_id;
+  // the index of the DRAM location the mapping was shifted to
+  uint64_t location{0};
+  HAMMERING_KERNEL kernel{HAMMERING_KERNEL::JITTED};
+  FLUSHING_STRATEGY flushing{FLUSHING_STRATEGY::EARLIEST_POSSIBLE};
+  FENCING_STRATEGY fencing{FENCING_STRATEGY::LATEST_POSSIBLE};
+  // the number of aggressor accesses within a refresh interval, 0 if unknown
+  uint64_t acts_per_trefi{0};
+  // how often the kernel ran the sequence, each time after synchronizing with REF
+  uint64_t num_rounds{0};
+};
+
+struct AccessTraceBlock {
+  AccessTraceHeader header;
+  // one round of the kernel in program order, starting with its SYNC
+  std::vector<TraceAccess> accesses;
+};
+
+// Writes the access sequences of hammered patterns into a compact binary trace: a file header ("RTRC", version)
+// followed by one block per pattern, mapping, and DRAM location. A block is [varint payload length][payload], where
+// the payload is the header (strings are length-prefixed, numbers varints) and the accesses. Each access is its
+// TRACE_OP byte and, unless it is a fence, the zigzag varint delta of its address and row to the previous access of
+// the block, followed by the varint subchannel, rank, bank group, bank, and column. Blocks are independent, i.e., a
+// truncated trace (e.g., due to a crash) can be read up to its last complete block.
+class AccessTraceWriter {
+ private:
+  std::ofstream os;
+
+  std::string filepath;
+
+  // the encoded payload of the current block
+  std::string payload;
+
+ public:
+  /// creates (or truncates) the trace; with append, an existing trace is continued after its last complete block
+  /// instead (e.g., when a run is resumed); exits on failure
+  void open(const std::string &path, bool append = false);
+
+  [[nodiscard]] bool is_open() const;
+
+  [[nodiscard]] const std::string &get_filepath() const;
+
+  /// appends a block and flushes the trace
+  void write(const AccessTraceHeader &header, const std::vector<TraceAccess> &accesses);
+
+  void close();
+};
+
+// Reads the blocks of a trace written by AccessTraceWriter one at a time.
+class AccessTraceReader {
+ private:
+  std::ifstream is;
+
+  std::vector<char> payload;
+
+  // the file offset after the last block that was read completely
+  uint64_t offset{0};
+
+ public:
+  /// returns false if the file cannot be opened or is not a trace
+  bool open(const std::string &path);
+
+  /// reads the next block; returns false at the end of the trace or if the remaining block is incomplete or corrupt
+  bool next(AccessTraceBlock &block);
+
+  /// the file offset after the last block next returned, i.e., the length of the trace's valid part
+  [[nodiscard]] uint64_t get_offset() const;
+};
+
+#endif //ZENHAMMER_INCLUDE_UTILITIES_ACCESSTRACE_HPP_
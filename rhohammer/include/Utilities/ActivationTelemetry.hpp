@@ -0,0 +1,62 @@
+#ifndef ZENHAMMER_INCLUDE_UTILITIES_ACTIVATIONTELEMETRY_HPP_
+#define ZENHAMMER_INCLUDE_UTILITIES_ACTIVATIONTELEMETRY_HPP_
+
+#include <cstdint>
+
+#include "Utilities/Enums.hpp"
+#include "Utilities/Statistics.hpp"
+
+#ifdef ENABLE_JSON
+#include <nlohmann/json.hpp>
+#endif
+
+// The activations achieved by a hammering kernel within a given number of TSC cycles. Can be summed up over several
+// hammering runs, the derived rates then describe the whole set of runs.
+struct ActivationRate {
+  // number of issued row activations, including the dummy accesses for REF synchronization
+  uint64_t total_acts{0};
+
+  // duration of the hammering in TSC cycles
+  uint64_t tsc_delta{0};
+
+  [[nodiscard]] bool is_valid() const;
+
+  [[nodiscard]] double get_duration_ns() const;
+
+  [[nodiscard]] double get_acts_per_sec() const;
+
+  [[nodiscard]] double get_acts_per_trefi() const;
+
+  void accumulate(const ActivationRate &other);
+};
+
+// Aggregates the activation rates of all hammering runs into histograms, separately for each hammering kernel.
+class ActivationTelemetry {
+ private:
+  struct KernelHistograms {
+    LogLinearHistogram acts_per_trefi;
+    LogLinearHistogram acts_per_sec;
+    ActivationRate total;
+  };
+
+  KernelHistograms jitted;
+
+  KernelHistograms unjitted;
+
+  KernelHistograms &get(HAMMERING_KERNEL kernel);
+
+ public:
+  void record(HAMMERING_KERNEL kernel, const ActivationRate &rate);
+
+#ifdef ENABLE_JSON
+  [[nodiscard]] nlohmann::json to_json() const;
+#endif
+};
+
+#ifdef ENABLE_JSON
+
+void to_json(nlohmann::json &j, const ActivationRate &p);
+
+#endif
+
+#endif //ZENHAMMER_INCLUDE_UTILITIES_ACTIVATIONTELEMETRY_HPP_
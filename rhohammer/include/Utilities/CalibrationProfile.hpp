@@ -0,0 +1,84 @@
+#ifndef ZENHAMMER_INCLUDE_UTILITIES_CALIBRATIONPROFILE_HPP_
+#define ZENHAMMER_INCLUDE_UTILITIES_CALIBRATIONPROFILE_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include "Fuzzer/KernelAutotuner.hpp"
+
+#ifdef ENABLE_JSON
+#include <nlohmann/json.hpp>
+#endif
+
+// The calibration results of a DIMM on a host. A profile is identified by the host, the CPU model, the DIMM, its
+// geometry, and the address mapping, so that it is not used anymore as soon as any of them changes. Each value is
+// stored with the time it was determined at (UNIX timestamp in seconds, 0 if it is unknown).
+struct CalibrationProfile {
+  std::string host;
+
+  std::string cpu_model;
+
+  long dimm_id{-1};
+
+  // see KernelAutotuner::get_geometry_key
+  std::string geometry;
+
+  // see DRAMAddr::get_mapping_hash
+  std::string mapping_hash;
+
+  // the sync REF threshold in cycles, -1 if unknown
+  long ref_threshold{-1};
+
+  int64_t ref_threshold_timestamp{0};
+
+  bool has_kernel_choice{false};
+
+  KernelChoice kernel_choice;
+
+  int64_t kernel_choice_timestamp{0};
+
+  [[nodiscard]] std::string get_key() const;
+
+  /// whether a value determined at the given time is at most max_age seconds old
+  static bool is_fresh(int64_t timestamp, int64_t max_age);
+
+  static std::string get_host_name();
+
+  /// the model name in /proc/cpuinfo
+  static std::string get_cpu_model();
+};
+
+// A JSON file of calibration profiles (calibration.json). Files written before the profiles were introduced, which
+// only map geometries to kernel choices, are migrated on load: their entries become profiles of this host without a
+// DIMM and mapping, of which only the kernel choice can be used (see load_kernel_choice).
+class CalibrationProfileStore {
+ private:
+  std::string filepath;
+
+#ifdef ENABLE_JSON
+  [[nodiscard]] nlohmann::json read_profiles() const;
+#endif
+
+ public:
+  explicit CalibrationProfileStore(std::string filepath);
+
+  /// fills the calibration values of the given profile from the stored one with the same key; returns false if there
+  /// is none
+  bool load(CalibrationProfile &profile) const;
+
+  /// the most recent kernel choice of any stored profile of the same host and CPU model with the same geometry
+  bool load_kernel_choice(const CalibrationProfile &profile, KernelChoice &choice, int64_t &timestamp) const;
+
+  /// adds or replaces the profile, keeping the other ones
+  void store(const CalibrationProfile &profile) const;
+};
+
+#ifdef ENABLE_JSON
+
+void to_json(nlohmann::json &j, const CalibrationProfile &p);
+
+void from_json(const nlohmann::json &j, CalibrationProfile &p);
+
+#endif
+
+#endif //ZENHAMMER_INCLUDE_UTILITIES_CALIBRATIONPROFILE_HPP_
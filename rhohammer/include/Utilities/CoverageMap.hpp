@@ -0,0 +1,99 @@
+#ifndef ZENHAMMER_INCLUDE_UTILITIES_COVERAGEMAP_HPP_
+#define ZENHAMMER_INCLUDE_UTILITIES_COVERAGEMAP_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+struct CoverageMapHeader {
+  char magic[4];
+  uint32_t version;
+  int64_t dimm_id;
+  uint64_t num_banks;
+  uint64_t rows_per_bank;
+  // the number of (pattern, mapping) entries in the file
+  uint64_t num_entries;
+};
+
+// The results of a (pattern, mapping) at all locations it was hammered at; in the file, each entry is followed by its
+// bitmap of covered locations and its bitmap of locations with bit flips.
+struct CoverageMapEntry {
+  // the zero-padded IDs of the pattern and the mapping
+  char pattern_id[48];
+  char mapping_id[48];
+  // the number of locations the pattern was hammered at, the number of them with bit flips, and the number of corrupted
+  // bytes at all of them
+  uint64_t num_covered;
+  uint64_t num_flipped;
+  uint64_t num_bitflips;
+  uint64_t reserved;
+};
+
+static_assert(sizeof(CoverageMapEntry) == 128, "CoverageMapEntry must be 128 bytes");
+
+// A persistent, memory-mapped record of the (bank, row) locations each (pattern, mapping) was already hammered at on a
+// DIMM. A location is identified by the bank of the pattern's first access and the row of its lowest aggressor. Entries
+// are appended when a (pattern, mapping) is hammered for the first time, which grows the file; bits are set in place, so
+// a crashed run loses at most what the OS did not write back yet (see sync).
+class CoverageMap {
+ private:
+  int fd{-1};
+
+  std::string filepath;
+
+  uint8_t *data{nullptr};
+
+  size_t data_size{0};
+
+  // the number of bytes of each of the two bitmaps of an entry, a multiple of 8
+  size_t bitmap_size{0};
+
+  // (pattern ID/mapping ID) -> index of the entry
+  std::unordered_map<std::string, size_t> slots;
+
+  [[nodiscard]] CoverageMapHeader *get_header() const;
+
+  [[nodiscard]] size_t get_entry_offset(size_t slot) const;
+
+  [[nodiscard]] size_t get_bit_index(size_t bank, size_t row) const;
+
+  void map(size_t size);
+
+ public:
+  CoverageMap() = default;
+
+  ~CoverageMap();
+
+  CoverageMap(const CoverageMap &) = delete;
+
+  CoverageMap &operator=(const CoverageMap &) = delete;
+
+  /// opens (or creates) the coverage map of the given DIMM; exits if the file cannot be mapped or was created for a
+  /// different DIMM or geometry
+  void open(const std::string &path, long dimm_id, size_t num_banks, size_t rows_per_bank);
+
+  [[nodiscard]] bool is_open() const;
+
+  /// the slot of the given (pattern, mapping), which is added if it has no entry yet
+  size_t get_slot(const std::string &pattern_id, const std::string &mapping_id);
+
+  [[nodiscard]] const CoverageMapEntry &get_entry(size_t slot) const;
+
+  [[nodiscard]] bool is_covered(size_t slot, size_t bank, size_t row) const;
+
+  [[nodiscard]] bool has_flipped(size_t slot, size_t bank, size_t row) const;
+
+  /// records that the pattern of the given slot was hammered at the location, resulting in num_bitflips corrupted bytes
+  void mark(size_t slot, size_t bank, size_t row, size_t num_bitflips);
+
+  /// the fraction of all locations of the DIMM that the (pattern, mapping) of the given slot was hammered at
+  [[nodiscard]] double get_covered_fraction(size_t slot) const;
+
+  /// writes all changes back to the file
+  void sync();
+
+  void close();
+};
+
+#endif //ZENHAMMER_INCLUDE_UTILITIES_COVERAGEMAP_HPP_
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <random>
+#include <string>
 
 #define PSEUDORANDOM (1)
 
@@ -13,6 +14,11 @@ public:
   std::mt19937 gen;
 
   explicit CustomRandom();
+
+  /// the generator's state in textual form, e.g., to continue a run after restarting the program
+  [[nodiscard]] std::string get_state() const;
+
+  void set_state(const std::string &state);
 };
 
 #endif //ZENHAMMER_INCLUDE_UTILITIES_CUSTOMRANDOM_HPP
@@ -0,0 +1,58 @@
+#ifndef ZENHAMMER_INCLUDE_UTILITIES_DURABLELOG_HPP_
+#define ZENHAMMER_INCLUDE_UTILITIES_DURABLELOG_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// An append-only, line-oriented log that survives crashes of this process and of the machine: lines are written with
+// a single write(2) each and made durable by fsync(2), which is batched to keep its overhead low.
+class DurableLog {
+ private:
+  int fd{-1};
+
+  std::string filepath;
+
+  // the number of lines appended since the last fsync
+  size_t num_unsynced{0};
+
+  // the time of the last fsync in seconds
+  int64_t last_sync_ts{0};
+
+  // fsync after this many lines or seconds, whatever comes first
+  size_t sync_every_lines;
+
+  int64_t sync_every_sec;
+
+  // removes a trailing line that was not completely written (e.g., due to a crash), so that appending can continue
+  void drop_partial_line();
+
+ public:
+  explicit DurableLog(size_t sync_every_lines = 16, int64_t sync_every_sec = 10);
+
+  ~DurableLog();
+
+  DurableLog(const DurableLog &) = delete;
+
+  DurableLog &operator=(const DurableLog &) = delete;
+
+  /// opens the log for appending, creating it if it does not exist yet; exits on failure
+  void open(const std::string &path);
+
+  [[nodiscard]] bool is_open() const;
+
+  /// appends the line (a trailing newline is added) and fsyncs if a batch is full or force_sync is set
+  void append(const std::string &line, bool force_sync = false);
+
+  /// makes all appended lines durable
+  void sync();
+
+  void close();
+
+  /// calls the given function for each complete line in the log; a trailing partial line (e.g., due to a crash during
+  /// write) is ignored and the number of ignored bytes is returned
+  static size_t read_lines(const std::string &path, const std::function<void(const std::string &)> &fn);
+};
+
+#endif //ZENHAMMER_INCLUDE_UTILITIES_DURABLELOG_HPP_
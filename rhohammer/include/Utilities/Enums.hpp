@@ -31,6 +31,28 @@ std::string to_string(FENCING_STRATEGY strategy);
 
 void from_string(const std::string &strategy, FENCING_STRATEGY &dest);
 
+enum class HAMMERING_KERNEL : int {
+  // the hammering code generated at runtime by CodeJitter::jit_strict
+  JITTED = 0,
+  // the precompiled hammering loop in CodeJitter::hammer_pattern_unjitted
+  UNJITTED = 1
+};
+
+std::string to_string(HAMMERING_KERNEL kernel);
+
+void from_string(const std::string &kernel, HAMMERING_KERNEL &dest);
+
+enum class RESULT_FORMAT : int {
+  // one JSON object per line
+  JSONL = 0,
+  // length-prefixed records with CBOR-encoded payloads and packed bit flips
+  BINARY = 1
+};
+
+std::string to_string(RESULT_FORMAT format);
+
+void from_string(const std::string &format, RESULT_FORMAT &dest);
+
 std::vector<std::pair<FLUSHING_STRATEGY, FENCING_STRATEGY>> get_valid_strategies();
 
 [[maybe_unused]] std::pair<FLUSHING_STRATEGY, FENCING_STRATEGY> get_valid_strategy_pair(std::mt19937 &gen);
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 enum class execution_mode : int
 {
@@ -27,23 +28,27 @@ static std::string get_string_from_execution_mode(const execution_mode &exm)
   return lookup_map[exm];
 }
 
+// The parameters of a measurement of the activations per REF interval (see DramAnalyzer::measure_acts_per_ref). The
+// defaults are the ones DramAnalyzer::count_acts_per_ref() uses.
 class ExperimentConfig
 {
 public:
   std::string filepath;
   size_t config_id{};
-  execution_mode exec_mode;
-  size_t num_measurement_rounds{};
-  size_t num_measurement_reps{};
-  size_t num_accesses_per_round{};
-  size_t num_sync_rows{};
-  size_t row_distance{};
-  size_t min_ref_thresh{};
-  bool row_origin_same_bg{};
-  bool row_origin_same_bk{};
+  execution_mode exec_mode{execution_mode::ALTERNATING};
+  size_t num_measurement_rounds{10};
+  size_t num_measurement_reps{10'000};
+  size_t num_accesses_per_round{2};
+  // the rows accessed to synchronize with a REF before each round that counts the activations
+  size_t num_sync_rows{32};
+  size_t row_distance{4};
+  size_t min_ref_thresh{1260};
+  bool row_origin_same_bg{true};
+  bool row_origin_same_bk{true};
 
   ExperimentConfig() = default;
 
+  /// loads the config with the given ID from the YAML file; exits if there is none
   ExperimentConfig(const std::string &filepath, size_t config_id);
 
   ExperimentConfig(execution_mode ExecMode,
@@ -55,6 +60,12 @@ public:
                    size_t MinRefThresh,
                    bool RowOriginSameBg,
                    bool RowOriginSameBk);
+
+  /// loads all configs of the YAML file, i.e., the ones listed in 'experiment_configs' and the cartesian product of the
+  /// values listed in 'matrix'; only the one with the given ID unless config_id is -1
+  static std::vector<ExperimentConfig> load_all(const std::string &filepath, int config_id = -1);
+
+  [[nodiscard]] std::string to_string() const;
 };
 
 #endif // ZENHAMMER_SRC_UTILITIES_EXPERIMENTCONFIG_HPP
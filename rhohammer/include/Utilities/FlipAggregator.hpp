@@ -0,0 +1,89 @@
+#ifndef ZENHAMMER_INCLUDE_UTILITIES_FLIPAGGREGATOR_HPP_
+#define ZENHAMMER_INCLUDE_UTILITIES_FLIPAGGREGATOR_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Fuzzer/BitFlip.hpp"
+
+#ifdef ENABLE_JSON
+#include <nlohmann/json.hpp>
+#endif
+
+// Histograms of bit flips by row, bank, bank group, byte offset, and bit position, and the rows with the most bit
+// flips, updated as the flips are observed. The memory used does not depend on the number of flips: the rows are
+// counted in buckets, and the top rows are tracked with the Space-Saving algorithm, which keeps a fixed number of
+// counters and replaces the smallest one if a new row shows up (its count is then an upper bound, off by at most the
+// replaced count).
+class FlipAggregator {
+ private:
+  static constexpr size_t MAX_BANKGROUPS = 16;
+
+  static constexpr size_t MAX_BANKS = 8;
+
+  static constexpr size_t NUM_ROW_BUCKETS = 256;
+
+  // the number of rows tracked for the top rows
+  static constexpr size_t NUM_MONITORED_ROWS = 256;
+
+  struct RowCounter {
+    size_t bankgroup;
+    size_t bank;
+    size_t row;
+    uint64_t count;
+    // the count of the row this counter replaced, i.e., the maximum overestimation of count
+    uint64_t error;
+  };
+
+  size_t row_bucket_width;
+
+  size_t top_k;
+
+  uint64_t num_flipped_bytes{0};
+
+  uint64_t num_flipped_bits{0};
+
+  uint64_t num_z2o{0};
+
+  uint64_t num_o2z{0};
+
+  // all histograms count flipped bits
+  std::array<uint64_t, 8> by_bit{};
+
+  // the offset of the byte within its 8-byte word
+  std::array<uint64_t, 8> by_byte_offset{};
+
+  std::array<uint64_t, MAX_BANKGROUPS> by_bankgroup{};
+
+  std::array<std::array<uint64_t, MAX_BANKS>, MAX_BANKGROUPS> by_bank{};
+
+  std::array<uint64_t, NUM_ROW_BUCKETS> by_row{};
+
+  std::vector<RowCounter> monitored_rows;
+
+  // (bank group, bank, row) -> index in monitored_rows
+  std::unordered_map<uint64_t, size_t> monitored_row_idx;
+
+  static uint64_t get_row_key(size_t bankgroup, size_t bank, size_t row);
+
+  void count_row(size_t bankgroup, size_t bank, size_t row, uint64_t num_bits);
+
+ public:
+  /// rows_per_bank determines the width of the row buckets, top_k the number of rows reported by to_json
+  explicit FlipAggregator(size_t rows_per_bank, size_t top_k = 16);
+
+  void record(const BitFlip &flip);
+
+  [[nodiscard]] uint64_t get_num_flipped_bytes() const;
+
+  [[nodiscard]] uint64_t get_num_flipped_bits() const;
+
+#ifdef ENABLE_JSON
+  [[nodiscard]] nlohmann::json to_json() const;
+#endif
+};
+
+#endif //ZENHAMMER_INCLUDE_UTILITIES_FLIPAGGREGATOR_HPP_
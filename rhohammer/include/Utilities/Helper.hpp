@@ -2,28 +2,57 @@
 #define ZENHAMMER_INCLUDE_UTILITIES_HELPER_HPP_
 
 #include <chrono>
+#include <stdexcept>
 #include <vector>
 #include <string>
 
+#include "Utilities/Statistics.hpp"
+
+// min/max/avg/std are exact, median, p99, and most_frequent are up to the histogram's bucket precision
 struct statistics {
   uint64_t min;
   uint64_t max;
   uint64_t avg;
   uint64_t median;
+  uint64_t p99;
   uint64_t std;
   uint64_t most_frequent;
   std::string to_string();
 };
 
-template <typename T>
-T median(std::vector<T> &v);
+// thrown by exit_target() in a worker of a campaign (see CampaignOrchestrator) instead of exiting the process
+class TargetExit : public std::runtime_error {
+ public:
+  int status;
+
+  explicit TargetExit(int status)
+      : std::runtime_error("target exited with status " + std::to_string(status)), status(status) {}
+};
+
+// whether this thread is a worker of a campaign, set by CampaignOrchestrator
+extern thread_local bool is_campaign_worker;
+
+/// exits the process with the given status when a fatal error occurs while working on a DIMM; in a worker of a
+/// campaign, only this worker is ended by throwing a TargetExit, so that the other DIMMs are not affected
+[[noreturn]] void exit_target(int status);
+
+/// installs a SIGINT/SIGTERM handler for the whole process that requests fuzzing to stop after the current pattern
+/// (see is_stop_requested); a second signal terminates immediately
+void install_stop_handler();
+
+[[nodiscard]] bool is_stop_requested();
 
 int64_t get_timestamp_sec();
 
 int64_t get_timestamp_us();
 
-double calc_std(std::vector<uint64_t> &values, double mean, size_t num_numbers);
+// returns the number of TSC cycles per nanosecond; calibrated against CLOCK_MONOTONIC_RAW on the first call
+double get_tsc_cycles_per_ns();
+
+double tsc_to_ns(uint64_t tsc_cycles);
+
+void calculate_statistics(const LogLinearHistogram &histogram, statistics &stats);
 
-void calculate_statistics(std::vector<uint64_t> &vec, statistics &stats);
+void calculate_statistics(const std::vector<uint64_t> &vec, statistics &stats);
 
 #endif //ZENHAMMER_INCLUDE_UTILITIES_HELPER_HPP_
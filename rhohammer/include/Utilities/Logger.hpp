@@ -36,16 +36,17 @@ class Logger {
   // a reference to the file output stream associated to the logfile
   std::ofstream logfile;
 
-  // the logger instance (a singleton)
-  static Logger instance;
-
-  static std::string format_timestamp(unsigned long ts);
+  // the logger instance (a singleton per thread, each worker of a campaign logs into its own file)
+  static thread_local Logger instance;
 
   unsigned long timestamp_start{};
 
  public:
 
-  static void initialize();
+  // formats the given number of seconds as hours, minutes, and seconds
+  static std::string format_timestamp(unsigned long ts);
+
+  static void initialize(const std::string &logfile_filename = "stdout.log");
 
   static void close();
 
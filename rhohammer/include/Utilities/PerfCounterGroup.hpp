@@ -0,0 +1,108 @@
+#ifndef ZENHAMMER_INCLUDE_UTILITIES_PERFCOUNTERGROUP_HPP_
+#define ZENHAMMER_INCLUDE_UTILITIES_PERFCOUNTERGROUP_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef ENABLE_JSON
+#include <nlohmann/json.hpp>
+#endif
+
+// The counter deltas of a single start()/stop() window (or the sum of several windows).
+struct PerfCounterSample {
+  // false if the PMU could not be accessed (e.g., inside a container), all counters are zero then
+  bool valid{false};
+
+  // the time (in ns) the group was enabled and actually running; both differ if the kernel multiplexed the PMU
+  uint64_t time_enabled{0};
+  uint64_t time_running{0};
+
+  uint64_t cycles{0};
+  uint64_t instructions{0};
+  uint64_t l1d_misses{0};
+  uint64_t llc_misses{0};
+
+  // one entry per raw event passed to PerfCounterGroup, in the same order
+  std::vector<uint64_t> raw;
+
+  // the events that were actually counted (events unsupported by the PMU are silently dropped)
+  bool has_l1d_misses{false};
+  bool has_llc_misses{false};
+
+  [[nodiscard]] double get_ipc() const;
+
+  void accumulate(const PerfCounterSample &other);
+};
+
+// The counters collected while hammering a pattern, split up by the phase they were collected in.
+struct HammerPerfCounters {
+  PerfCounterSample hammer_pattern;
+  PerfCounterSample hammer_pattern_unjitted;
+  PerfCounterSample check_memory;
+};
+
+// A group of hardware performance counters that is read at once using PERF_FORMAT_GROUP, so that all counters
+// describe exactly the same window. If perf_event_open is not permitted, the group silently degrades into a no-op and
+// all returned samples are marked invalid.
+class PerfCounterGroup {
+ private:
+  enum class EVENT : int {
+    CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, RAW
+  };
+
+  struct Event {
+    EVENT type;
+    // index into PerfCounterSample::raw if type == RAW
+    size_t raw_idx;
+    int fd;
+    uint64_t id;
+  };
+
+  // the group leader (cycles); -1 if the PMU is not available
+  int leader_fd = -1;
+
+  std::vector<Event> events;
+
+  // the raw events that are counted, i.e., without the ones the PMU rejected
+  std::vector<uint64_t> raw_configs;
+
+  // whether we had to fall back to user-space-only counting (e.g., because of perf_event_paranoid)
+  bool exclude_kernel = false;
+
+  // buffer the group is read into: nr, time_enabled, time_running, {value, id}[nr]
+  std::vector<uint64_t> read_buffer;
+
+  int open_event(uint32_t type, uint64_t config, int group_fd) const;
+
+  bool add_event(EVENT type, uint32_t perf_type, uint64_t config, size_t raw_idx = 0);
+
+ public:
+  explicit PerfCounterGroup(const std::vector<uint64_t> &raw_event_configs = {});
+
+  ~PerfCounterGroup();
+
+  PerfCounterGroup(const PerfCounterGroup &) = delete;
+
+  PerfCounterGroup &operator=(const PerfCounterGroup &) = delete;
+
+  [[nodiscard]] bool is_available() const;
+
+  [[nodiscard]] const std::vector<uint64_t> &get_raw_configs() const;
+
+  /// resets and enables all counters of the group
+  void start();
+
+  /// disables all counters and returns their values since the last start()
+  PerfCounterSample stop();
+};
+
+#ifdef ENABLE_JSON
+
+void to_json(nlohmann::json &j, const PerfCounterSample &p);
+
+void to_json(nlohmann::json &j, const HammerPerfCounters &p);
+
+#endif
+
+#endif //ZENHAMMER_INCLUDE_UTILITIES_PERFCOUNTERGROUP_HPP_
@@ -0,0 +1,115 @@
+#ifndef ZENHAMMER_INCLUDE_UTILITIES_RESULTSTREAMWRITER_HPP_
+#define ZENHAMMER_INCLUDE_UTILITIES_RESULTSTREAMWRITER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Fuzzer/BitFlip.hpp"
+#include "Utilities/Enums.hpp"
+
+#ifdef ENABLE_JSON
+#include <nlohmann/json.hpp>
+#endif
+
+enum class RESULT_RECORD : uint8_t {
+  // written once at the beginning: the kind of run ("fuzz" or "sweep"), its start time, the DIMM ID, etc.
+  METADATA = 1,
+  // a pattern that triggered bit flips, incl. all its mappings
+  PATTERN = 2,
+  // the statistics of a tested pattern, incl. the ineffective ones
+  PATTERN_STATS = 3,
+  // the summary of a single sweep; all bit flips of this sweep precede it
+  SWEEP = 4,
+  BITFLIP = 5,
+  // written once at the end: the end time and the activation telemetry
+  END = 6
+};
+
+std::string to_string(RESULT_RECORD type);
+
+// A bit flip as it is stored in the binary format.
+struct __attribute__((packed)) BitFlipRecord {
+  // the index of the sweep this bit flip was observed in
+  uint64_t sweep;
+  uint64_t phys_addr;
+  int64_t observed_at;
+  uint32_t subchannel;
+  uint32_t rank;
+  uint32_t bankgroup;
+  uint32_t bank;
+  uint32_t row;
+  uint32_t col;
+  uint8_t bitmask;
+  uint8_t data;
+};
+
+// Writes the results of a fuzzing run or sweep as a stream of records, so that nothing needs to be kept in memory
+// until the end of the run. Records are either JSON Lines (with a "type" field) or, in the binary format, a file header
+// followed by [uint8 type][uint32 payload length][payload] where the payload is CBOR or, for bit flips, a packed
+// BitFlipRecord. The stream can be converted into the fuzz-summary.json/sweep-summary-*.json schema by convert.
+class ResultStreamWriter {
+ private:
+  std::ofstream os;
+
+  std::string filepath;
+
+  RESULT_FORMAT format{RESULT_FORMAT::JSONL};
+
+  // the buffer of os; bit flips are only written out when it is full
+  std::vector<char> buffer;
+
+  size_t page_size;
+
+  void write_record(RESULT_RECORD type, const char *payload, uint32_t len);
+
+ public:
+  ResultStreamWriter();
+
+  ~ResultStreamWriter();
+
+  ResultStreamWriter(const ResultStreamWriter &) = delete;
+
+  ResultStreamWriter &operator=(const ResultStreamWriter &) = delete;
+
+  /// the file extension belonging to the given format, incl. the dot
+  static std::string get_extension(RESULT_FORMAT format);
+
+  /// creates (or truncates) the file; exits on failure
+  void open(const std::string &path, RESULT_FORMAT result_format);
+
+  /// continues an existing stream after cutting it to the given length (as returned by flush at a checkpoint), which
+  /// drops the records written after the checkpoint; exits on failure
+  void reopen(const std::string &path, RESULT_FORMAT result_format, uint64_t length);
+
+  [[nodiscard]] bool is_open() const;
+
+  [[nodiscard]] const std::string &get_filepath() const;
+
+  /// appends a bit flip that was observed in the sweep with the given index
+  void write_bitflip(uint64_t sweep, const BitFlip &flip);
+
+  /// writes out all buffered records and returns the length of the stream
+  uint64_t flush();
+
+  void close();
+
+#ifdef ENABLE_JSON
+  /// appends a record and flushes the stream, so that the record survives a crash of this process
+  void write(RESULT_RECORD type, const nlohmann::json &record);
+
+  /// calls the given function for each complete record in the stream; a trailing partial record (e.g., due to a crash
+  /// during write) and records of unknown types are ignored
+  static void read_records(const std::string &path,
+                           const std::function<void(RESULT_RECORD, nlohmann::json &)> &fn);
+
+  /// converts a result stream into the JSON schema of fuzz-summary.json or sweep-summary-*.json; the output is written
+  /// incrementally and only a single record is kept in memory at a time
+  static bool convert(const std::string &stream_path, const std::string &json_path);
+#endif
+};
+
+#endif //ZENHAMMER_INCLUDE_UTILITIES_RESULTSTREAMWRITER_HPP_
@@ -0,0 +1,56 @@
+#ifndef ZENHAMMER_INCLUDE_UTILITIES_RUNTIMECONFIG_HPP_
+#define ZENHAMMER_INCLUDE_UTILITIES_RUNTIMECONFIG_HPP_
+
+#include <cstddef>
+#include <string>
+
+// Configuration knobs that used to be compile-time constants in GlobalDefines.hpp. They can be set by a YAML file
+// (--config) and by individual command line arguments, the latter taking precedence.
+struct RuntimeConfig {
+  // the largest supported MULTI_BANK value, see PatternAddressMapper::export_pattern_internal
+  static constexpr int MAX_MULTI_BANK = 8;
+
+  // the number of banks each aggressor is hammered in simultaneously (same row, consecutive banks)
+  int multi_bank = 2;
+
+  // the REF synchronization threshold in cycles; -1 to determine it by calibration
+  long ref_threshold = 1500;
+
+  // the number of the 1 GiB hugepage to map (see Memory::allocate_memory); -1 to let the kernel choose
+  int hugepage_num = -1;
+
+  bool debug_mode = false;
+
+  // number of total banks in the system; 0 means #bankgroups x #banks as given by --geometry
+  size_t num_banks = 0;
+
+  // threshold to distinguish between bank conflict (t > bk_conf_thresh)
+  // and a regular access without any bank conflict (t < bk_conf_thresh)
+  size_t bk_conf_thresh = 430;  // worked best on DIMM 18
+
+  // the number of row offsets a pattern is swept over
+  size_t full_sweep_rows = 2000000;
+
+  // while sweeping, only every n-th row (and each row with bit flips) is logged
+  size_t sweep_log_every = 1000;
+
+  // calibration measurements sample until the confidence interval of their estimate at calibration_confidence is
+  // within +-calibration_precision (relative) of it
+  double calibration_confidence = 0.95;
+
+  double calibration_precision = 0.02;
+
+  // calibration results stored in calibration.json are only reused for this many seconds
+  long calibration_max_age = 7 * 24 * 3600;
+
+  /// overrides all knobs that are present in the given YAML file
+  void load_yaml(const std::string &filepath);
+
+  /// exits if any of the knobs has an unsupported value
+  void validate() const;
+};
+
+// per thread, so that each worker of a campaign can use its own configuration
+extern thread_local RuntimeConfig runtime_config;
+
+#endif //ZENHAMMER_INCLUDE_UTILITIES_RUNTIMECONFIG_HPP_
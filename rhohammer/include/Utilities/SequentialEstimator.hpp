@@ -0,0 +1,77 @@
+#ifndef ZENHAMMER_INCLUDE_UTILITIES_SEQUENTIALESTIMATOR_HPP_
+#define ZENHAMMER_INCLUDE_UTILITIES_SEQUENTIALESTIMATOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+// Estimates the mean of a stream of samples (Welford's running mean and variance) and tells when to stop sampling:
+// as soon as the confidence interval of the mean at the requested confidence is within the requested precision
+// (relative to the mean), but not before min_samples and not after max_samples. Outliers, i.e., samples outside the
+// valid range or more than outlier_sigmas standard deviations off the mean, are counted but not added.
+class SequentialEstimator {
+ private:
+  double confidence;
+
+  double rel_precision;
+
+  size_t min_samples;
+
+  size_t max_samples;
+
+  // the two-sided standard normal quantile of the confidence
+  double z;
+
+  double valid_min{-std::numeric_limits<double>::infinity()};
+
+  double valid_max{std::numeric_limits<double>::infinity()};
+
+  // 0 disables the rejection of samples far off the mean
+  double outlier_sigmas{0};
+
+  uint64_t count{0};
+
+  uint64_t num_rejected{0};
+
+  double mean{0};
+
+  // the sum of squared differences from the mean
+  double m2{0};
+
+ public:
+  /// confidence in (0, 1), rel_precision is the requested half-width of the confidence interval relative to the mean
+  SequentialEstimator(double confidence, double rel_precision, size_t min_samples, size_t max_samples);
+
+  /// samples outside [min, max] are rejected as outliers
+  void set_valid_range(double min, double max);
+
+  /// once min_samples were added, samples more than k standard deviations off the mean are rejected as outliers
+  void set_outlier_sigmas(double k);
+
+  /// adds the sample unless it is an outlier; returns whether it was added
+  bool add(double sample);
+
+  /// whether the requested precision is reached or max_samples (including outliers) were seen
+  [[nodiscard]] bool is_done() const;
+
+  [[nodiscard]] bool is_precise() const;
+
+  [[nodiscard]] uint64_t get_count() const;
+
+  [[nodiscard]] uint64_t get_num_rejected() const;
+
+  [[nodiscard]] double get_mean() const;
+
+  [[nodiscard]] double get_stddev() const;
+
+  /// the half-width of the confidence interval of the mean at the requested confidence
+  [[nodiscard]] double get_half_width() const;
+
+  /// the confidence at which the interval of the mean is within the requested precision
+  [[nodiscard]] double get_achieved_confidence() const;
+
+  [[nodiscard]] std::string to_string() const;
+};
+
+#endif //ZENHAMMER_INCLUDE_UTILITIES_SEQUENTIALESTIMATOR_HPP_
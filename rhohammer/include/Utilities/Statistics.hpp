@@ -0,0 +1,113 @@
+#ifndef ZENHAMMER_INCLUDE_UTILITIES_STATISTICS_HPP_
+#define ZENHAMMER_INCLUDE_UTILITIES_STATISTICS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef ENABLE_JSON
+#include <nlohmann/json.hpp>
+#endif
+
+// A histogram of non-negative values with a fixed set of log-linear buckets: each power of two is split into
+// 2^precision_bits equally sized buckets, so that the relative error of a bucket is at most 2^-precision_bits and values
+// below 2^(precision_bits + 1) are counted exactly. Values are rounded to integers for bucketing, min/max/mean/stddev are
+// computed from the exact values. Histograms with the same precision can be merged.
+class LogLinearHistogram {
+ private:
+  size_t precision_bits;
+
+  std::vector<uint64_t> buckets;
+
+  uint64_t count{0};
+
+  double sum{0};
+
+  double sum_of_squares{0};
+
+  double min{0};
+
+  double max{0};
+
+  [[nodiscard]] size_t get_bucket_index(uint64_t value) const;
+
+  [[nodiscard]] uint64_t get_bucket_lower_bound(size_t idx) const;
+
+  [[nodiscard]] uint64_t get_bucket_width(size_t idx) const;
+
+  // the value a bucket's samples are reported as, i.e., the middle of the bucket
+  [[nodiscard]] uint64_t get_bucket_value(size_t idx) const;
+
+ public:
+  explicit LogLinearHistogram(size_t precision_bits = 6);
+
+  void add(double value);
+
+  void merge(const LogLinearHistogram &other);
+
+  void clear();
+
+  [[nodiscard]] uint64_t get_count() const;
+
+  [[nodiscard]] double get_min() const;
+
+  [[nodiscard]] double get_max() const;
+
+  [[nodiscard]] double get_mean() const;
+
+  [[nodiscard]] double get_stddev() const;
+
+  /// the value below which the fraction q (in [0, 1]) of the samples are, up to the bucket precision
+  [[nodiscard]] double get_quantile(double q) const;
+
+  /// the (bucket) values of the n fullest buckets, most frequent first
+  [[nodiscard]] std::vector<uint64_t> get_most_frequent(size_t n) const;
+
+#ifdef ENABLE_JSON
+  [[nodiscard]] nlohmann::json to_json() const;
+#endif
+};
+
+// A mergeable quantile sketch (KLL): samples are kept in levels of compactors, where each item on level h stands for
+// 2^h samples. A full level is sorted and every other item of it (randomly the odd or the even ones) is promoted to the
+// next level. The memory is O(k log(n/k)) for n samples, the rank error is O(1/k) (a few percent for k = 128).
+class QuantileSketch {
+ private:
+  size_t k;
+
+  std::vector<std::vector<double>> levels;
+
+  uint64_t count{0};
+
+  double min{0};
+
+  double max{0};
+
+  uint64_t rng_state{0x9e3779b97f4a7c15ULL};
+
+  [[nodiscard]] size_t get_capacity(size_t level) const;
+
+  void compress();
+
+ public:
+  explicit QuantileSketch(size_t k = 128);
+
+  void add(double value);
+
+  void merge(const QuantileSketch &other);
+
+  [[nodiscard]] uint64_t get_count() const;
+
+  [[nodiscard]] double get_min() const;
+
+  [[nodiscard]] double get_max() const;
+
+  /// the value below which the fraction q (in [0, 1]) of the samples are, up to the rank error
+  [[nodiscard]] double get_quantile(double q) const;
+
+#ifdef ENABLE_JSON
+  [[nodiscard]] nlohmann::json to_json() const;
+#endif
+};
+
+#endif //ZENHAMMER_INCLUDE_UTILITIES_STATISTICS_HPP_
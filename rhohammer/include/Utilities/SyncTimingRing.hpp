@@ -0,0 +1,97 @@
+#ifndef ZENHAMMER_INCLUDE_UTILITIES_SYNCTIMINGRING_HPP_
+#define ZENHAMMER_INCLUDE_UTILITIES_SYNCTIMINGRING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "Utilities/Statistics.hpp"
+
+#ifdef ENABLE_JSON
+#include <nlohmann/json.hpp>
+#endif
+
+// The timing of a single REF synchronization.
+// NOTE: The layout of this struct must not be changed, as it is written to from Assembly.
+struct SyncTimingEntry {
+  // TSC right before and right after the synchronization
+  uint64_t tsc_entry;
+  uint64_t tsc_exit;
+  // the number of dummy rows accessed until REF was detected (or we gave up)
+  uint32_t num_dummy_accesses;
+  // 1 if the access time exceeded the REF threshold, 0 if we ran out of dummy rows (i.e., missed the REF)
+  uint32_t threshold_hit;
+  uint64_t reserved;
+};
+
+static_assert(sizeof(SyncTimingEntry) == 32, "SyncTimingEntry must be 32 bytes (two entries per cache line)");
+
+struct SyncTimingSummary {
+  // the number of synchronizations, including the ones already overwritten in the ring
+  uint64_t num_syncs{0};
+  // the number of synchronizations the statistics below are based on
+  uint64_t num_recorded{0};
+  uint64_t num_missed_refs{0};
+  uint64_t num_dummy_accesses{0};
+  uint64_t sync_cycles{0};
+  // the duration of the hammering window the synchronizations took place in
+  uint64_t window_cycles{0};
+  // the distribution of the duration (cycles) of the recorded synchronizations
+  QuantileSketch sync_cycles_dist{64};
+
+  // the fraction of the hammering window spent on synchronization (extrapolated if entries were overwritten)
+  [[nodiscard]] double get_overhead_fraction() const;
+
+  void accumulate(const SyncTimingSummary &other);
+};
+
+// A preallocated ring buffer of SyncTimingEntry that is written from the hammering loop. Recording an entry neither
+// allocates nor branches, old entries are silently overwritten.
+// NOTE: The data members must not be re-arranged, as they are accessed from Assembly (see CodeJitter::jit_strict).
+class SyncTimingRing {
+ public:
+  // cache line-aligned entry array of size (mask + 1)
+  SyncTimingEntry *entries;
+
+  uint64_t mask;
+
+  // the total number of recorded entries; the next entry is written to entries[head & mask]
+  uint64_t head;
+
+  /// capacity is rounded up to the next power of two
+  explicit SyncTimingRing(size_t capacity);
+
+  ~SyncTimingRing();
+
+  SyncTimingRing(const SyncTimingRing &) = delete;
+
+  SyncTimingRing &operator=(const SyncTimingRing &) = delete;
+
+  inline void record(uint64_t tsc_entry, uint64_t tsc_exit, uint32_t num_dummy_accesses, uint32_t threshold_hit) {
+    auto &e = entries[head & mask];
+    e.tsc_entry = tsc_entry;
+    e.tsc_exit = tsc_exit;
+    e.num_dummy_accesses = num_dummy_accesses;
+    e.threshold_hit = threshold_hit;
+    head++;
+  }
+
+  [[nodiscard]] uint64_t get_head() const;
+
+  [[nodiscard]] size_t get_capacity() const;
+
+  /// summarizes all entries recorded since the head was at position since
+  [[nodiscard]] SyncTimingSummary summarize(uint64_t since, uint64_t window_cycles) const;
+
+  /// appends all entries recorded since the head was at position since, preceded by a header with the given label
+  void export_binary(std::ofstream &os, uint64_t since, const std::string &label) const;
+};
+
+#ifdef ENABLE_JSON
+
+void to_json(nlohmann::json &j, const SyncTimingSummary &p);
+
+#endif
+
+#endif //ZENHAMMER_INCLUDE_UTILITIES_SYNCTIMINGRING_HPP_
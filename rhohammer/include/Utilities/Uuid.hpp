@@ -5,8 +5,8 @@
 #include <sstream>
 
 namespace uuid {
-static std::uniform_int_distribution<> dis(0, 15); /* NOLINT */
-static std::uniform_int_distribution<> dis2(8, 11); /* NOLINT */
+static thread_local std::uniform_int_distribution<> dis(0, 15); /* NOLINT */
+static thread_local std::uniform_int_distribution<> dis2(8, 11); /* NOLINT */
 
 static std::string gen_uuid(std::mt19937 &gen) {
   std::stringstream ss;
@@ -3,7 +3,9 @@
 
 #include <string>
 #include <unordered_set>
+#include <vector>
 #include <GlobalDefines.hpp>
+#include <Utilities/Enums.hpp>
 
 // defines the program's arguments and their default values
 struct ProgramArguments {
@@ -15,12 +17,16 @@ struct ProgramArguments {
   std::string load_json_filename;
   // the IDs of the patterns to be loaded from a given JSON file
   std::unordered_set<std::string> pattern_ids{};
+  // if no pattern IDs are given, only load the given number of patterns with the most bit flips (0 = all patterns)
+  size_t replay_top_k = 0;
   // total number of mappings (i.e., Aggressor ID -> DRAM rows mapping) to try for a pattern
   size_t num_address_mappings_per_pattern = 3;
   // number of DRAM locations we use to check a (pattern, address mapping)'s effectiveness
   size_t num_dram_locations_per_mapping = 3;
   // whether to sweep the 'best pattern' that was found during fuzzing afterward over a contiguous chunk of memory
   bool sweeping = false;
+  // a YAML file with the rows, banks, and time budget of each sweep (see SweepPlan); empty for the defaults
+  std::string sweep_plan_filename;
   // the ID of the DIMM that is currently inserted
   long dimm_id = -1;
   // these two parameters define the default program mode: do fuzzing and synchronize with REFRESH
@@ -32,9 +38,43 @@ struct ProgramArguments {
   size_t num_bankgroups;
   size_t num_banks;
   bool samsung_row_swizzling = false;
+  // raw PMU event configs (e.g., 0x01a2) that are counted in addition to the default performance counter group
+  std::vector<uint64_t> perf_raw_events{};
+  // whether to export the timing of each REF synchronization into a binary file
+  bool export_sync_timings = false;
+  // whether to record the access sequence of each hammered pattern into a binary trace (see AccessTraceWriter)
+  bool record_access_trace = false;
+  // whether to re-run the kernel autotuning even if calibration.json already has a choice for this geometry
+  bool force_autotune = false;
+  // whether to skip the kernel autotuning and use the default kernel and flushing/fencing strategy
+  bool skip_autotune = false;
+  // whether to calibrate again instead of using the calibration profile stored in calibration.json
+  bool recalibrate = false;
+  // whether to continue the fuzzing run or the sweeps recorded in the checkpoint log instead of starting anew
+  bool resume = false;
+  // the format fuzzing and sweeping results are streamed in before they are converted into the JSON summary
+  RESULT_FORMAT result_format = RESULT_FORMAT::JSONL;
+  // whether sweeps stream every bit flip in addition to the aggregated statistics of each sweep
+  bool stream_raw_flips = true;
+  // a YAML file with the DIMMs of a multi-DIMM campaign (see CampaignOrchestrator)
+  std::string targets_filename;
+  // whether to run on a simulated DRAM (see SimulatedDram) instead of real DRAM, and its seed and flip threshold
+  bool simulate = false;
+  uint64_t simulation_seed = 0;
+  size_t simulation_flip_threshold = 20000;
+  // whether to check the address mapping by timing the bank conflicts it predicts (see DramAnalyzer)
+  bool check_mapping = false;
+  // the benchmark that is run instead of hammering (see --benchmark), empty for none
+  std::string benchmark;
+  // the directory all output files (except calibration.json) are written to; empty for the working directory
+  std::string output_dir;
 };
 
-extern ProgramArguments program_args;
+// per thread, so that each worker of a campaign can target a different DIMM
+extern thread_local ProgramArguments program_args;
+
+/// the path of the given output file in program_args.output_dir
+std::string get_output_path(const std::string &filename);
 
 int main(int argc, char **argv);
 
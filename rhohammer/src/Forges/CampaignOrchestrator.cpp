@@ -0,0 +1,184 @@
+#include "Forges/CampaignOrchestrator.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+#include <yaml-cpp/yaml.h>
+
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+#include "Utilities/RuntimeConfig.hpp"
+#include "main.hpp"
+
+CampaignOrchestrator CampaignOrchestrator::load_yaml(const std::string &filename)
+{
+  YAML::Node config;
+  try
+  {
+    config = YAML::LoadFile(filename);
+  }
+  catch (const YAML::Exception &e)
+  {
+    Logger::log_error(format_string("Could not load campaign file %s: %s", filename.c_str(), e.what()));
+    exit(EXIT_FAILURE);
+  }
+
+  CampaignOrchestrator campaign;
+  if (config["runtime_limit"])
+    campaign.runtime_limit = config["runtime_limit"].as<unsigned long>();
+  if (!config["targets"] || !config["targets"].IsSequence() || config["targets"].size() == 0)
+  {
+    Logger::log_error(format_string("Campaign file %s does not contain any targets.", filename.c_str()));
+    exit(EXIT_FAILURE);
+  }
+
+  for (const auto &node : config["targets"])
+  {
+    CampaignTarget target;
+    if (!node["dimm_id"] || !node["geometry"] || node["geometry"].size() != 3)
+    {
+      Logger::log_error(format_string("Each target in %s requires 'dimm_id' and 'geometry: [#ranks, #bankgroups, "
+                                      "#banks]'.", filename.c_str()));
+      exit(EXIT_FAILURE);
+    }
+    target.dimm_id = node["dimm_id"].as<long>();
+    target.num_ranks = node["geometry"][0].as<size_t>();
+    target.num_bankgroups = node["geometry"][1].as<size_t>();
+    target.num_banks = node["geometry"][2].as<size_t>();
+    if (node["samsung"])
+      target.samsung_row_swizzling = node["samsung"].as<bool>();
+    if (node["hugepage_num"])
+      target.hugepage_num = node["hugepage_num"].as<int>();
+    if (node["cpu"])
+      target.cpu = node["cpu"].as<int>();
+    if (node["config"])
+      target.config_filename = node["config"].as<std::string>();
+
+    for (const auto &other : campaign.targets)
+    {
+      if (other.dimm_id == target.dimm_id)
+      {
+        Logger::log_error(format_string("DIMM %ld is listed more than once in %s.", target.dimm_id, filename.c_str()));
+        exit(EXIT_FAILURE);
+      }
+      if (target.hugepage_num != -1 && other.hugepage_num == target.hugepage_num)
+      {
+        Logger::log_error(format_string("DIMMs %ld and %ld cannot share hugepage %d.",
+                                        other.dimm_id, target.dimm_id, target.hugepage_num));
+        exit(EXIT_FAILURE);
+      }
+    }
+    campaign.targets.push_back(target);
+  }
+  Logger::log_debug(format_string("Loaded %zu campaign targets from %s.", campaign.targets.size(), filename.c_str()));
+  return campaign;
+}
+
+std::string CampaignOrchestrator::get_output_dir(const CampaignTarget &target)
+{
+  return format_string("dimm-%ld", target.dimm_id);
+}
+
+void CampaignOrchestrator::pin_to_cpu(int cpu)
+{
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu, &cpuset);
+  auto ret = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+  if (ret != 0)
+  {
+    Logger::log_error(format_string("Could not pin worker to CPU %d: %s", cpu, strerror(ret)));
+  }
+}
+
+thread_local std::latch *CampaignOrchestrator::setup_latch = nullptr;
+
+void CampaignOrchestrator::finish_setup()
+{
+  if (setup_latch == nullptr)
+    return;
+  // only arrive once, a failed worker arrives after it was ended
+  auto *latch = setup_latch;
+  setup_latch = nullptr;
+  latch->arrive_and_wait();
+}
+
+size_t CampaignOrchestrator::run(const std::function<void(const CampaignTarget &, int64_t)> &worker)
+{
+  const auto budget = (runtime_limit > 0) ? runtime_limit : program_args.runtime_limit;
+  const int64_t deadline = get_timestamp_sec() + static_cast<int64_t>(budget);
+  Logger::log_info(format_string("Starting campaign on %zu DIMMs with a time budget of %lu seconds.",
+                                 targets.size(), budget));
+
+  // the thread-local state of the workers starts from the state of this thread
+  const auto base_program_args = program_args;
+  const auto base_runtime_config = runtime_config;
+
+  std::latch setup_done(static_cast<std::ptrdiff_t>(targets.size()));
+  std::atomic<size_t> num_failed{0};
+  std::vector<std::thread> workers;
+  for (const auto &target : targets)
+  {
+    workers.emplace_back([&, target]()
+    {
+      is_campaign_worker = true;
+      setup_latch = &setup_done;
+      if (target.cpu != -1)
+        pin_to_cpu(target.cpu);
+
+      program_args = base_program_args;
+      program_args.dimm_id = target.dimm_id;
+      program_args.num_ranks = target.num_ranks;
+      program_args.num_bankgroups = target.num_bankgroups;
+      program_args.num_banks = target.num_banks;
+      program_args.samsung_row_swizzling = target.samsung_row_swizzling;
+      program_args.output_dir = get_output_dir(target);
+      std::filesystem::create_directories(program_args.output_dir);
+      Logger::initialize(get_output_path("stdout.log"));
+      Logger::log_info(format_string("Campaign worker for DIMM %ld (CPU %d, hugepage %d).",
+                                     target.dimm_id, target.cpu, target.hugepage_num));
+
+      try
+      {
+        // the worker's own copy of the run configuration: the target's YAML file and then its hugepage (if it sets
+        // one) override the knobs of the campaign
+        RuntimeConfig config = base_runtime_config;
+        if (!target.config_filename.empty())
+          config.load_yaml(target.config_filename);
+        if (target.hugepage_num != -1)
+          config.hugepage_num = target.hugepage_num;
+        if (config.num_banks == 0)
+          config.num_banks = target.num_bankgroups * target.num_banks;
+        config.validate();
+        runtime_config = config;
+
+        worker(target, deadline);
+      }
+      catch (const std::exception &e)
+      {
+        Logger::log_error(format_string("Campaign worker for DIMM %ld failed: %s", target.dimm_id, e.what()));
+        num_failed++;
+      }
+      // a worker that failed or skipped calibration must not keep the others waiting
+      finish_setup();
+      Logger::close();
+    });
+  }
+
+  for (auto &w : workers)
+    w.join();
+  if (num_failed > 0)
+  {
+    Logger::log_error(format_string("Campaign on %zu DIMMs finished, %zu of them failed (see dimm-<id>/stdout.log).",
+                                    targets.size(), num_failed.load()));
+  }
+  else
+  {
+    Logger::log_info(format_string("Campaign on %zu DIMMs finished.", targets.size()));
+  }
+  return num_failed;
+}
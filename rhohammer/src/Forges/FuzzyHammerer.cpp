@@ -1,5 +1,8 @@
 #include "Forges/FuzzyHammerer.hpp"
 
+#include <cstdio>
+#include <optional>
+
 #include "Utilities/Helper.hpp"
 #include "Fuzzer/PatternBuilder.hpp"
 #include "main.hpp"
@@ -24,33 +27,199 @@ void FuzzyHammerer::n_sided_frequency_based_hammering(DramAnalyzer &dramAnalyzer
     Logger::log_info(format_string("Setting ACTs/tREFI to %d as given as command line argument.", program_args.acts_per_ref));
     fuzzing_params.set_fixed_acts_per_trefi((int)program_args.acts_per_ref);
   }
+  fuzzing_params.set_fixed_strategies(kernel_choice.flushing_strategy, kernel_choice.fencing_strategy);
   fuzzing_params.print_static_parameters();
 
   //  ReplayingHammerer replaying_hammerer(memory);
 
-#ifdef ENABLE_JSON
-  nlohmann::json arr = nlohmann::json::array();
-#endif
-
   std::uniform_real_distribution<> dist(0.75, 1.25);
 
-  // all patterns that triggered bit flips
-  std::vector<HammeringPattern> effective_patterns;
+  // the number of patterns that triggered bit flips; the patterns themselves are only kept in the result stream
+  size_t num_effective_patterns = 0;
 
   PatternAddressMapper best_mapping;
   HammeringPattern best_pattern;
   size_t best_mapping_bitflips = 0;
   size_t best_hammering_pattern_bitflips = 0;
 
-  const auto start_ts = get_timestamp_sec();
-  const auto execution_time_limit = static_cast<int64_t>(start_ts + runtime_limit);
+  auto start_ts = get_timestamp_sec();
+  const auto session_start_ts = start_ts;
+  // the fuzzing time spent before the run was interrupted (only if resumed)
+  int64_t elapsed_before_resume = 0;
+
+  auto update_best_pattern = [&](const HammeringPattern &pattern, size_t num_bitflips)
+  {
+    // TODO additionally consider the number of locations where this pattern triggers bit flips besides the total
+    //  number of bit flips only because we want to find a pattern that generalizes well
+    // if this pattern is better than every other pattern tried out before, mark this as 'new best pattern'
+    if (num_bitflips <= best_hammering_pattern_bitflips)
+      return;
+    best_hammering_pattern_bitflips = num_bitflips;
+    best_pattern = pattern;
+    // find the best mapping of this pattern (generally it doesn't matter as we're sweeping anyway over a chunk of
+    // memory but the mapper also contains a reference to the CodeJitter, which in turn uses some parameters that we
+    // want to reuse during sweeping; other mappings could differ in these parameters)
+    for (const auto &m : pattern.address_mappings)
+    {
+      size_t mapping_bitflips = m.count_bitflips();
+      if (mapping_bitflips > best_mapping_bitflips)
+      {
+        best_mapping = m;
+        best_mapping_bitflips = mapping_bitflips;
+      }
+    }
+  };
+
+#ifdef ENABLE_JSON
+  // the result stream is rewritten from scratch, on resume from the records in the checkpoint log
+  const auto results_filename =
+      get_output_path(RESULTS_FILENAME_STEM + ResultStreamWriter::get_extension(program_args.result_format));
+  const auto checkpoint_filename = get_output_path(CHECKPOINT_FILENAME);
+  result_stream.open(results_filename, program_args.result_format);
+  bool has_metadata = false;
+  auto write_metadata = [&]()
+  {
+    result_stream.write(RESULT_RECORD::METADATA, {
+        {"kind", "fuzz"},
+        {"start", start_ts},
+        {"dimm_id", program_args.dimm_id},
+        {"perf_counters_available", perf_counters.is_available()},
+        {"perf_raw_events", perf_counters.get_raw_configs()}});
+    has_metadata = true;
+  };
+
+  if (program_args.resume)
+  {
+    // replay the checkpoint log to rebuild the state at the time the last pattern was completed
+    nlohmann::json last_record;
+    size_t num_records = 0;
+    bool has_run_record = false;
+    size_t num_corrupt_records = 0;
+    auto replay_record = [&](nlohmann::json &record)
+    {
+      if (record.at("type") == "run")
+      {
+        if (record.at("dimm_id").get<long>() != program_args.dimm_id)
+        {
+          Logger::log_error(format_string("Cannot resume: %s belongs to DIMM %ld but --dimm-id is %ld.",
+                                          checkpoint_filename.c_str(), record.at("dimm_id").get<long>(), program_args.dimm_id));
+          exit_target(EXIT_FAILURE);
+        }
+        start_ts = record.at("start").get<int64_t>();
+        has_run_record = true;
+        write_metadata();
+        return;
+      }
+      // everything is decoded before the state is updated, so that a corrupt record is skipped as a whole
+      const auto num_bitflips = record.at("num_bitflips").get<size_t>();
+      const auto &stats = record.at("stats");
+      record.at("next_pattern_no").get<size_t>();
+      record.at("elapsed_sec").get<int64_t>();
+      record.at("rng").at("fuzzer").get<std::string>();
+      record.at("rng").at("params").get<std::string>();
+      std::optional<HammeringPattern> pattern;
+      if (record.contains("pattern"))
+        pattern = record.at("pattern").get<HammeringPattern>();
+      std::vector<std::pair<HAMMERING_KERNEL, ActivationRate>> activation_runs;
+      if (record.contains("activation_runs"))
+      {
+        for (const auto &run : record.at("activation_runs"))
+        {
+          HAMMERING_KERNEL kernel;
+          from_string(run.at(0).get<std::string>(), kernel);
+          activation_runs.emplace_back(kernel, ActivationRate{.total_acts = run.at(1).get<uint64_t>(),
+                                                              .tsc_delta = run.at(2).get<uint64_t>()});
+        }
+      }
+
+      total_flips += num_bitflips;
+      result_stream.write(RESULT_RECORD::PATTERN_STATS, {{"stats", stats}});
+      if (pattern.has_value())
+      {
+        num_effective_patterns++;
+        result_stream.write(RESULT_RECORD::PATTERN, {{"pattern", record.at("pattern")}});
+        update_best_pattern(*pattern, num_bitflips);
+      }
+      for (const auto &[kernel, rate] : activation_runs)
+        activation_telemetry.record(kernel, rate);
+      last_record = std::move(record);
+      num_records++;
+    };
+    auto ignored_bytes = DurableLog::read_lines(checkpoint_filename, [&](const std::string &line)
+    {
+      // a complete line can still be corrupt (e.g., if the file was edited); it is skipped, so that the run resumes
+      // from the last valid record before it
+      try
+      {
+        auto record = nlohmann::json::parse(line);
+        replay_record(record);
+      }
+      catch (const TargetExit &)
+      {
+        throw;
+      }
+      catch (const std::exception &e)
+      {
+        Logger::log_error(format_string("Skipping corrupt record %zu of %s: %s", num_records + num_corrupt_records + 1,
+                                        checkpoint_filename.c_str(), e.what()));
+        num_corrupt_records++;
+      }
+    });
+    if (ignored_bytes > 0)
+    {
+      Logger::log_info(format_string("Ignoring incomplete last record (%zu bytes) of %s.", ignored_bytes, checkpoint_filename.c_str()));
+    }
+    if (num_records == 0)
+    {
+      Logger::log_info(format_string("Nothing to resume as %s has no completed patterns. Starting from scratch.",
+                                     checkpoint_filename.c_str()));
+    }
+    else
+    {
+      cnt_generated_patterns = last_record.at("next_pattern_no").get<size_t>();
+      elapsed_before_resume = last_record.at("elapsed_sec").get<int64_t>();
+      cr.set_state(last_record.at("rng").at("fuzzer").get<std::string>());
+      fuzzing_params.set_rng_state(last_record.at("rng").at("params").get<std::string>());
+      Logger::log_info(format_string("Resuming fuzzing run at pattern #%lu after %ld of %lu seconds "
+                                     "(%zu effective patterns, %zu bit flips so far).",
+                                     cnt_generated_patterns, elapsed_before_resume, runtime_limit,
+                                     num_effective_patterns, total_flips));
+    }
+    checkpoint_log.open(checkpoint_filename);
+    if (!has_run_record)
+    {
+      checkpoint_log.append(nlohmann::json{{"type", "run"}, {"start", start_ts}, {"dimm_id", program_args.dimm_id},
+                                           {"runtime_limit", runtime_limit}}.dump(), true);
+    }
+  }
+  else
+  {
+    // keep the checkpoint of a previous run instead of overwriting it
+    if (std::ifstream(checkpoint_filename).good())
+    {
+      auto backup = get_output_path(format_string("fuzz-checkpoint-%ld.jsonl", start_ts));
+      std::rename(checkpoint_filename.c_str(), backup.c_str());
+      Logger::log_info(format_string("Moved existing %s to %s.", checkpoint_filename.c_str(), backup.c_str()));
+    }
+    checkpoint_log.open(checkpoint_filename);
+    checkpoint_log.append(nlohmann::json{{"type", "run"}, {"start", start_ts}, {"dimm_id", program_args.dimm_id},
+                                         {"runtime_limit", runtime_limit}}.dump(), true);
+  }
+  if (!has_metadata)
+  {
+    write_metadata();
+  }
+#endif
+
+  const auto execution_time_limit =
+      static_cast<int64_t>(session_start_ts + static_cast<int64_t>(runtime_limit) - elapsed_before_resume);
 
   //  size_t num_acts_per_tref_idx = 0;
   //  std::vector<int> num_acts_per_tref = {
   //      14,16,18, 20, 22, 24, 26, 28, 30, 32, 34, 36
   //  };
 
-  for (; get_timestamp_sec() < execution_time_limit; ++cnt_generated_patterns)
+  for (; get_timestamp_sec() < execution_time_limit && !is_stop_requested(); ++cnt_generated_patterns)
   {
 
     //    fuzzing_params.set_num_activations_per_t_refi(
@@ -80,6 +249,10 @@ void FuzzyHammerer::n_sided_frequency_based_hammering(DramAnalyzer &dramAnalyzer
 
     // then test this pattern with N different mappings (i.e., address sets)
     size_t sum_flips_one_pattern_all_mappings = 0;
+    pattern_perf_counters = HammerPerfCounters();
+    pattern_activation_rates.clear();
+    pattern_activation_runs.clear();
+    pattern_sync_summary = SyncTimingSummary();
 
     for (cnt_pattern_probes = 0; cnt_pattern_probes < probes_per_pattern; ++cnt_pattern_probes)
     {
@@ -102,31 +275,45 @@ void FuzzyHammerer::n_sided_frequency_based_hammering(DramAnalyzer &dramAnalyzer
     }
     total_flips += sum_flips_one_pattern_all_mappings;
 
+#ifdef ENABLE_JSON
+    nlohmann::json activation_rates;
+    for (const auto &[kernel, rate] : pattern_activation_rates)
+    {
+      activation_rates[to_string(kernel)] = rate;
+    }
+    nlohmann::json stats = {
+        {"id", hammering_pattern.instance_id},
+        {"num_bitflips", sum_flips_one_pattern_all_mappings},
+        {"activation_rates", activation_rates},
+        {"sync", pattern_sync_summary},
+        {"perf_counters", pattern_perf_counters}};
+    result_stream.write(RESULT_RECORD::PATTERN_STATS, {{"stats", stats}});
+
+    // checkpoint everything needed to continue after this pattern; effective patterns are synced immediately
+    nlohmann::json record = {
+        {"type", "pattern"},
+        {"next_pattern_no", cnt_generated_patterns + 1},
+        {"elapsed_sec", elapsed_before_resume + (get_timestamp_sec() - session_start_ts)},
+        {"num_bitflips", sum_flips_one_pattern_all_mappings},
+        {"stats", stats},
+        {"rng", {{"fuzzer", cr.get_state()}, {"params", fuzzing_params.get_rng_state()}}}};
+    for (const auto &[kernel, rate] : pattern_activation_runs)
+    {
+      record["activation_runs"].push_back({to_string(kernel), rate.total_acts, rate.tsc_delta});
+    }
     if (sum_flips_one_pattern_all_mappings > 0)
     {
-      effective_patterns.push_back(hammering_pattern);
-      arr.push_back(hammering_pattern);
+      record["pattern"] = hammering_pattern;
+      result_stream.write(RESULT_RECORD::PATTERN, {{"pattern", record["pattern"]}});
     }
-    // TODO additionally consider the number of locations where this pattern triggers bit flips besides the total
-    //  number of bit flips only because we want to find a pattern that generalizes well
-    // if this pattern is better than every other pattern tried out before, mark this as 'new best pattern'
-    if (sum_flips_one_pattern_all_mappings > best_hammering_pattern_bitflips)
+    checkpoint_log.append(record.dump(), sum_flips_one_pattern_all_mappings > 0);
+#endif
+
+    if (sum_flips_one_pattern_all_mappings > 0)
     {
-      best_hammering_pattern_bitflips = sum_flips_one_pattern_all_mappings;
-      best_pattern = hammering_pattern;
-      // find the best mapping of this pattern (generally it doesn't matter as we're sweeping anyway over a chunk of
-      // memory but the mapper also contains a reference to the CodeJitter, which in turn uses some parameters that we
-      // want to reuse during sweeping; other mappings could differ in these parameters)
-      for (const auto &m : hammering_pattern.address_mappings)
-      {
-        size_t num_bitflips = m.count_bitflips();
-        if (num_bitflips > best_mapping_bitflips)
-        {
-          best_mapping = m;
-          best_mapping_bitflips = num_bitflips;
-        }
-      }
+      num_effective_patterns++;
     }
+    update_best_pattern(hammering_pattern, sum_flips_one_pattern_all_mappings);
 
     // dynamically change num acts per tREF after every 100 patterns; this is to avoid that we made a bad choice at the
     // beginning and then get stuck with that value
@@ -155,36 +342,34 @@ void FuzzyHammerer::n_sided_frequency_based_hammering(DramAnalyzer &dramAnalyzer
     std::flush(std::cout);
   } // end of fuzzing
 
+  if (is_stop_requested())
+  {
+    Logger::log_info("Stopping fuzzing early as requested. Continue this run with --resume.");
+  }
+  checkpoint_log.close();
+
   log_overall_statistics(
       cnt_generated_patterns,
       best_mapping.get_instance_id(),
       best_pattern.instance_id,
       best_mapping_bitflips,
-      effective_patterns.size(),
+      num_effective_patterns,
       total_flips);
 
   // start the post-analysis stage ============================
 
 #ifdef ENABLE_JSON
-  // export everything to JSON, this includes the HammeringPattern, AggressorAccessPattern, and BitFlips
-  std::ofstream json_export("fuzz-summary.json");
-
-  nlohmann::json meta;
-  meta["start"] = start_ts;
-  meta["end"] = get_timestamp_sec();
-  meta["num_patterns"] = arr.size();
-  //  meta["memory_config"] = DRAMAddr::get_memcfg_json();
-  meta["dimm_id"] = program_args.dimm_id;
-
-  nlohmann::json root;
-  root["metadata"] = meta;
-  root["hammering_patterns"] = arr;
-
-  json_export << root << "\n";
-  json_export.close();
+  // convert the result stream into fuzz-summary.json, which includes the HammeringPattern, AggressorAccessPattern, and
+  // BitFlips, for the existing tooling
+  result_stream.write(RESULT_RECORD::END, {
+      {"end", get_timestamp_sec()},
+      {"num_patterns", num_effective_patterns},
+      {"activation_telemetry", activation_telemetry.to_json()}});
+  result_stream.close();
+  ResultStreamWriter::convert(results_filename, get_output_path("fuzz-summary.json"));
 #endif
 
-  if (arr.empty())
+  if (num_effective_patterns == 0)
   {
     Logger::log_info("Skipping post-analysis stage as no effective patterns were found.");
   }
@@ -358,6 +543,8 @@ void FuzzyHammerer::probe_mapping_and_scan(PatternAddressMapper &mapper,
     auto da = DRAMAddr(any_aggressor_row);
     da.add_inplace(0, 1, 0, 0, 0);
     da.set_row(mr);
+    // the jitted kernel walks the sync rows on its own, starting from here
+    const auto sync_start = da;
     // now fill the pattern with these random addresses
 
     // std::cout << "sync_rows:\n";
@@ -372,16 +559,21 @@ void FuzzyHammerer::probe_mapping_and_scan(PatternAddressMapper &mapper,
       // std::cout << "sync_rows:"<<da.get_row() << "\n";
     }
     // std::cout << std::endl;
-    // now create instructions that follow this pattern (i.e., do jitting of code)
-    // Logger::log_info("Creating ASM code for hammering.");
-    // code_jitter.jit_strict(
-    //     fuzzing_params,
-    //     fuzzing_params.flushing_strategy,
-    //     fuzzing_params.fencing_strategy,
-    //     fuzzing_params.get_hammering_total_num_activations(),
-    //     hammering_accesses_vec,
-    //     da,
-    //     ref_threshold);
+#ifdef ENABLE_JITTING
+    if (kernel_choice.kernel == HAMMERING_KERNEL::JITTED)
+    {
+      // now create instructions that follow this pattern (i.e., do jitting of code)
+      Logger::log_info("Creating ASM code for hammering.");
+      code_jitter.jit_strict(
+          fuzzing_params,
+          fuzzing_params.flushing_strategy,
+          fuzzing_params.fencing_strategy,
+          fuzzing_params.get_hammering_total_num_activations(),
+          hammering_accesses_vec,
+          sync_start,
+          ref_threshold);
+    }
+#endif
     // Call default constructor
     mapper.bit_flips.emplace_back();
     Logger::log_info(format_string("Running pattern #%lu (%s) for address set %d (%s) at DRAM location #%ld.",
@@ -400,18 +592,38 @@ void FuzzyHammerer::probe_mapping_and_scan(PatternAddressMapper &mapper,
     //    }
 
     // do hammering
-    code_jitter.hammer_pattern(fuzzing_params, true);
-    //    while (true) {
-    code_jitter.hammer_pattern_unjitted(fuzzing_params, true,
-                                        fuzzing_params.flushing_strategy,
-                                        fuzzing_params.fencing_strategy,
-                                        fuzzing_params.get_hammering_total_num_activations(),
-                                        hammering_accesses_vec,
-                                        sync_rows, ref_threshold);
-    //    }
-    // code_jitter.cleanup();
+    code_jitter.last_hammering_data = HammeringData();
+    const auto sync_head = CodeJitter::sync_timings.get_head();
+    perf_counters.start();
+    if (kernel_choice.kernel == HAMMERING_KERNEL::JITTED)
+    {
+      code_jitter.hammer_pattern(fuzzing_params, true);
+      pattern_perf_counters.hammer_pattern.accumulate(perf_counters.stop());
+      code_jitter.cleanup();
+    }
+    else
+    {
+      code_jitter.hammer_pattern_unjitted(fuzzing_params, true,
+                                          fuzzing_params.flushing_strategy,
+                                          fuzzing_params.fencing_strategy,
+                                          fuzzing_params.get_hammering_total_num_activations(),
+                                          hammering_accesses_vec,
+                                          sync_rows, ref_threshold);
+      pattern_perf_counters.hammer_pattern_unjitted.accumulate(perf_counters.stop());
+    }
+    record_activation_rate(kernel_choice.kernel, code_jitter.last_hammering_data);
+    record_sync_timings(code_jitter, sync_head);
+    if (program_args.record_access_trace)
+    {
+      // the unjitted kernel starts synchronizing at the first sync row, the jitted one at sync_start
+      auto *trace_sync_start = (kernel_choice.kernel == HAMMERING_KERNEL::JITTED) ? (volatile char *)sync_start.to_virt()
+                                                                                 : sync_rows.front();
+      record_access_trace(mapper, fuzzing_params, dram_location, hammering_accesses_vec, trace_sync_start);
+    }
     // check if any bit flips happened
+    perf_counters.start();
     flipped_bits += memory.check_memory(mapper, false, true);
+    pattern_perf_counters.check_memory.accumulate(perf_counters.stop());
     memory.check_memory_full();
 
     // now shift the mapping to another location
@@ -430,6 +642,62 @@ void FuzzyHammerer::probe_mapping_and_scan(PatternAddressMapper &mapper,
   // code_jitter.cleanup();
 }
 
+void FuzzyHammerer::record_activation_rate(HAMMERING_KERNEL kernel, const HammeringData &data)
+{
+  ActivationRate rate{.total_acts = data.total_acts, .tsc_delta = data.tsc_delta};
+  if (!rate.is_valid())
+    return;
+  Logger::log_data(format_string("Achieved %.1f ACTs/tREFI (%.2f M ACTs/s).",
+                                 rate.get_acts_per_trefi(), rate.get_acts_per_sec() / 1e6));
+  activation_telemetry.record(kernel, rate);
+  pattern_activation_rates[kernel].accumulate(rate);
+  pattern_activation_runs.emplace_back(kernel, rate);
+}
+
+void FuzzyHammerer::record_sync_timings(const CodeJitter &code_jitter, uint64_t sync_head)
+{
+  if (CodeJitter::sync_timings.get_head() == sync_head)
+    return;
+  const auto &summary = code_jitter.last_sync_summary;
+  Logger::log_data(format_string("REF syncs: %lu, missed REFs: %lu, sync overhead: %.1f%%.",
+                                 summary.num_syncs, summary.num_missed_refs,
+                                 summary.get_overhead_fraction() * 100));
+  pattern_sync_summary.accumulate(summary);
+  if (program_args.export_sync_timings)
+  {
+    if (!sync_timings_export.is_open())
+      sync_timings_export.open(get_output_path("sync-timings.bin"), std::ios::out | std::ios::binary | std::ios::app);
+    CodeJitter::sync_timings.export_binary(sync_timings_export, sync_head, hammering_pattern.instance_id);
+  }
+}
+
+void FuzzyHammerer::record_access_trace(const PatternAddressMapper &mapper, const FuzzingParameterSet &fuzzing_params,
+                                        size_t dram_location, const std::vector<volatile char *> &hammering_accesses,
+                                        volatile char *sync_start)
+{
+  if (hammering_accesses.empty())
+    return;
+  if (!access_trace.is_open())
+    access_trace.open(get_output_path(ACCESS_TRACE_FILENAME), program_args.resume);
+
+  AccessTraceHeader header;
+  header.pattern_id = hammering_pattern.instance_id;
+  header.mapping_id = mapper.get_instance_id();
+  header.location = dram_location;
+  header.kernel = kernel_choice.kernel;
+  header.flushing = fuzzing_params.flushing_strategy;
+  header.fencing = fuzzing_params.fencing_strategy;
+  header.acts_per_trefi = static_cast<uint64_t>(fuzzing_params.get_num_activations_per_t_refi());
+  // both kernels run the whole sequence until the number of activations is reached, the unjitted one on each bank
+  auto total_num_activations = static_cast<uint64_t>(fuzzing_params.get_hammering_total_num_activations());
+  if (kernel_choice.kernel == HAMMERING_KERNEL::UNJITTED)
+    total_num_activations *= runtime_config.multi_bank;
+  header.num_rounds = (total_num_activations + hammering_accesses.size() - 1) / hammering_accesses.size();
+  access_trace.write(header, CodeJitter::get_access_sequence(kernel_choice.kernel, fuzzing_params.flushing_strategy,
+                                                             fuzzing_params.fencing_strategy, hammering_accesses,
+                                                             sync_start));
+}
+
 void FuzzyHammerer::log_overall_statistics(size_t cur_round, const std::string &best_mapping_id, const std::string &best_pattern_id,
                                            size_t best_mapping_num_bitflips, size_t num_effective_patterns, size_t total_flips)
 {
@@ -452,7 +720,8 @@ void FuzzyHammerer::log_overall_statistics(size_t cur_round, const std::string &
                                  total_flips));
 }
 
-FuzzyHammerer::FuzzyHammerer() : cr(CustomRandom()), hammering_pattern(cr.gen)
+FuzzyHammerer::FuzzyHammerer()
+    : cr(CustomRandom()), hammering_pattern(cr.gen), perf_counters(program_args.perf_raw_events)
 {
   cnt_pattern_probes = 0UL;
   cnt_generated_patterns = 0UL;
@@ -6,16 +6,18 @@
 #include <numeric>
 
 #include "Forges/FuzzyHammerer.hpp"
+#include "Forges/SweepEngine.hpp"
+#include "Fuzzer/PatternStore.hpp"
+#include <main.hpp>
 
 #ifdef ENABLE_JSON
-#include <main.hpp>
 #include <Utilities/Helper.hpp>
 #endif
 
 #define M(VAL) (VAL##000000)
 
 // initialize static variable
-double ReplayingHammerer::last_reproducibility_score = 0;
+thread_local double ReplayingHammerer::last_reproducibility_score = 0;
 
 size_t ReplayingHammerer::replay_patterns_brief(const std::string &json_filename,
                                                 const std::unordered_set<std::string> &pattern_ids, size_t sweep_bytes,
@@ -32,8 +34,36 @@ size_t ReplayingHammerer::replay_patterns_brief(std::vector<HammeringPattern> ha
 {
 
 #ifdef ENABLE_JSON
-  nlohmann::json runs;
   auto start = std::chrono::system_clock::now();
+  std::ostringstream filename_stem;
+  filename_stem << num_locations << "x" << sweep_bytes / 1024 / 1024 << "MB";
+  const auto results_filename = get_output_path(
+      "sweep-results-" + filename_stem.str() + ResultStreamWriter::get_extension(program_args.result_format));
+#endif
+  sweep_index = 0;
+  const auto resume_length = sweep_planner.begin(sweep_plan, hammering_patterns.size() * num_locations,
+                                                 program_args.resume);
+  coverage.open(get_output_path(format_string("coverage-dimm-%ld.bin", program_args.dimm_id)), program_args.dimm_id,
+                program_args.num_bankgroups * program_args.num_banks, DRAMAddr::get_max_row() + 1);
+#ifdef ENABLE_JSON
+  if (resume_length > 0)
+  {
+    // drop the records of the chunks that were swept after the last checkpoint, they are swept again
+    result_stream.reopen(results_filename, program_args.result_format, resume_length);
+  }
+  else
+  {
+    result_stream.open(results_filename, program_args.result_format);
+    result_stream.write(RESULT_RECORD::METADATA, {
+        {"kind", "sweep"},
+        {"start", std::chrono::duration_cast<std::chrono::seconds>(start.time_since_epoch()).count()},
+        {"num_patterns", hammering_patterns.size()},
+        // {"memory_config", DRAMAddr::get_memcfg_json()},
+        {"dimm_id", program_args.dimm_id},
+        {"perf_counters_available", perf_counters.is_available()},
+        {"perf_raw_events", perf_counters.get_raw_configs()},
+        {"sweep_plan", sweep_plan}});
+  }
 #endif
 
   size_t bitflips_count = 0;
@@ -72,26 +102,47 @@ size_t ReplayingHammerer::replay_patterns_brief(std::vector<HammeringPattern> ha
 
       for (size_t i = 0; i < num_locations; ++i)
       {
-        // do the sweep
-        // struct SweepSummary summary = sweep_pattern(pattern, mapper, 1, sweep_bytes, direct_effective_aggs);
-        struct SweepSummary summary = sweep_pattern(pattern, mapper, 1, sweep_bytes, direct_effective_aggs);
-        bitflips_count += summary.observed_bitflips.size();
+        SweepCounts completed_counts;
+        if (sweep_planner.is_sweep_completed(sweep_index, completed_counts))
+        {
+          // a resumed run skips the sweeps that were completed before, their records are in the result stream already
+          Logger::log_info(format_string("Skipping sweep %zu, it was completed before.", sweep_index));
+          bitflips_count += completed_counts.num_observed_bitflips;
+        }
+        else
+        {
+          // do the sweep
+          // struct SweepSummary summary = sweep_pattern(pattern, mapper, 1, direct_effective_aggs);
+          struct SweepSummary summary = sweep_pattern(pattern, mapper, 1, direct_effective_aggs);
+          bitflips_count += summary.num_observed_bitflips;
 
-        // save the data about the sweep
+          // save the data about the sweep; its bit flips were already streamed by sweep_pattern
 #ifdef ENABLE_JSON
-        nlohmann::json entry;
-        entry["pattern"] = pattern.instance_id;
-        entry["mapping"] = mapper.get_instance_id();
-
-        nlohmann::json flips;
-        flips["zero_to_one"] = summary.num_flips_z2o;
-        flips["one_to_zero"] = summary.num_flips_o2z;
-        flips["total"] = summary.num_flips_z2o + summary.num_flips_o2z;
-        flips["details"] = summary.observed_bitflips;
-        entry["flips"] = flips;
-
-        runs.push_back(entry);
+          nlohmann::json entry;
+          entry["sweep"] = sweep_index;
+          entry["pattern"] = pattern.instance_id;
+          entry["mapping"] = mapper.get_instance_id();
+
+          nlohmann::json flips;
+          flips["zero_to_one"] = summary.num_flips_z2o;
+          flips["one_to_zero"] = summary.num_flips_o2z;
+          flips["total"] = summary.num_flips_z2o + summary.num_flips_o2z;
+          entry["flips"] = flips;
+          entry["perf_counters"] = summary.perf_counters;
+          entry["activation_rate"] = summary.activation_rate;
+          entry["sync"] = summary.sync_summary;
+          entry["flip_stats"] = summary.flip_stats.to_json();
+
+          result_stream.write(RESULT_RECORD::SWEEP, entry);
 #endif
+          sweep_planner.complete_sweep(sweep_index,
+                                       {.num_flips = summary.num_flips_z2o + summary.num_flips_o2z,
+                                        .num_flips_z2o = summary.num_flips_z2o,
+                                        .num_flips_o2z = summary.num_flips_o2z,
+                                        .num_observed_bitflips = summary.num_observed_bitflips},
+                                       result_stream.is_open() ? result_stream.flush() : 0);
+        }
+        sweep_index++;
 
         if (i + 1 < num_locations)
         {
@@ -106,23 +157,15 @@ size_t ReplayingHammerer::replay_patterns_brief(std::vector<HammeringPattern> ha
 
 #ifdef ENABLE_JSON
   auto end = std::chrono::system_clock::now();
-
-  nlohmann::json meta;
-  meta["start"] = std::chrono::duration_cast<std::chrono::seconds>(start.time_since_epoch()).count();
-  meta["end"] = std::chrono::duration_cast<std::chrono::seconds>(end.time_since_epoch()).count();
-  meta["num_patterns"] = hammering_patterns.size();
-  // meta["memory_config"] = DRAMAddr::get_memcfg_json();
-  meta["dimm_id"] = program_args.dimm_id;
-
-  nlohmann::json root;
-  root["metadata"] = meta;
-  root["sweeps"] = runs;
-
-  std::ostringstream filename;
-  filename << "sweep-summary-" << num_locations << "x" << sweep_bytes / 1024 / 1024 << "MB.json";
-  std::ofstream stream(filename.str());
-  stream << root << std::endl;
-  stream.close();
+  result_stream.write(RESULT_RECORD::END, {
+      {"end", std::chrono::duration_cast<std::chrono::seconds>(end.time_since_epoch()).count()},
+      {"activation_telemetry", activation_telemetry.to_json()}});
+  result_stream.close();
+  sweep_planner.end();
+  coverage.close();
+
+  // the existing tooling expects the summary with all bit flips in a single JSON file
+  ResultStreamWriter::convert(results_filename, get_output_path("sweep-summary-" + filename_stem.str() + ".json"));
 #endif
 
   return bitflips_count;
@@ -131,12 +174,17 @@ size_t ReplayingHammerer::replay_patterns_brief(std::vector<HammeringPattern> ha
 std::vector<HammeringPattern> ReplayingHammerer::load_patterns_from_json(const std::string &json_filename,
                                                                          const std::unordered_set<std::string> &pattern_ids)
 {
+  if (PatternStore::is_pattern_store(json_filename))
+  {
+    return load_patterns_from_store(json_filename, pattern_ids);
+  }
+
   // open the JSON file
   std::ifstream ifs(json_filename);
   if (!ifs.is_open())
   {
     Logger::log_error(format_string("Could not open given file (%s).", json_filename.c_str()));
-    exit(1);
+    exit_target(1);
   }
 
   // parse the JSON file and extract HammeringPatterns matching any of the given IDs
@@ -156,11 +204,43 @@ std::vector<HammeringPattern> ReplayingHammerer::load_patterns_from_json(const s
   if (pattern_ids.empty())
   {
     // printf("pattern_ids is empty!\n");
-    // look for the best pattern (w.r.t. number of bit flips) instead
+    // look for the best pattern (w.r.t. number of bit flips) instead; if only the top k patterns are requested, they
+    // are selected by counting the bit flips in the JSON, so that only the selected patterns need to be decoded
+    std::vector<const nlohmann::json *> selected_patterns;
     for (auto const &json_hammering_patt : patterns_array)
+    {
+      selected_patterns.push_back(&json_hammering_patt);
+    }
+    if (program_args.replay_top_k > 0 && selected_patterns.size() > program_args.replay_top_k)
+    {
+      auto count_bitflips = [](const nlohmann::json &j)
+      {
+        size_t flips = 0;
+        for (const auto &mapping : j.at("address_mappings"))
+          for (const auto &bitflips : mapping.at("bit_flips"))
+            flips += bitflips.size();
+        return flips;
+      };
+      std::vector<std::pair<size_t, const nlohmann::json *>> flips_per_pattern;
+      flips_per_pattern.reserve(selected_patterns.size());
+      for (const auto *json_hammering_patt : selected_patterns)
+      {
+        flips_per_pattern.emplace_back(count_bitflips(*json_hammering_patt), json_hammering_patt);
+      }
+      std::stable_sort(flips_per_pattern.begin(), flips_per_pattern.end(),
+                       [](const auto &a, const auto &b) { return a.first > b.first; });
+      flips_per_pattern.resize(program_args.replay_top_k);
+      selected_patterns.clear();
+      for (const auto &[flips, json_hammering_patt] : flips_per_pattern)
+      {
+        selected_patterns.push_back(json_hammering_patt);
+      }
+    }
+
+    for (const auto *json_hammering_patt : selected_patterns)
     {
       HammeringPattern pattern;
-      from_json(json_hammering_patt, pattern);
+      from_json(*json_hammering_patt, pattern);
       // printf("iterating over pattern %s\n", pattern.instance_id.c_str());
 
       // store the mapping: mapping ID -> hammering pattern, for each mapping of the best pattern
@@ -201,12 +281,68 @@ std::vector<HammeringPattern> ReplayingHammerer::load_patterns_from_json(const s
   }
 #else
   Logger::log_failure("Replaying mode requires ENABLE_JSON (see CMakeLists.txt) to work. Cannot continue.");
-  exit(EXIT_FAILURE);
+  exit_target(EXIT_FAILURE);
 #endif
 
   return patterns;
 }
 
+std::vector<HammeringPattern> ReplayingHammerer::load_patterns_from_store(const std::string &store_filename,
+                                                                          const std::unordered_set<std::string> &pattern_ids)
+{
+  PatternStore store;
+  if (!store.open(store_filename))
+  {
+    exit_target(EXIT_FAILURE);
+  }
+
+  // select the patterns by their index entries first, so that only these need to be decoded
+  std::vector<const PatternStoreIndexEntry *> entries;
+  if (!pattern_ids.empty())
+  {
+    for (const auto &id : pattern_ids)
+    {
+      auto matches = store.find(id);
+      if (matches.empty())
+      {
+        Logger::log_error(format_string("Pattern %s not found in %s.", id.c_str(), store_filename.c_str()));
+      }
+      entries.insert(entries.end(), matches.begin(), matches.end());
+    }
+  }
+  else if (program_args.replay_top_k > 0)
+  {
+    entries = store.get_top_k(program_args.replay_top_k);
+  }
+  else
+  {
+    entries = store.get_entries();
+  }
+  Logger::log_info(format_string("Loading %zu of %zu patterns from %s.",
+                                 entries.size(), store.size(), store_filename.c_str()));
+
+  std::vector<HammeringPattern> patterns;
+  for (const auto *entry : entries)
+  {
+    auto pattern = store.load(*entry);
+    if (!pattern_ids.empty())
+    {
+      Logger::log_info(format_string("Found pattern %s and assoc. mappings:", pattern.instance_id.c_str()));
+    }
+    for (const auto &mp : pattern.address_mappings)
+    {
+      if (!pattern_ids.empty())
+      {
+        Logger::log_data(format_string("%s (min row: %d, max row: %d)", mp.get_instance_id().c_str(),
+                                       mp.min_row, mp.max_row));
+      }
+      map_mapping_id_to_pattern[mp.get_instance_id()] = pattern;
+    }
+    patterns.push_back(std::move(pattern));
+  }
+  return patterns;
+}
+
 /*
 size_t ReplayingHammerer::hammer_pattern(FuzzingParameterSet &fuzz_params,
                                          CodeJitter &code_jitter,
@@ -320,149 +456,298 @@ size_t ReplayingHammerer::hammer_pattern(FuzzingParameterSet &fuzz_params,
 */
 
 struct SweepSummary ReplayingHammerer::sweep_pattern(HammeringPattern &pattern, PatternAddressMapper &mapper,
-                                                     size_t num_reps, size_t size_bytes)
+                                                     size_t num_reps)
 {
-  return sweep_pattern(pattern, mapper, num_reps, size_bytes, {});
+  return sweep_pattern(pattern, mapper, num_reps, {});
 }
 
 struct SweepSummary ReplayingHammerer::sweep_pattern(HammeringPattern &pattern, PatternAddressMapper &mapper,
-                                                     size_t num_reps, size_t num_rows,
+                                                     size_t num_reps,
                                                      const std::unordered_set<AggressorAccessPattern> &effective_aggs)
 {
-  // find address sets that create bank conflicts
-  DramAnalyzer dramAnalyzer(mem.get_starting_address());
-
   // sweep_pattern modifies the original mapping, thus we create a copy and restore it again before returning from func
   PatternAddressMapper original_mapping = mapper;
 
-  // sweep over a chunk of N MBytes to see whether this pattern also works on other locations
-  // compute the bound of the mem area we want to check using this pattern
-  auto &jitter = mapper.get_code_jitter();
+  // sweep over the locations of the plan to see whether this pattern also works on other locations
+  const auto &plan = sweep_planner.get_plan();
+  const auto num_rows = plan.get_num_rows();
+  const auto num_banks = plan.get_num_banks();
 
-  Logger::log_info(format_string("Sweeping pattern %s with mapping %s over 2 MiB, equiv. to %d rows, with each %d repetitions.",
-                                 pattern.instance_id.c_str(), mapper.get_instance_id().c_str(), num_rows, num_reps));
+  Logger::log_info(format_string("Sweeping pattern %s with mapping %s over %s, with each %d repetitions.",
+                                 pattern.instance_id.c_str(), mapper.get_instance_id().c_str(),
+                                 plan.to_string().c_str(), num_reps));
 
-  auto init_ss = [](std::stringstream &stringstream)
+  // the locations this (pattern, mapping) was hammered at before, in this or in previous runs
+  size_t coverage_slot = 0;
+  if (coverage.is_open())
   {
-    stringstream.str("");
-    stringstream.clear();
-    stringstream << std::setfill(' ') << std::left;
-  };
+    coverage_slot = coverage.get_slot(pattern.instance_id, mapper.get_instance_id());
+    const auto &entry = coverage.get_entry(coverage_slot);
+    Logger::log_info(format_string("The mapping was hammered at %lu locations (%.3f%% of the DIMM) before, %lu of them "
+                                   "with bit flips.", entry.num_covered, coverage.get_covered_fraction(coverage_slot) * 100,
+                                   entry.num_flipped));
+  }
+  size_t num_skipped_covered = 0;
 
-  std::stringstream ss;
-  init_ss(ss);
-  ss << std::setw(10) << "Offset" << std::setw(12) << "Min. Row"
-     << std::setw(12) << "Max. Row" << std::setw(13) << "#Bit Flips" << "Flipped Rows"
-     << std::endl
-     << "--------------------------------------------------------------";
-  Logger::log_data(ss.str());
-
-  size_t total_bit_flips_sweeping = 0;
-  std::vector<BitFlip> bflips;
-  std::vector<BitFlip> bitflips_list;
-  if (DEBUG_MODE)
+  // the rows are logged in batches, see flush_log
+  std::string log_buffer = format_string("%-10s%-12s%-12s%-13s%s\n%s",
+                                         "Offset", "Min. Row", "Max. Row", "#Bit Flips", "Flipped Rows",
+                                         "--------------------------------------------------------------");
+  auto flush_log = [&log_buffer]()
   {
-    num_rows = 10;
-  }
-  else
+    if (!log_buffer.empty())
+      Logger::log_data(log_buffer);
+    log_buffer.clear();
+  };
+  flush_log();
+
+  HammerPerfCounters sweep_perf_counters;
+  ActivationRate sweep_activation_rate;
+  SyncTimingSummary sweep_sync_summary;
+  std::ofstream sync_timings_export;
+  if (program_args.export_sync_timings)
   {
-    num_rows = 2000000;
+    sync_timings_export.open(get_output_path("sync-timings.bin"), std::ios::out | std::ios::binary | std::ios::app);
   }
-  for (unsigned long r = 1; r <= num_rows; ++r)
+  // the counters of all chunks, including the ones that were completed before the run was resumed
+  SweepCounts counts;
+  // the histograms only cover the chunks swept by this run
+  FlipAggregator flip_stats(DRAMAddr::get_max_row() + 1);
+
+  // the sweep of this pattern stops once its time budget is used up
+  const auto sweep_start = std::chrono::steady_clock::now();
+  auto get_elapsed_sec = [&sweep_start]()
   {
-    // modify assignment of agg ID to DRAM address by shifting rows of all aggressors by 1
-    mapper.shift_mapping(1, effective_aggs);
-
-    // determine victim rows
-    mapper.determine_victims(pattern.agg_access_patterns);
-
-    std::vector<volatile char *> hammering_accesses_vec;
-    mapper.export_pattern(pattern.aggressors, pattern.base_period, hammering_accesses_vec);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - sweep_start).count();
+  };
+  bool budget_exceeded = false;
 
-    // SYNC ROWS: 32 rows in the same bank of a different bank group
-    if (DEBUG_MODE)
+  size_t num_rebuilds = 0;
+  for (size_t bank_idx = 0; bank_idx < num_banks && !budget_exceeded; ++bank_idx)
+  {
+    // the sweep of each bank starts from the original mapping; as the assignment replaces the mapper's code jitter, the
+    // jitter must only be taken afterwards
+    mapper = original_mapping;
+    auto &jitter = mapper.get_code_jitter();
+    if (!plan.banks.empty() || plan.first_row != -1)
     {
-      printf("sweeping pattern %s over row %zu\n", pattern.instance_id.c_str(), r);
+      const auto &first_agg = mapper.aggressor_to_addr.begin()->second;
+      const auto bankgroup = plan.banks.empty() ? first_agg.get_bankgroup() : plan.banks[bank_idx] / program_args.num_banks;
+      const auto bank = plan.banks.empty() ? first_agg.get_bank() : plan.banks[bank_idx] % program_args.num_banks;
+      const auto first_row = (plan.first_row == -1) ? mapper.min_row : static_cast<size_t>(plan.first_row);
+      if (!mapper.move_to(bankgroup, bank, first_row))
+      {
+        Logger::log_error(format_string("Cannot move mapping %s to row %zu, its aggressors span %zu rows and would "
+                                        "exceed the last row (%zu) of the bank.", mapper.get_instance_id().c_str(),
+                                        first_row, mapper.max_row - mapper.min_row, DRAMAddr::get_max_row()));
+        exit_target(EXIT_FAILURE);
+      }
     }
-    auto any_aggressor_row = DRAMAddr((void *)hammering_accesses_vec.at(0));
-    std::vector<volatile char *> sync_rows;
-    auto mr = mapper.max_row;
-    auto da = DRAMAddr(any_aggressor_row);
-    da.add_inplace(0, 1, 0, 0, 0);
-    da.set_row(mr);
-    // for (size_t i = 1; i <= 256; ++i)
-    // {
-    //   da.add_inplace(0, 0, 0, i, 0);
-    //   sync_rows.push_back((volatile char *)da.to_virt());
-    // }
-    for (size_t i = 1; i <= 256; ++i)
+    if (plan.first_row == -1)
     {
-      int random_data = Range<int>(1, 4).get_random_number(gen);
-
-      da.add_inplace(0, 0, 0, random_data, 0);
-      // random_data = i;
-      // random_data = 1;
-      sync_rows.push_back((volatile char *)da.to_virt());
-      // std::cout << "sync_rows:"<<da.get_row() << "\n";
+      // start one row after the mapping's location
+      mapper.shift_mapping(1, effective_aggs);
     }
-    mem.flipped_bits.clear();
-
-    // jitter.jit_strict(
-    //     params,
-    //     params.flushing_strategy,
-    //     params.fencing_strategy,
-    //     params.get_hammering_total_num_activations(),
-    //     hammering_accesses_vec,
-    //     da,
-    //     dramAnalyzer.get_ref_threshold());
-    jitter.hammer_pattern_unjitted(params, false, FLUSHING_STRATEGY::BATCHED, FENCING_STRATEGY::LATEST_POSSIBLE,
-                                   jitter.total_activations, hammering_accesses_vec, sync_rows, dramAnalyzer.get_ref_threshold());
-    // jitter.hammer_pattern(params, false);
-    // jitter.cleanup();
-    auto num_flips = mem.check_memory(mapper, false, false);
-
-    // note the use of early_stopping in hammer_pattern: we repeat hammering at maximum hammering_num_reps times but do stop
-    // after observing any bit flip - this is the number that we report
-    total_bit_flips_sweeping += num_flips;
-    bflips.insert(bflips.end(), mem.flipped_bits.begin(), mem.flipped_bits.end());
-    for (auto bf : mem.flipped_bits)
+
+    // the accesses, victims, and sync rows at the current location; they are moved by row_stride rows per location;
+    // the sync rows are drawn from the run's seed, so that a resumed sweep accesses the same ones
+    auto sync_row_gen = sweep_planner.get_sync_row_gen(sweep_index, bank_idx);
+    SweepEngine sweep(pattern, mapper, effective_aggs, sync_row_gen);
+    const DRAMAddr first_access((void *)sweep.accesses.at(0));
+    const auto coverage_bank = first_access.get_bankgroup() * program_args.num_banks + first_access.get_bank();
+
+    // the number of rows the engine is behind the next location, including the locations of skipped chunks
+    size_t pending_rows = 0;
+    for (size_t first_row_idx = 0; first_row_idx < num_rows && !budget_exceeded; first_row_idx += plan.chunk_rows)
     {
-      bitflips_list.push_back(bf);
-    }
+      const auto chunk_end = std::min(first_row_idx + plan.chunk_rows, num_rows);
+      if (sweep_planner.is_completed(sweep_index, bank_idx, first_row_idx, counts))
+      {
+        Logger::log_debug(format_string("Skipping locations %zu to %zu of bank %zu, they were swept before.",
+                                        first_row_idx + 1, chunk_end, bank_idx));
+        pending_rows += (chunk_end - first_row_idx) * plan.row_stride;
+        continue;
+      }
+
+      const auto chunk_start_sec = get_elapsed_sec();
+      SweepCounts chunk_counts;
+      // (row, #corrupted bytes) of each location of the chunk; they are only written to the coverage map once the chunk
+      // is checkpointed, otherwise a resumed run would skip locations whose bit flips were never recorded
+      std::vector<std::pair<size_t, size_t>> chunk_coverage;
+      for (size_t r = first_row_idx + 1; r <= chunk_end; ++r)
+      {
+        if (plan.time_budget > 0 && get_elapsed_sec() >= static_cast<double>(plan.time_budget))
+        {
+          budget_exceeded = true;
+          break;
+        }
+        if (pending_rows > 0)
+        {
+          sweep.advance(pending_rows);
+          pending_rows = 0;
+        }
+        if (plan.skip_covered && coverage.is_open() && coverage.is_covered(coverage_slot, coverage_bank, sweep.min_row))
+        {
+          num_skipped_covered++;
+          pending_rows = plan.row_stride;
+          continue;
+        }
+        if (runtime_config.debug_mode)
+        {
+          printf("sweeping pattern %s over row %zu\n", pattern.instance_id.c_str(), r);
+        }
+        mem.flipped_bits.clear();
 
-    init_ss(ss);
-    ss << std::setw(10) << r << std::setw(12) << mapper.min_row
-       << std::setw(12) << mapper.max_row << std::setw(13) << num_flips << mem.get_flipped_rows_text_repr();
-    Logger::log_data(ss.str());
+        const auto sync_head = CodeJitter::sync_timings.get_head();
+        if (kernel_choice.kernel == HAMMERING_KERNEL::JITTED)
+        {
+#ifdef ENABLE_JITTING
+          jitter.jit_strict(
+              params,
+              kernel_choice.flushing_strategy,
+              kernel_choice.fencing_strategy,
+              jitter.total_activations,
+              sweep.accesses,
+              sweep.sync_start,
+              ref_threshold);
+#endif
+          perf_counters.start();
+          jitter.hammer_pattern(params, false);
+          sweep_perf_counters.hammer_pattern.accumulate(perf_counters.stop());
+          jitter.cleanup();
+        }
+        else
+        {
+          perf_counters.start();
+          jitter.hammer_pattern_unjitted(params, false, kernel_choice.flushing_strategy, kernel_choice.fencing_strategy,
+                                         jitter.total_activations, sweep.accesses, sweep.sync_rows,
+                                         ref_threshold);
+          sweep_perf_counters.hammer_pattern_unjitted.accumulate(perf_counters.stop());
+        }
+        ActivationRate rate{.total_acts = jitter.last_hammering_data.total_acts,
+                            .tsc_delta = jitter.last_hammering_data.tsc_delta};
+        activation_telemetry.record(kernel_choice.kernel, rate);
+        sweep_activation_rate.accumulate(rate);
+        sweep_sync_summary.accumulate(jitter.last_sync_summary);
+        if (sync_timings_export.is_open())
+        {
+          CodeJitter::sync_timings.export_binary(sync_timings_export, sync_head, pattern.instance_id);
+        }
+        perf_counters.start();
+        auto num_flips = mem.check_memory(sweep.victim_row_starts, false);
+        sweep_perf_counters.check_memory.accumulate(perf_counters.stop());
+
+        // note the use of early_stopping in hammer_pattern: we repeat hammering at maximum hammering_num_reps times but do
+        // stop after observing any bit flip - this is the number that we report
+        chunk_counts.num_flips += num_flips;
+        // only keep aggregates here, the bit flips of this location are cleared before hammering the next one; the
+        // flips of a victim row are found one after the other, so its row only needs to be compared to the last one
+        std::string flipped_rows;
+        size_t last_flipped_row = SIZE_MAX;
+        for (const auto &bf : mem.flipped_bits)
+        {
+          chunk_counts.num_flips_z2o += bf.count_z2o_corruptions();
+          chunk_counts.num_flips_o2z += bf.count_o2z_corruptions();
+          flip_stats.record(bf);
+          if (bf.address.get_row() != last_flipped_row)
+          {
+            if (!flipped_rows.empty())
+              flipped_rows += ", ";
+            flipped_rows += std::to_string(bf.address.get_row());
+            last_flipped_row = bf.address.get_row();
+          }
+          if (program_args.stream_raw_flips && result_stream.is_open())
+          {
+            result_stream.write_bitflip(sweep_index, bf);
+          }
+        }
+        chunk_counts.num_observed_bitflips += mem.flipped_bits.size();
+        chunk_coverage.emplace_back(sweep.min_row, mem.flipped_bits.size());
+
+        if (num_flips > 0 || r % runtime_config.sweep_log_every == 0 || r == num_rows)
+        {
+          if (!log_buffer.empty())
+            log_buffer += '\n';
+          log_buffer += format_string("%-10lu%-12zu%-12zu%-13zu", r, sweep.min_row, sweep.max_row, num_flips);
+          log_buffer += flipped_rows;
+          if (log_buffer.size() >= 64 * 1024)
+            flush_log();
+        }
+        pending_rows = plan.row_stride;
+      }
+      counts.accumulate(chunk_counts);
+      flush_log();
+      if (budget_exceeded)
+      {
+        // the partially swept chunk is not checkpointed, but the sweep counts as completed with what it found so far;
+        // its locations are not marked as covered, so later sweeps may hammer them again
+        break;
+      }
+
+      const auto chunk_sec = get_elapsed_sec() - chunk_start_sec;
+      sweep_planner.complete_chunk(sweep_index, bank_idx, first_row_idx, chunk_end - first_row_idx, chunk_sec,
+                                   chunk_counts, result_stream.is_open() ? result_stream.flush() : 0);
+      if (coverage.is_open())
+      {
+        // a crash before the marks are synced at most loses coverage of a checkpointed chunk, which is only swept again
+        for (const auto &[row, num_bitflips] : chunk_coverage)
+          coverage.mark(coverage_slot, coverage_bank, row, num_bitflips);
+        coverage.sync();
+      }
+
+      const auto rows_left = (num_banks - bank_idx - 1) * num_rows + (num_rows - chunk_end);
+      const auto remaining_sec = sweep_planner.get_remaining_sec(
+          rows_left, static_cast<double>(plan.time_budget) - get_elapsed_sec());
+      Logger::log_info(format_string("Swept %zu/%zu locations of bank %zu/%zu (%.1f locations/s), time left: %s.",
+                                     chunk_end, num_rows, bank_idx + 1, num_banks,
+                                     static_cast<double>(chunk_end - first_row_idx) / std::max(chunk_sec, 1e-9),
+                                     (remaining_sec < 0)
+                                         ? "unknown"
+                                         : Logger::format_timestamp(static_cast<unsigned long>(remaining_sec)).c_str()));
+    }
+    num_rebuilds += sweep.get_num_rebuilds();
   }
-  if (DEBUG_MODE)
+  Logger::log_debug(format_string("Rebuilt the sweep state from the mapping %zu times.", num_rebuilds));
+  if (num_skipped_covered > 0)
   {
-    std::cerr << "Total corruptions: " << total_bit_flips_sweeping << "\n";
+    Logger::log_info(format_string("Skipped %zu locations the mapping was hammered at before.", num_skipped_covered));
   }
-  Logger::log_info("Summary of sweeping pattern:");
-  Logger::log_data(format_string("Total corruptions: %ld", total_bit_flips_sweeping));
-
-  size_t z2o_corruptions = 0;
-  size_t o2z_corruptions = 0;
-  for (const auto &bf : bflips)
+  if (budget_exceeded)
   {
-    z2o_corruptions += bf.count_z2o_corruptions();
-    o2z_corruptions += bf.count_o2z_corruptions();
+    Logger::log_info(format_string("Stopped sweeping pattern %s after its time budget of %lu seconds.",
+                                   pattern.instance_id.c_str(), plan.time_budget));
   }
-  Logger::log_data(format_string("0->1 flips: %lu", z2o_corruptions));
-  Logger::log_data(format_string("1->0 flips: %lu", o2z_corruptions));
+  if (runtime_config.debug_mode)
+  {
+    std::cerr << "Total corruptions: " << counts.num_flips << "\n";
+  }
+  Logger::log_info("Summary of sweeping pattern:");
+  Logger::log_data(format_string("Total corruptions: %ld", counts.num_flips));
+
+  Logger::log_data(format_string("0->1 flips: %lu", counts.num_flips_z2o));
+  Logger::log_data(format_string("1->0 flips: %lu", counts.num_flips_o2z));
+  Logger::log_data(format_string("Achieved ACTs/tREFI: %.1f (%.2f M ACTs/s)",
+                                 sweep_activation_rate.get_acts_per_trefi(),
+                                 sweep_activation_rate.get_acts_per_sec() / 1e6));
+  Logger::log_data(format_string("Missed REFs: %lu of %lu, sync overhead: %.1f%%",
+                                 sweep_sync_summary.num_missed_refs, sweep_sync_summary.num_syncs,
+                                 sweep_sync_summary.get_overhead_fraction() * 100));
 
   // restore original mapping
   mapper = original_mapping;
 
   struct SweepSummary sweepsum = {
-      .num_flips_z2o = z2o_corruptions,
-      .num_flips_o2z = o2z_corruptions,
-      .observed_bitflips = bitflips_list};
+      .num_flips_z2o = counts.num_flips_z2o,
+      .num_flips_o2z = counts.num_flips_o2z,
+      .num_observed_bitflips = counts.num_observed_bitflips,
+      .perf_counters = sweep_perf_counters,
+      .activation_rate = sweep_activation_rate,
+      .sync_summary = sweep_sync_summary,
+      .flip_stats = flip_stats};
   return sweepsum;
 }
 
-ReplayingHammerer::ReplayingHammerer(Memory &mem) : mem(mem)
+ReplayingHammerer::ReplayingHammerer(Memory &mem) : mem(mem), perf_counters(program_args.perf_raw_events)
 { /* NOLINT */
   std::random_device rd;
   gen = std::mt19937(rd());
@@ -662,7 +947,7 @@ void ReplayingHammerer::find_direct_effective_aggs(PatternAddressMapper &mapper,
                                                    std::unordered_set<AggressorAccessPattern> &direct_effective_aggs) {
   if (map_mapping_id_to_pattern.count(mapper.get_instance_id()) > 0) {
     Logger::log_error("find_direct_effective_aggs: Could not find pattern associated with given mapping. Aborting.");
-    exit(EXIT_FAILURE);
+    exit_target(EXIT_FAILURE);
   }
   auto &pattern = map_mapping_id_to_pattern.at(mapper.get_instance_id());
   find_direct_effective_aggs(pattern, mapper, direct_effective_aggs);
@@ -781,7 +1066,7 @@ void ReplayingHammerer::find_direct_effective_aggs(PatternAddressMapper &mapper,
       Logger::log_error(
           format_string("ReplayingHammerer.cpp:get_index(...) could not find given element (%d) in vector (%s).",
               elem, ss.str().c_str()));
-      exit(EXIT_FAILURE);
+      exit_target(EXIT_FAILURE);
     }
   };
 
@@ -0,0 +1,93 @@
+#include "Forges/SweepEngine.hpp"
+
+#include "Utilities/Range.hpp"
+
+SweepEngine::SweepEngine(HammeringPattern &pattern, PatternAddressMapper &mapper,
+                         const std::unordered_set<AggressorAccessPattern> &effective_aggs, std::mt19937 &gen)
+    : pattern(pattern), mapper(mapper), effective_aggs(effective_aggs)
+{
+  for (size_t i = 0; i < NUM_SYNC_ROWS; ++i)
+  {
+    sync_row_gaps.push_back(Range<int>(1, 4).get_random_number(gen));
+  }
+  rebuild();
+}
+
+void SweepEngine::rebuild()
+{
+  // modify assignment of agg ID to DRAM address by shifting rows of all (or only the effective) aggressors
+  if (pending_shift != 0)
+  {
+    mapper.shift_mapping(pending_shift, effective_aggs);
+    pending_shift = 0;
+  }
+  mapper.determine_victims(pattern.agg_access_patterns);
+  min_row = mapper.min_row;
+  max_row = mapper.max_row;
+
+  accesses.clear();
+  mapper.export_pattern(pattern.aggressors, pattern.base_period, accesses);
+  access_rows.clear();
+  for (auto *addr : accesses)
+  {
+    access_rows.push_back(DRAMAddr((void *)addr).get_row());
+  }
+
+  victim_row_starts.clear();
+  victim_rows.clear();
+  for (const auto &vr : mapper.get_victim_rows())
+  {
+    victim_row_starts.push_back((volatile char *)vr.to_virt());
+    victim_rows.push_back(vr.get_row());
+  }
+
+  // SYNC ROWS: rows in the same bank of a different bank group, starting after the pattern's last row
+  auto da = DRAMAddr((void *)accesses.at(0));
+  da.add_inplace(0, 1, 0, 0, 0);
+  da.set_row(max_row);
+  sync_start = da;
+  sync_rows.clear();
+  sync_row_nos.clear();
+  for (const auto gap : sync_row_gaps)
+  {
+    da.add_inplace(0, 0, 0, gap, 0);
+    sync_rows.push_back((volatile char *)da.to_virt());
+    sync_row_nos.push_back(da.get_row());
+  }
+  num_rebuilds++;
+}
+
+void SweepEngine::slide(std::vector<volatile char *> &addresses, std::vector<size_t> &rows, size_t num_rows)
+{
+  for (size_t i = 0; i < addresses.size(); ++i)
+  {
+    addresses[i] = (volatile char *)((uint64_t)addresses[i] ^ DRAMAddr::get_row_delta(rows[i], num_rows));
+    rows[i] = (rows[i] + num_rows) & DRAMAddr::get_max_row();
+  }
+}
+
+void SweepEngine::advance(size_t num_rows)
+{
+  pending_shift += static_cast<int>(num_rows);
+
+  // determine_victims skips rows below 0 and the rows wrap around after the last one, hence near the edges of the bank
+  // the victims are not simply the ones of the previous location moved by some rows
+  const auto radius = static_cast<size_t>(PatternAddressMapper::ROW_BLAST_RADIUS);
+  if (!effective_aggs.empty() || min_row < radius || max_row + radius + num_rows > DRAMAddr::get_max_row())
+  {
+    rebuild();
+    return;
+  }
+
+  slide(accesses, access_rows, num_rows);
+  slide(victim_row_starts, victim_rows, num_rows);
+  slide(sync_rows, sync_row_nos, num_rows);
+  sync_start.add_inplace(0, 0, 0, num_rows, 0);
+  min_row += num_rows;
+  max_row += num_rows;
+}
+
+size_t SweepEngine::get_num_rebuilds() const
+{
+  return num_rebuilds;
+}
@@ -0,0 +1,326 @@
+#include "Forges/SweepPlanner.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#include <yaml-cpp/yaml.h>
+
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+#include "Utilities/RuntimeConfig.hpp"
+#include "main.hpp"
+
+void SweepPlan::load_yaml(const std::string &filepath)
+{
+  YAML::Node config;
+  try
+  {
+    config = YAML::LoadFile(filepath);
+  }
+  catch (const YAML::Exception &e)
+  {
+    Logger::log_error(format_string("Could not load sweep plan %s: %s", filepath.c_str(), e.what()));
+    exit_target(EXIT_FAILURE);
+  }
+
+  if (config["first_row"])
+    first_row = config["first_row"].as<long>();
+  if (config["num_rows"])
+    num_rows = config["num_rows"].as<size_t>();
+  if (config["row_stride"])
+    row_stride = config["row_stride"].as<size_t>();
+  if (config["banks"])
+    banks = config["banks"].as<std::vector<size_t>>();
+  if (config["time_budget"])
+    time_budget = config["time_budget"].as<unsigned long>();
+  if (config["chunk_rows"])
+    chunk_rows = config["chunk_rows"].as<size_t>();
+  if (config["skip_covered"])
+    skip_covered = config["skip_covered"].as<bool>();
+  Logger::log_debug(format_string("Loaded sweep plan from %s.", filepath.c_str()));
+}
+
+void SweepPlan::validate() const
+{
+  if (first_row < -1)
+  {
+    Logger::log_error(format_string("first_row must be -1 or a row number but is %ld.", first_row));
+    exit_target(EXIT_FAILURE);
+  }
+  if (row_stride == 0 || chunk_rows == 0)
+  {
+    Logger::log_error("row_stride and chunk_rows of the sweep plan must be positive.");
+    exit_target(EXIT_FAILURE);
+  }
+  const auto num_banks_total = program_args.num_bankgroups * program_args.num_banks;
+  for (const auto bank : banks)
+  {
+    if (bank >= num_banks_total)
+    {
+      Logger::log_error(format_string("Bank %zu of the sweep plan does not exist, the geometry only has %zu banks.",
+                                      bank, num_banks_total));
+      exit_target(EXIT_FAILURE);
+    }
+  }
+}
+
+size_t SweepPlan::get_num_rows() const
+{
+  if (runtime_config.debug_mode)
+    return 10;
+  return (num_rows > 0) ? num_rows : runtime_config.full_sweep_rows;
+}
+
+size_t SweepPlan::get_num_banks() const
+{
+  return banks.empty() ? 1 : banks.size();
+}
+
+std::string SweepPlan::to_string() const
+{
+  auto str = format_string("%zu locations (stride %zu rows) starting at %s in %s",
+                           get_num_rows(), row_stride,
+                           (first_row == -1) ? "the mapping's location" : format_string("row %ld", first_row).c_str(),
+                           banks.empty() ? "the mapping's bank" : format_string("%zu banks", banks.size()).c_str());
+  if (time_budget > 0)
+    str += format_string(", at most %lu s per pattern", time_budget);
+  if (skip_covered)
+    str += ", skipping covered locations";
+  return str;
+}
+
+void SweepCounts::accumulate(const SweepCounts &other)
+{
+  num_flips += other.num_flips;
+  num_flips_z2o += other.num_flips_z2o;
+  num_flips_o2z += other.num_flips_o2z;
+  num_observed_bitflips += other.num_observed_bitflips;
+}
+
+std::string SweepPlanner::get_chunk_key(size_t sweep, size_t bank_idx, size_t first_row_idx)
+{
+  return format_string("%zu/%zu/%zu", sweep, bank_idx, first_row_idx);
+}
+
+uint64_t SweepPlanner::begin(const SweepPlan &sweep_plan, size_t num_sweeps, bool resume)
+{
+  plan = sweep_plan;
+  num_planned_sweeps = num_sweeps;
+  num_completed_sweeps = 0;
+  swept_sec = 0;
+  swept_rows = 0;
+  uint64_t stream_length = 0;
+  sync_row_seed = std::random_device()();
+  bool has_sync_row_seed = false;
+
+#ifdef ENABLE_JSON
+  const auto checkpoint_filename = get_output_path(CHECKPOINT_FILENAME);
+  nlohmann::json plan_json = plan;
+  completed_chunks.clear();
+  completed_sweeps.clear();
+  if (resume)
+  {
+    auto ignored_bytes = DurableLog::read_lines(checkpoint_filename, [&](const std::string &line)
+    {
+      auto record = nlohmann::json::parse(line);
+      if (record.at("type") == "run")
+      {
+        if (record.at("plan") != plan_json)
+        {
+          Logger::log_error(format_string("Cannot resume: %s was written with a different sweep plan (%s).",
+                                          checkpoint_filename.c_str(), record.at("plan").dump().c_str()));
+          exit_target(EXIT_FAILURE);
+        }
+        if (record.contains("sync_row_seed"))
+        {
+          sync_row_seed = record.at("sync_row_seed").get<uint64_t>();
+          has_sync_row_seed = true;
+        }
+        return;
+      }
+      SweepCounts counts;
+      counts.num_flips = record.at("num_flips").get<size_t>();
+      counts.num_flips_z2o = record.at("num_flips_z2o").get<size_t>();
+      counts.num_flips_o2z = record.at("num_flips_o2z").get<size_t>();
+      counts.num_observed_bitflips = record.at("num_observed_bitflips").get<size_t>();
+      if (record.at("type") == "sweep")
+        completed_sweeps[record.at("sweep").get<size_t>()] = counts;
+      else
+        completed_chunks[get_chunk_key(record.at("sweep").get<size_t>(), record.at("bank_idx").get<size_t>(),
+                                       record.at("first_row_idx").get<size_t>())] = counts;
+      stream_length = record.at("stream_length").get<uint64_t>();
+    });
+    if (ignored_bytes > 0)
+    {
+      Logger::log_info(format_string("Ignoring incomplete last record (%zu bytes) of %s.",
+                                     ignored_bytes, checkpoint_filename.c_str()));
+    }
+    num_completed_sweeps = completed_sweeps.size();
+    if (!has_sync_row_seed && !completed_chunks.empty())
+    {
+      Logger::log_info(format_string("%s has no sync row seed, the resumed sweeps use different sync rows.",
+                                     checkpoint_filename.c_str()));
+    }
+    Logger::log_info(format_string("Resuming with %zu completed sweeps and %zu completed chunks from %s.",
+                                   completed_sweeps.size(), completed_chunks.size(), checkpoint_filename.c_str()));
+    checkpoint_log.open(checkpoint_filename);
+  }
+  else
+  {
+    // keep the checkpoint of a previous run instead of overwriting it
+    if (std::ifstream(checkpoint_filename).good())
+    {
+      auto backup = get_output_path(format_string("sweep-checkpoint-%ld.jsonl", get_timestamp_sec()));
+      std::rename(checkpoint_filename.c_str(), backup.c_str());
+      Logger::log_info(format_string("Moved existing %s to %s.", checkpoint_filename.c_str(), backup.c_str()));
+    }
+    checkpoint_log.open(checkpoint_filename);
+  }
+  if (stream_length == 0)
+  {
+    checkpoint_log.append(nlohmann::json{{"type", "run"}, {"start", get_timestamp_sec()},
+                                         {"dimm_id", program_args.dimm_id}, {"plan", plan_json},
+                                         {"sync_row_seed", sync_row_seed}}.dump(), true);
+  }
+#else
+  (void)resume;
+  (void)has_sync_row_seed;
+#endif
+
+  Logger::log_info(format_string("Sweep plan: %s.", plan.to_string().c_str()));
+  return stream_length;
+}
+
+const SweepPlan &SweepPlanner::get_plan() const
+{
+  return plan;
+}
+
+std::mt19937 SweepPlanner::get_sync_row_gen(size_t sweep, size_t bank_idx) const
+{
+  std::seed_seq seq{static_cast<uint32_t>(sync_row_seed), static_cast<uint32_t>(sync_row_seed >> 32),
+                    static_cast<uint32_t>(sweep), static_cast<uint32_t>(bank_idx)};
+  return std::mt19937(seq);
+}
+
+bool SweepPlanner::is_completed(size_t sweep, size_t bank_idx, size_t first_row_idx, SweepCounts &counts) const
+{
+#ifdef ENABLE_JSON
+  auto it = completed_chunks.find(get_chunk_key(sweep, bank_idx, first_row_idx));
+  if (it == completed_chunks.end())
+    return false;
+  counts.accumulate(it->second);
+  return true;
+#else
+  (void)sweep;
+  (void)bank_idx;
+  (void)first_row_idx;
+  (void)counts;
+  return false;
+#endif
+}
+
+void SweepPlanner::complete_chunk(size_t sweep, size_t bank_idx, size_t first_row_idx, size_t num_rows,
+                                  double elapsed_sec, const SweepCounts &counts, uint64_t stream_length)
+{
+  swept_sec += elapsed_sec;
+  swept_rows += num_rows;
+#ifdef ENABLE_JSON
+  checkpoint_log.append(nlohmann::json{
+      {"type", "chunk"},
+      {"sweep", sweep},
+      {"bank_idx", bank_idx},
+      {"first_row_idx", first_row_idx},
+      {"num_rows", num_rows},
+      {"elapsed_sec", elapsed_sec},
+      {"num_flips", counts.num_flips},
+      {"num_flips_z2o", counts.num_flips_z2o},
+      {"num_flips_o2z", counts.num_flips_o2z},
+      {"num_observed_bitflips", counts.num_observed_bitflips},
+      {"stream_length", stream_length}}.dump(), true);
+#else
+  (void)sweep;
+  (void)bank_idx;
+  (void)first_row_idx;
+  (void)counts;
+  (void)stream_length;
+#endif
+}
+
+bool SweepPlanner::is_sweep_completed(size_t sweep, SweepCounts &counts) const
+{
+#ifdef ENABLE_JSON
+  auto it = completed_sweeps.find(sweep);
+  if (it == completed_sweeps.end())
+    return false;
+  counts = it->second;
+  return true;
+#else
+  (void)sweep;
+  (void)counts;
+  return false;
+#endif
+}
+
+void SweepPlanner::complete_sweep(size_t sweep, const SweepCounts &counts, uint64_t stream_length)
+{
+  num_completed_sweeps++;
+#ifdef ENABLE_JSON
+  checkpoint_log.append(nlohmann::json{
+      {"type", "sweep"},
+      {"sweep", sweep},
+      {"num_flips", counts.num_flips},
+      {"num_flips_z2o", counts.num_flips_z2o},
+      {"num_flips_o2z", counts.num_flips_o2z},
+      {"num_observed_bitflips", counts.num_observed_bitflips},
+      {"stream_length", stream_length}}.dump(), true);
+#else
+  (void)sweep;
+  (void)counts;
+  (void)stream_length;
+#endif
+}
+
+double SweepPlanner::get_remaining_sec(size_t rows_left_in_sweep, double budget_left_sec) const
+{
+  if (swept_rows == 0)
+    return -1;
+  const auto sec_per_row = swept_sec / static_cast<double>(swept_rows);
+
+  auto remaining = static_cast<double>(rows_left_in_sweep) * sec_per_row;
+  if (plan.time_budget > 0)
+    remaining = std::min(remaining, std::max(budget_left_sec, 0.0));
+
+  // the sweeps that did not start yet
+  if (num_planned_sweeps > num_completed_sweeps + 1)
+  {
+    auto per_sweep = static_cast<double>(plan.get_num_rows() * plan.get_num_banks()) * sec_per_row;
+    if (plan.time_budget > 0)
+      per_sweep = std::min(per_sweep, static_cast<double>(plan.time_budget));
+    remaining += static_cast<double>(num_planned_sweeps - num_completed_sweeps - 1) * per_sweep;
+  }
+  return remaining;
+}
+
+void SweepPlanner::end()
+{
+#ifdef ENABLE_JSON
+  checkpoint_log.close();
+#endif
+}
+
+#ifdef ENABLE_JSON
+
+void to_json(nlohmann::json &j, const SweepPlan &p)
+{
+  j = nlohmann::json{{"first_row", p.first_row},
+                     {"num_rows", p.get_num_rows()},
+                     {"row_stride", p.row_stride},
+                     {"banks", p.banks},
+                     {"time_budget", p.time_budget},
+                     {"chunk_rows", p.chunk_rows},
+                     {"skip_covered", p.skip_covered}};
+}
+
+#endif
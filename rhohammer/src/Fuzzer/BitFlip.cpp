@@ -1,7 +1,8 @@
 #include "Fuzzer/BitFlip.hpp"
 
 #include <bitset>
-#include <sstream>
+#include <cinttypes>
+#include <cstdio>
 #include <unistd.h>
 
 #ifdef ENABLE_JSON
@@ -13,17 +14,18 @@ void to_json(nlohmann::json &j, const BitFlip &p) {
   // std::stringstream addr;
   // addr << std::hex << virt;
 
-  auto* phy = p.address.to_phys_fast();
-  std::stringstream addr_phy;
-  addr_phy << std::hex << phy;
+  // this is called for every bit flip, hence we avoid the (much slower) formatting through std::stringstream
+  const auto phy = reinterpret_cast<uint64_t>(p.address.to_phys_fast());
+  char addr_phy[2 + 16 + 1];
+  snprintf(addr_phy, sizeof(addr_phy), "0x%" PRIx64, phy);
 
   j = nlohmann::json{{"dram_addr", p.address},
                      {"bitmask", p.bitmask},
                      {"data", p.corrupted_data},
                      {"observed_at", p.observation_time},
                     //  {"virt_addr", addr.str()},
-                     {"phy_addr", addr_phy.str()},
-                     {"page_offset", (uint64_t)phy % getpagesize()}
+                     {"phy_addr", addr_phy},
+                     {"page_offset", phy % getpagesize()}
   };
 }
 
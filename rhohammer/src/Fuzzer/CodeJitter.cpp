@@ -4,10 +4,14 @@
 
 #include "Fuzzer/CodeJitter.hpp"
 #include "Utilities/AsmPrimitives.hpp"
+#include "Utilities/Helper.hpp"
 #include "Utilities/Pagemap.hpp"
 
 #define MEASURE_TIME (1)
 
+// keeps the last 128K synchronizations, i.e., roughly one second of hammering
+thread_local SyncTimingRing CodeJitter::sync_timings(128 * 1024);
+
 CodeJitter::CodeJitter()
     : flushing_strategy(FLUSHING_STRATEGY::EARLIEST_POSSIBLE),
       fencing_strategy(FENCING_STRATEGY::LATEST_POSSIBLE),
@@ -58,7 +62,10 @@ size_t CodeJitter::hammer_pattern(FuzzingParameterSet &fuzzing_parameters, bool
   size_t total_sync_acts = 0;
   HammeringData data{};
 
+  const auto sync_head = sync_timings.get_head();
   total_sync_acts = fn(&data);
+  last_hammering_data = data;
+  last_sync_summary = sync_timings.summarize(sync_head, data.tsc_delta);
   // while (true) {
   //   (void)fn();
   // }
@@ -106,7 +113,7 @@ void CodeJitter::jit_strict(FuzzingParameterSet &fuzzing_parameters,
   {
     Logger::log_error(
         "Function pointer is not NULL, cannot continue jitting code without leaking memory. Did you forget to call cleanup() before?");
-    exit(1);
+    exit_target(1);
   }
 
   asmjit::CodeHolder code;
@@ -124,6 +131,8 @@ void CodeJitter::jit_strict(FuzzingParameterSet &fuzzing_parameters,
 
   // Move pointer to struct HammeringData to %r12.
   assembler.mov(asmjit::x86::r12, asmjit::x86::rdi);
+  // Move pointer to the sync timing ring buffer to %r15.
+  assembler.mov(asmjit::x86::r15, (uint64_t)&sync_timings);
 
   // ==== here start's the actual program ====================================================
   // ------- part 1: flush the row used for hammering ---------------------------------------------------------------------------------
@@ -169,7 +178,15 @@ void CodeJitter::jit_strict(FuzzingParameterSet &fuzzing_parameters,
 
   size_t cnt_total_activations = 0;
   // std::cout << "ASMjit run" << std::endl;
+  // Keep the ACT count in %r9d while we take the entry timestamp, which is kept in %r14.
+  assembler.mov(asmjit::x86::r9d, asmjit::x86::edx);
+  assembler.rdtscp();
+  assembler.shl(asmjit::x86::rdx, 32);
+  assembler.or_(asmjit::x86::rdx, asmjit::x86::rax);
+  assembler.mov(asmjit::x86::r14, asmjit::x86::rdx);
+  assembler.mov(asmjit::x86::edx, asmjit::x86::r9d);
   sync_ref_nonrepeating(syn_rows, ref_threshold, assembler);
+  record_sync_timing(assembler);
   // hammer each aggressor once
   for (auto *aggr : aggressor_pairs)
   {
@@ -293,6 +310,104 @@ void CodeJitter::jit_strict(FuzzingParameterSet &fuzzing_parameters,
   } while (std::cin.get() != '\n');
 }
 
+std::vector<TraceAccess> CodeJitter::get_access_sequence(HAMMERING_KERNEL kernel,
+                                                        FLUSHING_STRATEGY flushing,
+                                                        FENCING_STRATEGY fencing,
+                                                        const std::vector<volatile char *> &aggressor_pairs,
+                                                        volatile char *sync_start)
+{
+  std::vector<TraceAccess> accesses;
+  accesses.push_back(TraceAccess::resolve(TRACE_OP::SYNC, sync_start));
+  // jit_strict only flushes and fences before an access (LATEST_POSSIBLE) if the aggressor was accessed before
+  std::unordered_map<uint64_t, bool> accessed_before;
+  const bool jitted = (kernel == HAMMERING_KERNEL::JITTED);
+  for (auto *aggr : aggressor_pairs)
+  {
+    const bool repeated = !jitted || accessed_before[(uint64_t)aggr];
+    if (repeated && flushing == FLUSHING_STRATEGY::LATEST_POSSIBLE)
+      accesses.push_back(TraceAccess::resolve(TRACE_OP::FLUSH, aggr));
+    if (repeated && fencing == FENCING_STRATEGY::LATEST_POSSIBLE)
+      accesses.push_back(TraceAccess::resolve(TRACE_OP::MFENCE, nullptr));
+    accesses.push_back(TraceAccess::resolve(TRACE_OP::ACCESS, aggr));
+    accessed_before[(uint64_t)aggr] = true;
+    if (flushing == FLUSHING_STRATEGY::EARLIEST_POSSIBLE)
+      accesses.push_back(TraceAccess::resolve(TRACE_OP::FLUSH, aggr));
+    if (!jitted && fencing == FENCING_STRATEGY::EARLIEST_POSSIBLE)
+      accesses.push_back(TraceAccess::resolve(TRACE_OP::MFENCE, nullptr));
+    if (!jitted)
+      accesses.push_back(TraceAccess::resolve(TRACE_OP::LFENCE, nullptr));
+  }
+  if (jitted)
+  {
+    if (fencing != FENCING_STRATEGY::OMIT_FENCING)
+      accesses.push_back(TraceAccess::resolve(TRACE_OP::MFENCE, nullptr));
+  }
+  else if (flushing == FLUSHING_STRATEGY::BATCHED)
+  {
+    for (auto *aggr : aggressor_pairs)
+      accesses.push_back(TraceAccess::resolve(TRACE_OP::FLUSH, aggr));
+    if (fencing != FENCING_STRATEGY::OMIT_FENCING)
+      accesses.push_back(TraceAccess::resolve(TRACE_OP::MFENCE, nullptr));
+  }
+  return accesses;
+}
+
+void CodeJitter::hammer_pattern_simulated(SimulatedDram &dram,
+                                          bool verbose,
+                                          int total_num_activations,
+                                          const std::vector<volatile char *> &aggressor_pairs,
+                                          const std::vector<volatile char *> &sync_rows,
+                                          size_t ref_threshold)
+{
+  if (aggressor_pairs.empty())
+  {
+    Logger::log_error("Skipping hammering pattern as it has no aggressors.");
+    return;
+  }
+
+  synchronization_stats sync_stats{.num_sync_acts = 0, .num_sync_rounds = 0};
+  uint64_t num_hammering_acts = 0;
+  const auto num_acts_before = dram.get_num_acts();
+  const auto num_flips_before = dram.get_num_flips();
+  const auto num_dropped_flips_before = dram.get_num_dropped_flips();
+  const auto sync_head = sync_timings.get_head();
+  const auto tsc_start = dram.get_time_cycles();
+  while (total_num_activations > 0)
+  {
+    // synchronize with the next REF like sync_ref_unjitted
+    sync_stats.num_sync_rounds++;
+    const auto tsc_entry = dram.get_time_cycles();
+    size_t sync_cnt = 0;
+    bool threshold_hit = false;
+    while (sync_cnt < sync_rows.size() && !threshold_hit)
+    {
+      const auto before = dram.get_time_cycles();
+      dram.access(sync_rows[sync_cnt++]);
+      threshold_hit = (dram.get_time_cycles() - before) > ref_threshold;
+    }
+    sync_stats.num_sync_acts += sync_cnt;
+    sync_timings.record(tsc_entry, dram.get_time_cycles(), (uint32_t)sync_cnt, (uint32_t)threshold_hit);
+
+    for (auto *aggressor : aggressor_pairs)
+      dram.access(aggressor);
+    num_hammering_acts += aggressor_pairs.size();
+    total_num_activations -= static_cast<int>(aggressor_pairs.size());
+  }
+  last_hammering_data.tsc_delta = dram.get_time_cycles() - tsc_start;
+  last_hammering_data.total_acts = num_hammering_acts + sync_stats.num_sync_acts;
+  last_sync_summary = sync_timings.summarize(sync_head, last_hammering_data.tsc_delta);
+
+  if (verbose)
+  {
+    Logger::log_data(format_string("ACT DATA (simulated): %lu accesses (%lu for sync), %lu ACTs, %lu cycles, %lu "
+                                   "injected bit flips (%lu outside of the buffer)",
+                                   last_hammering_data.total_acts, sync_stats.num_sync_acts,
+                                   dram.get_num_acts() - num_acts_before, last_hammering_data.tsc_delta,
+                                   dram.get_num_flips() - num_flips_before,
+                                   dram.get_num_dropped_flips() - num_dropped_flips_before));
+  }
+}
+
 #pragma GCC push_options
 #pragma GCC optimize("unroll-loops")
 
@@ -308,6 +423,7 @@ void CodeJitter::sync_ref_unjitted(const std::vector<volatile char *> &sync_rows
   size_t sync_cnt = 0;
   uint64_t after;
   uint64_t before = rdtscp();
+  const uint64_t tsc_entry = before;
   do
   {
     clflushopt(sync_rows[sync_cnt]);
@@ -318,19 +434,20 @@ void CodeJitter::sync_ref_unjitted(const std::vector<volatile char *> &sync_rows
     before = after;
   } while (sync_cnt < 256);
   sync_stats.num_sync_acts += sync_cnt;
+  // if we ran out of sync rows, before equals after
+  sync_timings.record(tsc_entry, after, (uint32_t)sync_cnt, (uint32_t)((after - before) > ref_threshold));
 }
 
 #pragma GCC pop_options
 #pragma GCC push_options
 #pragma GCC optimize("unroll-loops")
-void CodeJitter::hammer_pattern_unjitted(FuzzingParameterSet &fuzzing_parameters,
-                                         bool verbose,
-                                         [[maybe_unused]] FLUSHING_STRATEGY flushing,
-                                         [[maybe_unused]] FENCING_STRATEGY fencing,
-                                         int total_num_activations,
-                                         const std::vector<volatile char *> &aggressor_pairs,
-                                         const std::vector<volatile char *> &sync_rows,
-                                         size_t ref_threshold)
+template <FLUSHING_STRATEGY flushing, FENCING_STRATEGY fencing>
+void CodeJitter::hammer_pattern_unjitted_impl(FuzzingParameterSet &fuzzing_parameters,
+                                              bool verbose,
+                                              int total_num_activations,
+                                              const std::vector<volatile char *> &aggressor_pairs,
+                                              const std::vector<volatile char *> &sync_rows,
+                                              size_t ref_threshold)
 {
 
   if (verbose)
@@ -341,17 +458,6 @@ void CodeJitter::hammer_pattern_unjitted(FuzzingParameterSet &fuzzing_parameters
     Logger::log_data(format_string("num_acts_per_trefi: %d\n", fuzzing_parameters.get_num_activations_per_t_refi()));
   }
 
-  // if (flushing != FLUSHING_STRATEGY::EARLIEST_POSSIBLE)
-  //   throw std::runtime_error("[-] FLUSHING_STRATEGY must be EARLIEST_POSSIBLE");
-  // if (fencing != FENCING_STRATEGY::OMIT_FENCING)
-  //   throw std::runtime_error(" [-] FENCING_STRATEGY must be OMIT_FENCING");
-
-  // Initialize counter (using L1D miss as an example)
-  // Intel L1D cache replacement event code example
-  // PerfCounter l1d_misses(PERF_TYPE_HW_CACHE, (PERF_COUNT_HW_CACHE_L1D |
-  //                                             (PERF_COUNT_HW_CACHE_OP_READ << 8) |
-  //                                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)));
-  total_num_activations *= MULTI_BANK;
   // int total_activations = total_num_activations;
   //  flush all sync rows but keep array holding addresses cached
   for (size_t i = 0; i < sync_rows.size(); ++i)
@@ -378,20 +484,13 @@ void CodeJitter::hammer_pattern_unjitted(FuzzingParameterSet &fuzzing_parameters
   const size_t NUM_AGG_PAIRS = aggressor_pairs.size();
   synchronization_stats sync_stats{.num_sync_acts = 0, .num_sync_rounds = 0};
 
-  std::vector<uint64_t> before_sync_tscs;
-  std::vector<uint64_t> after_sync_tscs;
-  before_sync_tscs.reserve(128 * 1024);
-  after_sync_tscs.reserve(128 * 1024);
-
   lfence();
   size_t agg_idx = 0;
   const size_t sync_rounds_max_original = (num_acts_per_trefi / 2);
   size_t sync_rounds_max = sync_rounds_max_original;
-  // PerfCounter cycles(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
-  // PerfCounter l1d_misses(PERF_TYPE_HW_CACHE, (PERF_COUNT_HW_CACHE_L1D |
-  //                                             (PERF_COUNT_HW_CACHE_OP_READ << 8) |
-  //                                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)));
-  // l1d_misses.start();
+  uint64_t num_hammering_acts = 0;
+  const auto sync_head = sync_timings.get_head();
+  const uint64_t tsc_start = rdtscp();
   while (total_num_activations > 0)
   {
     // Use hardware random number and timestamp to create chaos state
@@ -472,18 +571,34 @@ void CodeJitter::hammer_pattern_unjitted(FuzzingParameterSet &fuzzing_parameters
   path11:
 
   hammer:
+    num_hammering_acts += NUM_AGG_PAIRS - agg_idx;
     // attack_begin
     // mode_1:b1_flushnta_obf_0nop
     for (; agg_idx < NUM_AGG_PAIRS; agg_idx++)
     {
+      // the strategies are template parameters, i.e., only the selected flushes/fences end up in the loop
+      if constexpr (flushing == FLUSHING_STRATEGY::LATEST_POSSIBLE)
+        asm volatile("clflushopt (%0)" : : "r"(aggressor_pairs[agg_idx]) : "memory");
+      if constexpr (fencing == FENCING_STRATEGY::LATEST_POSSIBLE)
+        mfence();
       asm volatile("prefetchnta (%0)" : : "r"(aggressor_pairs[agg_idx]) : "memory");
-      asm volatile("clflushopt (%0)" : : "r"(aggressor_pairs[agg_idx]) : "memory");
+      if constexpr (flushing == FLUSHING_STRATEGY::EARLIEST_POSSIBLE)
+        asm volatile("clflushopt (%0)" : : "r"(aggressor_pairs[agg_idx]) : "memory");
+      if constexpr (fencing == FENCING_STRATEGY::EARLIEST_POSSIBLE)
+        mfence();
       // nop_begin
       // BEGIN NOP INSERT
       lfence();
       // END NOP INSERT
       // nop_end
     }
+    if constexpr (flushing == FLUSHING_STRATEGY::BATCHED)
+    {
+      for (size_t i = 0; i < NUM_AGG_PAIRS; i++)
+        clflushopt(aggressor_pairs[i]);
+      if constexpr (fencing != FENCING_STRATEGY::OMIT_FENCING)
+        mfence();
+    }
     // attack_end
     //  Use randomness and bit operations to update counter
     uint64_t new_rand;
@@ -492,19 +607,70 @@ void CodeJitter::hammer_pattern_unjitted(FuzzingParameterSet &fuzzing_parameters
     // agg_idx=0;
     total_num_activations -= NUM_AGG_PAIRS;
   }
-  // const uint64_t misses = l1d_misses.stop();
-  // std::cout << "[***] L1D Misses count: " << misses << ", Aggr num :" << NUM_AGG_PAIRS << ", Miss rate: " << double(misses - sync_stats.num_sync_acts) / double(20000000 * 2) << std::endl;
+  last_hammering_data.tsc_delta = rdtscp() - tsc_start;
+  last_hammering_data.total_acts = num_hammering_acts + sync_stats.num_sync_acts;
+  last_sync_summary = sync_timings.summarize(sync_head, last_hammering_data.tsc_delta);
 
-  // for (size_t i = 1; i < before_sync_tscs.size(); i++)
-  // {
-  //   auto hammer = before_sync_tscs[i] - after_sync_tscs[i - 1];
-  //   auto sync = after_sync_tscs[i] - before_sync_tscs[i];
-  //   // Logger::log_data(format_string("HAMMER = %7zu | SYNC = %7zu | TOTAL = %7zu", hammer, sync, hammer + sync));
-  //   std::cout << "hammer=" << hammer << " | sync=" << sync << " | total=" << hammer + sync << std::endl;
-  // }
+  if (verbose)
+  {
+    Logger::log_data(format_string("ACT DATA: %lu ACTs (%lu for sync), %lu cycles",
+                                   last_hammering_data.total_acts, sync_stats.num_sync_acts,
+                                   last_hammering_data.tsc_delta));
+  }
 }
 #pragma GCC pop_options
 
+void CodeJitter::hammer_pattern_unjitted(FuzzingParameterSet &fuzzing_parameters,
+                                         bool verbose,
+                                         FLUSHING_STRATEGY flushing,
+                                         FENCING_STRATEGY fencing,
+                                         int total_num_activations,
+                                         const std::vector<volatile char *> &aggressor_pairs,
+                                         const std::vector<volatile char *> &sync_rows,
+                                         size_t ref_threshold)
+{
+  this->flushing_strategy = flushing;
+  this->fencing_strategy = fencing;
+  // the aggressors were already expanded into multi_bank banks by PatternAddressMapper::export_pattern, hence this is
+  // the only place the loops depend on the knob; they need no specialization for it
+  total_num_activations *= runtime_config.multi_bank;
+
+  if (auto *dram = SimulatedDram::get())
+  {
+    hammer_pattern_simulated(*dram, verbose, total_num_activations, aggressor_pairs, sync_rows, ref_threshold);
+    return;
+  }
+
+#define HAMMER_UNJITTED(FL, FE)                                                                       \
+  hammer_pattern_unjitted_impl<FLUSHING_STRATEGY::FL, FENCING_STRATEGY::FE>(                          \
+      fuzzing_parameters, verbose, total_num_activations, aggressor_pairs, sync_rows, ref_threshold); \
+  return
+
+  if (flushing == FLUSHING_STRATEGY::EARLIEST_POSSIBLE)
+  {
+    if (fencing == FENCING_STRATEGY::OMIT_FENCING) { HAMMER_UNJITTED(EARLIEST_POSSIBLE, OMIT_FENCING); }
+    if (fencing == FENCING_STRATEGY::EARLIEST_POSSIBLE) { HAMMER_UNJITTED(EARLIEST_POSSIBLE, EARLIEST_POSSIBLE); }
+    if (fencing == FENCING_STRATEGY::LATEST_POSSIBLE) { HAMMER_UNJITTED(EARLIEST_POSSIBLE, LATEST_POSSIBLE); }
+  }
+  else if (flushing == FLUSHING_STRATEGY::LATEST_POSSIBLE)
+  {
+    if (fencing == FENCING_STRATEGY::OMIT_FENCING) { HAMMER_UNJITTED(LATEST_POSSIBLE, OMIT_FENCING); }
+    if (fencing == FENCING_STRATEGY::EARLIEST_POSSIBLE) { HAMMER_UNJITTED(LATEST_POSSIBLE, EARLIEST_POSSIBLE); }
+    if (fencing == FENCING_STRATEGY::LATEST_POSSIBLE) { HAMMER_UNJITTED(LATEST_POSSIBLE, LATEST_POSSIBLE); }
+  }
+  else if (flushing == FLUSHING_STRATEGY::BATCHED)
+  {
+    if (fencing == FENCING_STRATEGY::OMIT_FENCING) { HAMMER_UNJITTED(BATCHED, OMIT_FENCING); }
+    if (fencing == FENCING_STRATEGY::EARLIEST_POSSIBLE) { HAMMER_UNJITTED(BATCHED, EARLIEST_POSSIBLE); }
+    if (fencing == FENCING_STRATEGY::LATEST_POSSIBLE) { HAMMER_UNJITTED(BATCHED, LATEST_POSSIBLE); }
+  }
+#undef HAMMER_UNJITTED
+
+  Logger::log_error(format_string("Unsupported combination of flushing (%s) and fencing (%s) strategy.",
+                                  to_string(flushing).c_str(), to_string(fencing).c_str()));
+  exit_target(EXIT_FAILURE);
+}
+
 #ifdef ENABLE_JITTING
 void CodeJitter::sync_ref(const std::vector<volatile char *> &sync_rows,
                           asmjit::x86::Assembler &assembler,
@@ -572,18 +738,18 @@ void CodeJitter::jit_ref_sync(
     FENCING_STRATEGY fencing,
     std::vector<volatile char *> const &aggressors,
     DRAMAddr sync_ref_initial_aggr,
-    size_t sync_ref_threshold)
+    std::optional<size_t> sync_ref_threshold)
 {
   if (flushing != FLUSHING_STRATEGY::EARLIEST_POSSIBLE || fencing != FENCING_STRATEGY::OMIT_FENCING)
   {
     Logger::log_error("jit_ref_sync() implicitly assumes FLUSHING_STRATEGY::EARLIEST_POSSIBLE and FENCING_STRATEGY::OMIT_FENCING");
-    exit(1);
+    exit_target(1);
   }
 
   if (fn_ref_sync != nullptr)
   {
     Logger::log_error("Function pointer is not NULL, cannot continue jitting code without leaking memory. Did you forget to call cleanup() before?");
-    exit(1);
+    exit_target(1);
   }
 
   // Initialize assembler.
@@ -593,6 +759,12 @@ void CodeJitter::jit_ref_sync(
 
   // PRE: %rdi (first register) contains a pointer to a struct RefSyncData, used to return the results.
 
+  // Load the REF threshold into %esi if it is not embedded into the code.
+  if (!sync_ref_threshold.has_value())
+  {
+    assembler.mov(asmjit::x86::esi, asmjit::x86::ptr(asmjit::x86::rdi, offsetof(RefSyncData, sync_ref_threshold)));
+  }
+
   // FIRST SYNC: Initially synchronize with REF.
 
   // Store time stamp into %r8d.
@@ -680,11 +852,19 @@ void CodeJitter::jit_ref_sync(
 
 // This function accesses a list of rows starting from initial_aggressors. It measures the access time between
 // aggressors until REF is detected. Then it flushes all aggressors using clflush and hands control back.
-void CodeJitter::sync_ref_nonrepeating(DRAMAddr inital_aggressor, size_t sync_ref_threshold, asmjit::x86::Assembler &assembler)
+void CodeJitter::sync_ref_nonrepeating(DRAMAddr inital_aggressor, std::optional<size_t> sync_ref_threshold,
+                                       asmjit::x86::Assembler &assembler)
 {
+  // with a threshold of 0, every access would be taken for a REF
+  if (sync_ref_threshold.has_value() && *sync_ref_threshold == 0)
+  {
+    Logger::log_error("Cannot synchronize with REF using a threshold of 0 cycles.");
+    exit_target(EXIT_FAILURE);
+  }
   asmjit::Label out = assembler.newLabel();
   // asmjit::Label flush_out = assembler.newLabel();
   // PRE: %edx is an in-out argument containing the number of ACTs done for synchronization.
+  // POST: %r11 contains the number of accessed sync rows, bit 16 is set if no REF was detected.
   assembler.xor_(asmjit::x86::r11, asmjit::x86::r11);
   // Move ACT count from %edx to %r10d.
   assembler.mov(asmjit::x86::r10d, asmjit::x86::edx);
@@ -724,7 +904,10 @@ void CodeJitter::sync_ref_nonrepeating(DRAMAddr inital_aggressor, size_t sync_re
     if (i >= 4)
     {
       // if (%edx > sync_ref_threshold) { break; }
-      assembler.cmp(asmjit::x86::edx, sync_ref_threshold);
+      if (sync_ref_threshold.has_value())
+        assembler.cmp(asmjit::x86::edx, *sync_ref_threshold);
+      else
+        assembler.cmp(asmjit::x86::edx, asmjit::x86::esi);
       assembler.jg(out);
     }
 
@@ -732,8 +915,45 @@ void CodeJitter::sync_ref_nonrepeating(DRAMAddr inital_aggressor, size_t sync_re
     assembler.mov(asmjit::x86::ebx, asmjit::x86::eax);
   }
 
+  // We only get here if no REF was detected: mark this in bit 16 of the access count.
+  assembler.add(asmjit::x86::r11, 1 << 16);
+
   assembler.bind(out);
 
   // Move ACT count from %r10d back to %edx.
   assembler.mov(asmjit::x86::edx, asmjit::x86::r10d);
-}
\ No newline at end of file
+}
+
+#ifdef ENABLE_JITTING
+// Appends an entry for the synchronization that just finished to the sync timing ring buffer.
+// PRE: %r15 points to sync_timings, %r14 contains the TSC at the start of the synchronization, %r11 contains the
+// sync_ref_nonrepeating result. Clobbers %rax, %rcx, %r9; preserves %edx.
+void CodeJitter::record_sync_timing(asmjit::x86::Assembler &assembler)
+{
+  assembler.mov(asmjit::x86::r9d, asmjit::x86::edx);
+  assembler.rdtscp();
+  assembler.shl(asmjit::x86::rdx, 32);
+  assembler.or_(asmjit::x86::rdx, asmjit::x86::rax);
+
+  // %rax = &entries[head & mask]; head++
+  assembler.mov(asmjit::x86::rax, asmjit::x86::ptr(asmjit::x86::r15, offsetof(SyncTimingRing, head)));
+  assembler.mov(asmjit::x86::rcx, asmjit::x86::rax);
+  assembler.inc(asmjit::x86::rcx);
+  assembler.mov(asmjit::x86::ptr(asmjit::x86::r15, offsetof(SyncTimingRing, head)), asmjit::x86::rcx);
+  assembler.and_(asmjit::x86::rax, asmjit::x86::ptr(asmjit::x86::r15, offsetof(SyncTimingRing, mask)));
+  assembler.shl(asmjit::x86::rax, 5);
+  assembler.add(asmjit::x86::rax, asmjit::x86::ptr(asmjit::x86::r15, offsetof(SyncTimingRing, entries)));
+
+  assembler.mov(asmjit::x86::ptr(asmjit::x86::rax, offsetof(SyncTimingEntry, tsc_entry)), asmjit::x86::r14);
+  assembler.mov(asmjit::x86::ptr(asmjit::x86::rax, offsetof(SyncTimingEntry, tsc_exit)), asmjit::x86::rdx);
+  assembler.mov(asmjit::x86::ecx, asmjit::x86::r11d);
+  assembler.and_(asmjit::x86::ecx, 0xffff);
+  assembler.mov(asmjit::x86::ptr(asmjit::x86::rax, offsetof(SyncTimingEntry, num_dummy_accesses)), asmjit::x86::ecx);
+  assembler.mov(asmjit::x86::ecx, asmjit::x86::r11d);
+  assembler.shr(asmjit::x86::ecx, 16);
+  assembler.xor_(asmjit::x86::ecx, 1);
+  assembler.mov(asmjit::x86::ptr(asmjit::x86::rax, offsetof(SyncTimingEntry, threshold_hit)), asmjit::x86::ecx);
+
+  assembler.mov(asmjit::x86::edx, asmjit::x86::r9d);
+}
+#endif
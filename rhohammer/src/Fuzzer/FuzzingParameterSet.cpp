@@ -94,6 +94,21 @@ void FuzzingParameterSet::set_fixed_acts_per_trefi(int fixed_acts_per_trefi) {
   this->fixed_acts_per_trefi = fixed_acts_per_trefi;
 }
 
+void FuzzingParameterSet::set_fixed_strategies(FLUSHING_STRATEGY flushing, FENCING_STRATEGY fencing) {
+  fixed_flushing_strategy = flushing;
+  fixed_fencing_strategy = fencing;
+  flushing_strategy = flushing;
+  fencing_strategy = fencing;
+}
+
+std::string FuzzingParameterSet::get_rng_state() const {
+  return cr.get_state();
+}
+
+void FuzzingParameterSet::set_rng_state(const std::string &state) {
+  cr.set_state(state);
+}
+
 void FuzzingParameterSet::randomize_parameters(bool print) {
   // pick either the specified fixed ACTs/tREFI value, or randomly generate one.
   if (fixed_acts_per_trefi > 0) {
@@ -139,8 +154,8 @@ void FuzzingParameterSet::randomize_parameters(bool print) {
 //  auto strategy = get_valid_strategy_pair();
 //  flushing_strategy = strategy.first;
 //  fencing_strategy = strategy.second;
-  flushing_strategy = FLUSHING_STRATEGY::EARLIEST_POSSIBLE;
-  fencing_strategy = FENCING_STRATEGY::OMIT_FENCING;
+  flushing_strategy = fixed_flushing_strategy;
+  fencing_strategy = fixed_fencing_strategy;
 
   // [CANNOT be derived from anywhere else - must explicitly be exported]
   // if N_sided = (1,2) and this is {{1,2},{2,8}}, then this translates to:
@@ -1,5 +1,7 @@
 #include "Fuzzer/FuzzingParameterSet.hpp"
 #include "Fuzzer/HammeringPattern.hpp"
+#include "Fuzzer/PatternBuilder.hpp"
+#include "Utilities/Helper.hpp"
 
 #ifdef ENABLE_JSON
 
@@ -9,11 +11,19 @@ void to_json(nlohmann::json &j, const HammeringPattern &p) {
                      {"max_period", p.max_period},
                      {"total_activations", p.total_activations},
                      {"num_refresh_intervals", p.num_refresh_intervals},
-                     {"access_ids", Aggressor::get_agg_ids(p.aggressors)},
                      {"agg_access_patterns", p.agg_access_patterns},
                      {"address_mappings", p.address_mappings},
                      {"is_location_dependent", p.is_location_dependent}
   };
+  // the activation slots are fully determined by the access patterns, unless they were modified afterward or patterns
+  // overlap and were reordered; in that case we need to store them one by one
+  auto access_ids = Aggressor::get_agg_ids(p.aggressors);
+  if (Aggressor::get_agg_ids(p.regenerate_aggressors(p.aggressors.size())) == access_ids) {
+    j["num_access_slots"] = p.aggressors.size();
+    j["access_ids_hash"] = HammeringPattern::hash_aggressor_ids(p.aggressors);
+  } else {
+    j["access_ids"] = std::move(access_ids);
+  }
 }
 
 void from_json(const nlohmann::json &j, HammeringPattern &p) {
@@ -24,14 +34,23 @@ void from_json(const nlohmann::json &j, HammeringPattern &p) {
   j.at("num_refresh_intervals").get_to(p.num_refresh_intervals);
   j.at("is_location_dependent").get_to(p.is_location_dependent);
 
-  std::vector<AGGRESSOR_ID_TYPE> agg_ids;
-  j.at("access_ids").get_to<std::vector<AGGRESSOR_ID_TYPE>>(agg_ids);
-  p.aggressors = Aggressor::create_aggressors(agg_ids);
   if (j.contains("agg_access_patterns")) {
     j.at("agg_access_patterns").get_to<std::vector<AggressorAccessPattern>>(p.agg_access_patterns);
   } else {
     Logger::log_error(format_string("from_json() failed: No agg_access_patterns found for pattern %s in JSON!", p.instance_id.c_str()));
   }
+  if (j.contains("access_ids")) {
+    std::vector<AGGRESSOR_ID_TYPE> agg_ids;
+    j.at("access_ids").get_to<std::vector<AGGRESSOR_ID_TYPE>>(agg_ids);
+    p.aggressors = Aggressor::create_aggressors(agg_ids);
+  } else {
+    p.aggressors = p.regenerate_aggressors(j.at("num_access_slots").get<size_t>());
+    if (HammeringPattern::hash_aggressor_ids(p.aggressors) != j.at("access_ids_hash").get<uint64_t>()) {
+      Logger::log_error(format_string("from_json() failed: Regenerated activation slots of pattern %s do not match "
+                                      "the stored hash.", p.instance_id.c_str()));
+      exit_target(EXIT_FAILURE);
+    }
+  }
  j.at("address_mappings").get_to<std::vector<PatternAddressMapper>>(p.address_mappings);
 }
 
@@ -110,13 +129,13 @@ AggressorAccessPattern &HammeringPattern::get_access_pattern_by_aggressor(Aggres
     if (aap.aggressors[0].id==agg.id) return aap;
   }
   Logger::log_error(format_string("Could not find AggressorAccessPattern whose first aggressor has id %s.", agg.id));
-  exit(1);
+  exit_target(1);
 }
 
 PatternAddressMapper &HammeringPattern::get_most_effective_mapping() {
   if (address_mappings.empty()) {
     Logger::log_error("get_most_effective_mapping() failed: No mappings existing!");
-    exit(EXIT_FAILURE);
+    exit_target(EXIT_FAILURE);
   }
   PatternAddressMapper &best_mapping = address_mappings.front();
   for (const auto& mapping : address_mappings) {
@@ -136,3 +155,27 @@ void HammeringPattern::remove_mappings_without_bitflips() {
     }
   }
 }
+
+std::vector<Aggressor> HammeringPattern::regenerate_aggressors(size_t num_slots) const {
+  std::vector<Aggressor> slots(num_slots, Aggressor());
+  for (const auto &aap : agg_access_patterns) {
+    // fill_slots would never terminate
+    if (aap.frequency == 0) continue;
+    auto aggs = aap.aggressors;
+    PatternBuilder::fill_slots(aap.start_offset, aap.frequency, static_cast<size_t>(aap.amplitude), aggs, slots,
+                               num_slots);
+  }
+  return slots;
+}
+
+uint64_t HammeringPattern::hash_aggressor_ids(const std::vector<Aggressor> &aggs) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const auto &agg : aggs) {
+    const auto id = static_cast<uint32_t>(agg.id);
+    for (size_t i = 0; i < sizeof(id); ++i) {
+      hash ^= (id >> (8*i)) & 0xff;
+      hash *= 0x100000001b3ULL;
+    }
+  }
+  return hash;
+}
@@ -0,0 +1,207 @@
+#include "Fuzzer/KernelAutotuner.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Utilities/ActivationTelemetry.hpp"
+#include "Utilities/AsmPrimitives.hpp"
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+#include "main.hpp"
+
+double KernelChoice::get_score() const
+{
+  return acts_per_sec_mean - acts_per_sec_std;
+}
+
+std::string KernelChoice::to_string() const
+{
+  return format_string("%s kernel with %s flushing and %s fencing (%.2f +/- %.2f M ACTs/s, %s)",
+                       ::to_string(kernel).c_str(),
+                       ::to_string(flushing_strategy).c_str(),
+                       ::to_string(fencing_strategy).c_str(),
+                       acts_per_sec_mean / 1e6,
+                       acts_per_sec_std / 1e6,
+                       (verified_fraction > 0)
+                           ? format_string("%.0f%% verified", verified_fraction * 100).c_str()
+                           : "not verified");
+}
+
+KernelAutotuner::KernelAutotuner(DramAnalyzer &dram_analyzer)
+    : ref_threshold(dram_analyzer.get_ref_threshold()), aggressors(dram_analyzer.get_conflicting_rows(NUM_AGGRESSORS)),
+      sync_start(1, 0, 0), perf_counters(program_args.perf_raw_events)
+{
+  // aggressors in bank 0 like for the REF threshold calibration, sync rows in another bank
+  auto da = sync_start;
+  for (size_t i = 0; i < CodeJitter::SYNC_REF_NUM_AGGRS; i++)
+  {
+    da.add_inplace(0, 0, 0, Range<int>(1, 4).get_random_number(cr.gen), 0);
+    sync_rows.push_back((volatile char *)da.to_virt());
+  }
+  params.set_fixed_acts_per_trefi(static_cast<int>(aggressors.size()));
+  params.randomize_parameters(false);
+}
+
+bool KernelAutotuner::check_llc_miss_counter()
+{
+  constexpr size_t NUM_PROBE_ACCESSES = 100000;
+  if (!perf_counters.is_available() || aggressors.empty())
+    return false;
+
+  // the accesses of the kernels: each aggressor is flushed, so every prefetchnta of it goes to DRAM
+  for (auto *addr : aggressors)
+    clflushopt(addr);
+  mfence();
+  perf_counters.start();
+  for (size_t i = 0; i < NUM_PROBE_ACCESSES; i++)
+  {
+    auto *addr = aggressors[i % aggressors.size()];
+    prefetchnta(addr);
+    clflushopt(addr);
+    mfence();
+  }
+  const auto counters = perf_counters.stop();
+  if (!counters.valid || !counters.has_llc_misses)
+    return false;
+  Logger::log_data(format_string("LLC miss counter probe: %lu of %zu prefetchnta accesses counted.",
+                                 counters.llc_misses, NUM_PROBE_ACCESSES));
+  return counters.llc_misses >= NUM_PROBE_ACCESSES / 2;
+}
+
+KernelChoice KernelAutotuner::benchmark(HAMMERING_KERNEL kernel, FLUSHING_STRATEGY flushing, FENCING_STRATEGY fencing)
+{
+  KernelChoice choice{.kernel = kernel, .flushing_strategy = flushing, .fencing_strategy = fencing};
+
+#ifdef ENABLE_JITTING
+  if (kernel == HAMMERING_KERNEL::JITTED)
+  {
+    jitter.jit_strict(params, flushing, fencing, NUM_ACTIVATIONS_PER_TRIAL, aggressors, sync_start, ref_threshold);
+  }
+#endif
+
+  std::vector<double> rates;
+  double sum_verified_fraction = 0;
+  for (size_t trial = 0; trial < NUM_TRIALS; trial++)
+  {
+    jitter.last_hammering_data = HammeringData();
+    perf_counters.start();
+    if (kernel == HAMMERING_KERNEL::JITTED)
+    {
+      jitter.hammer_pattern(params, false);
+    }
+    else
+    {
+      jitter.hammer_pattern_unjitted(params, false, flushing, fencing, NUM_ACTIVATIONS_PER_TRIAL,
+                                     aggressors, sync_rows, ref_threshold);
+    }
+    const auto counters = perf_counters.stop();
+    ActivationRate rate{.total_acts = jitter.last_hammering_data.total_acts,
+                        .tsc_delta = jitter.last_hammering_data.tsc_delta};
+    // as the aggressors are in different rows of the same bank, each access that misses the LLC is an activation; an
+    // LLC miss count of 0 means that the PMU does not see the accesses at all
+    if (can_verify_acts && counters.valid && counters.has_llc_misses && counters.llc_misses > 0 && rate.total_acts > 0)
+    {
+      const auto verified_acts = std::min<uint64_t>(rate.total_acts, counters.llc_misses);
+      sum_verified_fraction += static_cast<double>(verified_acts) / static_cast<double>(rate.total_acts);
+      rate.total_acts = verified_acts;
+    }
+    if (trial > 0 && rate.is_valid())
+      rates.push_back(rate.get_acts_per_sec());
+  }
+  choice.verified_fraction = sum_verified_fraction / NUM_TRIALS;
+
+#ifdef ENABLE_JITTING
+  if (kernel == HAMMERING_KERNEL::JITTED)
+  {
+    jitter.cleanup();
+  }
+#endif
+
+  if (rates.empty())
+    return choice;
+
+  double sum = 0;
+  for (auto r : rates)
+    sum += r;
+  choice.acts_per_sec_mean = sum / static_cast<double>(rates.size());
+  double sq_diff = 0;
+  for (auto r : rates)
+    sq_diff += (r - choice.acts_per_sec_mean) * (r - choice.acts_per_sec_mean);
+  choice.acts_per_sec_std = std::sqrt(sq_diff / static_cast<double>(rates.size()));
+  return choice;
+}
+
+KernelChoice KernelAutotuner::run()
+{
+  std::vector<HAMMERING_KERNEL> kernels = {HAMMERING_KERNEL::UNJITTED};
+#ifdef ENABLE_JITTING
+  kernels.push_back(HAMMERING_KERNEL::JITTED);
+#endif
+
+  Logger::log_info("Autotuning hammering kernel and flushing/fencing strategy on calibration rows.");
+  can_verify_acts = check_llc_miss_counter();
+  if (!perf_counters.is_available())
+  {
+    Logger::log_info("The PMU is not accessible, the activations of the candidates cannot be verified.");
+  }
+  else if (!can_verify_acts)
+  {
+    Logger::log_info("The LLC miss counter does not count prefetchnta accesses, the activations of the candidates "
+                     "cannot be verified. Using the issued accesses instead.");
+  }
+  KernelChoice best;
+  bool has_best = false;
+  for (const auto kernel : kernels)
+  {
+    for (const auto &[flushing, fencing] : get_valid_strategies())
+    {
+      auto candidate = benchmark(kernel, flushing, fencing);
+      Logger::log_data(candidate.to_string());
+      if (candidate.acts_per_sec_mean == 0)
+        continue;
+      if (!has_best || candidate.get_score() > best.get_score())
+      {
+        best = candidate;
+        has_best = true;
+      }
+    }
+  }
+
+  if (!has_best)
+  {
+    Logger::log_error("Autotuning failed as no kernel could be benchmarked. Falling back to the default kernel.");
+    return KernelChoice();
+  }
+  Logger::log_info(format_string("Choosing %s.", best.to_string().c_str()));
+  return best;
+}
+
+std::string KernelAutotuner::get_geometry_key(size_t num_ranks, size_t num_bankgroups, size_t num_banks, bool samsung)
+{
+  return format_string("%zu,%zu,%zu%s", num_ranks, num_bankgroups, num_banks, samsung ? ",samsung" : "");
+}
+
+#ifdef ENABLE_JSON
+
+void to_json(nlohmann::json &j, const KernelChoice &p)
+{
+  j = nlohmann::json{{"kernel", to_string(p.kernel)},
+                     {"flushing_strategy", to_string(p.flushing_strategy)},
+                     {"fencing_strategy", to_string(p.fencing_strategy)},
+                     {"acts_per_sec_mean", p.acts_per_sec_mean},
+                     {"acts_per_sec_std", p.acts_per_sec_std},
+                     {"verified_fraction", p.verified_fraction}};
+}
+
+void from_json(const nlohmann::json &j, KernelChoice &p)
+{
+  from_string(j.at("kernel"), p.kernel);
+  from_string(j.at("flushing_strategy"), p.flushing_strategy);
+  from_string(j.at("fencing_strategy"), p.fencing_strategy);
+  j.at("acts_per_sec_mean").get_to(p.acts_per_sec_mean);
+  j.at("acts_per_sec_std").get_to(p.acts_per_sec_std);
+  // not present in choices stored before the activations were verified
+  p.verified_fraction = j.value("verified_fraction", 0.0);
+}
+
+#endif
@@ -6,12 +6,13 @@
 #include "GlobalDefines.hpp"
 #include "Utilities/Uuid.hpp"
 #include "Memory/Memory.hpp"
+#include "Utilities/Helper.hpp"
 
 // static variable initialization
 // size_t PatternAddressMapper::bank_counter = 0;
 // size_t PatternAddressMapper::bankgroup_counter = 0;
 // size_t PatternAddressMapper::sc_counter = 0;
-DRAMAddr PatternAddressMapper::pattern_start_row{};
+thread_local DRAMAddr PatternAddressMapper::pattern_start_row{};
 
 PatternAddressMapper::PatternAddressMapper()
     : cr(CustomRandom()), instance_id(uuid::gen_uuid(cr.gen))
@@ -169,8 +170,7 @@ void PatternAddressMapper::determine_victims(const std::vector<AggressorAccessPa
 {
   std::unordered_set<uint64_t> victim_vaddrs;
 
-  // check row_blast_radius rows around the aggressors for flipped bits
-  const int row_blast_radius = 3;
+  // check ROW_BLAST_RADIUS rows around the aggressors for flipped bits
   // a set to make sure we add victims only once
   victim_rows.clear();
   for (auto &acc_pattern : agg_access_patterns)
@@ -180,11 +180,11 @@ void PatternAddressMapper::determine_victims(const std::vector<AggressorAccessPa
       if (aggressor_to_addr.count(agg.id) == 0)
       {
         Logger::log_error(format_string("Could not find DRAMAddr mapping for Aggressor %d", agg.id));
-        exit(EXIT_FAILURE);
+        exit_target(EXIT_FAILURE);
       }
 
       const auto dram_addr = aggressor_to_addr.at(agg.id);
-      for (int delta_nrows = -row_blast_radius; delta_nrows <= row_blast_radius; ++delta_nrows)
+      for (int delta_nrows = -ROW_BLAST_RADIUS; delta_nrows <= ROW_BLAST_RADIUS; ++delta_nrows)
       {
         auto cur_row_candidate = static_cast<int>(dram_addr.get_row()) + delta_nrows;
         // don't add the aggressor itself and ignore any non-existing (negative) row no.
@@ -199,7 +199,7 @@ void PatternAddressMapper::determine_victims(const std::vector<AggressorAccessPa
         {
           victim_rows.push_back(vic_start);
           victim_vaddrs.insert((uint64_t)vic_start.to_virt());
-          for (int i = 1; i < MULTI_BANK; i++)
+          for (int i = 1; i < runtime_config.multi_bank; i++)
           {
             if(i==4){
               vic_start.add_inplace(0,2,0,0,0);
@@ -221,10 +221,51 @@ void PatternAddressMapper::determine_victims(const std::vector<AggressorAccessPa
 }
 
 void PatternAddressMapper::export_pattern_internal(
+    std::vector<Aggressor> &aggressors, int base_period,
+    std::vector<volatile char *> &addresses,
+    std::vector<int> &rows, std::vector<DRAMAddr> &aggr)
+{
+  // dispatch to a specialization so that the number of banks per aggressor is a compile-time constant
+  switch (runtime_config.multi_bank)
+  {
+  case 1:
+    export_pattern_internal_impl<1>(aggressors, base_period, addresses, rows, aggr);
+    break;
+  case 2:
+    export_pattern_internal_impl<2>(aggressors, base_period, addresses, rows, aggr);
+    break;
+  case 3:
+    export_pattern_internal_impl<3>(aggressors, base_period, addresses, rows, aggr);
+    break;
+  case 4:
+    export_pattern_internal_impl<4>(aggressors, base_period, addresses, rows, aggr);
+    break;
+  case 5:
+    export_pattern_internal_impl<5>(aggressors, base_period, addresses, rows, aggr);
+    break;
+  case 6:
+    export_pattern_internal_impl<6>(aggressors, base_period, addresses, rows, aggr);
+    break;
+  case 7:
+    export_pattern_internal_impl<7>(aggressors, base_period, addresses, rows, aggr);
+    break;
+  case 8:
+    export_pattern_internal_impl<8>(aggressors, base_period, addresses, rows, aggr);
+    break;
+  default:
+    Logger::log_error(format_string("Unsupported multi_bank value %d.", runtime_config.multi_bank));
+    exit_target(EXIT_FAILURE);
+  }
+}
+
+template <int multi_bank>
+void PatternAddressMapper::export_pattern_internal_impl(
     std::vector<Aggressor> &aggressors, int base_period,
     std::vector<volatile char *> &addresses,
     std::vector<int> &rows, [[maybe_unused]] std::vector<DRAMAddr> &aggr)
 {
+  static_assert(multi_bank >= 1 && multi_bank <= RuntimeConfig::MAX_MULTI_BANK);
+  addresses.reserve(addresses.size() + aggressors.size() * multi_bank);
   // size_t col = 0;
   bool invalid_aggs = false;
   std::stringstream pattern_str;
@@ -260,7 +301,7 @@ void PatternAddressMapper::export_pattern_internal(
     addresses.push_back((volatile char *)addr.to_virt());
     pattern_str << addr.get_row() << " ";
     // aggr.push_back(multi_bank);
-    for (int i = 1; i < MULTI_BANK; i++)
+    for (int i = 1; i < multi_bank; i++)
     {
       if(i==4){
         addr.add_inplace(0,2,0,0,0);
@@ -442,6 +483,35 @@ void PatternAddressMapper::shift_mapping(int rows, const std::unordered_set<Aggr
   max_row = *occupied_rows.rbegin();
 }
 
+bool PatternAddressMapper::move_to(size_t bankgroup, size_t bank, size_t first_row)
+{
+  size_t smallest_row_no = std::numeric_limits<size_t>::max();
+  size_t largest_row_no = 0;
+  for (const auto &[id, addr] : aggressor_to_addr)
+  {
+    smallest_row_no = std::min(smallest_row_no, addr.get_row());
+    largest_row_no = std::max(largest_row_no, addr.get_row());
+  }
+  // DRAMAddr wraps rows around, which would move the aggressors behind the last row to the beginning of the bank
+  if (first_row > DRAMAddr::get_max_row() || largest_row_no - smallest_row_no > DRAMAddr::get_max_row() - first_row)
+  {
+    return false;
+  }
+
+  std::set<size_t> occupied_rows;
+  for (auto &[id, addr] : aggressor_to_addr)
+  {
+    addr = DRAMAddr(addr.get_subchan(), addr.get_rank(), bankgroup, bank,
+                    addr.get_row() - smallest_row_no + first_row, addr.get_column());
+    occupied_rows.insert(addr.get_row());
+  }
+
+  // this works as sets are always ordered
+  min_row = *occupied_rows.begin();
+  max_row = *occupied_rows.rbegin();
+  return true;
+}
+
 CodeJitter &PatternAddressMapper::get_code_jitter() const
 {
   return *code_jitter;
@@ -0,0 +1,225 @@
+#include "Fuzzer/PatternStore.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+
+#ifdef ENABLE_JSON
+#include <nlohmann/json.hpp>
+#endif
+
+static constexpr uint32_t PATTERN_STORE_VERSION = 1;
+
+PatternStore::~PatternStore() {
+  close();
+}
+
+bool PatternStore::is_pattern_store(const std::string &path) {
+  std::ifstream ifs(path, std::ios::in | std::ios::binary);
+  char magic[4] = {};
+  ifs.read(magic, sizeof(magic));
+  return ifs.gcount() == sizeof(magic) && memcmp(magic, "RPST", sizeof(magic)) == 0;
+}
+
+bool PatternStore::open(const std::string &path) {
+  close();
+  fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    Logger::log_error(format_string("Could not open pattern store %s: %s", path.c_str(), strerror(errno)));
+    return false;
+  }
+  struct stat st{};
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(PatternStoreHeader)) {
+    Logger::log_error(format_string("Pattern store %s is too small.", path.c_str()));
+    close();
+    return false;
+  }
+  data_size = static_cast<size_t>(st.st_size);
+  auto *mapped = mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapped == MAP_FAILED) {
+    Logger::log_error(format_string("Could not map pattern store %s: %s", path.c_str(), strerror(errno)));
+    data_size = 0;
+    close();
+    return false;
+  }
+  data = static_cast<const uint8_t *>(mapped);
+
+  PatternStoreHeader header{};
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic, "RPST", sizeof(header.magic)) != 0 || header.version != PATTERN_STORE_VERSION
+      || header.index_offset > data_size
+      || header.num_patterns > (data_size - header.index_offset)/sizeof(PatternStoreIndexEntry)) {
+    Logger::log_error(format_string("%s is not a valid pattern store.", path.c_str()));
+    close();
+    return false;
+  }
+  index.resize(header.num_patterns);
+  memcpy(index.data(), data + header.index_offset, index.size()*sizeof(PatternStoreIndexEntry));
+  return true;
+}
+
+void PatternStore::close() {
+  if (data != nullptr) munmap(const_cast<uint8_t *>(data), data_size);
+  if (fd != -1) ::close(fd);
+  fd = -1;
+  data = nullptr;
+  data_size = 0;
+  index.clear();
+}
+
+size_t PatternStore::size() const {
+  return index.size();
+}
+
+std::vector<const PatternStoreIndexEntry *> PatternStore::get_entries() const {
+  std::vector<const PatternStoreIndexEntry *> entries;
+  entries.reserve(index.size());
+  for (const auto &entry : index) entries.push_back(&entry);
+  return entries;
+}
+
+std::vector<const PatternStoreIndexEntry *> PatternStore::find(const std::string &id) const {
+  auto cmp_entry_id = [](const PatternStoreIndexEntry &e, const std::string &id) {
+    return strncmp(e.id, id.c_str(), sizeof(e.id)) < 0;
+  };
+  std::vector<const PatternStoreIndexEntry *> matches;
+  for (auto it = std::lower_bound(index.begin(), index.end(), id, cmp_entry_id);
+       it != index.end() && strncmp(it->id, id.c_str(), sizeof(it->id)) == 0; ++it) {
+    matches.push_back(&*it);
+  }
+  return matches;
+}
+
+std::vector<const PatternStoreIndexEntry *> PatternStore::get_top_k(size_t k) const {
+  auto entries = get_entries();
+  k = std::min(k, entries.size());
+  std::partial_sort(entries.begin(), entries.begin() + static_cast<long>(k), entries.end(),
+                    [](const PatternStoreIndexEntry *a, const PatternStoreIndexEntry *b) {
+                      return a->num_bitflips > b->num_bitflips;
+                    });
+  entries.resize(k);
+  return entries;
+}
+
+HammeringPattern PatternStore::load(const PatternStoreIndexEntry &entry) const {
+  HammeringPattern pattern;
+#ifdef ENABLE_JSON
+  if (entry.offset > data_size || entry.length > data_size - entry.offset) {
+    Logger::log_error(format_string("Record of pattern %.48s exceeds the pattern store.", entry.id));
+    exit_target(EXIT_FAILURE);
+  }
+  const auto *begin = data + entry.offset;
+  try {
+    from_json(nlohmann::json::from_cbor(begin, begin + entry.length), pattern);
+  } catch (const nlohmann::json::exception &e) {
+    Logger::log_error(format_string("Pattern store is corrupt: could not decode pattern %.48s (%s).",
+                                    entry.id, e.what()));
+    exit_target(EXIT_FAILURE);
+  }
+#else
+  (void)entry;
+  Logger::log_error("Loading patterns requires ENABLE_JSON (see CMakeLists.txt).");
+  exit_target(EXIT_FAILURE);
+#endif
+  return pattern;
+}
+
+bool PatternStore::convert_from_json(const std::string &json_path, const std::string &store_path) {
+#ifdef ENABLE_JSON
+  std::ifstream ifs(json_path);
+  if (!ifs.is_open()) {
+    Logger::log_error(format_string("Could not open given file (%s).", json_path.c_str()));
+    return false;
+  }
+  std::ofstream ofs(store_path, std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!ofs.is_open()) {
+    Logger::log_error(format_string("Could not open %s for writing.", store_path.c_str()));
+    return false;
+  }
+
+  // the header is written again once the index offset is known
+  PatternStoreHeader header{};
+  memcpy(header.magic, "RPST", sizeof(header.magic));
+  header.version = PATTERN_STORE_VERSION;
+  ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  uint64_t offset = sizeof(header);
+
+  std::vector<PatternStoreIndexEntry> entries;
+  bool failed = false;
+  auto add_pattern = [&](const nlohmann::json &j) {
+    PatternStoreIndexEntry entry{};
+    const auto id = j.at("id").get<std::string>();
+    if (id.size() >= sizeof(entry.id)) {
+      Logger::log_error(format_string("Pattern ID %s is too long for the pattern store.", id.c_str()));
+      failed = true;
+      return;
+    }
+    strncpy(entry.id, id.c_str(), sizeof(entry.id) - 1);
+    for (const auto &mapping : j.at("address_mappings")) {
+      for (const auto &flips : mapping.at("bit_flips")) entry.num_bitflips += flips.size();
+      entry.num_mappings++;
+    }
+    const auto record = nlohmann::json::to_cbor(j);
+    entry.offset = offset;
+    entry.length = record.size();
+    ofs.write(reinterpret_cast<const char *>(record.data()), static_cast<std::streamsize>(record.size()));
+    offset += record.size();
+    entries.push_back(entry);
+  };
+
+  // the patterns are either in 'hammering_patterns' or, in the old format, the whole file is an array of patterns;
+  // each pattern is handed to add_pattern as soon as it is parsed and then discarded, as is everything else
+  bool root_is_array = false;
+  bool in_patterns = false;
+  nlohmann::json::parser_callback_t cb = [&](int depth, nlohmann::json::parse_event_t event, nlohmann::json &parsed) {
+    using event_t = nlohmann::json::parse_event_t;
+    if (depth == 0 && event == event_t::array_start) {
+      root_is_array = true;
+      in_patterns = true;
+    } else if (depth == 1 && event == event_t::key && !root_is_array) {
+      in_patterns = (parsed == "hammering_patterns");
+    }
+    const int pattern_depth = root_is_array ? 1 : 2;
+    if (event == event_t::object_end && depth == pattern_depth && in_patterns) {
+      if (!failed) add_pattern(parsed);
+      return false;
+    }
+    if ((event == event_t::object_end || event == event_t::array_end) && depth >= 1 && !in_patterns) {
+      return false;
+    }
+    return true;
+  };
+  auto root = nlohmann::json::parse(ifs, cb, false);
+  if (failed || root.is_discarded()) {
+    Logger::log_error(format_string("Could not convert %s into a pattern store.", json_path.c_str()));
+    return false;
+  }
+
+  std::sort(entries.begin(), entries.end(), [](const PatternStoreIndexEntry &a, const PatternStoreIndexEntry &b) {
+    return strncmp(a.id, b.id, sizeof(a.id)) < 0;
+  });
+  header.num_patterns = entries.size();
+  header.index_offset = offset;
+  ofs.write(reinterpret_cast<const char *>(entries.data()),
+            static_cast<std::streamsize>(entries.size()*sizeof(PatternStoreIndexEntry)));
+  ofs.seekp(0);
+  ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  ofs.close();
+  Logger::log_info(format_string("Converted %zu patterns of %s into %s.",
+                                 entries.size(), json_path.c_str(), store_path.c_str()));
+  return true;
+#else
+  (void)json_path;
+  (void)store_path;
+  Logger::log_error("Converting patterns requires ENABLE_JSON (see CMakeLists.txt).");
+  return false;
+#endif
+}
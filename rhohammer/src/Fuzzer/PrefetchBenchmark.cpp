@@ -0,0 +1,274 @@
+#include "Fuzzer/PrefetchBenchmark.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Memory/DRAMAddr.hpp"
+#include "Utilities/AsmPrimitives.hpp"
+#include "Utilities/CalibrationProfile.hpp"
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+#include "main.hpp"
+
+PrefetchBenchmark::PrefetchBenchmark(const std::string &results_filepath)
+    : host(CalibrationProfile::get_host_name()),
+      cpu_model(CalibrationProfile::get_cpu_model()),
+      results(results_filepath),
+      perf_counters(program_args.perf_raw_events)
+{
+  if (!results.is_open())
+  {
+    Logger::log_error(format_string("Could not open benchmark results file %s.", results_filepath.c_str()));
+    exit_target(EXIT_FAILURE);
+  }
+  Logger::log_info(format_string("Writing prefetch benchmark results to %s.", results_filepath.c_str()));
+  if (!perf_counters.is_available())
+  {
+    Logger::log_info("Performance counters are not available, the benchmark results will not include them.");
+  }
+
+  for (size_t i = 0; i < NUM_AGGRESSORS; i++)
+  {
+    aggressors.push_back((volatile char *)DRAMAddr(0, 2 * i, 0).to_virt());
+  }
+  const auto num_banks = program_args.num_bankgroups * program_args.num_banks;
+  for (size_t i = 0; i < MAX_OUTSTANDING; i++)
+  {
+    const auto bank = i % num_banks;
+    spread_addresses.push_back((volatile char *)DRAMAddr(1, 0, bank / program_args.num_banks,
+                                                         bank % program_args.num_banks, 2 * i, 0).to_virt());
+  }
+  write_header();
+}
+
+std::string PrefetchBenchmark::get_results_filename()
+{
+  return format_string("prefetch-%s.csv", CalibrationProfile::get_host_name().c_str());
+}
+
+void PrefetchBenchmark::write_header()
+{
+  results << "host,cpu_model,benchmark,flushing,fencing,padding_nops,num_addresses,num_accesses,"
+             "cycles_per_access,cycles_per_access_p90,accesses_per_sec,"
+             "perf_valid,perf_cycles,perf_instructions,perf_l1d_misses,perf_llc_misses";
+  for (const auto config : perf_counters.get_raw_configs())
+    results << format_string(",perf_raw_0x%lx", config);
+  results << std::endl;
+}
+
+void PrefetchBenchmark::write_row(const std::string &benchmark, const std::string &flushing,
+                                  const std::string &fencing, size_t padding_nops, size_t num_addresses,
+                                  size_t num_accesses, double cycles_median, double cycles_p90,
+                                  const PerfCounterSample &counters)
+{
+  const auto accesses_per_sec = (cycles_median > 0) ? get_tsc_cycles_per_ns() * 1e9 / cycles_median : 0;
+  results << '"' << host << "\",\"" << cpu_model << "\","
+          << benchmark << ','
+          << flushing << ','
+          << fencing << ','
+          << padding_nops << ','
+          << num_addresses << ','
+          << num_accesses << ','
+          << cycles_median << ','
+          << cycles_p90 << ','
+          << accesses_per_sec << ','
+          << counters.valid << ','
+          << counters.cycles << ','
+          << counters.instructions << ','
+          << counters.l1d_misses << ','
+          << counters.llc_misses;
+  for (size_t i = 0; i < perf_counters.get_raw_configs().size(); i++)
+    results << ',' << (i < counters.raw.size() ? counters.raw[i] : 0);
+  results << std::endl;
+}
+
+void PrefetchBenchmark::measure_latency()
+{
+  // a load of a line that is being prefetched waits for the prefetch, i.e., prefetch + load shows the prefetch latency;
+  // each mode is sampled in its own loop, so that the counters of a row only cover the accesses of its mode
+  auto measure = [this](LogLinearHistogram &cycles, auto &&access)
+  {
+    perf_counters.start();
+    for (size_t i = 0; i < NUM_SAMPLES; i++)
+    {
+      auto *addr = aggressors[i % NUM_AGGRESSORS];
+      clflushopt(addr);
+      mfence();
+      const auto before = rdtscp();
+      lfence();
+      access(addr);
+      lfence();
+      cycles.add(static_cast<double>(rdtscp() - before));
+    }
+    return perf_counters.stop();
+  };
+
+  LogLinearHistogram load_cycles(7);
+  const auto load_counters = measure(load_cycles, [](volatile char *addr)
+  {
+    *addr;
+  });
+  LogLinearHistogram prefetch_cycles(7);
+  const auto prefetch_counters = measure(prefetch_cycles, [](volatile char *addr)
+  {
+    prefetchnta(addr);
+    lfence();
+    *addr;
+  });
+  LogLinearHistogram issue_cycles(7);
+  const auto issue_counters = measure(issue_cycles, [](volatile char *addr)
+  {
+    prefetchnta(addr);
+  });
+
+  write_row("load_latency", "", "", 0, NUM_AGGRESSORS, NUM_SAMPLES, load_cycles.get_quantile(0.5),
+            load_cycles.get_quantile(0.9), load_counters);
+  write_row("prefetch_latency", "", "", 0, NUM_AGGRESSORS, NUM_SAMPLES, prefetch_cycles.get_quantile(0.5),
+            prefetch_cycles.get_quantile(0.9), prefetch_counters);
+  write_row("prefetch_issue", "", "", 0, NUM_AGGRESSORS, NUM_SAMPLES, issue_cycles.get_quantile(0.5),
+            issue_cycles.get_quantile(0.9), issue_counters);
+  Logger::log_data(format_string("Load/prefetch latency (median): %.0f/%.0f cycles, prefetch issue: %.0f cycles.",
+                                 load_cycles.get_quantile(0.5), prefetch_cycles.get_quantile(0.5),
+                                 issue_cycles.get_quantile(0.5)));
+}
+
+void PrefetchBenchmark::measure_outstanding()
+{
+  // the cycles per line drop as long as the prefetches overlap, and level off once the outstanding ones are limited
+  for (size_t n = 1; n <= MAX_OUTSTANDING; n++)
+  {
+    LogLinearHistogram batch_cycles(7);
+    perf_counters.start();
+    for (size_t i = 0; i < NUM_SAMPLES / 10; i++)
+    {
+      for (size_t j = 0; j < n; j++)
+        clflushopt(spread_addresses[j]);
+      mfence();
+      const auto before = rdtscp();
+      lfence();
+      for (size_t j = 0; j < n; j++)
+        prefetchnta(spread_addresses[j]);
+      for (size_t j = 0; j < n; j++)
+        *spread_addresses[j];
+      lfence();
+      batch_cycles.add(static_cast<double>(rdtscp() - before));
+    }
+    const auto counters = perf_counters.stop();
+    write_row("outstanding", "", "", 0, n, NUM_SAMPLES / 10, batch_cycles.get_quantile(0.5) / static_cast<double>(n),
+              batch_cycles.get_quantile(0.9) / static_cast<double>(n), counters);
+  }
+}
+
+#ifdef ENABLE_JITTING
+
+PrefetchBenchmark::AccessLoop PrefetchBenchmark::jit_access_loop(FLUSHING_STRATEGY flushing,
+                                                                 FENCING_STRATEGY fencing,
+                                                                 size_t padding_nops)
+{
+  asmjit::CodeHolder code;
+  code.init(runtime.environment());
+  asmjit::x86::Assembler assembler(&code);
+
+  asmjit::Label for_begin = assembler.newLabel();
+  asmjit::Label for_end = assembler.newLabel();
+
+  // %rsi counts down the rounds over all aggressors
+  assembler.mov(asmjit::x86::rsi, NUM_ACCESSES_PER_TRIAL / NUM_AGGRESSORS);
+  assembler.bind(for_begin);
+  assembler.cmp(asmjit::x86::rsi, 0);
+  assembler.jle(for_end);
+
+  for (auto *aggressor : aggressors)
+  {
+    assembler.mov(asmjit::x86::rax, (uint64_t)aggressor);
+    if (flushing == FLUSHING_STRATEGY::LATEST_POSSIBLE)
+      assembler.clflushopt(asmjit::x86::ptr(asmjit::x86::rax));
+    if (fencing == FENCING_STRATEGY::LATEST_POSSIBLE)
+      assembler.mfence();
+    assembler.prefetchnta(asmjit::x86::ptr(asmjit::x86::rax));
+    if (flushing == FLUSHING_STRATEGY::EARLIEST_POSSIBLE)
+      assembler.clflushopt(asmjit::x86::ptr(asmjit::x86::rax));
+    if (fencing == FENCING_STRATEGY::EARLIEST_POSSIBLE)
+      assembler.mfence();
+    for (size_t i = 0; i < padding_nops; i++)
+      assembler.nop();
+  }
+  if (flushing == FLUSHING_STRATEGY::BATCHED)
+  {
+    for (auto *aggressor : aggressors)
+    {
+      assembler.mov(asmjit::x86::rax, (uint64_t)aggressor);
+      assembler.clflushopt(asmjit::x86::ptr(asmjit::x86::rax));
+    }
+  }
+  if (fencing != FENCING_STRATEGY::OMIT_FENCING)
+    assembler.mfence();
+
+  assembler.dec(asmjit::x86::rsi);
+  assembler.jmp(for_begin);
+  assembler.bind(for_end);
+  assembler.ret();
+
+  AccessLoop fn = nullptr;
+  if (runtime.add(&fn, &code))
+    throw std::runtime_error("[-] Error occurred while jitting code. Aborting execution!");
+  return fn;
+}
+
+#endif
+
+void PrefetchBenchmark::measure_access_rate()
+{
+#ifdef ENABLE_JITTING
+  const std::vector<size_t> paddings = {0, 10, 50, 100, 200, 330, 500};
+  const std::vector<FLUSHING_STRATEGY> flushings = {FLUSHING_STRATEGY::EARLIEST_POSSIBLE,
+                                                    FLUSHING_STRATEGY::BATCHED,
+                                                    FLUSHING_STRATEGY::LATEST_POSSIBLE};
+  const std::vector<FENCING_STRATEGY> fencings = {FENCING_STRATEGY::OMIT_FENCING,
+                                                  FENCING_STRATEGY::EARLIEST_POSSIBLE,
+                                                  FENCING_STRATEGY::LATEST_POSSIBLE};
+  for (const auto flushing : flushings)
+  {
+    for (const auto fencing : fencings)
+    {
+      for (const auto padding_nops : paddings)
+      {
+        auto fn = jit_access_loop(flushing, fencing, padding_nops);
+        // the cycles per access of each trial
+        std::vector<double> trial_cycles;
+        PerfCounterSample counters;
+        for (size_t trial = 0; trial < NUM_TRIALS; trial++)
+        {
+          perf_counters.start();
+          const auto before = rdtscp();
+          fn();
+          const auto cycles = rdtscp() - before;
+          const auto sample = perf_counters.stop();
+          if (trial == 0)
+            continue;
+          trial_cycles.push_back(static_cast<double>(cycles) / static_cast<double>(NUM_ACCESSES_PER_TRIAL));
+          counters.accumulate(sample);
+        }
+        runtime.release(fn);
+        std::sort(trial_cycles.begin(), trial_cycles.end());
+        write_row("access_rate", to_string(flushing), to_string(fencing), padding_nops, NUM_AGGRESSORS,
+                  NUM_ACCESSES_PER_TRIAL * (NUM_TRIALS - 1), trial_cycles[trial_cycles.size() / 2],
+                  trial_cycles[(trial_cycles.size() - 1) * 9 / 10], counters);
+      }
+      Logger::log_info(format_string("Measured the access rate with %s flushing and %s fencing.",
+                                     to_string(flushing).c_str(), to_string(fencing).c_str()));
+    }
+  }
+#else
+  Logger::log_error("The access rate benchmark requires jitting (ENABLE_JITTING), skipping it.");
+#endif
+}
+
+void PrefetchBenchmark::run()
+{
+  Logger::log_info("Running prefetch benchmarks...");
+  measure_latency();
+  measure_outstanding();
+  measure_access_rate();
+  Logger::log_highlight("Finished the prefetch benchmarks.");
+}
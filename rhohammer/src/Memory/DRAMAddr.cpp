@@ -1,12 +1,13 @@
 #include "Memory/DRAMAddr.hpp"
 #include "Utilities/Pagemap.hpp"
+#include "Utilities/Helper.hpp"
 #include "GlobalDefines.hpp"
 #include <bitset>
 #include <limits.h>
 #include <iostream>
 
 // initialize static variable
-std::map<size_t, MemConfiguration> DRAMAddr::Configs;
+thread_local std::map<size_t, MemConfiguration> DRAMAddr::Configs;
 
 void DRAMAddr::initialize(volatile char *start_address, size_t num_ranks, size_t num_bankgroups, size_t num_banks, bool samsung_row_swizzling)
 {
@@ -15,6 +16,19 @@ void DRAMAddr::initialize(volatile char *start_address, size_t num_ranks, size_t
   DRAMAddr::set_base_pfn((void *)pagemap::vaddr2paddr((uint64_t)start_address));
 }
 
+std::string DRAMAddr::get_mapping_hash()
+{
+  // FNV-1a over the mapping functions and matrices; MemConfiguration consists of size_t fields only
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  const auto *bytes = reinterpret_cast<const unsigned char *>(&MemConfig);
+  for (size_t i = 0; i < sizeof(MemConfig); ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return format_string("%016lx", hash);
+}
+
 void DRAMAddr::set_base_msb(void *buff)
 {
   base_msb = (uint64_t)buff & (~((uint64_t)(1ULL << 30UL) - 1UL)); // get higher order bits above the super page
@@ -32,6 +46,7 @@ void DRAMAddr::load_mem_config(mem_config_t cfg)
   if (initialize_configs_from_json(filename)) {
     if (Configs.find(cfg) != Configs.end()) {
       MemConfig = Configs[cfg];
+      initialize_row_bit_deltas();
       Logger::log_info("Using memory configuration from JSON file");
       return;
     } else {
@@ -42,9 +57,27 @@ void DRAMAddr::load_mem_config(mem_config_t cfg)
   DRAMAddr::initialize_configs();
   if (Configs.find(cfg) == Configs.end()) {
     Logger::log_error("Could not find suitable memory configuration! Exiting.");
-    exit(EXIT_FAILURE);
+    exit_target(EXIT_FAILURE);
   }
   MemConfig = Configs[cfg];
+  initialize_row_bit_deltas();
+}
+
+void DRAMAddr::initialize_row_bit_deltas()
+{
+  for (size_t b = 0; b < 64; ++b)
+  {
+    row_bit_deltas[b] = 0;
+    if (b >= 64 - MemConfig.ROW_SHIFT || ((MemConfig.ROW_MASK >> b) & 1) == 0)
+      continue;
+    // the same linear mapping as in to_virt, applied to a single row bit
+    const size_t l = 1ULL << (MemConfig.ROW_SHIFT + b);
+    for (size_t i : MemConfig.ADDR_MTX)
+    {
+      row_bit_deltas[b] <<= 1ULL;
+      row_bit_deltas[b] |= (size_t)__builtin_parityl(l & i);
+    }
+  }
 }
 
 bool DRAMAddr::initialize_configs_from_json(const std::string &filename)
@@ -339,9 +372,10 @@ void DRAMAddr::increment_all_common()
 }
 
 // Define the static DRAM configs
-MemConfiguration DRAMAddr::MemConfig;
-size_t DRAMAddr::base_msb;
-size_t DRAMAddr::base_pfn;
+thread_local MemConfiguration DRAMAddr::MemConfig;
+thread_local size_t DRAMAddr::base_msb;
+thread_local size_t DRAMAddr::base_pfn;
+thread_local size_t DRAMAddr::row_bit_deltas[64];
 void DRAMAddr::initialize_configs()
 {
   struct MemConfiguration cfg_zen4_1ch_1d_1rk_8bg_4bk = {
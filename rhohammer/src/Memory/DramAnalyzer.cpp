@@ -1,4 +1,5 @@
 #include "Memory/DramAnalyzer.hpp"
+#include "GlobalDefines.hpp"
 #include "Memory/DRAMAddr.hpp"
 #include "Utilities/CustomRandom.hpp"
 #include "Utilities/Helper.hpp"
@@ -7,8 +8,20 @@
 #include <unordered_set>
 #include <iostream>
 #include "Memory/Memory.hpp"
+#include "Utilities/SequentialEstimator.hpp"
+#include "Utilities/Statistics.hpp"
+#include "main.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
 void DramAnalyzer::set_sync_ref_threshold(uint64_t ref_threshold)
 {
+  if (ref_threshold == 0)
+  {
+    Logger::log_error("The sync REF threshold must be positive.");
+    exit_target(EXIT_FAILURE);
+  }
   this->ref_threshold = ref_threshold;
 }
 
@@ -17,34 +30,53 @@ void DramAnalyzer::find_threshold()
   assert(threshold == (size_t)-1 && "find_threshold() has not been called yet.");
   Logger::log_info("Generating histogram data to find bank conflict threshold.");
   constexpr size_t HISTOGRAM_MAX_VALUE = 4096;
-  constexpr size_t HISTOGRAM_ENTRIES = 16384;
-
-  std::vector<size_t> histogram(HISTOGRAM_MAX_VALUE, 0);
-  size_t num_entries = 0;
+  constexpr size_t BATCH_ENTRIES = 1024;
+  constexpr size_t MIN_BATCHES = 4;
+  constexpr size_t MAX_BATCHES = 16;
 
-  while (num_entries < HISTOGRAM_ENTRIES)
+  // the threshold such that num_entries / runtime_config.num_banks times are above it
+  auto get_threshold = [](const std::vector<size_t> &histogram, size_t num_entries)
   {
-    auto a1 = get_random_address();
-    auto a2 = get_random_address();
-    auto time = (size_t)measure_time(a1, a2);
-    if (time < histogram.size())
+    size_t thresh = HISTOGRAM_MAX_VALUE - 1;
+    size_t num_entries_above_threshold = 0;
+    while (num_entries_above_threshold < num_entries / runtime_config.num_banks && thresh > 0)
     {
-      histogram[time]++;
-      num_entries++;
+      num_entries_above_threshold += histogram[thresh];
+      thresh--;
     }
-  }
+    return thresh;
+  };
 
-  // Find threshold such that HISTOGRAM_ENTRIES / NUM_BANKS times are above it.
-  threshold = HISTOGRAM_MAX_VALUE - 1;
-  size_t num_entries_above_threshold = 0;
-  while (num_entries_above_threshold < HISTOGRAM_ENTRIES / NUM_BANKS)
+  // sample batches of pairs until the thresholds of the batches agree
+  SequentialEstimator estimator(runtime_config.calibration_confidence, runtime_config.calibration_precision,
+                                MIN_BATCHES, MAX_BATCHES);
+  std::vector<size_t> histogram(HISTOGRAM_MAX_VALUE, 0);
+  std::vector<size_t> batch_histogram(HISTOGRAM_MAX_VALUE, 0);
+  size_t num_entries = 0;
+  while (!estimator.is_done())
   {
-    num_entries_above_threshold += histogram[threshold];
-    threshold--;
-    assert(threshold > 0);
+    std::fill(batch_histogram.begin(), batch_histogram.end(), 0);
+    size_t num_batch_entries = 0;
+    while (num_batch_entries < BATCH_ENTRIES)
+    {
+      auto a1 = get_random_address();
+      auto a2 = get_random_address();
+      auto time = (size_t)measure_time(a1, a2);
+      if (time < batch_histogram.size())
+      {
+        batch_histogram[time]++;
+        histogram[time]++;
+        num_batch_entries++;
+      }
+    }
+    num_entries += num_batch_entries;
+    estimator.add(static_cast<double>(get_threshold(batch_histogram, num_batch_entries)));
   }
 
-  Logger::log_info(format_string("Found bank conflict threshold to be %zu.", threshold));
+  threshold = get_threshold(histogram, num_entries);
+  assert(threshold > 0);
+  Logger::log_info(format_string("Found bank conflict threshold to be %zu (%zu pairs, batch thresholds: %s).",
+                                 threshold, num_entries, estimator.to_string().c_str()));
 }
 
 size_t DramAnalyzer::find_sync_ref_threshold()
@@ -52,8 +84,12 @@ size_t DramAnalyzer::find_sync_ref_threshold()
   Logger::log_info("Finding sync REF threshold using using jitted code.");
   CodeJitter jitter;
 
-  // Idea: Start with a threshold that is definitely too high, wait until there are no overruns (i.e., # ACTs is the
-  // maximum, meaning no REF is detected) in any of the three sync attempts.
+  // Idea: A threshold that is too high misses REFs (i.e., # ACTs is the maximum, meaning no REF is detected), a
+  // threshold that is low enough does not. Bisect for the highest threshold in [MIN_THRESHOLD, MAX_THRESHOLD] that
+  // does not miss REFs, using the same jitted code for all thresholds.
+  constexpr size_t MIN_THRESHOLD = 800;
+  constexpr size_t MAX_THRESHOLD = 4000;
+  constexpr size_t RESOLUTION = 25;
 
   // Prepare aggressors.
   constexpr size_t NUM_AGGRS = 32;
@@ -67,56 +103,63 @@ size_t DramAnalyzer::find_sync_ref_threshold()
   DRAMAddr initial_sync_addr(1, 0, 0);
   // NOTE: This needs to be in the same rank, but a different bank w.r.t. the aggressors.
 
-  for (size_t sync_ref_threshold = 4000; sync_ref_threshold >= 800; sync_ref_threshold -= 200)
+  jitter.jit_ref_sync(FLUSHING_STRATEGY::EARLIEST_POSSIBLE, FENCING_STRATEGY::OMIT_FENCING,
+                      aggressors, initial_sync_addr, CodeJitter::RUNTIME_SYNC_REF_THRESHOLD);
+
+  size_t num_probes = 0;
+  auto misses_refs = [&jitter, &num_probes](size_t sync_ref_threshold)
   {
-    size_t total_synced_refs = 0;
+    num_probes++;
     size_t missed_refs = 0;
-
-    jitter.jit_ref_sync(FLUSHING_STRATEGY::EARLIEST_POSSIBLE, FENCING_STRATEGY::OMIT_FENCING,
-                        aggressors, initial_sync_addr, sync_ref_threshold);
-
     // 32 iterations.
     for (size_t i = 0; i < 32; i++)
     {
       RefSyncData data;
+      data.sync_ref_threshold = static_cast<uint32_t>(sync_ref_threshold);
       jitter.run_ref_sync(&data);
-      if (data.first_sync_act_count == CodeJitter::SYNC_REF_NUM_AGGRS)
-      {
-        missed_refs++;
-      }
-      if (data.second_sync_act_count == CodeJitter::SYNC_REF_NUM_AGGRS)
-      {
-        missed_refs++;
-      }
-      if (data.last_sync_act_count == CodeJitter::SYNC_REF_NUM_AGGRS)
-      {
-        missed_refs++;
-      }
-      total_synced_refs += 3;
+      missed_refs += (data.first_sync_act_count == CodeJitter::SYNC_REF_NUM_AGGRS);
+      missed_refs += (data.second_sync_act_count == CodeJitter::SYNC_REF_NUM_AGGRS);
+      missed_refs += (data.last_sync_act_count == CodeJitter::SYNC_REF_NUM_AGGRS);
     }
-
-    jitter.cleanup();
-
     Logger::log_data(format_string("sync_ref_threshold = %zu, missed_refs = %zu", sync_ref_threshold, missed_refs));
-
     // Allow one missed REF due to noise.
-    if (missed_refs <= 1)
-    {
-      // Add a margin for safety.
-      sync_ref_threshold -= 100;
-      Logger::log_info(format_string("Choosing sync_ref_threshold = %zu.", sync_ref_threshold));
-      return sync_ref_threshold;
-    }
+    return missed_refs > 1;
+  };
+
+  // invariant: lo does not miss REFs, hi does
+  size_t lo = MIN_THRESHOLD;
+  size_t hi = MAX_THRESHOLD;
+  if (!misses_refs(hi))
+  {
+    lo = hi;
+  }
+  else if (misses_refs(lo))
+  {
+    jitter.cleanup();
+    Logger::log_error("Error: Could not determine sync_ref_threshold.");
+    exit_target(EXIT_FAILURE);
+  }
+  while (hi - lo > RESOLUTION)
+  {
+    const auto mid = lo + (hi - lo) / 2;
+    if (misses_refs(mid))
+      hi = mid;
+    else
+      lo = mid;
   }
+  jitter.cleanup();
 
-  Logger::log_error("Error: Could not determine sync_ref_threshold.");
-  exit(EXIT_FAILURE);
+  // Add a margin for safety.
+  const auto sync_ref_threshold = lo - 100;
+  Logger::log_info(format_string("Choosing sync_ref_threshold = %zu (%zu thresholds probed).",
+                                 sync_ref_threshold, num_probes));
+  return sync_ref_threshold;
 }
 
 void DramAnalyzer::find_bank_conflicts()
 {
   size_t nr_banks_cur = 0;
-  auto num_banks = (size_t)NUM_BANKS;
+  auto num_banks = runtime_config.num_banks;
   int remaining_tries = num_banks * 1024; // experimentally determined, may be unprecise
   while (nr_banks_cur < num_banks && remaining_tries > 0)
   {
@@ -130,7 +173,7 @@ void DramAnalyzer::find_bank_conflicts()
     if ((ret1 > threshold) && (ret2 > threshold))
     {
       bool all_banks_set = true;
-      for (size_t i = 0; i < NUM_BANKS; i++)
+      for (size_t i = 0; i < num_banks; i++)
       {
         if (banks.at(i).empty())
         {
@@ -164,14 +207,110 @@ void DramAnalyzer::find_bank_conflicts()
     {
       Logger::log_error(format_string(
           "Could not find conflicting address sets. Is the number of banks (%zu) defined correctly?",
-          NUM_BANKS));
-      exit(1);
+          num_banks));
+      exit_target(1);
     }
   }
 
   Logger::log_info("Found bank conflicts.");
 }
 
+void DramAnalyzer::find_bank_conflicts_from_mapping()
+{
+  // the number of banks whose address sets are checked by timing
+  constexpr size_t NUM_VALIDATED_BANKS = 4;
+  const auto num_banks = runtime_config.num_banks;
+  // the measured threshold is used for the validation as well as for the fallback search
+  if (threshold == (size_t)-1)
+    find_threshold();
+
+  // the flat bank index is bankgroup * #banks + bank; each set has two addresses in different rows like the ones
+  // found by find_bank_conflicts
+  for (size_t i = 0; i < num_banks; i++)
+  {
+    const auto bg = (i / program_args.num_banks) % program_args.num_bankgroups;
+    const auto bk = i % program_args.num_banks;
+    banks.at(i).clear();
+    banks.at(i).push_back((volatile char *)DRAMAddr(1, 0, bg, bk, 0, 0).to_virt());
+    banks.at(i).push_back((volatile char *)DRAMAddr(1, 0, bg, bk, 1, 0).to_virt());
+  }
+
+  // check banks spread over all bank groups, each against the next checked bank
+  const auto num_validated = std::min(NUM_VALIDATED_BANKS, num_banks);
+  bool valid = num_banks > 1;
+  for (size_t v = 0; v < num_validated && valid; v++)
+  {
+    const auto i = v * num_banks / num_validated;
+    const auto other = ((v + 1) % num_validated) * num_banks / num_validated;
+    valid = validate_same_bank(banks.at(i), banks.at(other == i ? (i + 1) % num_banks : other)[0], threshold);
+  }
+  if (valid)
+  {
+    Logger::log_info(format_string("Constructed bank conflicts for %zu banks from the address mapping (%zu banks "
+                                   "validated).", num_banks, num_validated));
+    return;
+  }
+
+  Logger::log_error(format_string("Timing disagrees with the address mapping, the mapping (%s) looks wrong for this "
+                                  "DIMM. Falling back to searching for bank conflicts.",
+                                  DRAMAddr::get_mapping_hash().c_str()));
+  for (auto &bank : banks)
+    bank.clear();
+  find_bank_conflicts();
+}
+
+std::vector<volatile char *> DramAnalyzer::get_conflicting_rows(size_t num_rows)
+{
+  // the rows are spaced like the aggressors of a double-sided pattern; rows whose timing does not show a bank
+  // conflict with the first one are skipped, up to this many candidates are tried
+  const size_t max_candidates = 4 * num_rows;
+  if (threshold == (size_t)-1)
+    find_threshold();
+
+  std::vector<volatile char *> rows{(volatile char *)DRAMAddr(0, 0, 0).to_virt()};
+  for (size_t i = 1; i < max_candidates && rows.size() < num_rows; i++)
+  {
+    auto *candidate = (volatile char *)DRAMAddr(0, 2 * i, 0).to_virt();
+    if (measure_time(rows.front(), candidate) > threshold)
+      rows.push_back(candidate);
+  }
+  if (rows.size() < num_rows)
+  {
+    Logger::log_error(format_string("Only found %zu of %zu rows that conflict with row 0 of bank 0 in %zu candidates, "
+                                    "the address mapping looks wrong for this DIMM.",
+                                    rows.size(), num_rows, max_candidates));
+  }
+  return rows;
+}
+
+bool DramAnalyzer::validate_same_bank(const std::vector<volatile char *> &same_bank, volatile char *other_bank,
+                                      size_t conflict_threshold)
+{
+  constexpr size_t MAX_CHECKED_PAIRS = 3;
+  for (size_t i = 1; i < same_bank.size() && i <= MAX_CHECKED_PAIRS; i++)
+  {
+    const auto time = measure_time(same_bank[0], same_bank[i]);
+    if (time <= conflict_threshold)
+    {
+      Logger::log_debug(format_string("Expected a bank conflict between %s and %s but measured %zu (threshold: %zu).",
+                                      DRAMAddr((void *)same_bank[0]).to_string_compact().c_str(),
+                                      DRAMAddr((void *)same_bank[i]).to_string_compact().c_str(),
+                                      time, conflict_threshold));
+      return false;
+    }
+  }
+  const auto time = measure_time(same_bank[0], other_bank);
+  if (time > conflict_threshold)
+  {
+    Logger::log_debug(format_string("Expected no bank conflict between %s and %s but measured %zu (threshold: %zu).",
+                                    DRAMAddr((void *)same_bank[0]).to_string_compact().c_str(),
+                                    DRAMAddr((void *)other_bank).to_string_compact().c_str(),
+                                    time, conflict_threshold));
+    return false;
+  }
+  return true;
+}
+
 void DramAnalyzer::find_targets(std::vector<volatile char *> &target_bank)
 {
   // create an unordered set of the addresses in the target bank for a quick lookup
@@ -193,7 +332,7 @@ void DramAnalyzer::find_targets(std::vector<volatile char *> &target_bank)
       }
     }
     cumulative_times /= num_repetitions;
-    if ((cumulative_times / tmp.size()) > BK_CONF_THRESH)
+    if ((cumulative_times / tmp.size()) > runtime_config.bk_conf_thresh)
     {
       tmp.insert(a1);
       target_bank.push_back(a1);
@@ -206,203 +345,233 @@ DramAnalyzer::DramAnalyzer(volatile char *target)
 {
   cr = CustomRandom();
   dist = std::uniform_int_distribution<>(0, std::numeric_limits<int>::max());
-  banks = std::vector<std::vector<volatile char *>>(NUM_BANKS, std::vector<volatile char *>());
+  banks = std::vector<std::vector<volatile char *>>(runtime_config.num_banks, std::vector<volatile char *>());
 }
 
 size_t DramAnalyzer::count_acts_per_ref()
 {
-  auto exp_cfg = ExperimentConfig();
-  exp_cfg.exec_mode = execution_mode::ALTERNATING;
-  exp_cfg.num_measurement_reps = 10'000;
-  exp_cfg.num_measurement_rounds = 10;
-  exp_cfg.num_accesses_per_round = 2;
-  exp_cfg.num_sync_rows = 32;
-  exp_cfg.row_distance = 4;
-  // exp_cfg.min_ref_thresh = 1000;
-  exp_cfg.min_ref_thresh = 1260;
-  exp_cfg.row_origin_same_bg = true;
-  exp_cfg.row_origin_same_bk = true;
-  return count_acts_per_ref(exp_cfg);
+  return count_acts_per_ref(ExperimentConfig());
 }
 
-std::vector<uint64_t> DramAnalyzer::get_nth_highest_values(size_t N, std::vector<uint64_t> &values)
+std::vector<uint64_t> DramAnalyzer::get_nth_highest_values(size_t N, const LogLinearHistogram &values)
 {
-  // compute frequencies
-  std::map<uint64_t, std::size_t> freq;
-  for (const auto &word : values)
-  {
-    freq[word]++;
-  }
-
-  // map -> vector
-  std::vector<std::pair<uint64_t, uint64_t>> freq_as_vec(freq.begin(), freq.end());
-
-  // partially sort the histogram based on the frequency count
-  std::partial_sort(freq_as_vec.begin(), freq_as_vec.end(), freq_as_vec.begin() + N,
-                    [](const auto &lhs, const auto &rhs)
-                    {
-                      return lhs.second > rhs.second;
-                    });
+  // the values of the top-N buckets by frequency count
+  return values.get_most_frequent(N);
+}
 
-  // build the result vector containing the top-N values only
-  std::vector<uint64_t> result;
-  for (size_t i = 0; i < N; ++i)
-  {
-    // std::cout << freq_as_vec[i].first << " " << freq_as_vec[i].second << "x" << std::endl;
-    result.push_back(freq_as_vec[i].first);
-  }
+size_t DramAnalyzer::count_acts_per_ref(const ExperimentConfig &exp_cfg)
+{
+  auto measurement = measure_acts_per_ref(exp_cfg);
+  if (measurement.acts_per_ref > 0)
+    return measurement.acts_per_ref;
 
-  return result;
+  Logger::log_error("Could not determine reasonable ACTs/REF value. Using default (30).");
+  Logger::log_data(format_string("REF threshold: %ld", measurement.ref_threshold));
+  return 30;
 }
 
-size_t DramAnalyzer::count_acts_per_ref([[maybe_unused]] const ExperimentConfig &exp_cfg)
+ActsPerRefMeasurement DramAnalyzer::measure_acts_per_ref(const ExperimentConfig &exp_cfg)
 {
   Logger::log_info("Determining the number of activations per REF(sb|ab) interval...");
-
-  size_t num_tries = 0;
-  if (false)
-  {
-  retry:
-    Logger::log_info(format_string("Trying it again.. try %d", num_tries));
-    num_tries++;
-  }
+  const auto start = std::chrono::steady_clock::now();
+  ActsPerRefMeasurement result;
 
   // measurement parameters
-  const size_t NUM_ADDRS = 2;
-  size_t NUM_REPS = 5'000'000;
+  const size_t num_addrs = std::max<size_t>(1, exp_cfg.num_accesses_per_round);
+  const size_t num_reps = std::max<size_t>(1, exp_cfg.num_measurement_reps);
+  const size_t num_rounds = std::max<size_t>(1, exp_cfg.num_measurement_rounds);
+  // the number of rounds with an implausible REF threshold that are tolerated
+  constexpr size_t MAX_TRIES = 10;
+  constexpr size_t TIMING_PRECISION_BITS = 7;
 
-  std::vector<uint64_t> timing_values;
-  timing_values.resize(NUM_REPS, 0);
+  const size_t num_sync_rows = std::max<size_t>(1, exp_cfg.num_sync_rows);
 
+  // the addresses are row_distance rows apart, either all in the first bank or spread over bank groups/banks
   std::vector<volatile char *> addrs;
-  for (size_t v = 0; v < NUM_ADDRS; ++v)
+  for (size_t v = 0; v < num_addrs; ++v)
   {
-    addrs.push_back((volatile char *)DRAMAddr(1, 0, 0, 0, v * 2, 0).to_virt());
+    const auto bg = exp_cfg.row_origin_same_bg ? 0 : v % program_args.num_bankgroups;
+    const auto bk = exp_cfg.row_origin_same_bk ? 0 : v % program_args.num_banks;
+    addrs.push_back((volatile char *)DRAMAddr(1, 0, bg, bk, v * exp_cfg.row_distance, 0).to_virt());
+  }
+  // the rows used to synchronize with a REF before each round of step 2; they follow the measured rows with the same
+  // bank (group) layout, so that accessing num_addrs of them takes as long as accessing the measured addresses
+  std::vector<volatile char *> sync_addrs;
+  for (size_t v = 0; v < num_sync_rows; ++v)
+  {
+    const auto bg = exp_cfg.row_origin_same_bg ? 0 : v % program_args.num_bankgroups;
+    const auto bk = exp_cfg.row_origin_same_bk ? 0 : v % program_args.num_banks;
+    sync_addrs.push_back((volatile char *)DRAMAddr(1, 0, bg, bk, (num_addrs + v) * exp_cfg.row_distance, 0).to_virt());
   }
 
-  uint64_t tmp_before;
-  uint64_t tmp_after;
-  uint64_t cur;
-  uint64_t cnt_higher_th = 0;
-  uint64_t counted_reps = 0;
-
-  // FILE* f2 = fopen("times2.txt", "w");
-  sched_yield();
-  for (size_t i = 0; i < NUM_REPS; i++)
+  // accesses the given addresses once and returns the TSC cycles it took; BATCHED flushes the addresses after
+  // accessing all of them, ALTERNATING flushes each address right after accessing it
+  auto access = [batched = (exp_cfg.exec_mode == execution_mode::BATCHED)](const std::vector<volatile char *> &as)
   {
     sfence();
-    tmp_before = rdtscp();
+    const auto tmp_before = rdtscp();
     lfence();
-    for (size_t k = 0; k < NUM_ADDRS; ++k)
+    if (batched)
+    {
+      for (auto *addr : as)
+        *addr;
+      for (auto *addr : as)
+        clflushopt(addr);
+    }
+    else
     {
-      *addrs[k];
-      clflushopt(addrs[k]);
+      for (auto *addr : as)
+      {
+        *addr;
+        clflushopt(addr);
+      }
     }
     lfence();
-    tmp_after = rdtscp();
-    for (size_t k = 0; k < NUM_ADDRS; ++k)
+    return rdtscp() - tmp_before;
+  };
+  auto access_addrs = [&access, &addrs]() { return access(addrs); };
+
+  // accesses num_addrs of the sync rows at a time (cycling through them) until the accesses take longer than the REF
+  // threshold, i.e., a REF was just issued; returns false if no REF was observed within num_reps accesses
+  std::vector<volatile char *> sync_batch(num_addrs);
+  size_t next_sync_row = 0;
+  auto sync_with_ref = [&]()
+  {
+    for (size_t i = 0; i < num_reps; i++)
     {
-      // clflushopt(addrs[k]);
+      for (auto &addr : sync_batch)
+      {
+        addr = sync_addrs[next_sync_row];
+        next_sync_row = (next_sync_row + 1) % num_sync_rows;
+      }
+      if (access(sync_batch) > ref_threshold)
+        return true;
     }
-    cur = (tmp_after - tmp_before);
-    timing_values[i] = cur;
-    // fprintf(f2, "%ld\n", cur);
-  }
-  // fclose(f2);
+    return false;
+  };
 
   //
   // STEP 1: Figure out the REF threshold by taking the average of the two
   // peaks we can observe in timing accessing two same-<bg, bk> addresses.
+  // Each round of reps accesses yields a threshold; sampling stops once their mean is precise enough.
   //
-  auto min_distance = 150; // cycles
-  auto vec = get_nth_highest_values(5, timing_values);
-  uint64_t highest = vec[0];
-  uint64_t second_highest;
-  bool second_highest_found = false;
-  for (std::size_t i = 1; i < vec.size(); ++i)
+  SequentialEstimator threshold_estimator(runtime_config.calibration_confidence,
+                                          runtime_config.calibration_precision,
+                                          std::min<size_t>(3, num_rounds), num_rounds + MAX_TRIES);
+  // sometimes the measurement leads to weird/very high (or too low) results, these rounds are dropped
+  threshold_estimator.set_valid_range(static_cast<double>(exp_cfg.min_ref_thresh), 1500);
+  // the timings are only kept as a histogram that resolves them to ~1%, which is enough to separate the peaks
+  LogLinearHistogram timing_values(TIMING_PRECISION_BITS);
+  uint64_t last_threshold = 0;
+  while (!threshold_estimator.is_done())
   {
-    auto candidate = vec[i];
-    if (candidate < (highest - min_distance) || candidate > (highest + min_distance))
-    {
-      second_highest = vec[i];
-      second_highest_found = true;
-    }
-    else
+    timing_values.clear();
+    sched_yield();
+    for (size_t i = 0; i < num_reps; i++)
     {
-      highest = (highest + vec[i]) / 2;
+      timing_values.add(static_cast<double>(access_addrs()));
     }
-    if (second_highest_found)
+
+    auto min_distance = 150; // cycles
+    auto vec = get_nth_highest_values(5, timing_values);
+    uint64_t highest = vec[0];
+    uint64_t second_highest = highest;
+    bool second_highest_found = false;
+    for (std::size_t i = 1; i < vec.size(); ++i)
     {
-      if (candidate < (second_highest - min_distance) || candidate > (second_highest + min_distance))
+      auto candidate = vec[i];
+      if (candidate < (highest - min_distance) || candidate > (highest + min_distance))
       {
-        second_highest = (second_highest + vec[i]) / 2;
+        second_highest = vec[i];
+        second_highest_found = true;
       }
       else
       {
-        break;
+        highest = (highest + vec[i]) / 2;
+      }
+      if (second_highest_found)
+      {
+        if (candidate < (second_highest - min_distance) || candidate > (second_highest + min_distance))
+        {
+          second_highest = (second_highest + vec[i]) / 2;
+        }
+        else
+        {
+          break;
+        }
       }
     }
+    last_threshold = (highest + second_highest) / 2;
+    Logger::log_data(format_string("%lu | %lu => %lu", highest, second_highest, last_threshold));
+    if (!threshold_estimator.add(static_cast<double>(last_threshold)))
+      Logger::log_info(format_string("Implausible REF threshold, trying it again.. try %lu",
+                                     threshold_estimator.get_num_rejected()));
   }
-  ref_threshold = (highest + second_highest) / 2;
-  std::cout << std::dec << highest << " | " << second_highest << " => " << ref_threshold << std::endl;
-
-  // sometimes the measurement leads to weird/very high results, in this case
-  // we just repeat
-  if (ref_threshold > 1500)
-    goto retry;
+  result.num_tries = threshold_estimator.get_count() + threshold_estimator.get_num_rejected();
+  result.ref_threshold = (threshold_estimator.get_count() > 0)
+                             ? static_cast<uint64_t>(std::lround(threshold_estimator.get_mean()))
+                             : last_threshold;
+  ref_threshold = result.ref_threshold;
+  Logger::log_data(format_string("REF threshold: %s", threshold_estimator.to_string().c_str()));
 
   //
   // STEP 2: Use the threshold to determine the number of activations we can do
   // in a REF interval, i.e., between two consecutive REF commands.
+  // Rounds are repeated until the mean over the rounds is precise enough, rounds without a reasonable value are dropped.
   //
-
-  std::vector<uint64_t> act_cnt;
-  act_cnt.resize(NUM_REPS, 0);
-
-  // FILE* f2 = fopen("times3.txt", "w");
-  cnt_higher_th = 0;
-  counted_reps = 0;
-
-  sched_yield();
-  for (size_t i = 0; i < NUM_REPS; i++)
+  SequentialEstimator acts_estimator(runtime_config.calibration_confidence, runtime_config.calibration_precision,
+                                     std::min<size_t>(3, num_rounds), num_rounds);
+  acts_estimator.set_valid_range(11, std::numeric_limits<double>::infinity());
+  LogLinearHistogram act_cnt(TIMING_PRECISION_BITS);
+  while (!acts_estimator.is_done())
   {
-    sfence();
-    tmp_before = rdtscp();
-    lfence();
-    for (size_t k = 0; k < NUM_ADDRS; ++k)
+    act_cnt.clear();
+    uint64_t counted_reps = 0;
+    sched_yield();
+    // if the round starts right after a REF observed on the sync rows, its first interval is complete; otherwise, it
+    // started before the measurement and is dropped
+    bool first_interval = !sync_with_ref();
+    for (size_t i = 0; i < num_reps; i++)
     {
-      *addrs[k];
-      clflushopt(addrs[k]);
-    }
-    lfence();
-    tmp_after = rdtscp();
-    if ((tmp_after - tmp_before) > ref_threshold)
-    {
-      act_cnt[cnt_higher_th] = (counted_reps * NUM_ADDRS);
-      cnt_higher_th++;
-      // fprintf(f2, "%ld, %ld\n", counted_reps*NUM_ADDRS, cur);
-      counted_reps = 0;
+      if (access_addrs() > ref_threshold)
+      {
+        if (!first_interval)
+          act_cnt.add(static_cast<double>(counted_reps * num_addrs));
+        first_interval = false;
+        result.num_refs++;
+        counted_reps = 0;
+      }
+      else
+      {
+        counted_reps++;
+      }
     }
-    else
+
+    size_t round_acts = 0;
+    if (act_cnt.get_count() > 0)
     {
-      counted_reps++;
+      for (const auto acts : get_nth_highest_values(5, act_cnt))
+      {
+        if (acts > 10)
+        {
+          round_acts = acts;
+          break;
+        }
+      }
     }
+    result.acts_per_round.push_back(round_acts);
+    acts_estimator.add(static_cast<double>(round_acts));
   }
-  // fclose(f2);
 
-  act_cnt.resize(cnt_higher_th - 1);
-  auto acts_per_ref = get_nth_highest_values(5, act_cnt);
-  for (std::size_t i = 0; i < acts_per_ref.size(); ++i)
+  if (acts_estimator.get_count() > 0)
   {
-    if (acts_per_ref[i] > 10)
-      return acts_per_ref[i];
+    result.acts_per_ref = static_cast<size_t>(std::lround(acts_estimator.get_mean()));
+    result.acts_per_ref_half_width = acts_estimator.get_half_width();
+    result.confidence = acts_estimator.get_achieved_confidence();
   }
-
-  Logger::log_error("Could not determine reasonable ACTs/REF value. Using default (30).");
-  Logger::log_data(format_string("REF threshold: %ld", ref_threshold));
-  Logger::log_data(format_string("ACTs/REF (best): %ld", acts_per_ref[0]));
-
-  return 30;
+  Logger::log_data(format_string("ACTs/REF: %s", acts_estimator.to_string().c_str()));
+  result.duration_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return result;
 }
 
 size_t DramAnalyzer::get_ref_threshold() const
@@ -412,65 +581,53 @@ size_t DramAnalyzer::get_ref_threshold() const
 
 size_t inline DramAnalyzer::measure_time(volatile char *a1, volatile char *a2)
 {
-  int error_cnt = 0;
-  int test_round = 6;
-  uint64_t res = 0;
-  uint64_t number_of_reads = 0;
-  size_t sum_res = 0;
-  for (int i = 0; i < test_round; i++)
+  // samples disturbed by an interrupt or a preemption take microseconds; the cap keeps them out of the first samples,
+  // which the estimator accepts without the sigma test, and is far above the latency of a row conflict on any platform
+  constexpr double MAX_VALID_NS = 1000;
+  constexpr double OUTLIER_SIGMAS = 3;
+  SequentialEstimator estimator(runtime_config.calibration_confidence, runtime_config.calibration_precision, 50, 3000);
+  estimator.set_valid_range(0, MAX_VALID_NS);
+  estimator.set_outlier_sigmas(OUTLIER_SIGMAS);
+  // the estimator only decides when to stop, the median of the accepted samples is reported as it is robust against
+  // the disturbed samples that pass both tests
+  LogLinearHistogram samples(7);
+
+  volatile size_t *f = (volatile size_t *)a1;
+  volatile size_t *s = (volatile size_t *)a2;
+  sched_yield();
+  while (!estimator.is_done())
   {
-    res = 0;
-    number_of_reads = 500;
-    volatile size_t *f = (volatile size_t *)a1;
-    volatile size_t *s = (volatile size_t *)a2;
-    for (int j = 0; j < 10; j++)
-    {
-      sched_yield();
-    }
-    while (number_of_reads-- > 0)
-    {
-      struct timespec start, end;
-      asm volatile("clflushopt (%0)"
-                   :
-                   : "r"(f)
-                   : "memory");
-      asm volatile("clflushopt (%0)"
-                   :
-                   : "r"(s)
-                   : "memory");
-      asm volatile("mfence" ::: "memory");
-      if (clock_gettime(CLOCK_MONOTONIC, &start) == -1)
-      {
-        perror("clock_gettime start");
-        return 1;
-      }
-      *f;
-      *s;
-      if (clock_gettime(CLOCK_MONOTONIC, &end) == -1)
-      {
-        perror("clock_gettime end");
-        return 1;
-      }
-      asm volatile("mfence" ::: "memory");
-      res += (end.tv_nsec - start.tv_nsec);
-    }
-    res /= (500);
-    if (res > 300)
-    {
-      error_cnt++;
-    }
-    else
+    struct timespec start, end;
+    asm volatile("clflushopt (%0)"
+                 :
+                 : "r"(f)
+                 : "memory");
+    asm volatile("clflushopt (%0)"
+                 :
+                 : "r"(s)
+                 : "memory");
+    asm volatile("mfence" ::: "memory");
+    if (clock_gettime(CLOCK_MONOTONIC, &start) == -1)
     {
-      sum_res += res;
+      perror("clock_gettime start");
+      return 1;
     }
-    if (error_cnt != 0)
+    *f;
+    *s;
+    if (clock_gettime(CLOCK_MONOTONIC, &end) == -1)
     {
-      i = 0;
-      error_cnt = 0;
-      sum_res = 0;
+      perror("clock_gettime end");
+      return 1;
     }
+    asm volatile("mfence" ::: "memory");
+    const auto sample = static_cast<double>((end.tv_sec - start.tv_sec) * 1'000'000'000L + (end.tv_nsec - start.tv_nsec));
+    if (estimator.add(sample))
+      samples.add(sample);
   }
-  return sum_res / (test_round - error_cnt);
+  // if all samples were disturbed, the addresses are reported as conflicting
+  if (samples.get_count() == 0)
+    return static_cast<size_t>(MAX_VALID_NS);
+  return static_cast<size_t>(std::lround(samples.get_quantile(0.5)));
 }
 
 bool DramAnalyzer::check_sync_ref_threshold(size_t sync_ref_threshold)
@@ -552,7 +709,7 @@ bool DramAnalyzer::check_sync_ref_threshold(size_t sync_ref_threshold)
     if (missed_refs > 1)
     {
       Logger::log_error(format_string("Error: Too many missed REFs (%zu)!", missed_refs));
-      // exit(EXIT_FAILURE);
+      // exit_target(EXIT_FAILURE);
       return false;
     }
   }
@@ -561,16 +718,45 @@ bool DramAnalyzer::check_sync_ref_threshold(size_t sync_ref_threshold)
   if (second_sync_avg_max > 1.2 * second_sync_avg_min)
   {
     Logger::log_error("Second sync cycle averages are spread too widely.");
-    // exit(EXIT_FAILURE);
+    // exit_target(EXIT_FAILURE);
     return false;
   }
   return true;
 }
 
+bool DramAnalyzer::validate_sync_ref_threshold(size_t sync_ref_threshold)
+{
+  // A threshold that is too high misses REFs, one that is too low detects REFs where there are none, which makes the
+  // REF-to-REF (second) sync much shorter than tREFI.
+  CodeJitter jitter;
+  jitter.jit_ref_sync(FLUSHING_STRATEGY::EARLIEST_POSSIBLE, FENCING_STRATEGY::OMIT_FENCING,
+                      {}, DRAMAddr(1, 0, 0), CodeJitter::RUNTIME_SYNC_REF_THRESHOLD);
+
+  size_t missed_refs = 0;
+  LogLinearHistogram second_sync_cycles;
+  // 32 iterations.
+  for (size_t i = 0; i < 32; i++)
+  {
+    RefSyncData data;
+    data.sync_ref_threshold = static_cast<uint32_t>(sync_ref_threshold);
+    jitter.run_ref_sync(&data);
+    missed_refs += (data.first_sync_act_count == CodeJitter::SYNC_REF_NUM_AGGRS);
+    missed_refs += (data.second_sync_act_count == CodeJitter::SYNC_REF_NUM_AGGRS);
+    second_sync_cycles.add(data.second_sync_tsc_delta);
+  }
+  jitter.cleanup();
+
+  const auto second_sync_ns = tsc_to_ns(static_cast<uint64_t>(second_sync_cycles.get_quantile(0.5)));
+  const bool valid = missed_refs <= 1 && second_sync_ns > 0.5 * TREFI_NS && second_sync_ns < 1.5 * TREFI_NS;
+  Logger::log_info(format_string("Sync REF threshold %zu is %s (missed REFs: %zu, REF-to-REF sync: %.0f ns).",
+                                 sync_ref_threshold, valid ? "valid" : "invalid", missed_refs, second_sync_ns));
+  return valid;
+}
+
 volatile char *DramAnalyzer::get_random_address() const
 {
-  static std::random_device rd;
-  static std::default_random_engine gen(rd());
-  static std::uniform_int_distribution<size_t> dist(0, MEM_SIZE - 1);
+  static thread_local std::random_device rd;
+  static thread_local std::default_random_engine gen(rd());
+  static thread_local std::uniform_int_distribution<size_t> dist(0, MEM_SIZE - 1);
   return start_address + dist(gen);
 }
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include "Memory/DramTimingBenchmark.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#include "GlobalDefines.hpp"
+#include "Memory/DRAMAddr.hpp"
+#include "Fuzzer/KernelAutotuner.hpp"
+#include "Utilities/AsmPrimitives.hpp"
+#include "Utilities/CalibrationProfile.hpp"
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+#include "Utilities/RuntimeConfig.hpp"
+#include "main.hpp"
+
+DramTimingBenchmark::DramTimingBenchmark(const std::string &results_filepath)
+    : results_filepath(results_filepath),
+      activate_window_ns(MAX_WINDOW_BANKS)
+{
+}
+
+uint64_t DramTimingBenchmark::time_access_after(volatile char *opener, volatile char *addr)
+{
+  clflushopt(opener);
+  clflushopt(addr);
+  mfence();
+  *opener;
+  lfence();
+  const auto before = rdtscp();
+  lfence();
+  *addr;
+  lfence();
+  return rdtscp() - before;
+}
+
+uint64_t DramTimingBenchmark::time_accesses(const std::vector<volatile char *> &addrs)
+{
+  for (auto *addr : addrs)
+    clflushopt(addr);
+  mfence();
+  const auto before = rdtscp();
+  lfence();
+  for (auto *addr : addrs)
+    *addr;
+  lfence();
+  return rdtscp() - before;
+}
+
+volatile char *DramTimingBenchmark::get_address(size_t flat_bank, size_t row, size_t col)
+{
+  const auto bg = (flat_bank / program_args.num_banks) % program_args.num_bankgroups;
+  const auto bk = flat_bank % program_args.num_banks;
+  return (volatile char *)DRAMAddr(1, 0, bg, bk, row, col).to_virt();
+}
+
+void DramTimingBenchmark::measure_row_buffer()
+{
+  // the hit accesses another column of the opened row, the conflict another row of the same bank
+  constexpr size_t HIT_COLUMN = 64;
+  const auto num_banks = runtime_config.num_banks;
+  row_hit_ns.assign(num_banks, LogLinearHistogram());
+  row_conflict_ns.assign(num_banks, LogLinearHistogram());
+  for (size_t b = 0; b < num_banks; b++)
+  {
+    auto *opener = get_address(b, 0);
+    auto *hit = get_address(b, 0, HIT_COLUMN);
+    auto *conflict = get_address(b, 1);
+    for (size_t i = 0; i < NUM_SAMPLES; i++)
+    {
+      row_hit_ns[b].add(tsc_to_ns(time_access_after(opener, hit)));
+      row_conflict_ns[b].add(tsc_to_ns(time_access_after(opener, conflict)));
+    }
+  }
+  Logger::log_info(format_string("Row buffer hit/conflict (median of bank 0): %.0f/%.0f ns.",
+                                 row_hit_ns[0].get_quantile(0.5), row_conflict_ns[0].get_quantile(0.5)));
+}
+
+void DramTimingBenchmark::measure_act_spacing()
+{
+  // alternating between two rows makes each access activate a row
+  std::vector<std::vector<volatile char *>> single;
+  std::vector<std::vector<volatile char *>> same_bg;
+  std::vector<std::vector<volatile char *>> different_bg;
+  for (size_t row = 0; row < 2; row++)
+  {
+    single.push_back({get_address(0, row)});
+    if (program_args.num_banks > 1)
+      same_bg.push_back({get_address(0, row), get_address(1, row)});
+    if (program_args.num_bankgroups > 1)
+      different_bg.push_back({get_address(0, row), get_address(program_args.num_banks, row)});
+  }
+  for (size_t i = 0; i < NUM_SAMPLES; i++)
+  {
+    single_act_ns.add(tsc_to_ns(time_accesses(single[i % 2])));
+    if (!same_bg.empty())
+      same_bankgroup_acts_ns.add(tsc_to_ns(time_accesses(same_bg[i % 2])));
+    if (!different_bg.empty())
+      different_bankgroup_acts_ns.add(tsc_to_ns(time_accesses(different_bg[i % 2])));
+  }
+  Logger::log_info(format_string("Two ACTs in the same/different bank groups (median): %.0f/%.0f ns (single ACT: "
+                                 "%.0f ns).", same_bankgroup_acts_ns.get_quantile(0.5),
+                                 different_bankgroup_acts_ns.get_quantile(0.5), single_act_ns.get_quantile(0.5)));
+}
+
+void DramTimingBenchmark::measure_activate_window()
+{
+  // the banks are spread over the bank groups first, so that tRRD_S rather than tRRD_L separates the ACTs
+  const auto max_banks = std::min(MAX_WINDOW_BANKS, runtime_config.num_banks);
+  activate_window_ns.assign(max_banks, LogLinearHistogram());
+  for (size_t n = 1; n <= max_banks; n++)
+  {
+    std::vector<std::vector<volatile char *>> addrs(2);
+    for (size_t row = 0; row < 2; row++)
+    {
+      for (size_t j = 0; j < n; j++)
+      {
+        const auto bg = j % program_args.num_bankgroups;
+        const auto bk = (j / program_args.num_bankgroups) % program_args.num_banks;
+        addrs[row].push_back(get_address(bg * program_args.num_banks + bk, row));
+      }
+    }
+    for (size_t i = 0; i < NUM_SAMPLES; i++)
+      activate_window_ns[n - 1].add(tsc_to_ns(time_accesses(addrs[i % 2])));
+  }
+  if (max_banks > 4)
+  {
+    Logger::log_info(format_string("Four/five ACTs at once (median): %.0f/%.0f ns.",
+                                   activate_window_ns[3].get_quantile(0.5), activate_window_ns[4].get_quantile(0.5)));
+  }
+}
+
+void DramTimingBenchmark::measure_refresh()
+{
+  // accesses that collide with a REF are delayed by (roughly) tRFC; delays within a quarter tREFI belong to one REF
+  constexpr double THRESHOLD_FACTOR = 2.0;
+  const std::vector<std::vector<volatile char *>> addrs{{get_address(0, 0)}, {get_address(0, 1)}};
+  std::vector<uint64_t> starts(NUM_REFRESH_SAMPLES);
+  std::vector<uint64_t> latencies(NUM_REFRESH_SAMPLES);
+  for (size_t i = 0; i < NUM_REFRESH_SAMPLES; i++)
+  {
+    starts[i] = rdtscp();
+    latencies[i] = time_accesses(addrs[i % 2]);
+  }
+
+  LogLinearHistogram latency_cycles(7);
+  for (const auto latency : latencies)
+    latency_cycles.add(static_cast<double>(latency));
+  const auto median = latency_cycles.get_quantile(0.5);
+  const auto threshold = THRESHOLD_FACTOR * median;
+  refresh_threshold_ns = tsc_to_ns(static_cast<uint64_t>(threshold));
+
+  const auto max_gap = static_cast<uint64_t>(TREFI_NS / 4 * get_tsc_cycles_per_ns());
+  uint64_t ref_start = 0;
+  uint64_t ref_end = 0;
+  uint64_t ref_max_latency = 0;
+  size_t num_refs = 0;
+  auto finish_ref = [&]()
+  {
+    if (num_refs > 0)
+      refresh_duration_ns.add(tsc_to_ns(ref_max_latency) - tsc_to_ns(static_cast<uint64_t>(median)));
+  };
+  for (size_t i = 0; i < NUM_REFRESH_SAMPLES; i++)
+  {
+    if (static_cast<double>(latencies[i]) <= threshold)
+      continue;
+    if (num_refs > 0 && starts[i] - ref_end < max_gap)
+    {
+      ref_end = starts[i];
+      ref_max_latency = std::max(ref_max_latency, latencies[i]);
+      continue;
+    }
+    finish_ref();
+    if (num_refs > 0)
+      refresh_interval_ns.add(tsc_to_ns(starts[i] - ref_start));
+    ref_start = ref_end = starts[i];
+    ref_max_latency = latencies[i];
+    num_refs++;
+  }
+  finish_ref();
+  Logger::log_info(format_string("Detected %zu REFs (threshold: %.0f ns), interval/duration (median): %.0f/%.0f ns.",
+                                 num_refs, refresh_threshold_ns, refresh_interval_ns.get_quantile(0.5),
+                                 refresh_duration_ns.get_quantile(0.5)));
+}
+
+void DramTimingBenchmark::write_results() const
+{
+#ifdef ENABLE_JSON
+  nlohmann::json j_row_buffer = nlohmann::json::array();
+  for (size_t b = 0; b < row_hit_ns.size(); b++)
+  {
+    j_row_buffer.push_back({{"bankgroup", (b / program_args.num_banks) % program_args.num_bankgroups},
+                            {"bank", b % program_args.num_banks},
+                            {"hit", row_hit_ns[b].to_json()},
+                            {"conflict", row_conflict_ns[b].to_json()}});
+  }
+  nlohmann::json j_activate_window = nlohmann::json::array();
+  for (size_t n = 0; n < activate_window_ns.size(); n++)
+    j_activate_window.push_back({{"num_banks", n + 1}, {"latency", activate_window_ns[n].to_json()}});
+
+  const nlohmann::json results = {
+      {"host", CalibrationProfile::get_host_name()},
+      {"cpu_model", CalibrationProfile::get_cpu_model()},
+      {"dimm_id", program_args.dimm_id},
+      {"geometry", KernelAutotuner::get_geometry_key(program_args.num_ranks, program_args.num_bankgroups,
+                                                     program_args.num_banks, program_args.samsung_row_swizzling)},
+      {"mapping_hash", DRAMAddr::get_mapping_hash()},
+      {"timestamp", get_timestamp_sec()},
+      {"tsc_cycles_per_ns", get_tsc_cycles_per_ns()},
+      {"unit", "ns"},
+      {"row_buffer", j_row_buffer},
+      {"act_spacing", {{"single", single_act_ns.to_json()},
+                       {"same_bankgroup", same_bankgroup_acts_ns.to_json()},
+                       {"different_bankgroup", different_bankgroup_acts_ns.to_json()}}},
+      {"activate_window", j_activate_window},
+      {"refresh", {{"threshold", refresh_threshold_ns},
+                   {"interval", refresh_interval_ns.to_json()},
+                   {"duration", refresh_duration_ns.to_json()}}}};
+
+  std::ofstream ofs(results_filepath);
+  if (!ofs.is_open())
+  {
+    Logger::log_error(format_string("Could not open benchmark results file %s.", results_filepath.c_str()));
+    exit_target(EXIT_FAILURE);
+  }
+  ofs << results.dump(2) << std::endl;
+  Logger::log_highlight(format_string("Wrote DRAM timing benchmark results to %s.", results_filepath.c_str()));
+#else
+  Logger::log_error("The DRAM timing benchmark results can only be written with JSON support (ENABLE_JSON).");
+#endif
+}
+
+void DramTimingBenchmark::run()
+{
+  Logger::log_info("Running DRAM timing benchmarks...");
+  measure_row_buffer();
+  measure_act_spacing();
+  measure_activate_window();
+  measure_refresh();
+  write_results();
+}
@@ -0,0 +1,88 @@
+#include "Memory/ExperimentRunner.hpp"
+
+#include <algorithm>
+
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+
+ExperimentRunner::ExperimentRunner(DramAnalyzer &dram_analyzer, const std::string &results_filepath)
+    : dram_analyzer(dram_analyzer), results(results_filepath)
+{
+  if (!results.is_open())
+  {
+    Logger::log_error(format_string("Could not open experiment results file %s.", results_filepath.c_str()));
+    exit_target(EXIT_FAILURE);
+  }
+  Logger::log_info(format_string("Writing experiment results to %s.", results_filepath.c_str()));
+  write_header();
+}
+
+void ExperimentRunner::write_header()
+{
+  results << "config_id,execution_mode,num_measurement_rounds,num_measurement_reps,num_accesses_per_round,"
+             "num_sync_rows,row_distance,min_ref_thresh,same_bg,same_bk,"
+             "ref_threshold,acts_per_ref,acts_per_ref_half_width,confidence,min_acts_per_ref,max_acts_per_ref,num_valid_rounds,num_refs,num_tries,"
+             "duration_sec"
+          << std::endl;
+}
+
+void ExperimentRunner::write_row(const ExperimentConfig &exp_cfg, const ActsPerRefMeasurement &measurement)
+{
+  // the minimum only considers the rounds that yielded a value
+  size_t min_acts = 0;
+  size_t max_acts = 0;
+  size_t num_valid_rounds = 0;
+  for (const auto acts : measurement.acts_per_round)
+  {
+    if (acts == 0)
+      continue;
+    min_acts = (num_valid_rounds == 0) ? acts : std::min(min_acts, acts);
+    max_acts = std::max(max_acts, acts);
+    num_valid_rounds++;
+  }
+
+  results << exp_cfg.config_id << ','
+          << get_string_from_execution_mode(exp_cfg.exec_mode) << ','
+          << exp_cfg.num_measurement_rounds << ','
+          << exp_cfg.num_measurement_reps << ','
+          << exp_cfg.num_accesses_per_round << ','
+          << exp_cfg.num_sync_rows << ','
+          << exp_cfg.row_distance << ','
+          << exp_cfg.min_ref_thresh << ','
+          << exp_cfg.row_origin_same_bg << ','
+          << exp_cfg.row_origin_same_bk << ','
+          << measurement.ref_threshold << ','
+          << measurement.acts_per_ref << ','
+          << measurement.acts_per_ref_half_width << ','
+          << measurement.confidence << ','
+          << min_acts << ','
+          << max_acts << ','
+          << num_valid_rounds << ','
+          << measurement.num_refs << ','
+          << measurement.num_tries << ','
+          << measurement.duration_sec
+          << std::endl;
+}
+
+void ExperimentRunner::run(const std::vector<ExperimentConfig> &exp_cfgs)
+{
+  if (exp_cfgs.empty())
+  {
+    Logger::log_error("No experiment configs to run.");
+    return;
+  }
+
+  for (size_t i = 0; i < exp_cfgs.size(); ++i)
+  {
+    const auto &exp_cfg = exp_cfgs[i];
+    Logger::log_info(format_string("Running experiment %zu/%zu (%s).", i + 1, exp_cfgs.size(),
+                                   exp_cfg.to_string().c_str()));
+    const auto measurement = dram_analyzer.measure_acts_per_ref(exp_cfg);
+    Logger::log_data(format_string("ACTs/REF: %zu +- %.1f (%.1f%% confidence, REF threshold: %lu, %zu REFs, %.1f s)",
+                                   measurement.acts_per_ref, measurement.acts_per_ref_half_width,
+                                   100 * measurement.confidence, measurement.ref_threshold, measurement.num_refs,
+                                   measurement.duration_sec));
+    write_row(exp_cfg, measurement);
+  }
+  Logger::log_highlight(format_string("Finished %zu experiments.", exp_cfgs.size()));
+}
@@ -6,6 +6,11 @@
 #include <unordered_set>
 #include <bitset>
 #include "Utilities/Pagemap.hpp"
+#include "Utilities/Helper.hpp"
+
+// the state of the pseudorandom fill sequence; unlike srand/rand, it is not shared with the memory of other campaign
+// workers, which would otherwise reseed it while this thread initializes or checks its memory
+static thread_local unsigned int fill_seed = 0;
 
 #define MMAP_PROT (PROT_READ | PROT_WRITE)
 #define MMAP_FLAGS (MAP_SHARED | MAP_ANONYMOUS | MAP_POPULATE | MAP_HUGETLB | MAP_HUGE_1GB)
@@ -20,7 +25,7 @@ size_t Memory::get_max_superpages()
   if (fp == nullptr)
   {
     Logger::log_error("Could not get the number of available superpages.");
-    exit(EXIT_FAILURE);
+    exit_target(EXIT_FAILURE);
   }
 
   std::string sout;
@@ -31,7 +36,7 @@ size_t Memory::get_max_superpages()
     if (pclose(fp) < 0)
     {
       Logger::log_error("Closing popen file descriptor in get_max_superpages failed!");
-      exit(EXIT_FAILURE);
+      exit_target(EXIT_FAILURE);
     }
     return n;
   }
@@ -54,13 +59,13 @@ void Memory::allocate_memory(size_t mem_size)
     {
       Logger::log_info(format_string("Could not mount superpage from %s. Error:", hugetlbfs_mountpoint.c_str()));
       Logger::log_data(std::strerror(errno));
-      exit(EXIT_FAILURE);
+      exit_target(EXIT_FAILURE);
     }
     auto mapped_target = mmap((void *)start_address, HUGEPAGE_SZ, MMAP_PROT, MMAP_FLAGS, fileno(fp), 0);
     if (mapped_target == MAP_FAILED)
     {
       perror("mmap");
-      exit(EXIT_FAILURE);
+      exit_target(EXIT_FAILURE);
     }
     target = (volatile char *)mapped_target;
     auto saddr_phy = pagemap::vaddr2paddr((uint64_t)mapped_target);
@@ -70,26 +75,34 @@ void Memory::allocate_memory(size_t mem_size)
                                    (uint64_t)saddr_phy, (uint64_t)(saddr_phy + HUGEPAGE_SZ)));
     Logger::log_info(format_string("Startaddress (vaddr): 0x%lx",
                                    (uint64_t)start_address));
-    if (DEBUG_MODE)
+    if (runtime_config.debug_mode)
     {
       std::cout << "Hugepage_num: " << (saddr_phy >> 30) << std::endl;
     }
   }
   else
   {
-    // allocate memory using huge pages
-    assert(posix_memalign((void **)&target, mem_size, mem_size) == 0);
-    assert(madvise((void *)target, mem_size, MADV_HUGEPAGE) == 0);
-    memset((char *)target, 'A', mem_size);
-    // for khugepaged
-    Logger::log_info("Waiting for khugepaged.");
-    sleep(10);
+    // allocate memory using regular (transparent huge) pages; the area is aligned like a superpage as DRAMAddr maps
+    // addresses relative to the 1 GiB boundary below them
+    if (posix_memalign((void **)&target, HUGEPAGE_SZ, mem_size) != 0)
+    {
+      Logger::log_error(format_string("Could not allocate %zu bytes of memory.", mem_size));
+      exit_target(EXIT_FAILURE);
+    }
+    if (madvise((void *)target, mem_size, MADV_HUGEPAGE) != 0)
+    {
+      Logger::log_info("Could not advise transparent huge pages, using regular pages.");
+    }
   }
 
   if (target != start_address)
   {
-    Logger::log_error(format_string("Could not create mmap area at address %p, instead using %p.",
-                                    start_address, target));
+    // regular pages are placed by the allocator
+    if (superpage)
+    {
+      Logger::log_error(format_string("Could not create mmap area at address %p, instead using %p.",
+                                      start_address, target));
+    }
     start_address = target;
   }
 
@@ -115,7 +128,7 @@ void Memory::allocate_memory(size_t mem_size, uint64_t hp)
     if (mapped_target == MAP_FAILED)
     {
       perror("mmap");
-      exit(EXIT_FAILURE);
+      exit_target(EXIT_FAILURE);
     }
 
     auto saddr_phy = pagemap::vaddr2paddr((uint64_t)mapped_target);
@@ -129,7 +142,7 @@ void Memory::allocate_memory(size_t mem_size, uint64_t hp)
         {
           Logger::log_error("munmap failed with error:");
           Logger::log_data(std::strerror(errno));
-          exit(EXIT_FAILURE);
+          exit_target(EXIT_FAILURE);
         }
       }
       Logger::log_info(format_string("Allocated memory (paddr): 0x%lx-0x%lx",
@@ -161,10 +174,10 @@ void Memory::allocate_memory(size_t mem_size, uint64_t hp)
       {
         Logger::log_error("munmap failed with error:");
         Logger::log_data(std::strerror(errno));
-        exit(EXIT_FAILURE);
+        exit_target(EXIT_FAILURE);
       }
     }
-    exit(EXIT_FAILURE);
+    exit_target(EXIT_FAILURE);
   }
 
   // initialize memory with random but reproducible sequence of numbers
@@ -203,7 +216,7 @@ void Memory::check_memory_full()
   }
 
   // if (has_flip)
-  //     exit(EXIT_FAILURE);
+  //     exit_target(EXIT_FAILURE);
   // #else
   //   assert(false && "Memory::check_memory_full should only be used for debugging purposes!");
   // #endif
@@ -211,17 +224,11 @@ void Memory::check_memory_full()
 
 void Memory::initialize(DATA_PATTERN patt)
 {
-  if (not superpage)
-  {
-    Logger::log_error("The function Memory::initialize has not been adapted to work with regular pages! Exiting.");
-    exit(EXIT_FAILURE);
-  }
-
   this->data_pattern = patt;
   Logger::log_info("Initializing memory with pseudorandom sequence.");
 
   // for each page in the address space [start, end]
-  for (uint64_t cur_page = 0; cur_page < HUGEPAGE_SZ; cur_page += getpagesize())
+  for (uint64_t cur_page = 0; cur_page < size; cur_page += getpagesize())
   {
     // reseed rand to have a sequence of reproducible numbers, using this we can compare the initialized values with
     // those after hammering to see whether bit flips occurred
@@ -240,7 +247,7 @@ void Memory::initialize(DATA_PATTERN patt)
 
 void Memory::reseed_srand(uint64_t cur_page)
 {
-  srand(cur_page * (uint64_t)getpagesize());
+  fill_seed = static_cast<unsigned int>(cur_page * (uint64_t)getpagesize());
 }
 
 size_t Memory::check_memory(PatternAddressMapper &mapping, bool reproducibility_mode, bool verbose)
@@ -259,7 +266,20 @@ size_t Memory::check_memory(PatternAddressMapper &mapping, bool reproducibility_
   {
     auto *start = (volatile char *)vr.to_virt();
     auto *end = start + DRAMAddr::get_row_to_row_offset();
-    sum_found_bitflips += check_memory_internal(mapping, start, end, reproducibility_mode, verbose);
+    sum_found_bitflips += check_memory_internal(&mapping, start, end, reproducibility_mode, verbose);
+  }
+  return sum_found_bitflips;
+}
+
+size_t Memory::check_memory(const std::vector<volatile char *> &victim_row_starts, bool verbose)
+{
+  flipped_bits.clear();
+
+  size_t sum_found_bitflips = 0;
+  for (auto *start : victim_row_starts)
+  {
+    auto *end = start + DRAMAddr::get_row_to_row_offset();
+    sum_found_bitflips += check_memory_internal(nullptr, start, end, true, verbose);
   }
   return sum_found_bitflips;
 }
@@ -268,7 +288,7 @@ uint32_t Memory::get_fill_value() const
 {
   if (data_pattern == DATA_PATTERN::RANDOM)
   {
-    return rand(); // NOLINT(cert-msc50-cpp)
+    return rand_r(&fill_seed);
   }
   else if (data_pattern == DATA_PATTERN::ZEROES)
   {
@@ -281,7 +301,7 @@ uint32_t Memory::get_fill_value() const
   else
   {
     Logger::log_error("Could not initialize memory with given (unknown) DATA_PATTERN.");
-    exit(EXIT_FAILURE);
+    exit_target(EXIT_FAILURE);
   }
 }
 
@@ -293,7 +313,7 @@ uint64_t Memory::round_down_to_next_page_boundary(uint64_t address)
              : address;
 }
 
-size_t Memory::check_memory_internal(PatternAddressMapper &mapping,
+size_t Memory::check_memory_internal(PatternAddressMapper *mapping,
                                      const volatile char *start,
                                      const volatile char *end,
                                      bool reproducibility_mode,
@@ -322,7 +342,7 @@ size_t Memory::check_memory_internal(PatternAddressMapper &mapping,
   if (page_raw == nullptr)
   {
     Logger::log_error("Could not create temporary page for memory comparison.");
-    exit(EXIT_FAILURE);
+    exit_target(EXIT_FAILURE);
   }
   memset(page_raw, 0, pagesize);
   int *page = (int *)page_raw;
@@ -331,11 +351,11 @@ size_t Memory::check_memory_internal(PatternAddressMapper &mapping,
   for (uint64_t i = start_offset; i < end_offset; i += pagesize)
   {
     // reseed rand to have the desired sequence of reproducible numbers
-    srand(static_cast<unsigned int>(i * pagesize));
+    reseed_srand(i);
 
-    // fill comparison page with expected values generated by rand()
+    // fill comparison page with expected values generated by rand_r()
     for (size_t j = 0; j < (unsigned long)pagesize / sizeof(int); ++j)
-      page[j] = rand();
+      page[j] = rand_r(&fill_seed);
 
     uint64_t addr = ((uint64_t)start_address + i);
 
@@ -394,15 +414,15 @@ size_t Memory::check_memory_internal(PatternAddressMapper &mapping,
           BitFlip bitflip(flipped_addr_dram, (expected_value ^ flipped_addr_value), flipped_addr_value);
           // std::cout << " one->zero: " << bitflip.count_o2z_corruptions() << " zero->one: " << bitflip.count_z2o_corruptions() << std::endl;
           // ..in the mapping that triggered this bit flip
-          if (!reproducibility_mode)
+          if (!reproducibility_mode && mapping != nullptr)
           {
-            if (mapping.bit_flips.empty())
+            if (mapping->bit_flips.empty())
             {
               Logger::log_error("Cannot store bit flips found in given address mapping.\n"
                                 "You need to create an empty vector in PatternAddressMapper::bit_flips before calling "
                                 "check_memory.");
             }
-            mapping.bit_flips.back().push_back(bitflip);
+            mapping->bit_flips.back().push_back(bitflip);
           }
           // ..in an attribute of this class so that it can be retrived by the caller
           flipped_bits.push_back(bitflip);
@@ -433,11 +453,17 @@ Memory::Memory(bool use_superpage)
 
 Memory::~Memory()
 {
-  if (munmap((void *)start_address, size) != 0)
+  if (!superpage)
+  {
+    // nothing was allocated if the size is still 0
+    if (size > 0)
+      free((void *)start_address);
+  }
+  else if (size > 0 && munmap((void *)start_address, size) != 0)
   {
+    // not fatal, the mapping is released when the process ends
     Logger::log_error("munmap failed with error:");
     Logger::log_data(std::strerror(errno));
-    exit(EXIT_FAILURE);
   }
   start_address = nullptr;
   size = 0;
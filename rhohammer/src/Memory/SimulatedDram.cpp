@@ -0,0 +1,171 @@
+#include "Memory/SimulatedDram.hpp"
+
+#include <algorithm>
+
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+
+thread_local std::unique_ptr<SimulatedDram> SimulatedDram::instance;
+
+// a stateless hash (splitmix64 finalizer), used to derive the per-row flip thresholds from the seed
+static uint64_t mix(uint64_t x)
+{
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+SimulatedDram::SimulatedDram(const SimulatedDramConfig &config, volatile char *start_address, size_t size)
+    : config(config), start_address(start_address), size(size), gen(config.seed), next_ref_ns(config.trefi_ns)
+{
+}
+
+void SimulatedDram::enable(const SimulatedDramConfig &config, volatile char *start_address, size_t size)
+{
+  instance = std::make_unique<SimulatedDram>(config, start_address, size);
+  Logger::log_info(format_string("Simulating DRAM (seed: %lu, flip threshold: %zu ACTs, tREFI: %.0f ns, tRFC: %.0f ns).",
+                                 config.seed, config.flip_threshold, config.trefi_ns, config.trfc_ns));
+}
+
+SimulatedDram *SimulatedDram::get()
+{
+  return instance.get();
+}
+
+uint64_t SimulatedDram::get_bank_key(const DRAMAddr &addr)
+{
+  return (addr.get_subchan() << 24) | (addr.get_rank() << 16) | (addr.get_bankgroup() << 8) | addr.get_bank();
+}
+
+uint64_t SimulatedDram::get_last_refresh(size_t row) const
+{
+  // the n-th REF (counted from 1) refreshes the rows with row % refs_per_window == (n - 1) % refs_per_window
+  const auto slot = row % config.refs_per_window;
+  if (num_refs <= slot)
+    return 0;
+  return num_refs - (num_refs - 1 - slot) % config.refs_per_window;
+}
+
+double SimulatedDram::get_row_threshold(uint64_t bank_key, size_t row) const
+{
+  const auto h = mix(config.seed ^ mix((bank_key << 32) | row));
+  const auto u = static_cast<double>(h >> 11) / static_cast<double>(1ULL << 53);
+  return static_cast<double>(config.flip_threshold) * (0.5 + u);
+}
+
+void SimulatedDram::refresh_if_due()
+{
+  while (now_ns >= next_ref_ns)
+  {
+    // the REF precharges all banks and blocks them for tRFC
+    num_refs++;
+    now_ns = std::max(now_ns, next_ref_ns + config.trfc_ns);
+    next_ref_ns += config.trefi_ns;
+    open_rows.clear();
+    // every row was refreshed once per window, hence the rows that were not disturbed since their last refresh have no
+    // disturbance left and are removed, so that the state only grows with the rows disturbed within a window
+    if (num_refs % config.refs_per_window == 0)
+    {
+      std::erase_if(rows, [this](const auto &entry)
+      {
+        return entry.second.last_refresh != get_last_refresh(entry.first & 0xffffffffULL);
+      });
+    }
+  }
+}
+
+double SimulatedDram::access(volatile char *addr)
+{
+  const auto start_ns = now_ns;
+  refresh_if_due();
+
+  const DRAMAddr dram_addr((void *)addr);
+  const auto bank_key = get_bank_key(dram_addr);
+  const auto row = dram_addr.get_row();
+  auto it = open_rows.find(bank_key);
+  if (it != open_rows.end() && it->second == row)
+  {
+    now_ns += config.row_hit_ns;
+  }
+  else
+  {
+    now_ns += (it == open_rows.end()) ? config.row_miss_ns : config.row_conflict_ns;
+    open_rows[bank_key] = row;
+    activate(bank_key, dram_addr);
+  }
+  return now_ns - start_ns;
+}
+
+void SimulatedDram::activate(uint64_t bank_key, const DRAMAddr &addr)
+{
+  num_acts++;
+  const auto row = addr.get_row();
+  if (row > 0)
+    disturb(bank_key, addr, row - 1);
+  if (row < DRAMAddr::get_max_row())
+    disturb(bank_key, addr, row + 1);
+}
+
+void SimulatedDram::disturb(uint64_t bank_key, const DRAMAddr &aggressor, size_t victim_row)
+{
+  auto &state = rows[(bank_key << 32) | victim_row];
+  const auto last_refresh = get_last_refresh(victim_row);
+  if (state.last_refresh != last_refresh)
+  {
+    state.last_refresh = last_refresh;
+    state.disturbance = 0;
+  }
+  state.disturbance++;
+  if (static_cast<double>(state.disturbance) >= get_row_threshold(bank_key, victim_row))
+  {
+    // the row flips again if it is disturbed as much again before being refreshed
+    state.disturbance = 0;
+    inject_flip(aggressor, victim_row);
+  }
+}
+
+void SimulatedDram::inject_flip(const DRAMAddr &aggressor, size_t victim_row)
+{
+  auto victim = aggressor;
+  victim.set_row(victim_row);
+  victim.set_col(static_cast<size_t>(gen()));
+  auto *addr = (volatile char *)victim.to_virt();
+  if (addr < start_address || addr >= start_address + size)
+  {
+    num_dropped_flips++;
+    return;
+  }
+  *addr = static_cast<char>(*addr ^ (1 << (gen() % 8)));
+  num_flips++;
+}
+
+uint64_t SimulatedDram::get_time_cycles() const
+{
+  return static_cast<uint64_t>(now_ns * get_tsc_cycles_per_ns());
+}
+
+size_t SimulatedDram::get_ref_threshold() const
+{
+  return static_cast<size_t>((config.row_conflict_ns + config.trfc_ns / 2) * get_tsc_cycles_per_ns());
+}
+
+uint64_t SimulatedDram::get_num_acts() const
+{
+  return num_acts;
+}
+
+uint64_t SimulatedDram::get_num_refs() const
+{
+  return num_refs;
+}
+
+uint64_t SimulatedDram::get_num_flips() const
+{
+  return num_flips;
+}
+
+uint64_t SimulatedDram::get_num_dropped_flips() const
+{
+  return num_dropped_flips;
+}
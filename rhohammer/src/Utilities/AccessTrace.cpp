@@ -0,0 +1,274 @@
+#include "Utilities/AccessTrace.hpp"
+
+#include <cstring>
+#include <filesystem>
+
+#include "Memory/DRAMAddr.hpp"
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+
+// header at the beginning of an access trace
+struct AccessTraceFileHeader {
+  char magic[4];
+  uint32_t version;
+};
+
+static constexpr uint32_t TRACE_VERSION = 1;
+
+// a block larger than this is considered corrupt rather than allocated
+static constexpr uint64_t MAX_BLOCK_SIZE = 1ULL << 32;
+
+static void put_varint(std::string &out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+// maps signed deltas to small unsigned numbers: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+static void put_zigzag(std::string &out, int64_t value) {
+  put_varint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+static void put_string(std::string &out, const std::string &str) {
+  put_varint(out, str.size());
+  out.append(str);
+}
+
+// decodes the payload of a block, every read fails (and stays failed) once the end is reached
+class PayloadReader {
+ private:
+  const char *cur;
+
+  const char *end;
+
+  bool ok{true};
+
+ public:
+  PayloadReader(const char *data, size_t size) : cur(data), end(data + size) {
+  }
+
+  uint64_t get_varint() {
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      if (cur >= end) break;
+      const auto byte = static_cast<uint8_t>(*cur++);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) return value;
+    }
+    ok = false;
+    return 0;
+  }
+
+  int64_t get_zigzag() {
+    const auto value = get_varint();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  uint8_t get_byte() {
+    if (cur >= end) {
+      ok = false;
+      return 0;
+    }
+    return static_cast<uint8_t>(*cur++);
+  }
+
+  std::string get_string() {
+    const auto len = get_varint();
+    if (!ok || len > static_cast<uint64_t>(end - cur)) {
+      ok = false;
+      return "";
+    }
+    std::string str(cur, len);
+    cur += len;
+    return str;
+  }
+
+  [[nodiscard]] bool is_ok() const {
+    return ok;
+  }
+};
+
+std::string to_string(TRACE_OP op) {
+  switch (op) {
+    case TRACE_OP::SYNC: return "sync";
+    case TRACE_OP::ACCESS: return "access";
+    case TRACE_OP::FLUSH: return "flush";
+    case TRACE_OP::MFENCE: return "mfence";
+    case TRACE_OP::LFENCE: return "lfence";
+  }
+  return "unknown";
+}
+
+TraceAccess TraceAccess::resolve(TRACE_OP op, volatile char *addr) {
+  TraceAccess access;
+  access.op = op;
+  if (!access.has_address()) return access;
+  const DRAMAddr dram_addr((void *)addr);
+  access.addr = reinterpret_cast<uint64_t>(addr);
+  access.subchannel = static_cast<uint32_t>(dram_addr.get_subchan());
+  access.rank = static_cast<uint32_t>(dram_addr.get_rank());
+  access.bankgroup = static_cast<uint32_t>(dram_addr.get_bankgroup());
+  access.bank = static_cast<uint32_t>(dram_addr.get_bank());
+  access.row = static_cast<uint32_t>(dram_addr.get_row());
+  access.col = static_cast<uint32_t>(dram_addr.get_column());
+  return access;
+}
+
+bool TraceAccess::has_address() const {
+  return op == TRACE_OP::SYNC || op == TRACE_OP::ACCESS || op == TRACE_OP::FLUSH;
+}
+
+uint64_t TraceAccess::get_bank_key() const {
+  return (static_cast<uint64_t>(subchannel) << 48) | (static_cast<uint64_t>(rank) << 32)
+      | (static_cast<uint64_t>(bankgroup) << 16) | bank;
+}
+
+void AccessTraceWriter::open(const std::string &path, bool append) {
+  close();
+  if (append) {
+    // a block that was only partially written when the previous run was interrupted is cut off before appending
+    AccessTraceReader reader;
+    if (reader.open(path)) {
+      AccessTraceBlock block;
+      size_t num_blocks = 0;
+      while (reader.next(block)) num_blocks++;
+      std::error_code ec;
+      std::filesystem::resize_file(path, reader.get_offset(), ec);
+      os.open(path, std::ios::out | std::ios::app | std::ios::binary);
+      if (ec || !os.is_open()) {
+        Logger::log_error(format_string("Could not open %s for appending to the access trace.", path.c_str()));
+        exit_target(EXIT_FAILURE);
+      }
+      filepath = path;
+      Logger::log_info(format_string("Appending to the access trace %s (%zu blocks).", path.c_str(), num_blocks));
+      return;
+    }
+  }
+  os.open(path, std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!os.is_open()) {
+    Logger::log_error(format_string("Could not open %s for writing the access trace.", path.c_str()));
+    exit_target(EXIT_FAILURE);
+  }
+  filepath = path;
+  AccessTraceFileHeader header{};
+  memcpy(header.magic, "RTRC", sizeof(header.magic));
+  header.version = TRACE_VERSION;
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+bool AccessTraceWriter::is_open() const {
+  return os.is_open();
+}
+
+const std::string &AccessTraceWriter::get_filepath() const {
+  return filepath;
+}
+
+void AccessTraceWriter::write(const AccessTraceHeader &header, const std::vector<TraceAccess> &accesses) {
+  payload.clear();
+  put_string(payload, header.pattern_id);
+  put_string(payload, header.mapping_id);
+  put_varint(payload, header.location);
+  put_varint(payload, static_cast<uint64_t>(header.kernel));
+  put_varint(payload, static_cast<uint64_t>(header.flushing));
+  put_varint(payload, static_cast<uint64_t>(header.fencing));
+  put_varint(payload, header.acts_per_trefi);
+  put_varint(payload, header.num_rounds);
+  put_varint(payload, accesses.size());
+
+  // consecutive accesses mostly hit the same bank and nearby rows, hence the deltas are short
+  uint64_t prev_addr = 0;
+  uint32_t prev_row = 0;
+  for (const auto &access : accesses) {
+    payload.push_back(static_cast<char>(access.op));
+    if (!access.has_address()) continue;
+    put_zigzag(payload, static_cast<int64_t>(access.addr - prev_addr));
+    put_varint(payload, access.subchannel);
+    put_varint(payload, access.rank);
+    put_varint(payload, access.bankgroup);
+    put_varint(payload, access.bank);
+    put_zigzag(payload, static_cast<int64_t>(access.row) - static_cast<int64_t>(prev_row));
+    put_varint(payload, access.col);
+    prev_addr = access.addr;
+    prev_row = access.row;
+  }
+
+  std::string length;
+  put_varint(length, payload.size());
+  os.write(length.data(), static_cast<std::streamsize>(length.size()));
+  os.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+  os.flush();
+}
+
+void AccessTraceWriter::close() {
+  if (os.is_open()) os.close();
+}
+
+bool AccessTraceReader::open(const std::string &path) {
+  is.open(path, std::ios::in | std::ios::binary);
+  if (!is.is_open()) return false;
+  AccessTraceFileHeader header{};
+  is.read(reinterpret_cast<char *>(&header), sizeof(header));
+  offset = sizeof(header);
+  return is.gcount() == sizeof(header) && memcmp(header.magic, "RTRC", sizeof(header.magic)) == 0
+      && header.version == TRACE_VERSION;
+}
+
+bool AccessTraceReader::next(AccessTraceBlock &block) {
+  // the payload length is a varint, read byte by byte
+  uint64_t length = 0;
+  for (unsigned shift = 0;; shift += 7) {
+    const auto c = is.get();
+    if (c == std::ifstream::traits_type::eof() || shift >= 64) return false;
+    length |= static_cast<uint64_t>(c & 0x7f) << shift;
+    if ((c & 0x80) == 0) break;
+  }
+  if (length > MAX_BLOCK_SIZE) return false;
+  payload.resize(length);
+  is.read(payload.data(), static_cast<std::streamsize>(length));
+  if (static_cast<uint64_t>(is.gcount()) != length) return false;
+
+  PayloadReader reader(payload.data(), payload.size());
+  auto &header = block.header;
+  header.pattern_id = reader.get_string();
+  header.mapping_id = reader.get_string();
+  header.location = reader.get_varint();
+  header.kernel = static_cast<HAMMERING_KERNEL>(reader.get_varint());
+  header.flushing = static_cast<FLUSHING_STRATEGY>(reader.get_varint());
+  header.fencing = static_cast<FENCING_STRATEGY>(reader.get_varint());
+  header.acts_per_trefi = reader.get_varint();
+  header.num_rounds = reader.get_varint();
+  const auto num_accesses = reader.get_varint();
+  // every access takes at least a byte
+  if (!reader.is_ok() || num_accesses > length) return false;
+
+  block.accesses.clear();
+  block.accesses.reserve(num_accesses);
+  uint64_t prev_addr = 0;
+  uint32_t prev_row = 0;
+  for (uint64_t i = 0; i < num_accesses && reader.is_ok(); i++) {
+    TraceAccess access;
+    access.op = static_cast<TRACE_OP>(reader.get_byte());
+    if (access.has_address()) {
+      access.addr = prev_addr + static_cast<uint64_t>(reader.get_zigzag());
+      access.subchannel = static_cast<uint32_t>(reader.get_varint());
+      access.rank = static_cast<uint32_t>(reader.get_varint());
+      access.bankgroup = static_cast<uint32_t>(reader.get_varint());
+      access.bank = static_cast<uint32_t>(reader.get_varint());
+      access.row = static_cast<uint32_t>(static_cast<int64_t>(prev_row) + reader.get_zigzag());
+      access.col = static_cast<uint32_t>(reader.get_varint());
+      prev_addr = access.addr;
+      prev_row = access.row;
+    }
+    block.accesses.push_back(access);
+  }
+  if (!reader.is_ok()) return false;
+  offset = static_cast<uint64_t>(is.tellg());
+  return true;
+}
+
+uint64_t AccessTraceReader::get_offset() const {
+  return offset;
+}
@@ -0,0 +1,72 @@
+#include "Utilities/ActivationTelemetry.hpp"
+
+#include "GlobalDefines.hpp"
+#include "Utilities/Helper.hpp"
+
+bool ActivationRate::is_valid() const {
+  return tsc_delta > 0;
+}
+
+double ActivationRate::get_duration_ns() const {
+  return tsc_to_ns(tsc_delta);
+}
+
+double ActivationRate::get_acts_per_sec() const {
+  if (!is_valid()) return 0;
+  return static_cast<double>(total_acts)/(get_duration_ns()/1e9);
+}
+
+double ActivationRate::get_acts_per_trefi() const {
+  if (!is_valid()) return 0;
+  return static_cast<double>(total_acts)/(get_duration_ns()/TREFI_NS);
+}
+
+void ActivationRate::accumulate(const ActivationRate &other) {
+  total_acts += other.total_acts;
+  tsc_delta += other.tsc_delta;
+}
+
+ActivationTelemetry::KernelHistograms &ActivationTelemetry::get(HAMMERING_KERNEL kernel) {
+  return (kernel == HAMMERING_KERNEL::JITTED) ? jitted : unjitted;
+}
+
+void ActivationTelemetry::record(HAMMERING_KERNEL kernel, const ActivationRate &rate) {
+  if (!rate.is_valid()) return;
+  auto &h = get(kernel);
+  h.acts_per_trefi.add(rate.get_acts_per_trefi());
+  h.acts_per_sec.add(rate.get_acts_per_sec());
+  h.total.accumulate(rate);
+}
+
+#ifdef ENABLE_JSON
+
+nlohmann::json ActivationTelemetry::to_json() const {
+  nlohmann::json j;
+  j["tsc_cycles_per_ns"] = get_tsc_cycles_per_ns();
+  j["trefi_ns"] = TREFI_NS;
+  for (const auto &[kernel, h] : {std::make_pair(HAMMERING_KERNEL::JITTED, &jitted),
+                                  std::make_pair(HAMMERING_KERNEL::UNJITTED, &unjitted)}) {
+    if (h->acts_per_sec.get_count() == 0) continue;
+    j["kernels"][to_string(kernel)] = {
+        {"total", h->total},
+        {"acts_per_trefi", h->acts_per_trefi.to_json()},
+        {"acts_per_sec", h->acts_per_sec.to_json()}
+    };
+  }
+  return j;
+}
+
+void to_json(nlohmann::json &j, const ActivationRate &p) {
+  if (!p.is_valid()) {
+    j = nullptr;
+    return;
+  }
+  j = nlohmann::json{{"total_acts", p.total_acts},
+                     {"tsc_delta", p.tsc_delta},
+                     {"duration_ns", p.get_duration_ns()},
+                     {"acts_per_sec", p.get_acts_per_sec()},
+                     {"acts_per_trefi", p.get_acts_per_trefi()}
+  };
+}
+
+#endif
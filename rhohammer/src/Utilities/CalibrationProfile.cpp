@@ -0,0 +1,222 @@
+#include "Utilities/CalibrationProfile.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+
+static constexpr int CALIBRATION_FILE_VERSION = 2;
+
+std::string CalibrationProfile::get_key() const {
+  return format_string("%s|%s|dimm-%ld|%s|%s", host.c_str(), cpu_model.c_str(), dimm_id, geometry.c_str(),
+                       mapping_hash.c_str());
+}
+
+bool CalibrationProfile::is_fresh(int64_t timestamp, int64_t max_age) {
+  return timestamp > 0 && get_timestamp_sec() - timestamp <= max_age;
+}
+
+std::string CalibrationProfile::get_host_name() {
+  char name[256] = {};
+  if (gethostname(name, sizeof(name) - 1) != 0) return "unknown";
+  return name;
+}
+
+std::string CalibrationProfile::get_cpu_model() {
+  std::ifstream ifs("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (line.rfind("model name", 0) != 0) continue;
+    const auto pos = line.find(':');
+    if (pos == std::string::npos) break;
+    const auto start = line.find_first_not_of(' ', pos + 1);
+    return (start == std::string::npos) ? "" : line.substr(start);
+  }
+  return "unknown";
+}
+
+CalibrationProfileStore::CalibrationProfileStore(std::string filepath) : filepath(std::move(filepath)) {
+}
+
+#ifdef ENABLE_JSON
+
+nlohmann::json CalibrationProfileStore::read_profiles() const {
+  std::ifstream ifs(filepath);
+  if (!ifs.is_open()) return nlohmann::json::object();
+  auto calibration = nlohmann::json::parse(ifs, nullptr, false);
+  if (calibration.is_discarded() || !calibration.is_object()) {
+    Logger::log_error(format_string("Ignoring %s as it is not a valid calibration file.", filepath.c_str()));
+    return nlohmann::json::object();
+  }
+  if (calibration.contains("version")) {
+    auto profiles = calibration.value("profiles", nlohmann::json::object());
+    if (!profiles.is_object()) {
+      Logger::log_error(format_string("Ignoring the profiles of %s as they are not an object.", filepath.c_str()));
+      return nlohmann::json::object();
+    }
+    return profiles;
+  }
+
+  // migrate the geometry -> {timestamp, ref_threshold, kernel_choice} entries of the first file format
+  nlohmann::json profiles = nlohmann::json::object();
+  for (const auto &[geometry, entry] : calibration.items()) {
+    if (!entry.is_object() || !entry.contains("kernel_choice")) continue;
+    CalibrationProfile profile;
+    profile.host = CalibrationProfile::get_host_name();
+    profile.cpu_model = CalibrationProfile::get_cpu_model();
+    profile.geometry = geometry;
+    profile.has_kernel_choice = true;
+    try {
+      profile.kernel_choice = entry["kernel_choice"].get<KernelChoice>();
+      profile.kernel_choice_timestamp = entry.value("timestamp", static_cast<int64_t>(0));
+    } catch (const nlohmann::json::exception &e) {
+      Logger::log_error(format_string("Ignoring the invalid kernel choice of %s in %s (%s).", geometry.c_str(),
+                                      filepath.c_str(), e.what()));
+      continue;
+    }
+    profiles[profile.get_key()] = profile;
+  }
+  Logger::log_info(format_string("Migrated %zu kernel choices of %s to calibration profiles.", profiles.size(),
+                                 filepath.c_str()));
+  return profiles;
+}
+
+#endif
+
+bool CalibrationProfileStore::load(CalibrationProfile &profile) const {
+#ifdef ENABLE_JSON
+  const auto profiles = read_profiles();
+  const auto key = profile.get_key();
+  if (!profiles.contains(key)) return false;
+  CalibrationProfile stored;
+  try {
+    stored = profiles[key].get<CalibrationProfile>();
+  } catch (const nlohmann::json::exception &e) {
+    // a truncated or hand-edited profile is treated as missing, hence the values are calibrated again
+    Logger::log_error(format_string("Ignoring the invalid calibration profile '%s' in %s (%s).", key.c_str(),
+                                    filepath.c_str(), e.what()));
+    return false;
+  }
+  profile.ref_threshold = stored.ref_threshold;
+  profile.ref_threshold_timestamp = stored.ref_threshold_timestamp;
+  profile.has_kernel_choice = stored.has_kernel_choice;
+  profile.kernel_choice = stored.kernel_choice;
+  profile.kernel_choice_timestamp = stored.kernel_choice_timestamp;
+  return true;
+#else
+  (void)profile;
+  return false;
+#endif
+}
+
+bool CalibrationProfileStore::load_kernel_choice(const CalibrationProfile &profile, KernelChoice &choice,
+                                                 int64_t &timestamp) const {
+#ifdef ENABLE_JSON
+  bool found = false;
+  const auto profiles = read_profiles();
+  for (const auto &[key, entry] : profiles.items()) {
+    CalibrationProfile stored;
+    try {
+      stored = entry.get<CalibrationProfile>();
+    } catch (const nlohmann::json::exception &e) {
+      Logger::log_error(format_string("Ignoring the invalid calibration profile '%s' in %s (%s).", key.c_str(),
+                                      filepath.c_str(), e.what()));
+      continue;
+    }
+    if (!stored.has_kernel_choice || stored.host != profile.host || stored.cpu_model != profile.cpu_model
+        || stored.geometry != profile.geometry) {
+      continue;
+    }
+    if (!found || stored.kernel_choice_timestamp > timestamp) {
+      choice = stored.kernel_choice;
+      timestamp = stored.kernel_choice_timestamp;
+      found = true;
+    }
+  }
+  return found;
+#else
+  (void)profile;
+  (void)choice;
+  (void)timestamp;
+  return false;
+#endif
+}
+
+void CalibrationProfileStore::store(const CalibrationProfile &profile) const {
+#ifdef ENABLE_JSON
+  auto profiles = read_profiles();
+  profiles[profile.get_key()] = profile;
+  const nlohmann::json calibration = {{"version", CALIBRATION_FILE_VERSION}, {"profiles", profiles}};
+
+  // replace the file atomically, as workers of other processes might read it at the same time; the temporary file
+  // has a unique name, as they might also write it at the same time
+  std::vector<char> tmp_filepath(filepath.begin(), filepath.end());
+  const std::string tmp_suffix = ".XXXXXX";
+  tmp_filepath.insert(tmp_filepath.end(), tmp_suffix.begin(), tmp_suffix.end());
+  tmp_filepath.push_back('\0');
+  const int fd = mkstemp(tmp_filepath.data());
+  if (fd == -1) {
+    Logger::log_error(format_string("Could not create a temporary file for %s: %s", filepath.c_str(),
+                                    strerror(errno)));
+    return;
+  }
+  const auto contents = calibration.dump(2) + "\n";
+  bool written = (fchmod(fd, 0644) == 0);
+  for (size_t pos = 0; written && pos < contents.size();) {
+    const auto n = write(fd, contents.data() + pos, contents.size() - pos);
+    if (n < 0 && errno == EINTR) continue;
+    written = (n > 0);
+    if (written) pos += static_cast<size_t>(n);
+  }
+  written = (::close(fd) == 0) && written;
+  if (!written || std::rename(tmp_filepath.data(), filepath.c_str()) != 0) {
+    Logger::log_error(format_string("Could not write calibration profiles to %s.", filepath.c_str()));
+    unlink(tmp_filepath.data());
+    return;
+  }
+  Logger::log_info(format_string("Stored calibration profile '%s' in %s.", profile.get_key().c_str(),
+                                 filepath.c_str()));
+#else
+  (void)profile;
+#endif
+}
+
+#ifdef ENABLE_JSON
+
+void to_json(nlohmann::json &j, const CalibrationProfile &p) {
+  j = nlohmann::json{{"host", p.host},
+                     {"cpu_model", p.cpu_model},
+                     {"dimm_id", p.dimm_id},
+                     {"geometry", p.geometry},
+                     {"mapping_hash", p.mapping_hash},
+                     {"ref_threshold", {{"value", p.ref_threshold}, {"timestamp", p.ref_threshold_timestamp}}}
+  };
+  if (p.has_kernel_choice) {
+    j["kernel_choice"] = {{"value", p.kernel_choice}, {"timestamp", p.kernel_choice_timestamp}};
+  }
+}
+
+void from_json(const nlohmann::json &j, CalibrationProfile &p) {
+  j.at("host").get_to(p.host);
+  j.at("cpu_model").get_to(p.cpu_model);
+  j.at("dimm_id").get_to(p.dimm_id);
+  j.at("geometry").get_to(p.geometry);
+  j.at("mapping_hash").get_to(p.mapping_hash);
+  j.at("ref_threshold").at("value").get_to(p.ref_threshold);
+  j.at("ref_threshold").at("timestamp").get_to(p.ref_threshold_timestamp);
+  p.has_kernel_choice = j.contains("kernel_choice");
+  if (p.has_kernel_choice) {
+    j.at("kernel_choice").at("value").get_to(p.kernel_choice);
+    j.at("kernel_choice").at("timestamp").get_to(p.kernel_choice_timestamp);
+  }
+}
+
+#endif
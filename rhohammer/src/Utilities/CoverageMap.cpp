@@ -0,0 +1,180 @@
+#include "Utilities/CoverageMap.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+
+static constexpr uint32_t COVERAGE_MAP_VERSION = 1;
+
+CoverageMap::~CoverageMap() {
+  close();
+}
+
+CoverageMapHeader *CoverageMap::get_header() const {
+  return reinterpret_cast<CoverageMapHeader *>(data);
+}
+
+size_t CoverageMap::get_entry_offset(size_t slot) const {
+  return sizeof(CoverageMapHeader) + slot*(sizeof(CoverageMapEntry) + 2*bitmap_size);
+}
+
+size_t CoverageMap::get_bit_index(size_t bank, size_t row) const {
+  const auto *header = get_header();
+  return (bank%header->num_banks)*header->rows_per_bank + (row%header->rows_per_bank);
+}
+
+void CoverageMap::map(size_t size) {
+  if (data != nullptr) munmap(data, data_size);
+  data = nullptr;
+  if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    Logger::log_error(format_string("Could not resize coverage map %s: %s", filepath.c_str(), strerror(errno)));
+    exit_target(EXIT_FAILURE);
+  }
+  auto *mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapped == MAP_FAILED) {
+    Logger::log_error(format_string("Could not map coverage map %s: %s", filepath.c_str(), strerror(errno)));
+    exit_target(EXIT_FAILURE);
+  }
+  data = static_cast<uint8_t *>(mapped);
+  data_size = size;
+}
+
+void CoverageMap::open(const std::string &path, long dimm_id, size_t num_banks, size_t rows_per_bank) {
+  close();
+  fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd == -1) {
+    Logger::log_error(format_string("Could not open coverage map %s: %s", path.c_str(), strerror(errno)));
+    exit_target(EXIT_FAILURE);
+  }
+  filepath = path;
+  bitmap_size = ((num_banks*rows_per_bank + 63)/64)*8;
+
+  struct stat st{};
+  if (fstat(fd, &st) != 0) {
+    Logger::log_error(format_string("Could not stat coverage map %s: %s", path.c_str(), strerror(errno)));
+    exit_target(EXIT_FAILURE);
+  }
+  if (st.st_size == 0) {
+    map(sizeof(CoverageMapHeader));
+    auto *header = get_header();
+    memcpy(header->magic, "RCOV", sizeof(header->magic));
+    header->version = COVERAGE_MAP_VERSION;
+    header->dimm_id = dimm_id;
+    header->num_banks = num_banks;
+    header->rows_per_bank = rows_per_bank;
+    header->num_entries = 0;
+    Logger::log_info(format_string("Created coverage map %s.", path.c_str()));
+    return;
+  }
+
+  map(std::max(static_cast<size_t>(st.st_size), sizeof(CoverageMapHeader)));
+  const auto *header = get_header();
+  if (memcmp(header->magic, "RCOV", sizeof(header->magic)) != 0 || header->version != COVERAGE_MAP_VERSION) {
+    Logger::log_error(format_string("%s is not a valid coverage map.", path.c_str()));
+    exit_target(EXIT_FAILURE);
+  }
+  if (header->dimm_id != dimm_id || header->num_banks != num_banks || header->rows_per_bank != rows_per_bank) {
+    Logger::log_error(format_string("Coverage map %s was created for DIMM %ld with %lu banks of %lu rows, but this is "
+                                    "DIMM %ld with %zu banks of %zu rows.", path.c_str(), header->dimm_id,
+                                    header->num_banks, header->rows_per_bank, dimm_id, num_banks, rows_per_bank));
+    exit_target(EXIT_FAILURE);
+  }
+  // an entry that was being added during a crash is not counted in the header yet and is overwritten later on
+  if (get_entry_offset(header->num_entries) > data_size) {
+    Logger::log_error(format_string("Coverage map %s is truncated.", path.c_str()));
+    exit_target(EXIT_FAILURE);
+  }
+  for (size_t i = 0; i < header->num_entries; ++i) {
+    const auto &entry = get_entry(i);
+    slots[std::string(entry.pattern_id, strnlen(entry.pattern_id, sizeof(entry.pattern_id))) + "/"
+        + std::string(entry.mapping_id, strnlen(entry.mapping_id, sizeof(entry.mapping_id)))] = i;
+  }
+  Logger::log_info(format_string("Loaded coverage map %s with %zu (pattern, mapping) entries.",
+                                 path.c_str(), slots.size()));
+}
+
+bool CoverageMap::is_open() const {
+  return data != nullptr;
+}
+
+size_t CoverageMap::get_slot(const std::string &pattern_id, const std::string &mapping_id) {
+  const auto key = pattern_id.substr(0, sizeof(CoverageMapEntry::pattern_id)) + "/"
+      + mapping_id.substr(0, sizeof(CoverageMapEntry::mapping_id));
+  auto it = slots.find(key);
+  if (it != slots.end()) return it->second;
+
+  // the new entry and its bitmaps are zero-filled by growing the file
+  const auto slot = static_cast<size_t>(get_header()->num_entries);
+  map(get_entry_offset(slot + 1));
+  auto *entry = reinterpret_cast<CoverageMapEntry *>(data + get_entry_offset(slot));
+  memset(data + get_entry_offset(slot), 0, get_entry_offset(slot + 1) - get_entry_offset(slot));
+  strncpy(entry->pattern_id, pattern_id.c_str(), sizeof(entry->pattern_id));
+  strncpy(entry->mapping_id, mapping_id.c_str(), sizeof(entry->mapping_id));
+  get_header()->num_entries = slot + 1;
+  slots[key] = slot;
+  return slot;
+}
+
+const CoverageMapEntry &CoverageMap::get_entry(size_t slot) const {
+  return *reinterpret_cast<const CoverageMapEntry *>(data + get_entry_offset(slot));
+}
+
+bool CoverageMap::is_covered(size_t slot, size_t bank, size_t row) const {
+  const auto idx = get_bit_index(bank, row);
+  const auto *covered = data + get_entry_offset(slot) + sizeof(CoverageMapEntry);
+  return (covered[idx/8] >> (idx%8)) & 1;
+}
+
+bool CoverageMap::has_flipped(size_t slot, size_t bank, size_t row) const {
+  const auto idx = get_bit_index(bank, row);
+  const auto *flipped = data + get_entry_offset(slot) + sizeof(CoverageMapEntry) + bitmap_size;
+  return (flipped[idx/8] >> (idx%8)) & 1;
+}
+
+void CoverageMap::mark(size_t slot, size_t bank, size_t row, size_t num_bitflips) {
+  const auto idx = get_bit_index(bank, row);
+  auto *entry = reinterpret_cast<CoverageMapEntry *>(data + get_entry_offset(slot));
+  auto *covered = data + get_entry_offset(slot) + sizeof(CoverageMapEntry);
+  auto *flipped = covered + bitmap_size;
+  const auto mask = static_cast<uint8_t>(1U << (idx%8));
+  if (!(covered[idx/8] & mask)) {
+    covered[idx/8] |= mask;
+    entry->num_covered++;
+  }
+  if (num_bitflips > 0 && !(flipped[idx/8] & mask)) {
+    flipped[idx/8] |= mask;
+    entry->num_flipped++;
+  }
+  entry->num_bitflips += num_bitflips;
+}
+
+double CoverageMap::get_covered_fraction(size_t slot) const {
+  const auto *header = get_header();
+  return static_cast<double>(get_entry(slot).num_covered)/static_cast<double>(header->num_banks*header->rows_per_bank);
+}
+
+void CoverageMap::sync() {
+  if (data == nullptr) return;
+  if (msync(data, data_size, MS_SYNC) != 0) {
+    Logger::log_error(format_string("Could not sync coverage map %s: %s", filepath.c_str(), strerror(errno)));
+  }
+}
+
+void CoverageMap::close() {
+  if (data != nullptr) {
+    msync(data, data_size, MS_SYNC);
+    munmap(data, data_size);
+  }
+  if (fd != -1) ::close(fd);
+  fd = -1;
+  data = nullptr;
+  data_size = 0;
+  slots.clear();
+}
@@ -1,5 +1,18 @@
 #include "Utilities/CustomRandom.hpp"
 
+#include <sstream>
+
 CustomRandom::CustomRandom() {
   gen = std::mt19937((PSEUDORANDOM) ? SEED : std::random_device{}());
 }
+
+std::string CustomRandom::get_state() const {
+  std::ostringstream oss;
+  oss << gen;
+  return oss.str();
+}
+
+void CustomRandom::set_state(const std::string &state) {
+  std::istringstream iss(state);
+  iss >> gen;
+}
@@ -0,0 +1,115 @@
+#include "Utilities/DurableLog.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <unistd.h>
+
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+
+DurableLog::DurableLog(size_t sync_every_lines, int64_t sync_every_sec)
+    : sync_every_lines(sync_every_lines), sync_every_sec(sync_every_sec) {
+}
+
+DurableLog::~DurableLog() {
+  close();
+}
+
+void DurableLog::open(const std::string &path) {
+  close();
+  fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd == -1) {
+    Logger::log_error(format_string("Could not open %s for appending: %s", path.c_str(), strerror(errno)));
+    exit_target(EXIT_FAILURE);
+  }
+  filepath = path;
+  drop_partial_line();
+  num_unsynced = 0;
+  last_sync_ts = get_timestamp_sec();
+}
+
+void DurableLog::drop_partial_line() {
+  // find the end of the last complete line by scanning backwards from the end of the file
+  off_t end = ::lseek(fd, 0, SEEK_END);
+  off_t pos = end;
+  char buf[4096];
+  while (pos > 0) {
+    const auto len = static_cast<size_t>(std::min<off_t>(pos, sizeof(buf)));
+    if (::pread(fd, buf, len, pos - static_cast<off_t>(len)) != static_cast<ssize_t>(len)) return;
+    for (size_t i = len; i > 0; --i) {
+      if (buf[i - 1] == '\n') {
+        pos -= static_cast<off_t>(len - i);
+        goto found;
+      }
+    }
+    pos -= static_cast<off_t>(len);
+  }
+  found:
+  if (pos == end) return;
+  Logger::log_info(format_string("Dropping %ld bytes of an incomplete record at the end of %s.",
+                                 static_cast<long>(end - pos), filepath.c_str()));
+  if (::ftruncate(fd, pos) != 0) {
+    Logger::log_error(format_string("Could not truncate %s: %s", filepath.c_str(), strerror(errno)));
+    exit_target(EXIT_FAILURE);
+  }
+}
+
+bool DurableLog::is_open() const {
+  return fd != -1;
+}
+
+void DurableLog::append(const std::string &line, bool force_sync) {
+  if (fd == -1) return;
+
+  // write the line including its newline at once so that a crash can only leave a partial last line behind
+  std::string buf = line;
+  buf.push_back('\n');
+  const char *ptr = buf.data();
+  size_t remaining = buf.size();
+  while (remaining > 0) {
+    auto written = ::write(fd, ptr, remaining);
+    if (written == -1) {
+      if (errno == EINTR) continue;
+      Logger::log_error(format_string("Could not append to %s: %s", filepath.c_str(), strerror(errno)));
+      return;
+    }
+    ptr += written;
+    remaining -= static_cast<size_t>(written);
+  }
+
+  num_unsynced++;
+  if (force_sync || num_unsynced >= sync_every_lines || (get_timestamp_sec() - last_sync_ts) >= sync_every_sec) {
+    sync();
+  }
+}
+
+void DurableLog::sync() {
+  if (fd == -1 || num_unsynced == 0) return;
+  if (::fdatasync(fd) != 0) {
+    Logger::log_error(format_string("Could not sync %s: %s", filepath.c_str(), strerror(errno)));
+  }
+  num_unsynced = 0;
+  last_sync_ts = get_timestamp_sec();
+}
+
+void DurableLog::close() {
+  if (fd == -1) return;
+  sync();
+  ::close(fd);
+  fd = -1;
+}
+
+size_t DurableLog::read_lines(const std::string &path, const std::function<void(const std::string &)> &fn) {
+  std::ifstream ifs(path);
+  if (!ifs.is_open()) return 0;
+  std::string line;
+  while (std::getline(ifs, line)) {
+    // getline also returns the last line if it is not terminated by a newline, i.e., if it was cut off
+    if (ifs.eof()) return line.size();
+    if (!line.empty()) fn(line);
+  }
+  return 0;
+}
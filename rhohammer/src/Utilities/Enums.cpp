@@ -43,6 +43,42 @@ void from_string(const std::string &strategy, FENCING_STRATEGY &dest) {
   dest = map.at(strategy);
 }
 
+std::string to_string(HAMMERING_KERNEL kernel) {
+  std::map<HAMMERING_KERNEL, std::string> map =
+      {
+          {HAMMERING_KERNEL::JITTED, "JITTED"},
+          {HAMMERING_KERNEL::UNJITTED, "UNJITTED"}
+      };
+  return map.at(kernel);
+}
+
+void from_string(const std::string &kernel, HAMMERING_KERNEL &dest) {
+  std::map<std::string, HAMMERING_KERNEL> map =
+      {
+          {"JITTED", HAMMERING_KERNEL::JITTED},
+          {"UNJITTED", HAMMERING_KERNEL::UNJITTED}
+      };
+  dest = map.at(kernel);
+}
+
+std::string to_string(RESULT_FORMAT format) {
+  std::map<RESULT_FORMAT, std::string> map =
+      {
+          {RESULT_FORMAT::JSONL, "jsonl"},
+          {RESULT_FORMAT::BINARY, "binary"}
+      };
+  return map.at(format);
+}
+
+void from_string(const std::string &format, RESULT_FORMAT &dest) {
+  std::map<std::string, RESULT_FORMAT> map =
+      {
+          {"jsonl", RESULT_FORMAT::JSONL},
+          {"binary", RESULT_FORMAT::BINARY}
+      };
+  dest = map.at(format);
+}
+
 [[maybe_unused]] std::pair<FLUSHING_STRATEGY, FENCING_STRATEGY> get_valid_strategy_pair(std::mt19937 &gen) {
   auto valid_strategies = get_valid_strategies();
   auto strategy_idx = Range<size_t>(0, valid_strategies.size() - 1).get_random_number(gen);
@@ -1,27 +1,70 @@
 #include "Utilities/ExperimentConfig.hpp"
 
+#include <algorithm>
+
 #include <yaml-cpp/yaml.h>
 
-ExperimentConfig::ExperimentConfig(const std::string &filepath, size_t config_id) : filepath(filepath) {
-  YAML::Node config = YAML::LoadFile(filepath);
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
 
-  for (const auto &cfg : config["experiment_configs"]) {
-    if (cfg["config_id"].as<size_t>() == config_id) {
-      this->config_id = config_id;
-      exec_mode = get_exec_mode_from_string(cfg["execution_mode"].as<std::string>());
-      num_measurement_reps = cfg["num_measurement_rounds"].as<size_t>();
-      num_sync_rows = cfg["num_sync_rows"].as<size_t>();
-      row_distance = cfg["row_distance"].as<size_t>();
-      row_origin_same_bg = cfg["row_origin"]["same_bg"].as<bool>();
-      row_origin_same_bk = cfg["row_origin"]["same_bk"].as<bool>();
-      break;
+// overrides the parameters of exp_cfg that are present in the given YAML map
+static void parse_config(const YAML::Node &cfg, ExperimentConfig &exp_cfg) {
+  for (const auto &kv : cfg) {
+    const auto key = kv.first.as<std::string>();
+    const auto &value = kv.second;
+    if (key == "config_id") {
+      exp_cfg.config_id = value.as<size_t>();
+    } else if (key == "execution_mode") {
+      const auto mode = value.as<std::string>();
+      if (mode != "BATCHED" && mode != "ALTERNATING") {
+        Logger::log_error(format_string("Unknown execution_mode '%s' in %s, must be BATCHED or ALTERNATING.",
+                                        mode.c_str(), exp_cfg.filepath.c_str()));
+        exit_target(EXIT_FAILURE);
+      }
+      exp_cfg.exec_mode = get_exec_mode_from_string(mode);
+    } else if (key == "num_measurement_rounds") {
+      exp_cfg.num_measurement_rounds = value.as<size_t>();
+    } else if (key == "num_measurement_reps") {
+      exp_cfg.num_measurement_reps = value.as<size_t>();
+    } else if (key == "num_accesses_per_round") {
+      exp_cfg.num_accesses_per_round = value.as<size_t>();
+    } else if (key == "num_sync_rows") {
+      exp_cfg.num_sync_rows = value.as<size_t>();
+    } else if (key == "row_distance") {
+      exp_cfg.row_distance = value.as<size_t>();
+    } else if (key == "min_ref_thresh") {
+      exp_cfg.min_ref_thresh = value.as<size_t>();
+    } else if (key == "row_origin") {
+      if (value["same_bg"]) exp_cfg.row_origin_same_bg = value["same_bg"].as<bool>();
+      if (value["same_bk"]) exp_cfg.row_origin_same_bk = value["same_bk"].as<bool>();
+    } else {
+      Logger::log_error(format_string("Unknown experiment parameter '%s' in %s.", key.c_str(), exp_cfg.filepath.c_str()));
+      exit_target(EXIT_FAILURE);
     }
   }
 }
 
+static YAML::Node load_file(const std::string &filepath) {
+  try {
+    return YAML::LoadFile(filepath);
+  } catch (const YAML::Exception &e) {
+    Logger::log_error(format_string("Could not load experiment configs %s: %s", filepath.c_str(), e.what()));
+    exit_target(EXIT_FAILURE);
+  }
+}
+
+ExperimentConfig::ExperimentConfig(const std::string &filepath, size_t config_id) : filepath(filepath) {
+  auto configs = load_all(filepath, static_cast<int>(config_id));
+  if (configs.empty()) {
+    Logger::log_error(format_string("%s does not contain an experiment config with ID %zu.", filepath.c_str(), config_id));
+    exit_target(EXIT_FAILURE);
+  }
+  *this = configs.front();
+}
+
 ExperimentConfig::ExperimentConfig(execution_mode ExecMode,
-                                   size_t NumMeasurementReps,
                                    size_t NumMeasurementRounds,
+                                   size_t NumMeasurementReps,
                                    size_t NumAccessesPerRound,
                                    size_t NumSyncRows,
                                    size_t RowDistance,
@@ -31,3 +74,74 @@ ExperimentConfig::ExperimentConfig(execution_mode ExecMode,
     : config_id(0), exec_mode(ExecMode), num_measurement_rounds(NumMeasurementRounds), num_measurement_reps(NumMeasurementReps), num_accesses_per_round(NumAccessesPerRound), num_sync_rows(NumSyncRows),
       row_distance(RowDistance), min_ref_thresh(MinRefThresh), row_origin_same_bg(RowOriginSameBg), row_origin_same_bk(RowOriginSameBk) {
 }
+
+std::vector<ExperimentConfig> ExperimentConfig::load_all(const std::string &filepath, int config_id) {
+  const auto config = load_file(filepath);
+  std::vector<ExperimentConfig> configs;
+  size_t next_id = 0;
+
+  for (const auto &cfg : config["experiment_configs"]) {
+    ExperimentConfig exp_cfg;
+    exp_cfg.filepath = filepath;
+    exp_cfg.config_id = next_id;
+    parse_config(cfg, exp_cfg);
+    next_id = std::max(next_id, exp_cfg.config_id + 1);
+    configs.push_back(exp_cfg);
+  }
+
+  // the matrix maps each parameter to a value or a list of values; its configs are numbered after the listed ones
+  const auto matrix = config["matrix"];
+  if (matrix && matrix.IsMap()) {
+    std::vector<std::pair<std::string, std::vector<YAML::Node>>> params;
+    for (const auto &kv : matrix) {
+      std::vector<YAML::Node> values;
+      if (kv.second.IsSequence()) {
+        for (const auto &v : kv.second) values.push_back(v);
+      } else {
+        values.push_back(kv.second);
+      }
+      if (values.empty()) {
+        Logger::log_error(format_string("Matrix parameter '%s' in %s has no values.",
+                                        kv.first.as<std::string>().c_str(), filepath.c_str()));
+        exit_target(EXIT_FAILURE);
+      }
+      params.emplace_back(kv.first.as<std::string>(), values);
+    }
+
+    // count through all combinations, the last parameter changes fastest
+    std::vector<size_t> indices(params.size(), 0);
+    while (true) {
+      YAML::Node cfg;
+      for (size_t i = 0; i < params.size(); ++i) cfg[params[i].first] = params[i].second[indices[i]];
+      ExperimentConfig exp_cfg;
+      exp_cfg.filepath = filepath;
+      parse_config(cfg, exp_cfg);
+      exp_cfg.config_id = next_id++;
+      configs.push_back(exp_cfg);
+
+      size_t i = params.size();
+      while (i > 0 && ++indices[i - 1] == params[i - 1].second.size()) {
+        indices[i - 1] = 0;
+        i--;
+      }
+      if (i == 0) break;
+    }
+  }
+
+  if (config_id != -1) {
+    std::erase_if(configs, [config_id](const ExperimentConfig &c) {
+      return c.config_id != static_cast<size_t>(config_id);
+    });
+  }
+  Logger::log_debug(format_string("Loaded %zu experiment configs from %s.", configs.size(), filepath.c_str()));
+  return configs;
+}
+
+std::string ExperimentConfig::to_string() const {
+  return format_string("#%zu: %s, %zu rounds x %zu reps of %zu accesses, %zu rows apart (same bg: %s, same bk: %s), "
+                       "%zu sync rows, REF threshold >= %zu",
+                       config_id, get_string_from_execution_mode(exec_mode).c_str(), num_measurement_rounds,
+                       num_measurement_reps, num_accesses_per_round, row_distance,
+                       row_origin_same_bg ? "yes" : "no", row_origin_same_bk ? "yes" : "no", num_sync_rows,
+                       min_ref_thresh);
+}
@@ -0,0 +1,104 @@
+#include "Utilities/FlipAggregator.hpp"
+
+#include <algorithm>
+
+FlipAggregator::FlipAggregator(size_t rows_per_bank, size_t top_k)
+    : row_bucket_width(std::max<size_t>(1, (rows_per_bank + NUM_ROW_BUCKETS - 1)/NUM_ROW_BUCKETS)), top_k(top_k) {
+  monitored_rows.reserve(NUM_MONITORED_ROWS);
+}
+
+uint64_t FlipAggregator::get_row_key(size_t bankgroup, size_t bank, size_t row) {
+  return (static_cast<uint64_t>(bankgroup) << 48) | (static_cast<uint64_t>(bank) << 40) | row;
+}
+
+void FlipAggregator::count_row(size_t bankgroup, size_t bank, size_t row, uint64_t num_bits) {
+  const auto key = get_row_key(bankgroup, bank, row);
+  auto it = monitored_row_idx.find(key);
+  if (it != monitored_row_idx.end()) {
+    monitored_rows[it->second].count += num_bits;
+    return;
+  }
+  if (monitored_rows.size() < NUM_MONITORED_ROWS) {
+    monitored_row_idx[key] = monitored_rows.size();
+    monitored_rows.push_back({bankgroup, bank, row, num_bits, 0});
+    return;
+  }
+  // replace the row with the smallest count, the new row inherits its count as error
+  auto min_it = std::min_element(monitored_rows.begin(), monitored_rows.end(),
+                                 [](const RowCounter &a, const RowCounter &b) { return a.count < b.count; });
+  monitored_row_idx.erase(get_row_key(min_it->bankgroup, min_it->bank, min_it->row));
+  monitored_row_idx[key] = static_cast<size_t>(min_it - monitored_rows.begin());
+  *min_it = {bankgroup, bank, row, min_it->count + num_bits, min_it->count};
+}
+
+void FlipAggregator::record(const BitFlip &flip) {
+  const auto num_bits = static_cast<uint64_t>(flip.count_bit_corruptions());
+  num_flipped_bytes++;
+  num_flipped_bits += num_bits;
+  num_z2o += flip.count_z2o_corruptions();
+  num_o2z += flip.count_o2z_corruptions();
+
+  for (size_t bit = 0; bit < by_bit.size(); ++bit) {
+    if (flip.bitmask & (1U << bit)) by_bit[bit]++;
+  }
+  by_byte_offset[reinterpret_cast<uintptr_t>(flip.address.to_virt())%by_byte_offset.size()] += num_bits;
+
+  const auto bankgroup = std::min(flip.address.get_bankgroup(), MAX_BANKGROUPS - 1);
+  const auto bank = std::min(flip.address.get_bank(), MAX_BANKS - 1);
+  const auto row = flip.address.get_row();
+  by_bankgroup[bankgroup] += num_bits;
+  by_bank[bankgroup][bank] += num_bits;
+  by_row[std::min(row/row_bucket_width, NUM_ROW_BUCKETS - 1)] += num_bits;
+  count_row(bankgroup, bank, row, num_bits);
+}
+
+uint64_t FlipAggregator::get_num_flipped_bytes() const {
+  return num_flipped_bytes;
+}
+
+uint64_t FlipAggregator::get_num_flipped_bits() const {
+  return num_flipped_bits;
+}
+
+#ifdef ENABLE_JSON
+
+nlohmann::json FlipAggregator::to_json() const {
+  // only export non-empty bank and row buckets to keep the summary small
+  nlohmann::json j_banks = nlohmann::json::array();
+  for (size_t bg = 0; bg < MAX_BANKGROUPS; ++bg) {
+    for (size_t bk = 0; bk < MAX_BANKS; ++bk) {
+      if (by_bank[bg][bk] == 0) continue;
+      j_banks.push_back({{"bankgroup", bg}, {"bank", bk}, {"flips", by_bank[bg][bk]}});
+    }
+  }
+  nlohmann::json j_rows = nlohmann::json::array();
+  for (size_t i = 0; i < by_row.size(); ++i) {
+    if (by_row[i] == 0) continue;
+    j_rows.push_back({i*row_bucket_width, by_row[i]});
+  }
+
+  auto top_rows = monitored_rows;
+  const auto k = std::min(top_k, top_rows.size());
+  std::partial_sort(top_rows.begin(), top_rows.begin() + static_cast<long>(k), top_rows.end(),
+                    [](const RowCounter &a, const RowCounter &b) { return a.count > b.count; });
+  nlohmann::json j_top_rows = nlohmann::json::array();
+  for (size_t i = 0; i < k; ++i) {
+    const auto &r = top_rows[i];
+    j_top_rows.push_back({{"bankgroup", r.bankgroup}, {"bank", r.bank}, {"row", r.row}, {"flips", r.count},
+                          {"max_error", r.error}});
+  }
+
+  return nlohmann::json{{"flipped_bytes", num_flipped_bytes},
+                        {"flipped_bits", num_flipped_bits},
+                        {"zero_to_one", num_z2o},
+                        {"one_to_zero", num_o2z},
+                        {"by_bit", by_bit},
+                        {"by_byte_offset", by_byte_offset},
+                        {"by_bankgroup", by_bankgroup},
+                        {"by_bank", j_banks},
+                        {"by_row", {{"bucket_width", row_bucket_width}, {"buckets", j_rows}}},
+                        {"top_rows", j_top_rows}
+  };
+}
+
+#endif
@@ -1,22 +1,35 @@
 #include "Utilities/Helper.hpp"
 #include "Utilities/Logger.hpp"
+#include "Utilities/AsmPrimitives.hpp"
 
 #include <cinttypes>
+#include <csignal>
 #include <vector>
 #include <cmath>
-#include <unordered_map>
-#include <algorithm>
-#include <numeric>
-
-double calc_std(std::vector <uint64_t> &values, double mean, size_t num_numbers) {
-  double var = 0;
-  for (const auto &num : values) {
-    if (static_cast<double>(num) < mean)
-      continue;
-    var += std::pow(static_cast<double>(num) - mean, 2);
-  }
-  auto val = std::sqrt(var / static_cast<double>(num_numbers));
-  return val;
+
+thread_local bool is_campaign_worker = false;
+
+void exit_target(int status) {
+  if (is_campaign_worker) throw TargetExit(status);
+  exit(status);
+}
+
+// set by SIGINT/SIGTERM, shared by all workers of a campaign
+static volatile sig_atomic_t stop_requested = 0;
+
+static void request_stop(int sig) {
+  stop_requested = 1;
+  // a second signal terminates immediately
+  signal(sig, SIG_DFL);
+}
+
+void install_stop_handler() {
+  signal(SIGINT, request_stop);
+  signal(SIGTERM, request_stop);
+}
+
+bool is_stop_requested() {
+  return stop_requested != 0;
 }
 
 int64_t get_timestamp_sec() {
@@ -29,44 +42,53 @@ int64_t get_timestamp_us() {
       std::chrono::system_clock::now().time_since_epoch()).count();
 }
 
-void calculate_statistics(std::vector<uint64_t> &vec, statistics &stats) {
-  stats.min = *std::min_element(vec.begin(), vec.end());
-  stats.max = *std::max_element(vec.begin(), vec.end());
-  auto avg = static_cast<double>(std::accumulate(vec.begin(), vec.end(), 0UL)/static_cast<double>(vec.size()));
-  stats.avg = static_cast<uint64_t>(avg);
-  stats.std = static_cast<uint64_t>(calc_std(vec, static_cast<double>(stats.avg), vec.size()));
-  stats.median = median<uint64_t>(vec);
-
-  size_t max_cnt = 0;
-  size_t mf_val;
-  std::unordered_map<uint64_t,uint64_t> val2cnt;
-  for (const auto &v : vec) {
-    val2cnt[v]++;
-    if (val2cnt[v] > max_cnt) {
-      max_cnt = val2cnt[v];
-      mf_val = v;
-    }
-  }
-  stats.most_frequent = mf_val;
+double get_tsc_cycles_per_ns() {
+  // the campaign workers may call this concurrently, the initialization of a function-local static is thread-safe
+  static const double cycles_per_ns = []() {
+    // busy-wait for ~20 ms and compare the elapsed TSC cycles with the elapsed wall clock time
+    auto now_ns = []() {
+      struct timespec ts{};
+      clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+      return static_cast<uint64_t>(ts.tv_sec)*1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    };
+    const uint64_t ns_start = now_ns();
+    const uint64_t tsc_start = rdtscp();
+    uint64_t ns_end;
+    do {
+      ns_end = now_ns();
+    } while (ns_end - ns_start < 20*1000*1000);
+    const uint64_t tsc_end = rdtscp();
+
+    const auto calibrated = static_cast<double>(tsc_end - tsc_start)/static_cast<double>(ns_end - ns_start);
+    Logger::log_info(format_string("Calibrated TSC frequency: %.3f GHz.", calibrated));
+    return calibrated;
+  }();
+  return cycles_per_ns;
+}
+
+double tsc_to_ns(uint64_t tsc_cycles) {
+  return static_cast<double>(tsc_cycles)/get_tsc_cycles_per_ns();
 }
 
-template<typename T>
-T median(std::vector<T> &v) {
-  if (v.empty()) {
-    return 0.0;
-  }
-  auto n = v.size() / 2;
-  nth_element(v.begin(), v.begin()+n, v.end());
-  auto med = v[n];
-  // even set size
-  if (!(v.size() & 1)) {
-    auto max_it = max_element(v.begin(), v.begin()+n);
-    med = (*max_it + med) / 2.0;
-  }
-  return static_cast<T>(med);
+void calculate_statistics(const LogLinearHistogram &histogram, statistics &stats) {
+  stats.min = static_cast<uint64_t>(histogram.get_min());
+  stats.max = static_cast<uint64_t>(histogram.get_max());
+  stats.avg = static_cast<uint64_t>(histogram.get_mean());
+  stats.std = static_cast<uint64_t>(histogram.get_stddev());
+  stats.median = static_cast<uint64_t>(histogram.get_quantile(0.5));
+  stats.p99 = static_cast<uint64_t>(histogram.get_quantile(0.99));
+  const auto most_frequent = histogram.get_most_frequent(1);
+  stats.most_frequent = most_frequent.empty() ? 0 : most_frequent.front();
 }
+
+void calculate_statistics(const std::vector<uint64_t> &vec, statistics &stats) {
+  LogLinearHistogram histogram;
+  for (const auto v : vec) histogram.add(static_cast<double>(v));
+  calculate_statistics(histogram, stats);
+}
+
 std::string statistics::to_string() {
-  return format_string("min=%d, max=%d, mf=%d, avg=%d, med=%d, std=%d",
-                       min, max, most_frequent, avg, median, std);
+  return format_string("min=%lu, max=%lu, mf=%lu, avg=%lu, med=%lu, p99=%lu, std=%lu",
+                       min, max, most_frequent, avg, median, p99, std);
 
 }
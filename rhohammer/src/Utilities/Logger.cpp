@@ -5,14 +5,13 @@
 #include <filesystem>
 
 // initialize the singleton instance
-Logger Logger::instance; /* NOLINT */
+thread_local Logger Logger::instance; /* NOLINT */
 
 Logger::Logger() = default;
 
-void Logger::initialize() {
+void Logger::initialize(const std::string &logfile_filename) {
   instance.logfile = std::ofstream();
 
-  std::string logfile_filename = "stdout.log";
   // std::cout << "Writing into logfile " FF_BOLD << logfile_filename << F_RESET << std::endl;
   // we need to open the log file in append mode because the run_benchmark script writes values into it
   instance.logfile.open(logfile_filename, std::ios::out | std::ios::app);
@@ -186,14 +185,16 @@ void Logger::log_metadata(const char *commit_hash, unsigned long run_time_limit_
 }
 
 void Logger::log_global_defines() {
-  Logger::log_info("Printing run configuration (GlobalDefines.hpp):");
+  Logger::log_info("Printing run configuration (GlobalDefines.hpp, RuntimeConfig):");
   std::stringstream ss;
   ss << "HAMMER_ROUNDS: " << (1000000) << "\n"
-     << "THRESH: " << BK_CONF_THRESH << "\n"
-     << "NUM_BANKS: " << NUM_BANKS << "\n"
-     << "NUM_BANKGROUPS: " << NUM_BANKGROUPS << "\n"
-     << "NUM_BANKS_PER_BG: " << NUM_BANKS_PER_BG << "\n"
-     << "NUM_BANKS: " << NUM_BANKS << "\n"
+     << "THRESH: " << runtime_config.bk_conf_thresh << "\n"
+     << "NUM_BANKS: " << runtime_config.num_banks << "\n"
+     << "MULTI_BANK: " << runtime_config.multi_bank << "\n"
+     << "REF_THRESHOLD: " << runtime_config.ref_threshold << "\n"
+     << "HUGEPAGE_NUM: " << runtime_config.hugepage_num << "\n"
+     << "FULL_SWEEP_ROWS: " << runtime_config.full_sweep_rows << "\n"
+     << "DEBUG_MODE: " << runtime_config.debug_mode << "\n"
      << "MEM_SIZE: " << MEM_SIZE << "\n"
      << "PAGE_SIZE: " << getpagesize() << "\n";
   Logger::log_data(ss.str());
@@ -0,0 +1,190 @@
+#include "Utilities/PerfCounterGroup.hpp"
+#include "Utilities/Logger.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+double PerfCounterSample::get_ipc() const {
+  return (cycles == 0) ? 0.0 : static_cast<double>(instructions)/static_cast<double>(cycles);
+}
+
+void PerfCounterSample::accumulate(const PerfCounterSample &other) {
+  if (!other.valid) return;
+  if (!valid) {
+    *this = other;
+    return;
+  }
+  time_enabled += other.time_enabled;
+  time_running += other.time_running;
+  cycles += other.cycles;
+  instructions += other.instructions;
+  l1d_misses += other.l1d_misses;
+  llc_misses += other.llc_misses;
+  if (raw.size() < other.raw.size()) raw.resize(other.raw.size(), 0);
+  for (size_t i = 0; i < other.raw.size(); ++i) raw[i] += other.raw[i];
+}
+
+PerfCounterGroup::PerfCounterGroup(const std::vector<uint64_t> &raw_event_configs)
+    : raw_configs(raw_event_configs) {
+  // the group leader decides whether we can use the PMU at all; retry without kernel counting as unprivileged users
+  // are usually only allowed to count user-space events (perf_event_paranoid >= 2)
+  leader_fd = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+  if (leader_fd == -1 && (errno == EACCES || errno == EPERM)) {
+    exclude_kernel = true;
+    leader_fd = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+  }
+  if (leader_fd == -1) {
+    Logger::log_info(format_string("Hardware performance counters are not available (perf_event_open: %s). "
+                                   "Continuing without them.", strerror(errno)));
+    return;
+  }
+  uint64_t leader_id = 0;
+  ioctl(leader_fd, PERF_EVENT_IOC_ID, &leader_id);
+  events.push_back({EVENT::CYCLES, 0, leader_fd, leader_id});
+
+  add_event(EVENT::INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  add_event(EVENT::L1D_MISSES, PERF_TYPE_HW_CACHE,
+            PERF_COUNT_HW_CACHE_L1D
+                | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+  add_event(EVENT::LLC_MISSES, PERF_TYPE_HW_CACHE,
+            PERF_COUNT_HW_CACHE_LL
+                | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+  // a raw event the PMU rejects is dropped, otherwise it would show up as a counter that is always zero
+  const auto requested_raw_configs = raw_configs;
+  raw_configs.clear();
+  for (const auto config : requested_raw_configs) {
+    if (add_event(EVENT::RAW, PERF_TYPE_RAW, config, raw_configs.size())) {
+      raw_configs.push_back(config);
+    } else {
+      Logger::log_error(format_string("Warning: raw perf event 0x%lx was rejected (%s), it is not counted.",
+                                      config, strerror(errno)));
+    }
+  }
+
+  read_buffer.resize(3 + 2*events.size());
+  Logger::log_info(format_string("Using a group of %zu hardware performance counters%s.",
+                                 events.size(), exclude_kernel ? " (user space only)" : ""));
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+  for (const auto &e : events) {
+    if (e.fd != -1) close(e.fd);
+  }
+}
+
+int PerfCounterGroup::open_event(uint32_t type, uint64_t config, int group_fd) const {
+  struct perf_event_attr pe{};
+  pe.type = type;
+  pe.size = sizeof(struct perf_event_attr);
+  pe.config = config;
+  // only the leader is disabled initially, the other events follow the leader's state
+  pe.disabled = (group_fd == -1) ? 1 : 0;
+  pe.exclude_kernel = exclude_kernel ? 1 : 0;
+  pe.exclude_hv = 1;
+  pe.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID
+      | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(syscall(SYS_perf_event_open, &pe, 0, -1, group_fd, 0));
+}
+
+bool PerfCounterGroup::add_event(EVENT type, uint32_t perf_type, uint64_t config, size_t raw_idx) {
+  int fd = open_event(perf_type, config, leader_fd);
+  if (fd == -1) {
+    Logger::log_debug(format_string("Could not add perf event (type=%u, config=0x%lx) to group: %s",
+                                    perf_type, config, strerror(errno)));
+    return false;
+  }
+  uint64_t id = 0;
+  ioctl(fd, PERF_EVENT_IOC_ID, &id);
+  events.push_back({type, raw_idx, fd, id});
+  return true;
+}
+
+bool PerfCounterGroup::is_available() const {
+  return leader_fd != -1;
+}
+
+const std::vector<uint64_t> &PerfCounterGroup::get_raw_configs() const {
+  return raw_configs;
+}
+
+void PerfCounterGroup::start() {
+  if (leader_fd == -1) return;
+  ioctl(leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounterSample PerfCounterGroup::stop() {
+  PerfCounterSample sample;
+  if (leader_fd == -1) return sample;
+
+  ioctl(leader_fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  auto bytes = read(leader_fd, read_buffer.data(), read_buffer.size()*sizeof(uint64_t));
+  if (bytes < static_cast<ssize_t>(3*sizeof(uint64_t))) return sample;
+
+  const uint64_t nr = read_buffer[0];
+  sample.time_enabled = read_buffer[1];
+  sample.time_running = read_buffer[2];
+  sample.raw.resize(raw_configs.size(), 0);
+
+  // scale the counts if the kernel had to multiplex the PMU
+  const double scale = (sample.time_running == 0)
+                       ? 0.0
+                       : static_cast<double>(sample.time_enabled)/static_cast<double>(sample.time_running);
+
+  for (uint64_t i = 0; i < nr && (3 + 2*i + 1) < read_buffer.size(); ++i) {
+    const auto value = static_cast<uint64_t>(static_cast<double>(read_buffer[3 + 2*i])*scale);
+    const auto id = read_buffer[3 + 2*i + 1];
+    for (const auto &e : events) {
+      if (e.id != id) continue;
+      switch (e.type) {
+        case EVENT::CYCLES: sample.cycles = value; break;
+        case EVENT::INSTRUCTIONS: sample.instructions = value; break;
+        case EVENT::L1D_MISSES:
+          sample.l1d_misses = value;
+          sample.has_l1d_misses = true;
+          break;
+        case EVENT::LLC_MISSES:
+          sample.llc_misses = value;
+          sample.has_llc_misses = true;
+          break;
+        case EVENT::RAW: sample.raw[e.raw_idx] = value; break;
+      }
+      break;
+    }
+  }
+  sample.valid = true;
+  return sample;
+}
+
+#ifdef ENABLE_JSON
+
+void to_json(nlohmann::json &j, const PerfCounterSample &p) {
+  if (!p.valid) {
+    j = nullptr;
+    return;
+  }
+  j = nlohmann::json{{"time_enabled_ns", p.time_enabled},
+                     {"time_running_ns", p.time_running},
+                     {"cycles", p.cycles},
+                     {"instructions", p.instructions},
+                     {"ipc", p.get_ipc()},
+                     {"l1d_misses", p.has_l1d_misses ? nlohmann::json(p.l1d_misses) : nlohmann::json(nullptr)},
+                     {"llc_misses", p.has_llc_misses ? nlohmann::json(p.llc_misses) : nlohmann::json(nullptr)},
+                     {"raw", p.raw}
+  };
+}
+
+void to_json(nlohmann::json &j, const HammerPerfCounters &p) {
+  j = nlohmann::json{{"hammer_pattern", p.hammer_pattern},
+                     {"hammer_pattern_unjitted", p.hammer_pattern_unjitted},
+                     {"check_memory", p.check_memory}
+  };
+}
+
+#endif
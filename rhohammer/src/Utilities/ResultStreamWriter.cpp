@@ -0,0 +1,333 @@
+#include "Utilities/ResultStreamWriter.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+
+// header at the beginning of a result stream in the binary format
+struct ResultStreamHeader {
+  char magic[4];
+  uint32_t version;
+};
+
+static constexpr size_t STREAM_BUFFER_SIZE = 1024*1024;
+
+static constexpr RESULT_RECORD RECORD_TYPES[] = {RESULT_RECORD::METADATA, RESULT_RECORD::PATTERN,
+                                                 RESULT_RECORD::PATTERN_STATS, RESULT_RECORD::SWEEP,
+                                                 RESULT_RECORD::BITFLIP, RESULT_RECORD::END};
+
+std::string to_string(RESULT_RECORD type) {
+  switch (type) {
+    case RESULT_RECORD::METADATA: return "metadata";
+    case RESULT_RECORD::PATTERN: return "pattern";
+    case RESULT_RECORD::PATTERN_STATS: return "pattern_stats";
+    case RESULT_RECORD::SWEEP: return "sweep";
+    case RESULT_RECORD::BITFLIP: return "bitflip";
+    case RESULT_RECORD::END: return "end";
+  }
+  return "unknown";
+}
+
+ResultStreamWriter::ResultStreamWriter() : buffer(STREAM_BUFFER_SIZE), page_size(getpagesize()) {
+}
+
+ResultStreamWriter::~ResultStreamWriter() {
+  close();
+}
+
+std::string ResultStreamWriter::get_extension(RESULT_FORMAT format) {
+  return (format == RESULT_FORMAT::BINARY) ? ".bin" : ".jsonl";
+}
+
+void ResultStreamWriter::open(const std::string &path, RESULT_FORMAT result_format) {
+  close();
+  // the buffer must be installed before opening the file
+  os.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  os.open(path, std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!os.is_open()) {
+    Logger::log_error(format_string("Could not open %s for writing results.", path.c_str()));
+    exit_target(EXIT_FAILURE);
+  }
+  filepath = path;
+  format = result_format;
+  if (format == RESULT_FORMAT::BINARY) {
+    ResultStreamHeader header{};
+    memcpy(header.magic, "RRES", sizeof(header.magic));
+    header.version = 1;
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  }
+}
+
+void ResultStreamWriter::reopen(const std::string &path, RESULT_FORMAT result_format, uint64_t length) {
+  close();
+  if (truncate(path.c_str(), static_cast<off_t>(length)) != 0) {
+    Logger::log_error(format_string("Could not truncate %s to continue writing results: %s", path.c_str(),
+                                    strerror(errno)));
+    exit_target(EXIT_FAILURE);
+  }
+  os.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  os.open(path, std::ios::out | std::ios::app | std::ios::ate | std::ios::binary);
+  if (!os.is_open()) {
+    Logger::log_error(format_string("Could not open %s for writing results.", path.c_str()));
+    exit_target(EXIT_FAILURE);
+  }
+  filepath = path;
+  format = result_format;
+}
+
+bool ResultStreamWriter::is_open() const {
+  return os.is_open();
+}
+
+const std::string &ResultStreamWriter::get_filepath() const {
+  return filepath;
+}
+
+void ResultStreamWriter::write_record(RESULT_RECORD type, const char *payload, uint32_t len) {
+  const auto type_byte = static_cast<uint8_t>(type);
+  os.write(reinterpret_cast<const char *>(&type_byte), sizeof(type_byte));
+  os.write(reinterpret_cast<const char *>(&len), sizeof(len));
+  os.write(payload, len);
+}
+
+void ResultStreamWriter::write_bitflip(uint64_t sweep, const BitFlip &flip) {
+  const auto phys_addr = reinterpret_cast<uint64_t>(flip.address.to_phys_fast());
+  if (format == RESULT_FORMAT::BINARY) {
+    BitFlipRecord rec{};
+    rec.sweep = sweep;
+    rec.phys_addr = phys_addr;
+    rec.observed_at = flip.observation_time;
+    rec.subchannel = static_cast<uint32_t>(flip.address.get_subchan());
+    rec.rank = static_cast<uint32_t>(flip.address.get_rank());
+    rec.bankgroup = static_cast<uint32_t>(flip.address.get_bankgroup());
+    rec.bank = static_cast<uint32_t>(flip.address.get_bank());
+    rec.row = static_cast<uint32_t>(flip.address.get_row());
+    rec.col = static_cast<uint32_t>(flip.address.get_column());
+    rec.bitmask = flip.bitmask;
+    rec.data = flip.corrupted_data;
+    write_record(RESULT_RECORD::BITFLIP, reinterpret_cast<const char *>(&rec), sizeof(rec));
+    return;
+  }
+  // bit flips are by far the most frequent record, hence we format them by hand instead of building a JSON object;
+  // the fields are the same as the ones written by to_json(BitFlip)
+  char line[512];
+  const int len = snprintf(line, sizeof(line),
+                           "{\"type\":\"bitflip\",\"sweep\":%" PRIu64 ",\"dram_addr\":{\"subchannel\":%zu,\"rank\":%zu,"
+                           "\"bankgroup\":%zu,\"bank\":%zu,\"row\":%zu,\"col\":%zu},\"bitmask\":%u,\"data\":%u,"
+                           "\"observed_at\":%" PRId64 ",\"phy_addr\":\"0x%" PRIx64 "\",\"page_offset\":%" PRIu64 "}\n",
+                           sweep,
+                           flip.address.get_subchan(), flip.address.get_rank(), flip.address.get_bankgroup(),
+                           flip.address.get_bank(), flip.address.get_row(), flip.address.get_column(),
+                           static_cast<unsigned>(flip.bitmask), static_cast<unsigned>(flip.corrupted_data),
+                           static_cast<int64_t>(flip.observation_time), phys_addr, phys_addr%page_size);
+  os.write(line, len);
+}
+
+uint64_t ResultStreamWriter::flush() {
+  os.flush();
+  return static_cast<uint64_t>(os.tellp());
+}
+
+void ResultStreamWriter::close() {
+  if (!os.is_open()) return;
+  os.close();
+}
+
+#ifdef ENABLE_JSON
+
+void ResultStreamWriter::write(RESULT_RECORD type, const nlohmann::json &record) {
+  if (format == RESULT_FORMAT::BINARY) {
+    const auto payload = nlohmann::json::to_cbor(record);
+    write_record(type, reinterpret_cast<const char *>(payload.data()), static_cast<uint32_t>(payload.size()));
+  } else {
+    nlohmann::json line = record;
+    line["type"] = to_string(type);
+    os << line.dump() << '\n';
+  }
+  os.flush();
+}
+
+static void bitflip_record_to_json(const BitFlipRecord &rec, nlohmann::json &j) {
+  j = nlohmann::json{{"sweep", rec.sweep},
+                     {"dram_addr", {{"subchannel", rec.subchannel},
+                                    {"rank", rec.rank},
+                                    {"bankgroup", rec.bankgroup},
+                                    {"bank", rec.bank},
+                                    {"row", rec.row},
+                                    {"col", rec.col}}},
+                     {"bitmask", rec.bitmask},
+                     {"data", rec.data},
+                     {"observed_at", rec.observed_at},
+                     {"phy_addr", format_string("0x%" PRIx64, rec.phys_addr)},
+                     {"page_offset", rec.phys_addr%static_cast<uint64_t>(getpagesize())}
+  };
+}
+
+void ResultStreamWriter::read_records(const std::string &path,
+                                      const std::function<void(RESULT_RECORD, nlohmann::json &)> &fn) {
+  std::ifstream is(path, std::ios::in | std::ios::binary);
+  if (!is.is_open()) {
+    Logger::log_error(format_string("Could not open result stream %s.", path.c_str()));
+    return;
+  }
+
+  ResultStreamHeader header{};
+  is.read(reinterpret_cast<char *>(&header), sizeof(header));
+  const bool is_binary = (is.gcount() == sizeof(header) && memcmp(header.magic, "RRES", sizeof(header.magic)) == 0);
+
+  nlohmann::json record;
+  if (!is_binary) {
+    is.clear();
+    is.seekg(0);
+    std::string line;
+    while (std::getline(is, line)) {
+      // a line without a newline at the end of the file was not written completely
+      if (is.eof()) break;
+      record = nlohmann::json::parse(line, nullptr, false);
+      if (record.is_discarded() || !record.is_object() || !record.contains("type") || !record["type"].is_string()) {
+        continue;
+      }
+      // records of unknown types (e.g., written by a newer version) are skipped
+      const auto type_str = record["type"].get<std::string>();
+      const auto *type_it = std::find_if(std::begin(RECORD_TYPES), std::end(RECORD_TYPES),
+                                         [&type_str](RESULT_RECORD t) { return to_string(t) == type_str; });
+      if (type_it == std::end(RECORD_TYPES)) continue;
+      const auto type = *type_it;
+      record.erase("type");
+      fn(type, record);
+    }
+    return;
+  }
+
+  std::vector<uint8_t> payload;
+  while (true) {
+    uint8_t type_byte;
+    uint32_t len;
+    is.read(reinterpret_cast<char *>(&type_byte), sizeof(type_byte));
+    is.read(reinterpret_cast<char *>(&len), sizeof(len));
+    if (!is) break;
+    payload.resize(len);
+    is.read(reinterpret_cast<char *>(payload.data()), len);
+    if (!is) break;
+    // records of unknown types are skipped by their length, which was just read
+    if (std::none_of(std::begin(RECORD_TYPES), std::end(RECORD_TYPES),
+                     [type_byte](RESULT_RECORD t) { return static_cast<uint8_t>(t) == type_byte; })) {
+      continue;
+    }
+    const auto type = static_cast<RESULT_RECORD>(type_byte);
+    if (type == RESULT_RECORD::BITFLIP) {
+      if (len != sizeof(BitFlipRecord)) continue;
+      BitFlipRecord rec{};
+      memcpy(&rec, payload.data(), sizeof(rec));
+      bitflip_record_to_json(rec, record);
+    } else {
+      record = nlohmann::json::from_cbor(payload, true, false);
+      if (record.is_discarded()) continue;
+    }
+    fn(type, record);
+  }
+}
+
+bool ResultStreamWriter::convert(const std::string &stream_path, const std::string &json_path) {
+  // first pass: collect the (small) metadata and end records
+  nlohmann::json meta;
+  nlohmann::json end;
+  size_t num_patterns = 0;
+  read_records(stream_path, [&](RESULT_RECORD type, nlohmann::json &record) {
+    if (type == RESULT_RECORD::METADATA) meta = std::move(record);
+    else if (type == RESULT_RECORD::END) end = std::move(record);
+    else if (type == RESULT_RECORD::PATTERN) num_patterns++;
+  });
+  if (!meta.is_object() || !meta.contains("kind")) {
+    Logger::log_error(format_string("Cannot convert %s as it has no metadata record.", stream_path.c_str()));
+    return false;
+  }
+  const auto kind = meta["kind"].get<std::string>();
+  meta.erase("kind");
+  if (end.is_object()) {
+    for (const auto &[key, value] : end.items()) {
+      if (key != "activation_telemetry") meta[key] = value;
+    }
+  } else {
+    Logger::log_info(format_string("%s has no end record, the run was probably interrupted.", stream_path.c_str()));
+  }
+  if (kind == "fuzz") meta["num_patterns"] = num_patterns;
+
+  std::ofstream os(json_path);
+  if (!os.is_open()) {
+    Logger::log_error(format_string("Could not open %s for writing.", json_path.c_str()));
+    return false;
+  }
+  os << "{\"metadata\":" << meta.dump();
+
+  // writes all records of the given type as a JSON array, one pass over the stream for each array
+  auto write_array = [&](const char *key, RESULT_RECORD wanted, const char *field) {
+    os << ",\"" << key << "\":[";
+    bool first = true;
+    read_records(stream_path, [&](RESULT_RECORD type, nlohmann::json &record) {
+      if (type != wanted) return;
+      os << (first ? "" : ",") << record[field].dump();
+      first = false;
+    });
+    os << "]";
+  };
+
+  if (kind == "fuzz") {
+    write_array("hammering_patterns", RESULT_RECORD::PATTERN, "pattern");
+    write_array("pattern_stats", RESULT_RECORD::PATTERN_STATS, "stats");
+  } else {
+    // the bit flips of a sweep are written before its summary, so we open the sweep's entry with its "details" when we
+    // see its first bit flip and add the remaining fields when its summary arrives
+    os << ",\"sweeps\":[";
+    bool first_sweep = true;
+    bool in_sweep = false;
+    bool first_flip = true;
+    auto open_sweep = [&]() {
+      os << (first_sweep ? "" : ",") << "{\"flips\":{\"details\":[";
+      first_sweep = false;
+      first_flip = true;
+      in_sweep = true;
+    };
+    read_records(stream_path, [&](RESULT_RECORD type, nlohmann::json &record) {
+      if (type == RESULT_RECORD::BITFLIP) {
+        if (!in_sweep) open_sweep();
+        record.erase("sweep");
+        os << (first_flip ? "" : ",") << record.dump();
+        first_flip = false;
+      } else if (type == RESULT_RECORD::SWEEP) {
+        if (!in_sweep) open_sweep();
+        os << "]";
+        for (const auto &[key, value] : record["flips"].items()) {
+          os << "," << nlohmann::json(key).dump() << ":" << value.dump();
+        }
+        os << "}";
+        for (const auto &[key, value] : record.items()) {
+          if (key == "flips" || key == "sweep") continue;
+          os << "," << nlohmann::json(key).dump() << ":" << value.dump();
+        }
+        os << "}";
+        in_sweep = false;
+      }
+    });
+    if (in_sweep) {
+      // the run was interrupted during this sweep, keep the bit flips observed so far
+      os << "]}}";
+    }
+    os << "]";
+  }
+
+  const bool has_telemetry = end.is_object() && end.contains("activation_telemetry");
+  os << ",\"activation_telemetry\":" << (has_telemetry ? end["activation_telemetry"] : nlohmann::json()).dump()
+     << "}\n";
+  os.close();
+  Logger::log_info(format_string("Converted %s into %s.", stream_path.c_str(), json_path.c_str()));
+  return true;
+}
+
+#endif
@@ -0,0 +1,62 @@
+#include "Utilities/RuntimeConfig.hpp"
+
+#include <yaml-cpp/yaml.h>
+
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+
+thread_local RuntimeConfig runtime_config;
+
+void RuntimeConfig::load_yaml(const std::string &filepath) {
+  YAML::Node config;
+  try {
+    config = YAML::LoadFile(filepath);
+  } catch (const YAML::Exception &e) {
+    Logger::log_error(format_string("Could not load config file %s: %s", filepath.c_str(), e.what()));
+    exit_target(EXIT_FAILURE);
+  }
+
+  if (config["multi_bank"]) multi_bank = config["multi_bank"].as<int>();
+  if (config["ref_threshold"]) ref_threshold = config["ref_threshold"].as<long>();
+  if (config["hugepage_num"]) hugepage_num = config["hugepage_num"].as<int>();
+  if (config["debug_mode"]) debug_mode = config["debug_mode"].as<bool>();
+  if (config["num_banks"]) num_banks = config["num_banks"].as<size_t>();
+  if (config["bk_conf_thresh"]) bk_conf_thresh = config["bk_conf_thresh"].as<size_t>();
+  if (config["full_sweep_rows"]) full_sweep_rows = config["full_sweep_rows"].as<size_t>();
+  if (config["sweep_log_every"]) sweep_log_every = config["sweep_log_every"].as<size_t>();
+  if (config["calibration_confidence"]) calibration_confidence = config["calibration_confidence"].as<double>();
+  if (config["calibration_precision"]) calibration_precision = config["calibration_precision"].as<double>();
+  if (config["calibration_max_age"]) calibration_max_age = config["calibration_max_age"].as<long>();
+  Logger::log_debug(format_string("Loaded run configuration from %s.", filepath.c_str()));
+}
+
+void RuntimeConfig::validate() const {
+  if (multi_bank < 1 || multi_bank > MAX_MULTI_BANK) {
+    Logger::log_error(format_string("multi_bank must be in [1, %d] but is %d.", MAX_MULTI_BANK, multi_bank));
+    exit_target(EXIT_FAILURE);
+  }
+  if (ref_threshold < -1 || ref_threshold == 0) {
+    Logger::log_error(format_string("ref_threshold must be -1 (calibrate) or positive but is %ld.", ref_threshold));
+    exit_target(EXIT_FAILURE);
+  }
+  if (num_banks == 0) {
+    Logger::log_error("num_banks must be positive.");
+    exit_target(EXIT_FAILURE);
+  }
+  if (sweep_log_every == 0) {
+    Logger::log_error("sweep_log_every must be positive.");
+    exit_target(EXIT_FAILURE);
+  }
+  if (calibration_confidence <= 0 || calibration_confidence >= 1) {
+    Logger::log_error(format_string("calibration_confidence must be in (0, 1) but is %f.", calibration_confidence));
+    exit_target(EXIT_FAILURE);
+  }
+  if (calibration_max_age < 0) {
+    Logger::log_error(format_string("calibration_max_age must not be negative but is %ld.", calibration_max_age));
+    exit_target(EXIT_FAILURE);
+  }
+  if (calibration_precision <= 0) {
+    Logger::log_error(format_string("calibration_precision must be positive but is %f.", calibration_precision));
+    exit_target(EXIT_FAILURE);
+  }
+}
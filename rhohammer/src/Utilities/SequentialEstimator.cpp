@@ -0,0 +1,97 @@
+#include "Utilities/SequentialEstimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+
+// the z such that a standard normal variable is within [-z, z] with the given probability
+static double get_normal_quantile(double confidence) {
+  double lo = 0;
+  double hi = 10;
+  for (int i = 0; i < 64; ++i) {
+    const auto mid = (lo + hi)/2;
+    if (std::erf(mid/std::sqrt(2.0)) < confidence) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return (lo + hi)/2;
+}
+
+SequentialEstimator::SequentialEstimator(double confidence, double rel_precision, size_t min_samples,
+                                         size_t max_samples)
+    : confidence(confidence), rel_precision(rel_precision), min_samples(std::max<size_t>(2, min_samples)),
+      max_samples(std::max(max_samples, std::max<size_t>(2, min_samples))), z(get_normal_quantile(confidence)) {
+  if (confidence <= 0 || confidence >= 1 || rel_precision <= 0) {
+    Logger::log_error(format_string("Invalid sequential estimator (confidence %f, precision %f).",
+                                    confidence, rel_precision));
+    exit_target(EXIT_FAILURE);
+  }
+}
+
+void SequentialEstimator::set_valid_range(double min, double max) {
+  valid_min = min;
+  valid_max = max;
+}
+
+void SequentialEstimator::set_outlier_sigmas(double k) {
+  outlier_sigmas = k;
+}
+
+bool SequentialEstimator::add(double sample) {
+  const bool off_mean = outlier_sigmas > 0 && count >= min_samples
+      && std::fabs(sample - mean) > outlier_sigmas*get_stddev();
+  if (sample < valid_min || sample > valid_max || off_mean) {
+    num_rejected++;
+    return false;
+  }
+  count++;
+  const auto delta = sample - mean;
+  mean += delta/static_cast<double>(count);
+  m2 += delta*(sample - mean);
+  return true;
+}
+
+bool SequentialEstimator::is_done() const {
+  return is_precise() || count + num_rejected >= max_samples;
+}
+
+bool SequentialEstimator::is_precise() const {
+  return count >= min_samples && get_half_width() <= rel_precision*std::fabs(mean);
+}
+
+uint64_t SequentialEstimator::get_count() const {
+  return count;
+}
+
+uint64_t SequentialEstimator::get_num_rejected() const {
+  return num_rejected;
+}
+
+double SequentialEstimator::get_mean() const {
+  return mean;
+}
+
+double SequentialEstimator::get_stddev() const {
+  return (count < 2) ? 0 : std::sqrt(m2/static_cast<double>(count - 1));
+}
+
+double SequentialEstimator::get_half_width() const {
+  if (count < 2) return std::numeric_limits<double>::infinity();
+  return z*get_stddev()/std::sqrt(static_cast<double>(count));
+}
+
+double SequentialEstimator::get_achieved_confidence() const {
+  if (count < 2) return 0;
+  const auto std_error = get_stddev()/std::sqrt(static_cast<double>(count));
+  if (std_error == 0) return 1;
+  return std::erf(rel_precision*std::fabs(mean)/(std_error*std::sqrt(2.0)));
+}
+
+std::string SequentialEstimator::to_string() const {
+  return format_string("%.1f +- %.1f (%.1f%% confidence for +-%.1f%%, %lu samples, %lu outliers)", mean,
+                       get_half_width(), 100*get_achieved_confidence(), 100*rel_precision, count, num_rejected);
+}
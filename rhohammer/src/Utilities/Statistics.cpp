@@ -0,0 +1,257 @@
+#include "Utilities/Statistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+
+LogLinearHistogram::LogLinearHistogram(size_t precision_bits)
+    : precision_bits(precision_bits), buckets((65 - precision_bits) << precision_bits, 0) {
+  if (precision_bits < 1 || precision_bits > 16) {
+    Logger::log_error(format_string("Histogram precision must be in [1, 16] bits but is %zu.", precision_bits));
+    exit_target(EXIT_FAILURE);
+  }
+}
+
+size_t LogLinearHistogram::get_bucket_index(uint64_t value) const {
+  const uint64_t num_sub_buckets = 1ULL << precision_bits;
+  if (value < num_sub_buckets) return value;
+  // the buckets of [2^msb, 2^(msb + 1)) have a width of 2^shift
+  const auto msb = static_cast<size_t>(63 - __builtin_clzll(value));
+  const auto shift = msb - precision_bits;
+  return ((shift + 1) << precision_bits) + ((value >> shift) - num_sub_buckets);
+}
+
+uint64_t LogLinearHistogram::get_bucket_lower_bound(size_t idx) const {
+  const uint64_t num_sub_buckets = 1ULL << precision_bits;
+  if (idx < num_sub_buckets) return idx;
+  const auto shift = (idx >> precision_bits) - 1;
+  return (num_sub_buckets + (idx & (num_sub_buckets - 1))) << shift;
+}
+
+uint64_t LogLinearHistogram::get_bucket_width(size_t idx) const {
+  return (idx < (1ULL << precision_bits)) ? 1 : 1ULL << ((idx >> precision_bits) - 1);
+}
+
+uint64_t LogLinearHistogram::get_bucket_value(size_t idx) const {
+  return get_bucket_lower_bound(idx) + (get_bucket_width(idx) - 1)/2;
+}
+
+void LogLinearHistogram::add(double value) {
+  value = std::max(0.0, value);
+  if (count == 0) {
+    min = value;
+    max = value;
+  } else {
+    min = std::min(min, value);
+    max = std::max(max, value);
+  }
+  count++;
+  sum += value;
+  sum_of_squares += value*value;
+  const auto rounded = (value >= 18446744073709551615.0) ? UINT64_MAX : static_cast<uint64_t>(std::llround(value));
+  buckets[get_bucket_index(rounded)]++;
+}
+
+void LogLinearHistogram::merge(const LogLinearHistogram &other) {
+  if (other.precision_bits != precision_bits) {
+    Logger::log_error("Cannot merge histograms with different precisions.");
+    exit_target(EXIT_FAILURE);
+  }
+  if (other.count == 0) return;
+  min = (count == 0) ? other.min : std::min(min, other.min);
+  max = (count == 0) ? other.max : std::max(max, other.max);
+  count += other.count;
+  sum += other.sum;
+  sum_of_squares += other.sum_of_squares;
+  for (size_t i = 0; i < buckets.size(); ++i) buckets[i] += other.buckets[i];
+}
+
+void LogLinearHistogram::clear() {
+  std::fill(buckets.begin(), buckets.end(), 0);
+  count = 0;
+  sum = 0;
+  sum_of_squares = 0;
+  min = 0;
+  max = 0;
+}
+
+uint64_t LogLinearHistogram::get_count() const {
+  return count;
+}
+
+double LogLinearHistogram::get_min() const {
+  return min;
+}
+
+double LogLinearHistogram::get_max() const {
+  return max;
+}
+
+double LogLinearHistogram::get_mean() const {
+  return (count == 0) ? 0 : sum/static_cast<double>(count);
+}
+
+double LogLinearHistogram::get_stddev() const {
+  if (count < 2) return 0;
+  const auto mean = get_mean();
+  const auto variance = (sum_of_squares - static_cast<double>(count)*mean*mean)/static_cast<double>(count - 1);
+  return std::sqrt(std::max(0.0, variance));
+}
+
+double LogLinearHistogram::get_quantile(double q) const {
+  if (count == 0) return 0;
+  const auto rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0)*static_cast<double>(count)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen >= std::max<uint64_t>(1, rank)) {
+      return std::clamp(static_cast<double>(get_bucket_value(i)), min, max);
+    }
+  }
+  return max;
+}
+
+std::vector<uint64_t> LogLinearHistogram::get_most_frequent(size_t n) const {
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    if (buckets[i] > 0) indices.push_back(i);
+  }
+  n = std::min(n, indices.size());
+  // ties are broken by the lower value
+  std::partial_sort(indices.begin(), indices.begin() + static_cast<long>(n), indices.end(),
+                    [this](size_t a, size_t b) {
+                      return buckets[a] > buckets[b] || (buckets[a] == buckets[b] && a < b);
+                    });
+  std::vector<uint64_t> result;
+  for (size_t i = 0; i < n; ++i) result.push_back(get_bucket_value(indices[i]));
+  return result;
+}
+
+#ifdef ENABLE_JSON
+
+nlohmann::json LogLinearHistogram::to_json() const {
+  // only export non-empty buckets as [lower bound, count] pairs to keep the summary small
+  nlohmann::json j_buckets = nlohmann::json::array();
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    if (buckets[i] == 0) continue;
+    j_buckets.push_back({get_bucket_lower_bound(i), buckets[i]});
+  }
+  return nlohmann::json{{"count", count},
+                        {"min", min},
+                        {"max", max},
+                        {"mean", get_mean()},
+                        {"stddev", get_stddev()},
+                        {"p50", get_quantile(0.5)},
+                        {"p90", get_quantile(0.9)},
+                        {"p99", get_quantile(0.99)},
+                        {"precision_bits", precision_bits},
+                        {"buckets", j_buckets}
+  };
+}
+
+#endif
+
+QuantileSketch::QuantileSketch(size_t k) : k(std::max<size_t>(8, k)), levels(1) {
+}
+
+size_t QuantileSketch::get_capacity(size_t level) const {
+  // the capacities shrink by 2/3 per level below the top one
+  const auto depth = levels.size() - 1 - level;
+  return std::max<size_t>(2, static_cast<size_t>(std::ceil(static_cast<double>(k)*std::pow(2.0/3.0, depth))));
+}
+
+void QuantileSketch::compress() {
+  for (size_t h = 0; h < levels.size(); ++h) {
+    if (levels[h].size() < get_capacity(h)) continue;
+    if (h + 1 == levels.size()) levels.emplace_back();
+
+    auto &level = levels[h];
+    std::sort(level.begin(), level.end());
+    // an odd item stays on this level
+    double leftover = 0;
+    const bool has_leftover = (level.size()%2 == 1);
+    if (has_leftover) {
+      leftover = level.back();
+      level.pop_back();
+    }
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    for (size_t i = rng_state & 1; i < level.size(); i += 2) levels[h + 1].push_back(level[i]);
+    level.clear();
+    if (has_leftover) level.push_back(leftover);
+  }
+}
+
+void QuantileSketch::add(double value) {
+  if (count == 0) {
+    min = value;
+    max = value;
+  } else {
+    min = std::min(min, value);
+    max = std::max(max, value);
+  }
+  count++;
+  levels[0].push_back(value);
+  if (levels[0].size() >= get_capacity(0)) compress();
+}
+
+void QuantileSketch::merge(const QuantileSketch &other) {
+  if (other.count == 0) return;
+  min = (count == 0) ? other.min : std::min(min, other.min);
+  max = (count == 0) ? other.max : std::max(max, other.max);
+  count += other.count;
+  if (levels.size() < other.levels.size()) levels.resize(other.levels.size());
+  for (size_t h = 0; h < other.levels.size(); ++h) {
+    levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+  }
+  compress();
+}
+
+uint64_t QuantileSketch::get_count() const {
+  return count;
+}
+
+double QuantileSketch::get_min() const {
+  return min;
+}
+
+double QuantileSketch::get_max() const {
+  return max;
+}
+
+double QuantileSketch::get_quantile(double q) const {
+  if (count == 0) return 0;
+  std::vector<std::pair<double, uint64_t>> items;
+  uint64_t total_weight = 0;
+  for (size_t h = 0; h < levels.size(); ++h) {
+    for (const auto value : levels[h]) {
+      items.emplace_back(value, 1ULL << h);
+      total_weight += 1ULL << h;
+    }
+  }
+  std::sort(items.begin(), items.end());
+  const auto rank = std::clamp(q, 0.0, 1.0)*static_cast<double>(total_weight);
+  uint64_t seen = 0;
+  for (const auto &[value, weight] : items) {
+    seen += weight;
+    if (static_cast<double>(seen) >= rank) return value;
+  }
+  return max;
+}
+
+#ifdef ENABLE_JSON
+
+nlohmann::json QuantileSketch::to_json() const {
+  return nlohmann::json{{"count", count},
+                        {"min", min},
+                        {"max", max},
+                        {"p50", get_quantile(0.5)},
+                        {"p90", get_quantile(0.9)},
+                        {"p99", get_quantile(0.99)}
+  };
+}
+
+#endif
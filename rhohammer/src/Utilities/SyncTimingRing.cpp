@@ -0,0 +1,112 @@
+#include "Utilities/SyncTimingRing.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "Utilities/Helper.hpp"
+#include "Utilities/Logger.hpp"
+
+// header that precedes each block of entries in the binary export
+struct SyncTimingExportHeader {
+  char magic[4];
+  uint32_t version;
+  // e.g., the pattern ID, zero-padded
+  char label[48];
+  double tsc_cycles_per_ns;
+  uint64_t num_entries;
+};
+
+double SyncTimingSummary::get_overhead_fraction() const {
+  if (num_recorded == 0 || window_cycles == 0) return 0;
+  const double extrapolated_sync_cycles =
+      static_cast<double>(sync_cycles)*static_cast<double>(num_syncs)/static_cast<double>(num_recorded);
+  return extrapolated_sync_cycles/static_cast<double>(window_cycles);
+}
+
+void SyncTimingSummary::accumulate(const SyncTimingSummary &other) {
+  num_syncs += other.num_syncs;
+  num_recorded += other.num_recorded;
+  num_missed_refs += other.num_missed_refs;
+  num_dummy_accesses += other.num_dummy_accesses;
+  sync_cycles += other.sync_cycles;
+  window_cycles += other.window_cycles;
+  sync_cycles_dist.merge(other.sync_cycles_dist);
+}
+
+SyncTimingRing::SyncTimingRing(size_t capacity) : entries(nullptr), mask(0), head(0) {
+  size_t cap = 1;
+  while (cap < capacity) cap <<= 1;
+  mask = cap - 1;
+  entries = static_cast<SyncTimingEntry *>(std::aligned_alloc(64, cap*sizeof(SyncTimingEntry)));
+  if (entries == nullptr) {
+    Logger::log_error("Could not allocate the sync timing ring buffer.");
+    exit_target(EXIT_FAILURE);
+  }
+  // touch all pages now so that recording never triggers a page fault
+  memset(entries, 0, cap*sizeof(SyncTimingEntry));
+}
+
+SyncTimingRing::~SyncTimingRing() {
+  free(entries);
+}
+
+uint64_t SyncTimingRing::get_head() const {
+  return head;
+}
+
+size_t SyncTimingRing::get_capacity() const {
+  return mask + 1;
+}
+
+SyncTimingSummary SyncTimingRing::summarize(uint64_t since, uint64_t window_cycles) const {
+  SyncTimingSummary summary;
+  summary.window_cycles = window_cycles;
+  summary.num_syncs = head - since;
+  const uint64_t first = std::max(since, (head > get_capacity()) ? head - get_capacity() : 0);
+  for (uint64_t i = first; i < head; ++i) {
+    const auto &e = entries[i & mask];
+    summary.num_recorded++;
+    summary.num_missed_refs += (e.threshold_hit == 0);
+    summary.num_dummy_accesses += e.num_dummy_accesses;
+    summary.sync_cycles += e.tsc_exit - e.tsc_entry;
+    summary.sync_cycles_dist.add(static_cast<double>(e.tsc_exit - e.tsc_entry));
+  }
+  return summary;
+}
+
+void SyncTimingRing::export_binary(std::ofstream &os, uint64_t since, const std::string &label) const {
+  const uint64_t first = std::max(since, (head > get_capacity()) ? head - get_capacity() : 0);
+
+  SyncTimingExportHeader header{};
+  memcpy(header.magic, "RSYN", sizeof(header.magic));
+  header.version = 1;
+  strncpy(header.label, label.c_str(), sizeof(header.label) - 1);
+  header.tsc_cycles_per_ns = get_tsc_cycles_per_ns();
+  header.num_entries = head - first;
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  // the recorded range can wrap around the end of the entry array
+  for (uint64_t i = first; i < head;) {
+    const uint64_t idx = i & mask;
+    const uint64_t n = std::min(head - i, get_capacity() - idx);
+    os.write(reinterpret_cast<const char *>(&entries[idx]), static_cast<std::streamsize>(n*sizeof(SyncTimingEntry)));
+    i += n;
+  }
+}
+
+#ifdef ENABLE_JSON
+
+void to_json(nlohmann::json &j, const SyncTimingSummary &p) {
+  const double num_recorded = (p.num_recorded == 0) ? 1.0 : static_cast<double>(p.num_recorded);
+  j = nlohmann::json{{"num_syncs", p.num_syncs},
+                     {"num_recorded", p.num_recorded},
+                     {"missed_refs", p.num_missed_refs},
+                     {"avg_dummy_accesses", static_cast<double>(p.num_dummy_accesses)/num_recorded},
+                     {"avg_sync_cycles", static_cast<double>(p.sync_cycles)/num_recorded},
+                     {"sync_cycles_dist", p.sync_cycles_dist.to_json()},
+                     {"overhead_fraction", p.get_overhead_fraction()}
+  };
+}
+
+#endif
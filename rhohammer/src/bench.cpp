@@ -0,0 +1,275 @@
+// rhoBench: microbenchmarks of the library's hot paths (address translation, pattern generation and mapping, memory
+// checking, and pattern (de)serialization). It runs on a regular, non-hugepage buffer with the built-in address mapping
+// of the given geometry, i.e., it neither requires root nor touches DRAM in a way that matters, so that performance
+// regressions are caught before the code runs in the lab.
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "GlobalDefines.hpp"
+#include "Fuzzer/FuzzingParameterSet.hpp"
+#include "Fuzzer/HammeringPattern.hpp"
+#include "Fuzzer/PatternAddressMapper.hpp"
+#include "Fuzzer/PatternBuilder.hpp"
+#include "Memory/DRAMAddr.hpp"
+#include "Memory/Memory.hpp"
+#include "Utilities/Helper.hpp"
+#include "Utilities/RuntimeConfig.hpp"
+
+#include <argagg/argagg.hpp>
+
+// the number of addresses translated per iteration of the DRAMAddr benchmarks
+static constexpr size_t NUM_ADDRESSES = 4096;
+
+// the ACTs/tREFI the patterns are generated for, fixed so that all runs generate patterns of the same size
+static constexpr int ACTS_PER_TREFI = 80;
+
+struct BenchmarkOptions
+{
+  // only benchmarks whose name contains this are run
+  std::string filter;
+  // the minimum duration of a timed batch of iterations
+  double min_batch_ns{10e6};
+  size_t num_repetitions{10};
+};
+
+struct BenchmarkResult
+{
+  std::string name;
+  size_t iterations_per_batch{0};
+  double ns_per_op_median{0};
+  double ns_per_op_min{0};
+  double ns_per_op_max{0};
+};
+
+// keeps the compiler from optimizing a benchmarked result away
+template <typename T>
+static void do_not_optimize(const T &value)
+{
+  asm volatile("" : : "r"(&value) : "memory");
+}
+
+// Times the body (which runs the given number of iterations) in batches: the batch size is doubled until a batch takes
+// at least min_batch_ns, then num_repetitions batches of that size are timed. The first batch also warms up the caches.
+static BenchmarkResult run_benchmark(const BenchmarkOptions &options, const std::string &name,
+                                     const std::function<void(size_t)> &body)
+{
+  auto time_batch = [&](size_t iterations)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    body(iterations);
+    return static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+  };
+
+  BenchmarkResult result;
+  result.name = name;
+  size_t iterations = 1;
+  while (time_batch(iterations) < options.min_batch_ns && iterations < (1UL << 30))
+    iterations *= 2;
+  result.iterations_per_batch = iterations;
+
+  std::vector<double> ns_per_op;
+  for (size_t i = 0; i < options.num_repetitions; i++)
+    ns_per_op.push_back(time_batch(iterations) / static_cast<double>(iterations));
+  std::sort(ns_per_op.begin(), ns_per_op.end());
+  result.ns_per_op_median = ns_per_op[ns_per_op.size() / 2];
+  result.ns_per_op_min = ns_per_op.front();
+  result.ns_per_op_max = ns_per_op.back();
+
+  std::cout << format_string("%-48s %12zu %14.1f %14.1f %14.1f", name.c_str(), result.iterations_per_batch,
+                             result.ns_per_op_median, result.ns_per_op_min, result.ns_per_op_max)
+            << std::endl;
+  return result;
+}
+
+int main(int argc, char **argv)
+{
+  argagg::parser argparser{{
+      {"help", {"-h", "--help"}, "shows this help message", 0},
+      {"geometry", {"-g", "--geometry"}, "DRAM geometry of the built-in address mapping: <#ranks>,<#bankgroups>,<#banks> (default: 1,4,4)", 1},
+      {"samsung", {"--samsung"}, "use the address mapping with Samsung row swizzling (default: absent)", 0},
+      {"filter", {"--filter"}, "only run the benchmarks whose name contains the given string (default: all)", 1},
+      {"repetitions", {"--repetitions"}, "number of timed batches per benchmark (default: 10)", 1},
+      {"min-time", {"--min-time"}, "minimum duration of a timed batch in milliseconds (default: 10)", 1},
+      {"csv", {"--csv"}, "additionally write the results to the given CSV file", 1},
+  }};
+
+  argagg::parser_results parsed_args;
+  try
+  {
+    parsed_args = argparser.parse(argc, argv);
+  }
+  catch (const std::exception &e)
+  {
+    std::cerr << e.what() << '\n';
+    exit(EXIT_FAILURE);
+  }
+
+  if (parsed_args["help"])
+  {
+    std::cerr << argparser;
+    exit(EXIT_SUCCESS);
+  }
+
+  size_t num_ranks = 1;
+  size_t num_bankgroups = 4;
+  size_t num_banks = 4;
+  if (parsed_args.has_option("geometry"))
+  {
+    const auto geometry = parsed_args["geometry"].as<std::string>();
+    if (sscanf(geometry.c_str(), "%zu,%zu,%zu", &num_ranks, &num_bankgroups, &num_banks) != 3)
+    {
+      std::cerr << "[-] Program argument '--geometry' must be <#ranks>,<#bankgroups>,<#banks>.\n";
+      exit(EXIT_FAILURE);
+    }
+  }
+  BenchmarkOptions options;
+  options.filter = parsed_args["filter"].as<std::string>("");
+  options.num_repetitions = std::max<size_t>(1, parsed_args["repetitions"].as<size_t>(options.num_repetitions));
+  options.min_batch_ns = parsed_args["min-time"].as<double>(options.min_batch_ns / 1e6) * 1e6;
+
+  // the library's log messages are not of interest here, hence the logger is not initialized and discards them
+  runtime_config.num_banks = num_bankgroups * num_banks;
+  Memory memory(false);
+  memory.allocate_memory(HUGEPAGE_SZ);
+  DRAMAddr::initialize(memory.get_starting_address(), num_ranks, num_bankgroups, num_banks,
+                       parsed_args.has_option("samsung"));
+
+  // the pattern, mapping, and accesses all benchmarks work on
+  FuzzingParameterSet params;
+  params.set_fixed_acts_per_trefi(ACTS_PER_TREFI);
+  params.randomize_parameters(false);
+  std::mt19937 gen(SEED);
+  HammeringPattern pattern(params.get_base_period(), gen);
+  PatternBuilder(pattern).generate_frequency_based_pattern(params);
+  PatternAddressMapper mapper;
+  mapper.randomize_addresses(params, pattern.agg_access_patterns, false);
+  mapper.determine_victims(pattern.agg_access_patterns);
+  std::vector<volatile char *> accesses;
+  mapper.export_pattern(pattern.aggressors, pattern.base_period, accesses);
+  pattern.address_mappings.push_back(mapper);
+
+  std::vector<DRAMAddr> dram_addrs;
+  std::vector<void *> virt_addrs;
+  std::uniform_int_distribution<size_t> offset_dist(0, HUGEPAGE_SZ - 1);
+  for (size_t i = 0; i < NUM_ADDRESSES; i++)
+  {
+    virt_addrs.push_back((void *)(memory.get_starting_address() + offset_dist(gen)));
+    dram_addrs.emplace_back(virt_addrs.back());
+  }
+
+  std::cout << format_string("Pattern: %zu aggressors, %zu accesses, %zu victim rows; geometry %zu,%zu,%zu.",
+                             pattern.aggressors.size(), accesses.size(), mapper.get_victim_rows().size(),
+                             num_ranks, num_bankgroups, num_banks)
+            << std::endl;
+  std::cout << format_string("%-48s %12s %14s %14s %14s", "benchmark", "iterations", "ns/op (median)", "ns/op (min)",
+                             "ns/op (max)")
+            << std::endl;
+
+  std::vector<std::pair<std::string, std::function<void(size_t)>>> benchmarks;
+  benchmarks.emplace_back("DRAMAddr/virt_to_dram", [&](size_t iterations)
+  {
+    for (size_t i = 0; i < iterations; i++)
+    {
+      DRAMAddr addr(virt_addrs[i % NUM_ADDRESSES]);
+      do_not_optimize(addr);
+    }
+  });
+  benchmarks.emplace_back("DRAMAddr/dram_to_virt", [&](size_t iterations)
+  {
+    for (size_t i = 0; i < iterations; i++)
+    {
+      auto *addr = dram_addrs[i % NUM_ADDRESSES].to_virt();
+      do_not_optimize(addr);
+    }
+  });
+  benchmarks.emplace_back("PatternBuilder/generate_frequency_based_pattern", [&](size_t iterations)
+  {
+    for (size_t i = 0; i < iterations; i++)
+    {
+      HammeringPattern generated(params.get_base_period(), gen);
+      PatternBuilder(generated).generate_frequency_based_pattern(params);
+      do_not_optimize(generated);
+    }
+  });
+  benchmarks.emplace_back("PatternAddressMapper/randomize_addresses", [&](size_t iterations)
+  {
+    PatternAddressMapper randomized;
+    for (size_t i = 0; i < iterations; i++)
+      randomized.randomize_addresses(params, pattern.agg_access_patterns, false);
+  });
+  benchmarks.emplace_back("PatternAddressMapper/export_pattern", [&](size_t iterations)
+  {
+    std::vector<volatile char *> exported;
+    for (size_t i = 0; i < iterations; i++)
+    {
+      exported.clear();
+      mapper.export_pattern(pattern.aggressors, pattern.base_period, exported);
+      do_not_optimize(exported);
+    }
+  });
+  benchmarks.emplace_back("PatternAddressMapper/determine_victims", [&](size_t iterations)
+  {
+    for (size_t i = 0; i < iterations; i++)
+      mapper.determine_victims(pattern.agg_access_patterns);
+  });
+  benchmarks.emplace_back("Memory/check_memory", [&](size_t iterations)
+  {
+    for (size_t i = 0; i < iterations; i++)
+    {
+      auto num_bitflips = memory.check_memory(mapper, false, false);
+      do_not_optimize(num_bitflips);
+    }
+  });
+#ifdef ENABLE_JSON
+  const nlohmann::json pattern_json = pattern;
+  benchmarks.emplace_back("HammeringPattern/to_json", [&](size_t iterations)
+  {
+    for (size_t i = 0; i < iterations; i++)
+    {
+      const nlohmann::json j = pattern;
+      do_not_optimize(j);
+    }
+  });
+  benchmarks.emplace_back("HammeringPattern/from_json", [&](size_t iterations)
+  {
+    for (size_t i = 0; i < iterations; i++)
+    {
+      auto deserialized = pattern_json.get<HammeringPattern>();
+      do_not_optimize(deserialized);
+    }
+  });
+#endif
+
+  std::vector<BenchmarkResult> results;
+  for (const auto &[name, body] : benchmarks)
+  {
+    if (name.find(options.filter) == std::string::npos)
+      continue;
+    results.push_back(run_benchmark(options, name, body));
+  }
+
+  if (parsed_args.has_option("csv"))
+  {
+    const auto csv_path = parsed_args["csv"].as<std::string>();
+    std::ofstream csv(csv_path);
+    if (!csv.is_open())
+    {
+      std::cerr << "[-] Could not open " << csv_path << " for writing the results.\n";
+      exit(EXIT_FAILURE);
+    }
+    csv << "benchmark,iterations_per_batch,ns_per_op_median,ns_per_op_min,ns_per_op_max\n";
+    for (const auto &result : results)
+    {
+      csv << result.name << ',' << result.iterations_per_batch << ',' << result.ns_per_op_median << ','
+          << result.ns_per_op_min << ',' << result.ns_per_op_max << '\n';
+    }
+  }
+  return EXIT_SUCCESS;
+}
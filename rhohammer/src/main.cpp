@@ -7,43 +7,164 @@
 #include <stdexcept>
 #include <string>
 #include <array>
+#include <map>
+#include <mutex>
 
+#include "Forges/CampaignOrchestrator.hpp"
 #include "Forges/FuzzyHammerer.hpp"
+#include "Fuzzer/KernelAutotuner.hpp"
+#include "Fuzzer/PrefetchBenchmark.hpp"
+#include "Fuzzer/PatternStore.hpp"
+#include "Memory/DramTimingBenchmark.hpp"
+#include "Memory/ExperimentRunner.hpp"
+#include "Memory/SimulatedDram.hpp"
+#include "Utilities/CalibrationProfile.hpp"
+#include "Utilities/Helper.hpp"
+#include "Utilities/ResultStreamWriter.hpp"
 
 #include <argagg/argagg.hpp>
 #include <argagg/convert/csv.hpp>
 
-ProgramArguments program_args;
+thread_local ProgramArguments program_args;
 
-int main(int argc, char **argv)
+// the file in which the calibration profiles (see CalibrationProfile) are kept across runs
+static const char *CALIBRATION_FILENAME = "calibration.json";
+
+std::string get_output_path(const std::string &filename)
 {
-  Logger::initialize();
+  return program_args.output_dir.empty() ? filename : program_args.output_dir + "/" + filename;
+}
 
-#ifdef DEBUG_SAMSUNG
-  Logger::log_debug(
-      "\n"
-      "=================================================================================================\n"
-      "==== ATTENTION // Debugging enabled: DEBUG_SAMSUNG=1 ===========================================\n"
-      "=================================================================================================");
-#endif
+// serializes the memory allocation and calibration of the workers of a campaign: the hugepage allocation maps and
+// releases superpages until it gets the requested one, and calibration.json is read and written by all workers
+static std::mutex setup_mutex;
 
-  handle_args(argc, argv);
+// the kernel choices determined in this process, by geometry key, so that workers with the same geometry only
+// autotune once
+static std::map<std::string, KernelChoice> kernel_choices;
 
-  // prints the current git commit and some program metadata
-  Logger::log_metadata(GIT_COMMIT_HASH, program_args.runtime_limit);
+// the calibration profile of the DIMM given by program_args; DRAMAddr must be initialized before
+static CalibrationProfile get_calibration_profile()
+{
+  CalibrationProfile profile;
+  profile.host = CalibrationProfile::get_host_name();
+  profile.cpu_model = CalibrationProfile::get_cpu_model();
+  profile.dimm_id = program_args.dimm_id;
+  profile.geometry = KernelAutotuner::get_geometry_key(program_args.num_ranks,
+                                                       program_args.num_bankgroups,
+                                                       program_args.num_banks,
+                                                       program_args.samsung_row_swizzling);
+  profile.mapping_hash = DRAMAddr::get_mapping_hash();
+  return profile;
+}
 
-  // give this process the highest CPU priority so it can hammer with less interruptions
-  int ret = setpriority(PRIO_PROCESS, 0, -20);
-  if (ret != 0)
+// uses the sync REF threshold of the profile if it is recent and still valid, otherwise calibrates it
+static void determine_ref_threshold(DramAnalyzer &dram_analyzer, CalibrationProfile &profile,
+                                    const CalibrationProfileStore &store)
+{
+  if (!program_args.recalibrate && profile.ref_threshold > 0
+      && CalibrationProfile::is_fresh(profile.ref_threshold_timestamp, runtime_config.calibration_max_age))
   {
-    Logger::log_error("Instruction setpriority failed.");
+    if (dram_analyzer.validate_sync_ref_threshold(profile.ref_threshold))
+    {
+      Logger::log_info(format_string("Using stored sync REF threshold %ld.", profile.ref_threshold));
+      dram_analyzer.set_sync_ref_threshold(profile.ref_threshold);
+      return;
+    }
+    Logger::log_info("Stored sync REF threshold failed validation. Calibrating again.");
+  }
+
+  // the threshold is determined again until it passes the check, but at most MAX_TRIES times
+  constexpr size_t MAX_TRIES = 5;
+  bool passed = false;
+  for (size_t tries = 0; tries < MAX_TRIES && !passed; ++tries)
+  {
+    dram_analyzer.set_sync_ref_threshold(dram_analyzer.find_sync_ref_threshold());
+    passed = dram_analyzer.check_sync_ref_threshold(dram_analyzer.get_ref_threshold());
+  }
+  if (!passed)
+  {
+    Logger::log_error(format_string("Sync REF threshold %zu failed the check %zu times, using it anyway without "
+                                    "storing it.", dram_analyzer.get_ref_threshold(), MAX_TRIES));
+    return;
+  }
+  profile.ref_threshold = static_cast<long>(dram_analyzer.get_ref_threshold());
+  profile.ref_threshold_timestamp = get_timestamp_sec();
+  store.store(profile);
+}
+
+static KernelChoice determine_kernel_choice(DramAnalyzer &dram_analyzer, CalibrationProfile &profile,
+                                            const CalibrationProfileStore &store)
+{
+  KernelChoice choice;
+  if (program_args.skip_autotune)
+  {
+    Logger::log_info(format_string("Skipping kernel autotuning, using %s.", choice.to_string().c_str()));
+    return choice;
+  }
+
+  const auto &geometry_key = profile.geometry;
+  if (kernel_choices.count(geometry_key) > 0)
+  {
+    choice = kernel_choices.at(geometry_key);
+    Logger::log_info(format_string("Using kernel choice of another DIMM with geometry '%s': %s.",
+                                   geometry_key.c_str(), choice.to_string().c_str()));
+    return choice;
+  }
+
+  // the profile's own choice, otherwise the one of another DIMM with the same geometry on this host
+  int64_t timestamp = profile.kernel_choice_timestamp;
+  bool found = profile.has_kernel_choice;
+  if (found)
+    choice = profile.kernel_choice;
+  else
+    found = store.load_kernel_choice(profile, choice, timestamp);
+  if (!program_args.force_autotune && !program_args.recalibrate && found
+      && CalibrationProfile::is_fresh(timestamp, runtime_config.calibration_max_age))
+  {
+#ifndef ENABLE_JITTING
+    if (choice.kernel == HAMMERING_KERNEL::JITTED)
+    {
+      Logger::log_info("Stored kernel choice requires jitting, which is disabled in this build. Autotuning again.");
+    }
+    else
+#endif
+    {
+      Logger::log_info(format_string("Using stored kernel choice for geometry '%s': %s.",
+                                     geometry_key.c_str(), choice.to_string().c_str()));
+      kernel_choices[geometry_key] = choice;
+      if (!profile.has_kernel_choice)
+      {
+        profile.has_kernel_choice = true;
+        profile.kernel_choice = choice;
+        profile.kernel_choice_timestamp = timestamp;
+        store.store(profile);
+      }
+      return choice;
+    }
   }
 
+  KernelAutotuner autotuner(dram_analyzer);
+  choice = autotuner.run();
+  profile.has_kernel_choice = true;
+  profile.kernel_choice = choice;
+  profile.kernel_choice_timestamp = get_timestamp_sec();
+  store.store(profile);
+  kernel_choices[geometry_key] = choice;
+  return choice;
+}
+
+// allocates the memory of the DIMM given by program_args, calibrates, and then replays or fuzzes; the fuzzing run
+// ends at the given deadline (UNIX timestamp in seconds) or, if it is -1, after --runtime-limit seconds
+static void run_target(int64_t deadline)
+{
+  Memory memory(!program_args.simulate);
+  std::unique_lock<std::mutex> setup_lock(setup_mutex);
+
   // allocate a large bulk of contiguous memory
-  Memory memory(true);
-  if (HUGEPAGE_NUM > -1)
+  if (runtime_config.hugepage_num > -1 && !program_args.simulate)
   {
-    memory.allocate_memory(HUGEPAGE_SZ, HUGEPAGE_NUM);
+    memory.allocate_memory(HUGEPAGE_SZ, runtime_config.hugepage_num);
   }
   else
   {
@@ -55,34 +176,96 @@ int main(int argc, char **argv)
                        program_args.num_bankgroups,
                        program_args.num_banks,
                        program_args.samsung_row_swizzling);
+  if (program_args.simulate)
+  {
+    SimulatedDramConfig simulation_config;
+    simulation_config.seed = program_args.simulation_seed;
+    simulation_config.flip_threshold = program_args.simulation_flip_threshold;
+    SimulatedDram::enable(simulation_config, memory.get_starting_address(), HUGEPAGE_SZ);
+  }
 
   // find address sets that create bank conflicts
 
   DramAnalyzer dram_analyzer(memory.get_starting_address());
-  // dram_analyzer.find_threshold();
-  // dram_analyzer.find_bank_conflicts();
-  if (REF_THREAD == -1)
+  // the simulated DRAM follows the mapping by construction, and its regular pages do not show the real bank conflicts
+  if (program_args.check_mapping && !program_args.simulate)
   {
-    do
-    {
-      dram_analyzer.set_sync_ref_threshold(dram_analyzer.find_sync_ref_threshold());
-    } while (dram_analyzer.check_sync_ref_threshold(dram_analyzer.get_ref_threshold()));
+    dram_analyzer.find_bank_conflicts_from_mapping();
   }
-  else
+
+  // run the benchmark instead of hammering; the benchmarks do not need any calibration, but like it, they hold the
+  // setup lock so that the workers of a campaign do not disturb each other's measurements
+  if (program_args.benchmark == "dram-timing")
   {
-    dram_analyzer.set_sync_ref_threshold(REF_THREAD);
+    DramTimingBenchmark benchmark(get_output_path("dram-timing.json"));
+    benchmark.run();
+    setup_lock.unlock();
+    CampaignOrchestrator::finish_setup();
+    return;
   }
-  // std::cout<<"column,row"<<std::endl; 
-  // dram_analyzer.set_sync_ref_threshold(1300);
-  if (DEBUG_MODE)
+  if (program_args.benchmark == "prefetch")
   {
-    std::cout << "Find ref_threshold: " << dram_analyzer.get_ref_threshold() << std::endl;
-    std::cout << "# Bank: " << MULTI_BANK << std::endl;
+    PrefetchBenchmark benchmark(get_output_path(PrefetchBenchmark::get_results_filename()));
+    benchmark.run();
+    setup_lock.unlock();
+    CampaignOrchestrator::finish_setup();
+    return;
   }
 
+  // run the calibration experiments instead of hammering; they determine their REF thresholds themselves and hold the
+  // setup lock like any calibration
+  if (!program_args.filepath_exp_cfg.empty())
+  {
+    ExperimentRunner runner(dram_analyzer, get_output_path("experiment-results.csv"));
+    runner.run(ExperimentConfig::load_all(program_args.filepath_exp_cfg, program_args.exp_cfg_id));
+    setup_lock.unlock();
+    CampaignOrchestrator::finish_setup();
+    return;
+  }
+  KernelChoice kernel_choice;
+  if (program_args.simulate)
+  {
+    // the REF threshold follows from the simulated timing, and only the unjitted kernel runs on the simulated DRAM
+    dram_analyzer.set_sync_ref_threshold(SimulatedDram::get()->get_ref_threshold());
+  }
+  else
+  {
+    CalibrationProfileStore calibration_store(CALIBRATION_FILENAME);
+    auto calibration_profile = get_calibration_profile();
+    if (calibration_store.load(calibration_profile))
+    {
+      Logger::log_info(format_string("Loaded calibration profile '%s'.", calibration_profile.get_key().c_str()));
+    }
+    if (runtime_config.ref_threshold == -1)
+    {
+      determine_ref_threshold(dram_analyzer, calibration_profile, calibration_store);
+    }
+    else
+    {
+      dram_analyzer.set_sync_ref_threshold(runtime_config.ref_threshold);
+    }
+    // std::cout<<"column,row"<<std::endl; 
+    // dram_analyzer.set_sync_ref_threshold(1300);
+    if (runtime_config.debug_mode)
+    {
+      std::cout << "Find ref_threshold: " << dram_analyzer.get_ref_threshold() << std::endl;
+      std::cout << "# Bank: " << runtime_config.multi_bank << std::endl;
+    }
+
+    kernel_choice = determine_kernel_choice(dram_analyzer, calibration_profile, calibration_store);
+  }
+  setup_lock.unlock();
+  // the other workers of a campaign only start hammering once all of them are calibrated
+  CampaignOrchestrator::finish_setup();
+
   if (!program_args.load_json_filename.empty())
   {
     ReplayingHammerer replayer(memory);
+    replayer.kernel_choice = kernel_choice;
+    replayer.ref_threshold = dram_analyzer.get_ref_threshold();
+    if (!program_args.sweep_plan_filename.empty())
+      replayer.sweep_plan.load_yaml(program_args.sweep_plan_filename);
+    replayer.sweep_plan.validate();
     if (program_args.sweeping)
     {
       auto res = replayer.replay_patterns_brief(program_args.load_json_filename, program_args.pattern_ids, 2048ULL, true);
@@ -91,7 +274,19 @@ int main(int argc, char **argv)
   }
   else if (program_args.do_fuzzing && program_args.use_synchronization)
   {
+    if (deadline != -1)
+    {
+      // the calibration of this worker (and waiting for the others) counts towards the campaign's budget
+      const auto remaining = deadline - get_timestamp_sec();
+      if (remaining <= 0)
+      {
+        Logger::log_info("No time left in the campaign's budget for fuzzing.");
+        return;
+      }
+      program_args.runtime_limit = static_cast<unsigned long>(remaining);
+    }
     FuzzyHammerer fuzzyHammerer;
+    fuzzyHammerer.kernel_choice = kernel_choice;
     fuzzyHammerer.n_sided_frequency_based_hammering(
         dram_analyzer,
         memory,
@@ -100,7 +295,46 @@ int main(int argc, char **argv)
         program_args.num_address_mappings_per_pattern,
         program_args.sweeping);
   }
+}
+
+int main(int argc, char **argv)
+{
+  Logger::initialize();
+
+#ifdef DEBUG_SAMSUNG
+  Logger::log_debug(
+      "\n"
+      "=================================================================================================\n"
+      "==== ATTENTION // Debugging enabled: DEBUG_SAMSUNG=1 ===========================================\n"
+      "=================================================================================================");
+#endif
+
+  handle_args(argc, argv);
 
+  // prints the current git commit and some program metadata
+  Logger::log_metadata(GIT_COMMIT_HASH, program_args.runtime_limit);
+
+  // give this process the highest CPU priority so it can hammer with less interruptions
+  int ret = setpriority(PRIO_PROCESS, 0, -20);
+  if (ret != 0)
+  {
+    Logger::log_error("Instruction setpriority failed.");
+  }
+
+  // installed once for the whole process, so that a Ctrl-C stops the fuzzing of all DIMMs of a campaign gracefully
+  install_stop_handler();
+
+  if (!program_args.targets_filename.empty())
+  {
+    // each DIMM is handled by its own worker thread, see CampaignOrchestrator
+    auto campaign = CampaignOrchestrator::load_yaml(program_args.targets_filename);
+    const auto num_failed = campaign.run([](const CampaignTarget &, int64_t deadline)
+                                         { run_target(deadline); });
+    Logger::close();
+    return (num_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  run_target(-1);
   Logger::close();
   return EXIT_SUCCESS;
 }
@@ -147,25 +381,55 @@ void handle_args(int argc, char **argv)
   argagg::parser argparser{{
       {"help", {"-h", "--help"}, "shows this help message", 0},
       {"dimm-id", {"-d", "--dimm-id"}, "internal identifier of the currently inserted DIMM (default: 0)", 1},
+      {"targets", {"--targets"}, "YAML file with the DIMMs (ID, geometry, hugepage, CPU core) of a campaign that hammers all of them in parallel, each with its own output directory dimm-<id>/; replaces --dimm-id, --geometry, and --hugepage-num", 1},
 
       {"fuzzing", {"-f", "--fuzzing"}, "perform a fuzzing run (default program mode)", 0},
       {"replay-patterns", {"-y", "--replay-patterns"}, "replays patterns given as comma-separated list of pattern IDs", 1},
 
-      {"load-json", {"-j", "--load-json"}, "loads the specified JSON file generated in a previous fuzzer run, loads patterns given by --replay-patterns or determines the best ones", 1},
+      {"load-json", {"-j", "--load-json"}, "loads the specified JSON file (or pattern store) generated in a previous fuzzer run, loads patterns given by --replay-patterns or determines the best ones", 1},
+      {"top-k", {"--top-k"}, "without --replay-patterns, only load the K patterns with the most bit flips (default: all)", 1},
+      {"convert-patterns", {"--convert-patterns"}, "converts the patterns of a fuzz-summary.json into an indexed pattern store (.rps) for fast replaying and exits", 1},
 
       // note that these two parameters don't require a value, their presence already equals a "true"
       {"sync", {"-s", "--sync"}, "synchronize with REFRESH while hammering (default: present)", 0},
       {"sweeping", {"-w", "--sweeping"}, "sweep the best pattern over a contig. memory area after fuzzing (default: absent)", 0},
+      {"sweep-plan", {"--sweep-plan"}, "YAML file with the rows (first_row, num_rows, row_stride), banks, time_budget (seconds per pattern), and chunk_rows of each sweep (default: full_sweep_rows rows next to the mapping)", 1},
 
       {"runtime-limit", {"-t", "--runtime-limit"}, "number of seconds to run the fuzzer before sweeping/terminating (default: 120)", 1},
       {"acts-per-ref", {"-a", "--acts-per-ref"}, "number of activations in a tREF interval, i.e., 7.8us (default: random for each pattern)", 1},
       {"probes", {"-p", "--probes"}, "number of different DRAM locations to try each pattern on (default: NUM_BANKS/4)", 1},
 
-      {"yaml-exp-cfg", {"-e", "--exp-cfg"}, "", 1},
-      {"yaml-exp-cfg-id", {"-x", "--exp-cfg-id"}, "", 1},
+      {"simulate", {"--simulate"}, "run on a simulated DRAM (with the address mapping of --geometry) instead of real DRAM, e.g., without root or hugepages; calibration is skipped and the unjitted kernel is used (default: absent)", 0},
+      {"simulation-seed", {"--simulation-seed"}, "seed of the simulated DRAM's row vulnerability and bit flip locations (default: 0)", 1},
+      {"simulation-flip-threshold", {"--simulation-flip-threshold"}, "average number of ACTs of its neighbours within a refresh window after which a simulated row flips (default: 20000)", 1},
+      {"benchmark", {"--benchmark"}, "runs a benchmark instead of hammering: 'dram-timing' (row buffer hit/conflict latency per bank, ACT spacing, four-activate window, and REF interval/duration, written to dram-timing.json) or 'prefetch' (prefetchnta latency, outstanding prefetches, and access rate by flushing/fencing strategy and padding, written to prefetch-<host>.csv)", 1},
+      {"yaml-exp-cfg", {"-e", "--exp-cfg"}, "YAML file with ACTs/REF calibration experiments (experiment_configs and/or a matrix of parameter values) to run back-to-back instead of hammering; results are written to experiment-results.csv", 1},
+      {"yaml-exp-cfg-id", {"-x", "--exp-cfg-id"}, "runs only the experiment with the given config_id from --exp-cfg", 1},
 
       {"geometry", {"--geometry"}, "a triple describing the DRAM geometry: #ranks, #bankgroups, #banks (e.g. '--geometry 2,8,4')", 1},
       {"samsung", {"--samsung"}, "use Samsung row swizzling", 0},
+
+      {"export-sync-timings", {"--export-sync-timings"}, "write the timing of every REF synchronization to sync-timings.bin (default: absent)", 0},
+      {"config", {"--config"}, "YAML file with run configuration knobs (multi_bank, ref_threshold, hugepage_num, debug_mode, num_banks, bk_conf_thresh, full_sweep_rows, sweep_log_every, calibration_confidence, calibration_precision, calibration_max_age), overridden by the individual arguments below", 1},
+      {"multi-bank", {"--multi-bank"}, "number of banks each aggressor is hammered in simultaneously, 1 to 8 (default: 2)", 1},
+      {"ref-threshold", {"--ref-threshold"}, "REF synchronization threshold in cycles, -1 to calibrate it (default: 1500)", 1},
+      {"hugepage-num", {"--hugepage-num"}, "number of the 1 GiB hugepage to map, -1 to let the kernel choose (default: -1)", 1},
+      {"num-banks", {"--num-banks"}, "number of total banks used for finding bank conflicts (default: #bankgroups x #banks)", 1},
+      {"bk-conf-thresh", {"--bk-conf-thresh"}, "access time threshold (cycles) that indicates a bank conflict (default: 430)", 1},
+      {"full-sweep-rows", {"--full-sweep-rows"}, "number of row offsets a pattern is swept over (default: 2000000)", 1},
+      {"sweep-log-every", {"--sweep-log-every"}, "while sweeping, only log every n-th row and the rows with bit flips (default: 1000)", 1},
+      {"debug", {"--debug"}, "enable debug mode, e.g., sweep only 10 rows (default: absent)", 0},
+
+      {"resume", {"--resume"}, "continue the interrupted fuzzing run recorded in fuzz-checkpoint.jsonl, incl. its remaining runtime, or the interrupted sweeps recorded in sweep-checkpoint.jsonl (default: absent)", 0},
+      {"autotune", {"--autotune"}, "re-run the kernel autotuning even if calibration.json has a kernel choice for this geometry (default: absent)", 0},
+      {"recalibrate", {"--recalibrate"}, "ignore the calibration profile in calibration.json and calibrate the sync REF threshold (if --ref-threshold is -1) and the kernel again (default: absent)", 0},
+      {"no-autotune", {"--no-autotune"}, "skip the kernel autotuning and use the unjitted kernel with EARLIEST_POSSIBLE flushing and no fencing (default: absent)", 0},
+      {"result-format", {"--result-format"}, "format in which results are streamed to disk during the run: 'jsonl' or 'binary' (default: jsonl)", 1},
+      {"no-raw-flips", {"--no-raw-flips"}, "only write the aggregated bit flip statistics of each sweep, not every single bit flip (default: absent)", 0},
+      {"convert-results", {"--convert-results"}, "converts a result stream (e.g., fuzz-results.jsonl) into the JSON summary format and exits", 1},
+      {"access-trace", {"--access-trace"}, "record the accesses, flushes, fences, and REF synchronizations of each hammered pattern and DRAM location, incl. their DRAM coordinates, into access-trace.bin for offline analysis with rhoTrace (default: absent)", 0},
+      {"check-mapping", {"--check-mapping"}, "check the address mapping of --geometry by timing a few bank conflicts it predicts before hammering, and search for the bank conflicts if it looks wrong (default: absent)", 0},
+      {"perf-raw-events", {"--perf-raw-events"}, "comma-separated list of raw PMU event configs (e.g., '0x01a2,0x02a3') to count in addition to cycles, instructions, L1D and LLC misses", 1},
   }};
 
   argagg::parser_results parsed_args;
@@ -185,10 +449,33 @@ void handle_args(int argc, char **argv)
     exit(EXIT_SUCCESS);
   }
 
+#ifdef ENABLE_JSON
+  if (parsed_args.has_option("convert-results"))
+  {
+    // the summary is written next to the stream, e.g., fuzz-results.jsonl -> fuzz-results.json
+    const auto stream_path = parsed_args["convert-results"].as<std::string>();
+    const auto json_path = stream_path.substr(0, stream_path.find_last_of('.')) + ".json";
+    exit(ResultStreamWriter::convert(stream_path, json_path) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  if (parsed_args.has_option("convert-patterns"))
+  {
+    // the pattern store is written next to the JSON file, e.g., fuzz-summary.json -> fuzz-summary.rps
+    const auto json_path = parsed_args["convert-patterns"].as<std::string>();
+    const auto store_path = json_path.substr(0, json_path.find_last_of('.')) + PatternStore::FILE_EXTENSION;
+    exit(PatternStore::convert_from_json(json_path, store_path) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+#endif
+
   /**
-   * mandatory parameters
+   * mandatory parameters (given per DIMM in a campaign)
    */
-  if (parsed_args.has_option("dimm-id"))
+  if (parsed_args.has_option("targets"))
+  {
+    program_args.targets_filename = parsed_args["targets"].as<std::string>();
+    Logger::log_debug(format_string("Set --targets=%s", program_args.targets_filename.c_str()));
+  }
+  else if (parsed_args.has_option("dimm-id"))
   {
     program_args.dimm_id = parsed_args["dimm-id"].as<int>(0);
     Logger::log_debug(format_string("Set --dimm-id: %ld", program_args.dimm_id));
@@ -199,7 +486,11 @@ void handle_args(int argc, char **argv)
     exit(EXIT_FAILURE);
   }
 
-  if (parsed_args.has_option("geometry"))
+  if (!program_args.targets_filename.empty())
+  {
+    // the geometry is given per target
+  }
+  else if (parsed_args.has_option("geometry"))
   {
     auto geom = parsed_args["geometry"].as<dram_geometry>();
     program_args.num_ranks = geom.num_ranks;
@@ -212,15 +503,51 @@ void handle_args(int argc, char **argv)
     exit(EXIT_FAILURE);
   }
   program_args.samsung_row_swizzling = parsed_args.has_option("samsung");
-  if (parsed_args.has_option("yaml-exp-cfg") || parsed_args.has_option("yaml-exp-cfg-id"))
+
+  /**
+   * run configuration (formerly compile-time constants in GlobalDefines.hpp)
+   */
+  if (parsed_args.has_option("config"))
+  {
+    runtime_config.load_yaml(parsed_args["config"].as<std::string>());
+  }
+  runtime_config.multi_bank = parsed_args["multi-bank"].as<int>(runtime_config.multi_bank);
+  runtime_config.ref_threshold = parsed_args["ref-threshold"].as<long>(runtime_config.ref_threshold);
+  runtime_config.hugepage_num = parsed_args["hugepage-num"].as<int>(runtime_config.hugepage_num);
+  runtime_config.num_banks = parsed_args["num-banks"].as<size_t>(runtime_config.num_banks);
+  runtime_config.bk_conf_thresh = parsed_args["bk-conf-thresh"].as<size_t>(runtime_config.bk_conf_thresh);
+  runtime_config.full_sweep_rows = parsed_args["full-sweep-rows"].as<size_t>(runtime_config.full_sweep_rows);
+  runtime_config.sweep_log_every = parsed_args["sweep-log-every"].as<size_t>(runtime_config.sweep_log_every);
+  runtime_config.debug_mode = parsed_args.has_option("debug") || runtime_config.debug_mode;
+  // in a campaign, the number of banks is derived and the configuration validated per target
+  if (program_args.targets_filename.empty())
   {
-    if (!parsed_args.has_option("yaml-exp-cfg") || !parsed_args.has_option("yaml-exp-cfg-id"))
+    if (runtime_config.num_banks == 0)
     {
-      Logger::log_error("Program argument '--exp-cfg <filename_yaml>' requires '--exp-cfg-id <int>' and vice versa.");
+      runtime_config.num_banks = program_args.num_bankgroups * program_args.num_banks;
+    }
+    runtime_config.validate();
+  }
+  if (parsed_args.has_option("benchmark"))
+  {
+    program_args.benchmark = parsed_args["benchmark"].as<std::string>();
+    if (program_args.benchmark != "dram-timing" && program_args.benchmark != "prefetch")
+    {
+      Logger::log_error(format_string("Unknown benchmark '%s', must be 'dram-timing' or 'prefetch'.",
+                                      program_args.benchmark.c_str()));
       exit(EXIT_FAILURE);
     }
+    Logger::log_debug(format_string("Set --benchmark=%s", program_args.benchmark.c_str()));
+  }
+  if (parsed_args.has_option("yaml-exp-cfg-id") && !parsed_args.has_option("yaml-exp-cfg"))
+  {
+    Logger::log_error("Program argument '--exp-cfg-id <int>' requires '--exp-cfg <filename_yaml>'.");
+    exit(EXIT_FAILURE);
+  }
+  if (parsed_args.has_option("yaml-exp-cfg"))
+  {
     program_args.filepath_exp_cfg = parsed_args["yaml-exp-cfg"].as<std::string>();
-    program_args.exp_cfg_id = parsed_args["yaml-exp-cfg-id"].as<int>();
+    program_args.exp_cfg_id = parsed_args["yaml-exp-cfg-id"].as<int>(-1);
   }
 
   /**
@@ -238,6 +565,81 @@ void handle_args(int argc, char **argv)
   program_args.num_address_mappings_per_pattern = parsed_args["probes"].as<size_t>(program_args.num_address_mappings_per_pattern);
   Logger::log_debug(format_string("Set --probes=%d", program_args.num_address_mappings_per_pattern));
 
+  program_args.resume = parsed_args.has_option("resume");
+  Logger::log_debug(format_string("Set --resume=%s", (program_args.resume ? "true" : "false")));
+
+  if (parsed_args.has_option("result-format"))
+  {
+    const auto format = parsed_args["result-format"].as<std::string>();
+    if (format != "jsonl" && format != "binary")
+    {
+      Logger::log_error("Program argument '--result-format' must be either 'jsonl' or 'binary'.");
+      exit(EXIT_FAILURE);
+    }
+    from_string(format, program_args.result_format);
+  }
+  Logger::log_debug(format_string("Set --result-format=%s", to_string(program_args.result_format).c_str()));
+  program_args.stream_raw_flips = !parsed_args.has_option("no-raw-flips");
+  Logger::log_debug(format_string("Set --no-raw-flips=%s", (program_args.stream_raw_flips ? "false" : "true")));
+
+  program_args.export_sync_timings = parsed_args.has_option("export-sync-timings");
+  Logger::log_debug(format_string("Set --export-sync-timings=%s", (program_args.export_sync_timings ? "true" : "false")));
+
+  program_args.record_access_trace = parsed_args.has_option("access-trace");
+  Logger::log_debug(format_string("Set --access-trace=%s", (program_args.record_access_trace ? "true" : "false")));
+
+  program_args.check_mapping = parsed_args.has_option("check-mapping");
+  Logger::log_debug(format_string("Set --check-mapping=%s", (program_args.check_mapping ? "true" : "false")));
+
+  program_args.simulate = parsed_args.has_option("simulate");
+  program_args.simulation_seed = parsed_args["simulation-seed"].as<uint64_t>(program_args.simulation_seed);
+  program_args.simulation_flip_threshold =
+      parsed_args["simulation-flip-threshold"].as<size_t>(program_args.simulation_flip_threshold);
+  Logger::log_debug(format_string("Set --simulate=%s, --simulation-seed=%lu, --simulation-flip-threshold=%zu",
+                                  (program_args.simulate ? "true" : "false"), program_args.simulation_seed,
+                                  program_args.simulation_flip_threshold));
+
+  program_args.force_autotune = parsed_args.has_option("autotune");
+  program_args.skip_autotune = parsed_args.has_option("no-autotune");
+  program_args.recalibrate = parsed_args.has_option("recalibrate");
+  Logger::log_debug(format_string("Set --recalibrate=%s", (program_args.recalibrate ? "true" : "false")));
+  if (program_args.force_autotune && program_args.skip_autotune)
+  {
+    Logger::log_error("Program arguments '--autotune' and '--no-autotune' are mutually exclusive.");
+    exit(EXIT_FAILURE);
+  }
+  Logger::log_debug(format_string("Set --autotune=%s, --no-autotune=%s",
+                                  (program_args.force_autotune ? "true" : "false"),
+                                  (program_args.skip_autotune ? "true" : "false")));
+
+  if (parsed_args.has_option("perf-raw-events"))
+  {
+    auto vec_raw_events = parsed_args["perf-raw-events"].as<argagg::csv<std::string>>();
+    for (const auto &ev : vec_raw_events.values)
+    {
+      // the whole value must be a number, std::stoull throws if it does not start with one
+      size_t num_parsed = 0;
+      uint64_t config = 0;
+      try
+      {
+        config = std::stoull(ev, &num_parsed, 0);
+      }
+      catch (const std::exception &)
+      {
+        num_parsed = 0;
+      }
+      if (num_parsed == 0 || num_parsed != ev.size())
+      {
+        Logger::log_error(format_string("Invalid raw perf event '%s' in --perf-raw-events, expected a number such as "
+                                        "0x01a2.", ev.c_str()));
+        std::cerr << argparser;
+        exit(EXIT_FAILURE);
+      }
+      program_args.perf_raw_events.push_back(config);
+      Logger::log_debug(format_string("Set --perf-raw-events+=0x%lx", program_args.perf_raw_events.back()));
+    }
+  }
+
   /**
    * program modes
    */
@@ -255,6 +657,10 @@ void handle_args(int argc, char **argv)
     {
       program_args.pattern_ids = std::unordered_set<std::string>();
     }
+    program_args.replay_top_k = parsed_args["top-k"].as<size_t>(program_args.replay_top_k);
+    Logger::log_debug(format_string("Set --top-k=%zu", program_args.replay_top_k));
+    program_args.sweep_plan_filename = parsed_args["sweep-plan"].as<std::string>("");
+    Logger::log_debug(format_string("Set --sweep-plan=%s", program_args.sweep_plan_filename.c_str()));
   }
   else
   {
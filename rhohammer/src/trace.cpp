@@ -0,0 +1,218 @@
+// rhoTrace: analyzes an access trace recorded with --access-trace (see AccessTraceWriter) without any hardware. For
+// each pattern, mapping, and DRAM location, it determines the ACTs of each row per refresh interval and the activity
+// of each bank, and writes them to <prefix>-rows.csv and <prefix>-banks.csv.
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include "Utilities/AccessTrace.hpp"
+
+#include <argagg/argagg.hpp>
+
+struct RowActivity
+{
+  // the ACTs in a round of the kernel and the most ACTs in one of its refresh intervals
+  uint64_t acts_per_round{0};
+  uint64_t max_acts_per_interval{0};
+};
+
+struct BankActivity
+{
+  uint64_t acts_per_round{0};
+  uint64_t max_acts_per_interval{0};
+  uint64_t num_rows{0};
+};
+
+// the activity of the rows and banks in one block of the trace
+struct BlockActivity
+{
+  // (bank key, row) -> activity
+  std::map<std::pair<uint64_t, uint32_t>, RowActivity> rows;
+
+  // bank key -> activity
+  std::map<uint64_t, BankActivity> banks;
+
+  // bank key -> one of its accesses, for the bank's coordinates
+  std::unordered_map<uint64_t, TraceAccess> bank_coordinates;
+
+  uint64_t num_accesses{0};
+
+  uint64_t num_intervals{0};
+};
+
+// Counts the ACTs of a round of the kernel. An access activates its row unless the row is still open in the bank (open
+// page policy); as the kernel repeats the round, the rows open at the end of a round can still be open at the beginning
+// of the next one (unless it starts with a REF synchronization), hence the round is run twice and only the second pass
+// is counted. The accesses after a REF synchronization are split into refresh intervals of acts_per_trefi accesses.
+static BlockActivity analyze_block(const AccessTraceBlock &block)
+{
+  BlockActivity activity;
+  const auto acts_per_trefi = block.header.acts_per_trefi;
+  std::unordered_map<uint64_t, uint32_t> open_rows;
+  // (bank key, row) -> ACTs in the current refresh interval
+  std::map<std::pair<uint64_t, uint32_t>, uint64_t> interval_row_acts;
+  std::unordered_map<uint64_t, uint64_t> interval_bank_acts;
+
+  auto finish_interval = [&]()
+  {
+    for (const auto &[key, acts] : interval_row_acts)
+    {
+      auto &row = activity.rows[key];
+      row.max_acts_per_interval = std::max(row.max_acts_per_interval, acts);
+    }
+    for (const auto &[bank_key, acts] : interval_bank_acts)
+    {
+      auto &bank = activity.banks[bank_key];
+      bank.max_acts_per_interval = std::max(bank.max_acts_per_interval, acts);
+    }
+    if (!interval_row_acts.empty())
+      activity.num_intervals++;
+    interval_row_acts.clear();
+    interval_bank_acts.clear();
+  };
+
+  for (int pass = 0; pass < 2; pass++)
+  {
+    const bool counted = (pass == 1);
+    uint64_t accesses_since_sync = 0;
+    for (const auto &access : block.accesses)
+    {
+      if (access.op == TRACE_OP::SYNC)
+      {
+        if (counted)
+          finish_interval();
+        // the REF the kernel synchronizes with precharges all banks
+        open_rows.clear();
+        accesses_since_sync = 0;
+        continue;
+      }
+      if (access.op != TRACE_OP::ACCESS)
+        continue;
+      if (counted && acts_per_trefi > 0 && accesses_since_sync > 0 && accesses_since_sync % acts_per_trefi == 0)
+        finish_interval();
+      accesses_since_sync++;
+
+      const auto bank_key = access.get_bank_key();
+      auto it = open_rows.find(bank_key);
+      const bool act = (it == open_rows.end() || it->second != access.row);
+      open_rows[bank_key] = access.row;
+      if (!counted)
+        continue;
+      activity.num_accesses++;
+      activity.bank_coordinates.emplace(bank_key, access);
+      if (!act)
+        continue;
+      activity.rows[{bank_key, access.row}].acts_per_round++;
+      activity.banks[bank_key].acts_per_round++;
+      interval_row_acts[{bank_key, access.row}]++;
+      interval_bank_acts[bank_key]++;
+    }
+    if (counted)
+      finish_interval();
+  }
+  for (const auto &[key, row] : activity.rows)
+    activity.banks[key.first].num_rows++;
+  return activity;
+}
+
+int main(int argc, char **argv)
+{
+  argagg::parser argparser{{
+      {"help", {"-h", "--help"}, "shows this help message", 0},
+      {"output", {"-o", "--output"}, "prefix of the CSV files (default: the trace's path without its extension)", 1},
+  }};
+
+  argagg::parser_results parsed_args;
+  try
+  {
+    parsed_args = argparser.parse(argc, argv);
+  }
+  catch (const std::exception &e)
+  {
+    std::cerr << e.what() << '\n';
+    exit(EXIT_FAILURE);
+  }
+
+  if (parsed_args["help"] || parsed_args.pos.size() != 1)
+  {
+    std::cerr << "Usage: " << argv[0] << " [options] <access-trace.bin>\n" << argparser;
+    exit(parsed_args["help"] ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  const std::string trace_path = parsed_args.pos[0];
+  const auto prefix = parsed_args["output"].as<std::string>(trace_path.substr(0, trace_path.find_last_of('.')));
+
+  AccessTraceReader reader;
+  if (!reader.open(trace_path))
+  {
+    std::cerr << "[-] Could not open " << trace_path << " or it is not an access trace.\n";
+    exit(EXIT_FAILURE);
+  }
+  std::ofstream rows_csv(prefix + "-rows.csv");
+  std::ofstream banks_csv(prefix + "-banks.csv");
+  if (!rows_csv.is_open() || !banks_csv.is_open())
+  {
+    std::cerr << "[-] Could not open the output files " << prefix << "-{rows,banks}.csv.\n";
+    exit(EXIT_FAILURE);
+  }
+  const std::string block_columns = "pattern_id,mapping_id,location,kernel,flushing,fencing,num_rounds,";
+  rows_csv << block_columns << "subchannel,rank,bankgroup,bank,row,acts_per_round,max_acts_per_interval,total_acts\n";
+  banks_csv << block_columns << "subchannel,rank,bankgroup,bank,num_rows,acts_per_round,max_acts_per_interval,"
+                                "total_acts\n";
+
+  AccessTraceBlock block;
+  size_t num_blocks = 0;
+  while (reader.next(block))
+  {
+    num_blocks++;
+    const auto &header = block.header;
+    const auto activity = analyze_block(block);
+    const auto block_values = header.pattern_id + ',' + header.mapping_id + ',' + std::to_string(header.location)
+        + ',' + to_string(header.kernel) + ',' + to_string(header.flushing) + ',' + to_string(header.fencing) + ','
+        + std::to_string(header.num_rounds) + ',';
+
+    std::pair<uint64_t, uint32_t> hottest_row{0, 0};
+    uint64_t hottest_row_acts = 0;
+    for (const auto &[key, row] : activity.rows)
+    {
+      const auto &coords = activity.bank_coordinates.at(key.first);
+      rows_csv << block_values << coords.subchannel << ',' << coords.rank << ',' << coords.bankgroup << ','
+               << coords.bank << ',' << key.second << ',' << row.acts_per_round << ',' << row.max_acts_per_interval
+               << ',' << row.acts_per_round * header.num_rounds << '\n';
+      if (row.max_acts_per_interval > hottest_row_acts)
+      {
+        hottest_row = key;
+        hottest_row_acts = row.max_acts_per_interval;
+      }
+    }
+    uint64_t acts_per_round = 0;
+    for (const auto &[bank_key, bank] : activity.banks)
+    {
+      const auto &coords = activity.bank_coordinates.at(bank_key);
+      banks_csv << block_values << coords.subchannel << ',' << coords.rank << ',' << coords.bankgroup << ','
+                << coords.bank << ',' << bank.num_rows << ',' << bank.acts_per_round << ','
+                << bank.max_acts_per_interval << ',' << bank.acts_per_round * header.num_rounds << '\n';
+      acts_per_round += bank.acts_per_round;
+    }
+
+    std::cout << "[+] Pattern " << header.pattern_id << ", mapping " << header.mapping_id << ", location "
+              << header.location << ": " << activity.num_accesses << " accesses and " << acts_per_round
+              << " ACTs per round (" << header.num_rounds << " rounds, " << activity.num_intervals
+              << " refresh intervals per round) in " << activity.banks.size() << " bank(s)";
+    if (hottest_row_acts > 0)
+    {
+      const auto &coords = activity.bank_coordinates.at(hottest_row.first);
+      std::cout << ", hottest row " << hottest_row.second << " (bank group " << coords.bankgroup << ", bank "
+                << coords.bank << ") with " << hottest_row_acts << " ACTs per refresh interval";
+    }
+    std::cout << ".\n";
+  }
+  std::cout << "[+] Analyzed " << num_blocks << " block(s), wrote " << prefix << "-rows.csv and " << prefix
+            << "-banks.csv.\n";
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,200 @@
+#include "Utilities/AccessTrace.hpp"
+
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+#include "TestHelper.hpp"
+
+static TraceAccess make_access(TRACE_OP op, uint64_t addr, uint32_t bankgroup, uint32_t bank, uint32_t row,
+                               uint32_t col) {
+  TraceAccess access;
+  access.op = op;
+  access.addr = addr;
+  access.subchannel = 1;
+  access.rank = 0;
+  access.bankgroup = bankgroup;
+  access.bank = bank;
+  access.row = row;
+  access.col = col;
+  return access;
+}
+
+static TraceAccess make_fence(TRACE_OP op) {
+  TraceAccess access;
+  access.op = op;
+  return access;
+}
+
+static void expect_equal(const TraceAccess &expected, const TraceAccess &actual, size_t idx) {
+  EXPECT_EQ(expected.op, actual.op) << "access " << idx;
+  EXPECT_EQ(expected.addr, actual.addr) << "access " << idx;
+  EXPECT_EQ(expected.subchannel, actual.subchannel) << "access " << idx;
+  EXPECT_EQ(expected.rank, actual.rank) << "access " << idx;
+  EXPECT_EQ(expected.bankgroup, actual.bankgroup) << "access " << idx;
+  EXPECT_EQ(expected.bank, actual.bank) << "access " << idx;
+  EXPECT_EQ(expected.row, actual.row) << "access " << idx;
+  EXPECT_EQ(expected.col, actual.col) << "access " << idx;
+}
+
+static void expect_equal(const AccessTraceBlock &expected, const AccessTraceBlock &actual) {
+  EXPECT_EQ(expected.header.pattern_id, actual.header.pattern_id);
+  EXPECT_EQ(expected.header.mapping_id, actual.header.mapping_id);
+  EXPECT_EQ(expected.header.location, actual.header.location);
+  EXPECT_EQ(expected.header.kernel, actual.header.kernel);
+  EXPECT_EQ(expected.header.flushing, actual.header.flushing);
+  EXPECT_EQ(expected.header.fencing, actual.header.fencing);
+  EXPECT_EQ(expected.header.acts_per_trefi, actual.header.acts_per_trefi);
+  EXPECT_EQ(expected.header.num_rounds, actual.header.num_rounds);
+  ASSERT_EQ(expected.accesses.size(), actual.accesses.size());
+  for (size_t i = 0; i < expected.accesses.size(); ++i) expect_equal(expected.accesses[i], actual.accesses[i], i);
+}
+
+static AccessTraceBlock make_block(const std::string &pattern_id, uint64_t location) {
+  AccessTraceBlock block;
+  block.header.pattern_id = pattern_id;
+  block.header.mapping_id = "mapping-" + pattern_id;
+  block.header.location = location;
+  block.header.kernel = HAMMERING_KERNEL::UNJITTED;
+  block.header.flushing = FLUSHING_STRATEGY::BATCHED;
+  block.header.fencing = FENCING_STRATEGY::OMIT_FENCING;
+  block.header.acts_per_trefi = 84;
+  block.header.num_rounds = 1ULL << 40;
+  // addresses and rows go up and down, i.e., the deltas are positive and negative
+  block.accesses = {
+      make_access(TRACE_OP::SYNC, 0x7f0040002000, 3, 1, 1000, 0),
+      make_access(TRACE_OP::ACCESS, 0x7f0040042000, 3, 1, 1002, 8),
+      make_access(TRACE_OP::ACCESS, 0x7f0040000040, 3, 1, 998, 1023),
+      make_fence(TRACE_OP::MFENCE),
+      make_access(TRACE_OP::FLUSH, 0x7f0040042000, 3, 1, 1002, 8),
+      make_access(TRACE_OP::ACCESS, 0x7f007fffffc0, 7, 3, 0xffffffff, 0),
+      make_access(TRACE_OP::ACCESS, 0x7f0040000000, 0, 0, 0, 0),
+      make_fence(TRACE_OP::LFENCE),
+  };
+  return block;
+}
+
+static std::vector<AccessTraceBlock> read_blocks(const std::string &path, uint64_t &offset) {
+  std::vector<AccessTraceBlock> blocks;
+  AccessTraceReader reader;
+  if (!reader.open(path)) return blocks;
+  AccessTraceBlock block;
+  while (reader.next(block)) blocks.push_back(block);
+  offset = reader.get_offset();
+  return blocks;
+}
+
+TEST(AccessTraceTest, RoundTrip) {
+  TempDir dir;
+  const auto path = dir.file("access-trace.bin");
+  const auto first = make_block("first", 0);
+  const auto second = make_block("second", 12345);
+  AccessTraceWriter writer;
+  writer.open(path);
+  ASSERT_TRUE(writer.is_open());
+  EXPECT_EQ(writer.get_filepath(), path);
+  writer.write(first.header, first.accesses);
+  writer.write(second.header, second.accesses);
+  writer.write(AccessTraceHeader(), {});
+  writer.close();
+
+  uint64_t offset = 0;
+  const auto blocks = read_blocks(path, offset);
+  ASSERT_EQ(blocks.size(), 3U);
+  expect_equal(first, blocks[0]);
+  expect_equal(second, blocks[1]);
+  expect_equal(AccessTraceBlock(), blocks[2]);
+  EXPECT_EQ(offset, std::filesystem::file_size(path));
+}
+
+TEST(AccessTraceTest, ReadsUpToTruncatedBlock) {
+  TempDir dir;
+  const auto path = dir.file("access-trace.bin");
+  const auto first = make_block("first", 0);
+  const auto second = make_block("second", 1);
+  AccessTraceWriter writer;
+  writer.open(path);
+  writer.write(first.header, first.accesses);
+  writer.close();
+  const auto first_size = std::filesystem::file_size(path);
+  writer.open(path, true);
+  writer.write(second.header, second.accesses);
+  writer.close();
+
+  // every cut within the second block leaves the first one readable
+  const auto trace = read_file(path);
+  for (auto size = first_size; size < trace.size(); ++size) {
+    write_file(path, trace.substr(0, size));
+    uint64_t offset = 0;
+    const auto blocks = read_blocks(path, offset);
+    ASSERT_EQ(blocks.size(), 1U) << "trace cut at " << size;
+    expect_equal(first, blocks[0]);
+    EXPECT_EQ(offset, first_size);
+  }
+}
+
+TEST(AccessTraceTest, AppendCutsOffTruncatedBlock) {
+  TempDir dir;
+  const auto path = dir.file("access-trace.bin");
+  const auto first = make_block("first", 0);
+  const auto second = make_block("second", 1);
+  const auto third = make_block("third", 2);
+  AccessTraceWriter writer;
+  writer.open(path);
+  writer.write(first.header, first.accesses);
+  writer.write(second.header, second.accesses);
+  writer.close();
+  const auto trace = read_file(path);
+  write_file(path, trace.substr(0, trace.size() - 3));
+
+  // e.g., a resumed run
+  writer.open(path, true);
+  writer.write(third.header, third.accesses);
+  writer.close();
+
+  uint64_t offset = 0;
+  const auto blocks = read_blocks(path, offset);
+  ASSERT_EQ(blocks.size(), 2U);
+  expect_equal(first, blocks[0]);
+  expect_equal(third, blocks[1]);
+  EXPECT_EQ(offset, std::filesystem::file_size(path));
+}
+
+TEST(AccessTraceTest, AppendCreatesMissingTrace) {
+  TempDir dir;
+  const auto path = dir.file("access-trace.bin");
+  const auto first = make_block("first", 0);
+  AccessTraceWriter writer;
+  writer.open(path, true);
+  writer.write(first.header, first.accesses);
+  writer.close();
+
+  uint64_t offset = 0;
+  const auto blocks = read_blocks(path, offset);
+  ASSERT_EQ(blocks.size(), 1U);
+  expect_equal(first, blocks[0]);
+}
+
+TEST(AccessTraceTest, RejectsOtherFiles) {
+  TempDir dir;
+  const auto path = dir.file("other.bin");
+  AccessTraceReader reader;
+  EXPECT_FALSE(reader.open(path));
+  write_file(path, "RTRX\x01\x00\x00\x00");
+  EXPECT_FALSE(AccessTraceReader().open(path));
+  write_file(path, "RTR");
+  EXPECT_FALSE(AccessTraceReader().open(path));
+}
+
+TEST(AccessTraceTest, BankKey) {
+  const auto access = make_access(TRACE_OP::ACCESS, 0x1000, 3, 1, 1000, 0);
+  auto other_row = make_access(TRACE_OP::ACCESS, 0x2000, 3, 1, 2000, 8);
+  EXPECT_EQ(access.get_bank_key(), other_row.get_bank_key());
+  for (auto *field : {&other_row.subchannel, &other_row.rank, &other_row.bankgroup, &other_row.bank}) {
+    (*field)++;
+    EXPECT_NE(access.get_bank_key(), other_row.get_bank_key());
+    (*field)--;
+  }
+  EXPECT_TRUE(access.has_address());
+  EXPECT_FALSE(make_fence(TRACE_OP::MFENCE).has_address());
+}
@@ -0,0 +1,133 @@
+#include "Utilities/CoverageMap.hpp"
+
+#include <gtest/gtest.h>
+
+#include "TestHelper.hpp"
+#include "Utilities/Helper.hpp"
+
+static constexpr long DIMM_ID = 7;
+static constexpr size_t NUM_BANKS = 4;
+static constexpr size_t ROWS_PER_BANK = 100;
+
+TEST(CoverageMapTest, MarksLocations) {
+  TempDir dir;
+  CoverageMap map;
+  map.open(dir.file("coverage.bin"), DIMM_ID, NUM_BANKS, ROWS_PER_BANK);
+  ASSERT_TRUE(map.is_open());
+
+  const auto slot = map.get_slot("pattern", "mapping");
+  EXPECT_EQ(map.get_slot("pattern", "mapping"), slot);
+  EXPECT_FALSE(map.is_covered(slot, 1, 42));
+
+  map.mark(slot, 1, 42, 0);
+  map.mark(slot, 3, 99, 5);
+  // marking a location again only adds its bit flips
+  map.mark(slot, 3, 99, 2);
+  EXPECT_TRUE(map.is_covered(slot, 1, 42));
+  EXPECT_FALSE(map.has_flipped(slot, 1, 42));
+  EXPECT_TRUE(map.is_covered(slot, 3, 99));
+  EXPECT_TRUE(map.has_flipped(slot, 3, 99));
+  EXPECT_FALSE(map.is_covered(slot, 0, 42));
+  EXPECT_FALSE(map.is_covered(slot, 1, 43));
+
+  const auto &entry = map.get_entry(slot);
+  EXPECT_STREQ(entry.pattern_id, "pattern");
+  EXPECT_STREQ(entry.mapping_id, "mapping");
+  EXPECT_EQ(entry.num_covered, 2U);
+  EXPECT_EQ(entry.num_flipped, 1U);
+  EXPECT_EQ(entry.num_bitflips, 7U);
+  EXPECT_DOUBLE_EQ(map.get_covered_fraction(slot), 2.0/(NUM_BANKS*ROWS_PER_BANK));
+}
+
+TEST(CoverageMapTest, SlotsAreIndependent) {
+  TempDir dir;
+  CoverageMap map;
+  map.open(dir.file("coverage.bin"), DIMM_ID, NUM_BANKS, ROWS_PER_BANK);
+  const auto slot_a = map.get_slot("pattern", "mapping-a");
+  map.mark(slot_a, 0, 0, 1);
+  // adding a slot grows (and remaps) the file
+  const auto slot_b = map.get_slot("pattern", "mapping-b");
+  EXPECT_NE(slot_a, slot_b);
+  map.mark(slot_b, 0, 1, 0);
+
+  EXPECT_TRUE(map.is_covered(slot_a, 0, 0));
+  EXPECT_FALSE(map.is_covered(slot_a, 0, 1));
+  EXPECT_FALSE(map.is_covered(slot_b, 0, 0));
+  EXPECT_TRUE(map.is_covered(slot_b, 0, 1));
+  EXPECT_EQ(map.get_entry(slot_a).num_bitflips, 1U);
+  EXPECT_EQ(map.get_entry(slot_b).num_bitflips, 0U);
+}
+
+TEST(CoverageMapTest, ReopenKeepsCoverage) {
+  TempDir dir;
+  const auto path = dir.file("coverage.bin");
+  size_t slot_a;
+  size_t slot_b;
+  {
+    CoverageMap map;
+    map.open(path, DIMM_ID, NUM_BANKS, ROWS_PER_BANK);
+    slot_a = map.get_slot("pattern", "mapping-a");
+    slot_b = map.get_slot("pattern", "mapping-b");
+    map.mark(slot_a, 2, 10, 3);
+    map.mark(slot_b, 3, 20, 0);
+    map.close();
+    EXPECT_FALSE(map.is_open());
+  }
+
+  CoverageMap map;
+  map.open(path, DIMM_ID, NUM_BANKS, ROWS_PER_BANK);
+  EXPECT_EQ(map.get_slot("pattern", "mapping-a"), slot_a);
+  EXPECT_EQ(map.get_slot("pattern", "mapping-b"), slot_b);
+  EXPECT_TRUE(map.is_covered(slot_a, 2, 10));
+  EXPECT_TRUE(map.has_flipped(slot_a, 2, 10));
+  EXPECT_TRUE(map.is_covered(slot_b, 3, 20));
+  EXPECT_FALSE(map.is_covered(slot_b, 2, 10));
+  EXPECT_EQ(map.get_entry(slot_a).num_bitflips, 3U);
+
+  // new slots are appended after the existing ones
+  const auto slot_c = map.get_slot("other-pattern", "mapping-a");
+  EXPECT_EQ(slot_c, 2U);
+  EXPECT_FALSE(map.is_covered(slot_c, 2, 10));
+}
+
+TEST(CoverageMapTest, LongIdsAreTruncated) {
+  TempDir dir;
+  const auto path = dir.file("coverage.bin");
+  const std::string long_id(100, 'p');
+  size_t slot;
+  {
+    CoverageMap map;
+    map.open(path, DIMM_ID, NUM_BANKS, ROWS_PER_BANK);
+    slot = map.get_slot(long_id, "mapping");
+    map.mark(slot, 0, 0, 0);
+  }
+  CoverageMap map;
+  map.open(path, DIMM_ID, NUM_BANKS, ROWS_PER_BANK);
+  EXPECT_EQ(map.get_slot(long_id, "mapping"), slot);
+  EXPECT_TRUE(map.is_covered(slot, 0, 0));
+}
+
+TEST(CoverageMapTest, RejectsDifferentDimm) {
+  TempDir dir;
+  const auto path = dir.file("coverage.bin");
+  {
+    CoverageMap map;
+    map.open(path, DIMM_ID, NUM_BANKS, ROWS_PER_BANK);
+  }
+  is_campaign_worker = true;
+  CoverageMap map;
+  EXPECT_THROW(map.open(path, DIMM_ID + 1, NUM_BANKS, ROWS_PER_BANK), TargetExit);
+  EXPECT_THROW(map.open(path, DIMM_ID, NUM_BANKS*2, ROWS_PER_BANK), TargetExit);
+  EXPECT_THROW(map.open(path, DIMM_ID, NUM_BANKS, ROWS_PER_BANK + 1), TargetExit);
+  is_campaign_worker = false;
+}
+
+TEST(CoverageMapTest, RejectsOtherFiles) {
+  TempDir dir;
+  const auto path = dir.file("coverage.bin");
+  write_file(path, std::string(sizeof(CoverageMapHeader), 'x'));
+  is_campaign_worker = true;
+  CoverageMap map;
+  EXPECT_THROW(map.open(path, DIMM_ID, NUM_BANKS, ROWS_PER_BANK), TargetExit);
+  is_campaign_worker = false;
+}
@@ -0,0 +1,90 @@
+#include "Utilities/DurableLog.hpp"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "TestHelper.hpp"
+
+static std::vector<std::string> read_all_lines(const std::string &path, size_t &ignored_bytes) {
+  std::vector<std::string> lines;
+  ignored_bytes = DurableLog::read_lines(path, [&](const std::string &line) { lines.push_back(line); });
+  return lines;
+}
+
+TEST(DurableLogTest, AppendsLines) {
+  TempDir dir;
+  const auto path = dir.file("log.jsonl");
+  DurableLog log(2, 10);
+  log.open(path);
+  ASSERT_TRUE(log.is_open());
+  log.append("first");
+  log.append("second");
+  log.append("third", true);
+  log.close();
+  EXPECT_FALSE(log.is_open());
+  EXPECT_EQ(read_file(path), "first\nsecond\nthird\n");
+
+  size_t ignored_bytes = 0;
+  EXPECT_EQ(read_all_lines(path, ignored_bytes), (std::vector<std::string>{"first", "second", "third"}));
+  EXPECT_EQ(ignored_bytes, 0U);
+}
+
+TEST(DurableLogTest, ReadLinesOfMissingFile) {
+  TempDir dir;
+  size_t ignored_bytes = 1;
+  EXPECT_TRUE(read_all_lines(dir.file("missing.jsonl"), ignored_bytes).empty());
+  EXPECT_EQ(ignored_bytes, 0U);
+}
+
+TEST(DurableLogTest, ReadLinesIgnoresPartialLastLine) {
+  TempDir dir;
+  const auto path = dir.file("log.jsonl");
+  write_file(path, "first\n\nsecond\n{\"cut\":");
+  size_t ignored_bytes = 0;
+  // empty lines are skipped, the cut-off record is not passed on
+  EXPECT_EQ(read_all_lines(path, ignored_bytes), (std::vector<std::string>{"first", "second"}));
+  EXPECT_EQ(ignored_bytes, 7U);
+}
+
+TEST(DurableLogTest, ResumeDropsPartialLastLine) {
+  TempDir dir;
+  const auto path = dir.file("log.jsonl");
+  write_file(path, "first\nsecond\n{\"cut\":");
+
+  DurableLog log;
+  log.open(path);
+  EXPECT_EQ(read_file(path), "first\nsecond\n");
+  log.append("third", true);
+  log.close();
+
+  size_t ignored_bytes = 0;
+  EXPECT_EQ(read_all_lines(path, ignored_bytes), (std::vector<std::string>{"first", "second", "third"}));
+  EXPECT_EQ(ignored_bytes, 0U);
+}
+
+TEST(DurableLogTest, ResumeWithoutAnyCompleteLine) {
+  TempDir dir;
+  const auto path = dir.file("log.jsonl");
+  // longer than the buffer the partial line is searched with
+  write_file(path, std::string(5000, 'x'));
+
+  DurableLog log;
+  log.open(path);
+  EXPECT_EQ(read_file(path), "");
+  log.append("first", true);
+  log.close();
+  EXPECT_EQ(read_file(path), "first\n");
+}
+
+TEST(DurableLogTest, ResumeKeepsCompleteLog) {
+  TempDir dir;
+  const auto path = dir.file("log.jsonl");
+  write_file(path, "first\n" + std::string(5000, 'x') + "\n");
+
+  DurableLog log;
+  log.open(path);
+  log.append("third", true);
+  log.close();
+  EXPECT_EQ(read_file(path), "first\n" + std::string(5000, 'x') + "\nthird\n");
+}
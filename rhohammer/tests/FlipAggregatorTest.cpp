@@ -0,0 +1,92 @@
+#include "Utilities/FlipAggregator.hpp"
+
+#include <gtest/gtest.h>
+
+#include "Memory/DRAMAddr.hpp"
+
+static constexpr size_t ROWS_PER_BANK = 1024;
+
+class FlipAggregatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // the built-in mapping of a single-rank DIMM with 8 bank groups of 4 banks, based at the second superpage
+    DRAMAddr::load_mem_config(CHANS(1) | DIMMS(1) | RANKS(1) | BANKGROUPS(8) | BANKS(4));
+    DRAMAddr::set_base_msb(reinterpret_cast<void *>(1ULL << 30));
+  }
+
+  static BitFlip make_flip(size_t bankgroup, size_t bank, size_t row, uint8_t bitmask, uint8_t corrupted_data) {
+    return {DRAMAddr(0, 0, bankgroup, bank, row, 0), bitmask, corrupted_data};
+  }
+};
+
+TEST_F(FlipAggregatorTest, CountsFlips) {
+  FlipAggregator aggregator(ROWS_PER_BANK);
+  // bits 0 and 2 flipped, bit 0 from 0 to 1 and bit 2 from 1 to 0
+  aggregator.record(make_flip(1, 2, 9, 0b101, 0b001));
+  aggregator.record(make_flip(1, 3, 900, 0b100, 0b100));
+  EXPECT_EQ(aggregator.get_num_flipped_bytes(), 2U);
+  EXPECT_EQ(aggregator.get_num_flipped_bits(), 3U);
+
+  const auto j = aggregator.to_json();
+  EXPECT_EQ(j.at("zero_to_one"), 2);
+  EXPECT_EQ(j.at("one_to_zero"), 1);
+  EXPECT_EQ(j.at("by_bit"), nlohmann::json({1, 0, 2, 0, 0, 0, 0, 0}));
+  EXPECT_EQ(j.at("by_bankgroup").at(1), 3);
+  EXPECT_EQ(j.at("by_bank"), nlohmann::json({{{"bankgroup", 1}, {"bank", 2}, {"flips", 2}},
+                                             {{"bankgroup", 1}, {"bank", 3}, {"flips", 1}}}));
+  // 256 buckets of 4 rows each
+  EXPECT_EQ(j.at("by_row").at("bucket_width"), 4);
+  EXPECT_EQ(j.at("by_row").at("buckets"), nlohmann::json({{8, 2}, {900, 1}}));
+}
+
+TEST_F(FlipAggregatorTest, CountsByteOffsets) {
+  FlipAggregator aggregator(ROWS_PER_BANK);
+  size_t expected[8]{};
+  for (size_t col = 0; col < 16; ++col) {
+    const DRAMAddr addr(0, 0, 0, 0, 5, col);
+    aggregator.record(BitFlip(addr, 0b11, 0));
+    expected[reinterpret_cast<uintptr_t>(addr.to_virt())%8] += 2;
+  }
+  const auto j = aggregator.to_json();
+  for (size_t i = 0; i < 8; ++i) EXPECT_EQ(j.at("by_byte_offset").at(i), expected[i]) << "offset " << i;
+}
+
+TEST_F(FlipAggregatorTest, ReportsTopRows) {
+  FlipAggregator aggregator(ROWS_PER_BANK, 2);
+  for (int i = 0; i < 5; ++i) aggregator.record(make_flip(0, 0, 100, 0b1, 0b1));
+  for (int i = 0; i < 3; ++i) aggregator.record(make_flip(2, 1, 100, 0b11, 0b11));
+  aggregator.record(make_flip(0, 0, 101, 0b1, 0b1));
+
+  const auto top_rows = aggregator.to_json().at("top_rows");
+  ASSERT_EQ(top_rows.size(), 2U);
+  EXPECT_EQ(top_rows[0], nlohmann::json({{"bankgroup", 2}, {"bank", 1}, {"row", 100}, {"flips", 6},
+                                         {"max_error", 0}}));
+  EXPECT_EQ(top_rows[1], nlohmann::json({{"bankgroup", 0}, {"bank", 0}, {"row", 100}, {"flips", 5},
+                                         {"max_error", 0}}));
+}
+
+TEST_F(FlipAggregatorTest, KeepsHeavyRowsWhenCountersRunOut) {
+  FlipAggregator aggregator(ROWS_PER_BANK, 1);
+  for (int i = 0; i < 10; ++i) aggregator.record(make_flip(0, 0, 0, 0b1, 0b1));
+  // many more distinct rows than counters, each with a single flip
+  for (size_t row = 1; row < ROWS_PER_BANK; ++row) aggregator.record(make_flip(0, 0, row, 0b1, 0b1));
+  EXPECT_EQ(aggregator.get_num_flipped_bits(), 10U + ROWS_PER_BANK - 1);
+
+  const auto top_rows = aggregator.to_json().at("top_rows");
+  ASSERT_EQ(top_rows.size(), 1U);
+  EXPECT_EQ(top_rows[0].at("row"), 0);
+  EXPECT_EQ(top_rows[0].at("flips"), 10);
+  EXPECT_EQ(top_rows[0].at("max_error"), 0);
+}
+
+TEST_F(FlipAggregatorTest, ReplacedRowsReportTheirError) {
+  FlipAggregator aggregator(ROWS_PER_BANK, 512);
+  for (size_t row = 0; row < 256; ++row) aggregator.record(make_flip(0, 0, row, 0b1, 0b1));
+  // no counter is left, the new row takes over the smallest one
+  aggregator.record(make_flip(0, 1, 0, 0b11, 0b11));
+
+  const auto top_rows = aggregator.to_json().at("top_rows");
+  EXPECT_EQ(top_rows.size(), 256U);
+  EXPECT_EQ(top_rows[0], nlohmann::json({{"bankgroup", 0}, {"bank", 1}, {"row", 0}, {"flips", 3},
+                                         {"max_error", 1}}));
+}
@@ -0,0 +1,84 @@
+#include "Utilities/SequentialEstimator.hpp"
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "Utilities/Helper.hpp"
+
+TEST(SequentialEstimatorTest, MeanAndStddev) {
+  SequentialEstimator estimator(0.95, 0.01, 2, 100);
+  for (const auto sample : {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0}) EXPECT_TRUE(estimator.add(sample));
+  EXPECT_EQ(estimator.get_count(), 8U);
+  EXPECT_DOUBLE_EQ(estimator.get_mean(), 5.0);
+  EXPECT_DOUBLE_EQ(estimator.get_stddev(), std::sqrt(32.0/7.0));
+  // the 95% interval is +-1.96 standard errors
+  EXPECT_NEAR(estimator.get_half_width(), 1.959964*std::sqrt(32.0/7.0)/std::sqrt(8.0), 1e-5);
+}
+
+TEST(SequentialEstimatorTest, StopsWhenPrecise) {
+  SequentialEstimator estimator(0.99, 0.05, 10, 1000);
+  for (int i = 0; i < 9; ++i) {
+    estimator.add((i%2 == 0) ? 99.0 : 101.0);
+    EXPECT_FALSE(estimator.is_done()) << "stopped before min_samples at sample " << i;
+  }
+  estimator.add(99.0);
+  EXPECT_TRUE(estimator.is_precise());
+  EXPECT_TRUE(estimator.is_done());
+  EXPECT_GT(estimator.get_achieved_confidence(), 0.99);
+}
+
+TEST(SequentialEstimatorTest, StopsAtMaxSamples) {
+  SequentialEstimator estimator(0.95, 0.001, 2, 20);
+  for (int i = 0; i < 19; ++i) {
+    estimator.add((i%2 == 0) ? 10.0 : 1000.0);
+    EXPECT_FALSE(estimator.is_done());
+  }
+  estimator.add(10.0);
+  EXPECT_FALSE(estimator.is_precise());
+  EXPECT_TRUE(estimator.is_done());
+  EXPECT_LT(estimator.get_achieved_confidence(), 0.95);
+}
+
+TEST(SequentialEstimatorTest, RejectsSamplesOutsideValidRange) {
+  SequentialEstimator estimator(0.95, 0.01, 2, 4);
+  estimator.set_valid_range(10, 20);
+  EXPECT_FALSE(estimator.add(9));
+  EXPECT_TRUE(estimator.add(10));
+  EXPECT_TRUE(estimator.add(20));
+  EXPECT_FALSE(estimator.add(21));
+  EXPECT_EQ(estimator.get_count(), 2U);
+  EXPECT_EQ(estimator.get_num_rejected(), 2U);
+  EXPECT_DOUBLE_EQ(estimator.get_mean(), 15);
+  // outliers count towards max_samples, so that a broken measurement cannot loop forever
+  EXPECT_TRUE(estimator.is_done());
+}
+
+TEST(SequentialEstimatorTest, RejectsSamplesFarOffTheMean) {
+  SequentialEstimator estimator(0.95, 0.0001, 4, 100);
+  estimator.set_outlier_sigmas(3);
+  // before min_samples, there is no reliable standard deviation to compare to
+  for (const auto sample : {100.0, 102.0, 98.0, 100.0}) EXPECT_TRUE(estimator.add(sample));
+  EXPECT_FALSE(estimator.add(1000));
+  EXPECT_FALSE(estimator.add(0));
+  EXPECT_TRUE(estimator.add(103));
+  EXPECT_EQ(estimator.get_count(), 5U);
+  EXPECT_EQ(estimator.get_num_rejected(), 2U);
+  EXPECT_DOUBLE_EQ(estimator.get_mean(), 100.6);
+}
+
+TEST(SequentialEstimatorTest, FewSamplesAreNotPrecise) {
+  SequentialEstimator estimator(0.95, 0.5, 0, 10);
+  EXPECT_FALSE(estimator.is_done());
+  estimator.add(5);
+  EXPECT_TRUE(std::isinf(estimator.get_half_width()));
+  EXPECT_EQ(estimator.get_achieved_confidence(), 0);
+  EXPECT_FALSE(estimator.is_done());
+}
+
+TEST(SequentialEstimatorTest, RejectsInvalidConfiguration) {
+  is_campaign_worker = true;
+  EXPECT_THROW(SequentialEstimator(1.0, 0.01, 2, 10), TargetExit);
+  EXPECT_THROW(SequentialEstimator(0.95, 0, 2, 10), TargetExit);
+  is_campaign_worker = false;
+}
@@ -0,0 +1,165 @@
+#include "Utilities/Statistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Utilities/Helper.hpp"
+
+// the exact value below which the fraction q of the sorted values are, as defined by get_quantile
+static double get_exact_quantile(const std::vector<double> &sorted, double q) {
+  const auto rank = static_cast<size_t>(std::ceil(q*static_cast<double>(sorted.size())));
+  return sorted[std::max<size_t>(1, rank) - 1];
+}
+
+TEST(LogLinearHistogramTest, SmallValuesAreExact) {
+  LogLinearHistogram histogram(6);
+  for (int i = 100; i >= 1; --i) histogram.add(i);
+  EXPECT_EQ(histogram.get_count(), 100U);
+  EXPECT_EQ(histogram.get_min(), 1);
+  EXPECT_EQ(histogram.get_max(), 100);
+  EXPECT_DOUBLE_EQ(histogram.get_mean(), 50.5);
+  EXPECT_NEAR(histogram.get_stddev(), 29.011492, 1e-6);
+  EXPECT_EQ(histogram.get_quantile(0), 1);
+  EXPECT_EQ(histogram.get_quantile(0.5), 50);
+  EXPECT_EQ(histogram.get_quantile(0.99), 99);
+  EXPECT_EQ(histogram.get_quantile(1), 100);
+}
+
+TEST(LogLinearHistogramTest, LargeValuesWithinRelativeError) {
+  constexpr size_t PRECISION_BITS = 5;
+  LogLinearHistogram histogram(PRECISION_BITS);
+  std::mt19937_64 gen(42);
+  std::lognormal_distribution<double> dist(10, 2);
+  std::vector<double> values;
+  for (int i = 0; i < 100000; ++i) {
+    values.push_back(std::round(dist(gen)));
+    histogram.add(values.back());
+  }
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(histogram.get_min(), values.front());
+  EXPECT_EQ(histogram.get_max(), values.back());
+  for (const auto q : {0.01, 0.1, 0.5, 0.9, 0.99, 0.999}) {
+    const auto exact = get_exact_quantile(values, q);
+    EXPECT_LE(std::fabs(histogram.get_quantile(q) - exact), exact/(1 << PRECISION_BITS)) << "quantile " << q;
+  }
+}
+
+TEST(LogLinearHistogramTest, ClampsValues) {
+  LogLinearHistogram histogram;
+  histogram.add(-5);
+  histogram.add(1e30);
+  EXPECT_EQ(histogram.get_count(), 2U);
+  EXPECT_EQ(histogram.get_min(), 0);
+  EXPECT_EQ(histogram.get_max(), 1e30);
+  EXPECT_EQ(histogram.get_quantile(0.5), 0);
+  EXPECT_GT(histogram.get_quantile(1), 1e18);
+}
+
+TEST(LogLinearHistogramTest, MostFrequent) {
+  LogLinearHistogram histogram;
+  for (int i = 0; i < 5; ++i) histogram.add(9);
+  for (int i = 0; i < 2; ++i) histogram.add(3);
+  for (int i = 0; i < 5; ++i) histogram.add(7);
+  histogram.add(1000);
+  // ties are broken by the lower value
+  EXPECT_EQ(histogram.get_most_frequent(3), (std::vector<uint64_t>{7, 9, 3}));
+  EXPECT_EQ(histogram.get_most_frequent(10).size(), 4U);
+}
+
+TEST(LogLinearHistogramTest, MergeEqualsAddingAll) {
+  LogLinearHistogram a;
+  LogLinearHistogram b;
+  LogLinearHistogram all;
+  for (int i = 0; i < 1000; ++i) {
+    const auto value = static_cast<double>((i*7919)%5000);
+    ((i%3 == 0) ? a : b).add(value);
+    all.add(value);
+  }
+  a.merge(b);
+  a.merge(LogLinearHistogram());
+  EXPECT_EQ(a.get_count(), all.get_count());
+  EXPECT_EQ(a.get_min(), all.get_min());
+  EXPECT_EQ(a.get_max(), all.get_max());
+  EXPECT_DOUBLE_EQ(a.get_mean(), all.get_mean());
+  EXPECT_EQ(a.to_json(), all.to_json());
+
+  LogLinearHistogram empty;
+  empty.merge(all);
+  EXPECT_EQ(empty.get_min(), all.get_min());
+}
+
+TEST(LogLinearHistogramTest, MergeRequiresSamePrecision) {
+  is_campaign_worker = true;
+  LogLinearHistogram a(6);
+  EXPECT_THROW(a.merge(LogLinearHistogram(7)), TargetExit);
+  EXPECT_THROW(LogLinearHistogram(0), TargetExit);
+  is_campaign_worker = false;
+}
+
+TEST(LogLinearHistogramTest, Clear) {
+  LogLinearHistogram histogram;
+  histogram.add(10);
+  histogram.add(20);
+  histogram.clear();
+  EXPECT_EQ(histogram.get_count(), 0U);
+  EXPECT_EQ(histogram.get_quantile(0.5), 0);
+  EXPECT_TRUE(histogram.get_most_frequent(1).empty());
+  histogram.add(30);
+  EXPECT_EQ(histogram.get_min(), 30);
+  EXPECT_EQ(histogram.get_quantile(0.5), 30);
+}
+
+TEST(QuantileSketchTest, FewValuesAreExact) {
+  QuantileSketch sketch(128);
+  for (int i = 100; i >= 1; --i) sketch.add(i);
+  EXPECT_EQ(sketch.get_count(), 100U);
+  EXPECT_EQ(sketch.get_min(), 1);
+  EXPECT_EQ(sketch.get_max(), 100);
+  EXPECT_EQ(sketch.get_quantile(0.5), 50);
+  EXPECT_EQ(sketch.get_quantile(0.99), 99);
+  EXPECT_EQ(sketch.get_quantile(1), 100);
+}
+
+TEST(QuantileSketchTest, ManyValuesWithinRankError) {
+  QuantileSketch sketch(128);
+  constexpr int NUM_VALUES = 200000;
+  std::vector<double> values(NUM_VALUES);
+  for (int i = 0; i < NUM_VALUES; ++i) values[i] = i;
+  std::shuffle(values.begin(), values.end(), std::mt19937_64(42));
+  for (const auto value : values) sketch.add(value);
+
+  EXPECT_EQ(sketch.get_count(), static_cast<uint64_t>(NUM_VALUES));
+  EXPECT_EQ(sketch.get_min(), 0);
+  EXPECT_EQ(sketch.get_max(), NUM_VALUES - 1);
+  // the value of a quantile is its rank here
+  for (const auto q : {0.01, 0.1, 0.5, 0.9, 0.99}) {
+    EXPECT_NEAR(sketch.get_quantile(q), q*NUM_VALUES, 0.03*NUM_VALUES) << "quantile " << q;
+  }
+}
+
+TEST(QuantileSketchTest, MergeWithinRankError) {
+  QuantileSketch low;
+  QuantileSketch high;
+  constexpr int NUM_VALUES = 50000;
+  for (int i = 0; i < NUM_VALUES; ++i) {
+    low.add(i);
+    high.add(NUM_VALUES + i);
+  }
+  low.merge(high);
+  low.merge(QuantileSketch());
+  EXPECT_EQ(low.get_count(), 2U*NUM_VALUES);
+  EXPECT_EQ(low.get_min(), 0);
+  EXPECT_EQ(low.get_max(), 2*NUM_VALUES - 1);
+  for (const auto q : {0.1, 0.25, 0.5, 0.75, 0.9}) {
+    EXPECT_NEAR(low.get_quantile(q), q*2*NUM_VALUES, 0.03*2*NUM_VALUES) << "quantile " << q;
+  }
+
+  QuantileSketch empty;
+  empty.merge(high);
+  EXPECT_EQ(empty.get_min(), NUM_VALUES);
+  EXPECT_EQ(empty.get_count(), static_cast<uint64_t>(NUM_VALUES));
+}
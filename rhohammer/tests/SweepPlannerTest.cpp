@@ -0,0 +1,181 @@
+#include "Forges/SweepPlanner.hpp"
+
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+#include "TestHelper.hpp"
+#include "Utilities/Helper.hpp"
+#include "main.hpp"
+
+class SweepPlannerTest : public ::testing::Test {
+ protected:
+  TempDir dir;
+  SweepPlan plan;
+
+  void SetUp() override {
+    program_args.output_dir = dir.get_path();
+    plan.num_rows = 100;
+    plan.banks = {0, 1};
+    plan.chunk_rows = 10;
+  }
+
+  void TearDown() override {
+    program_args.output_dir.clear();
+    is_campaign_worker = false;
+  }
+
+  static SweepCounts make_counts(size_t num_flips) {
+    SweepCounts counts;
+    counts.num_flips = num_flips;
+    counts.num_flips_z2o = num_flips/2;
+    counts.num_flips_o2z = num_flips - num_flips/2;
+    counts.num_observed_bitflips = 2*num_flips;
+    return counts;
+  }
+};
+
+TEST_F(SweepPlannerTest, RemainingTimeIsUnknownBeforeFirstChunk) {
+  SweepPlanner planner;
+  EXPECT_EQ(planner.begin(plan, 1, false), 0U);
+  EXPECT_EQ(planner.get_remaining_sec(100, 0), -1);
+  planner.end();
+}
+
+TEST_F(SweepPlannerTest, RemainingTimeOfSweeps) {
+  SweepPlanner planner;
+  planner.begin(plan, 3, false);
+  // 0.5 s per location
+  planner.complete_chunk(0, 0, 0, 10, 5.0, make_counts(0), 0);
+  // the rest of this sweep plus two sweeps of 2 banks x 100 locations
+  EXPECT_DOUBLE_EQ(planner.get_remaining_sec(20, 0), 20*0.5 + 2*200*0.5);
+
+  planner.complete_sweep(0, make_counts(0), 0);
+  EXPECT_DOUBLE_EQ(planner.get_remaining_sec(200, 0), 200*0.5 + 200*0.5);
+  planner.complete_sweep(1, make_counts(0), 0);
+  EXPECT_DOUBLE_EQ(planner.get_remaining_sec(30, 0), 30*0.5);
+  planner.end();
+}
+
+TEST_F(SweepPlannerTest, RemainingTimeIsCappedByBudget) {
+  plan.time_budget = 30;
+  SweepPlanner planner;
+  planner.begin(plan, 3, false);
+  planner.complete_chunk(0, 0, 0, 10, 5.0, make_counts(0), 0);
+  // the current sweep ends with its budget, the next ones after time_budget each
+  EXPECT_DOUBLE_EQ(planner.get_remaining_sec(20, 4.0), 4.0 + 2*30.0);
+  EXPECT_DOUBLE_EQ(planner.get_remaining_sec(4, 4.0), 2.0 + 2*30.0);
+  // an exhausted budget does not count negatively
+  EXPECT_DOUBLE_EQ(planner.get_remaining_sec(20, -1.0), 2*30.0);
+  planner.end();
+}
+
+TEST_F(SweepPlannerTest, ResumeSkipsCompletedChunks) {
+  uint32_t sync_row;
+  {
+    SweepPlanner planner;
+    EXPECT_EQ(planner.begin(plan, 2, false), 0U);
+    sync_row = planner.get_sync_row_gen(1, 1)();
+    planner.complete_chunk(0, 0, 0, 10, 1.0, make_counts(1), 100);
+    planner.complete_chunk(0, 0, 10, 10, 1.0, make_counts(2), 200);
+    planner.complete_chunk(0, 1, 0, 10, 1.0, make_counts(4), 300);
+    planner.complete_sweep(0, make_counts(7), 350);
+    planner.complete_chunk(1, 0, 0, 10, 1.0, make_counts(8), 400);
+    planner.end();
+  }
+
+  SweepPlanner planner;
+  EXPECT_EQ(planner.begin(plan, 2, true), 400U);
+  // the sync rows are drawn from the same seed as before
+  EXPECT_EQ(planner.get_sync_row_gen(1, 1)(), sync_row);
+
+  SweepCounts counts;
+  EXPECT_TRUE(planner.is_sweep_completed(0, counts));
+  EXPECT_EQ(counts.num_flips, 7U);
+  EXPECT_FALSE(planner.is_sweep_completed(1, counts));
+
+  // the counters of completed chunks are added up
+  counts = SweepCounts();
+  EXPECT_TRUE(planner.is_completed(1, 0, 0, counts));
+  EXPECT_FALSE(planner.is_completed(1, 0, 10, counts));
+  EXPECT_FALSE(planner.is_completed(1, 1, 0, counts));
+  EXPECT_TRUE(planner.is_completed(0, 0, 10, counts));
+  EXPECT_EQ(counts.num_flips, 10U);
+  EXPECT_EQ(counts.num_flips_z2o, 5U);
+  EXPECT_EQ(counts.num_flips_o2z, 5U);
+  EXPECT_EQ(counts.num_observed_bitflips, 20U);
+
+  // the checkpoint log is continued, i.e., chunks completed after resuming are also skipped by the next resume
+  planner.complete_chunk(1, 0, 10, 10, 1.0, make_counts(16), 500);
+  planner.end();
+  SweepPlanner resumed;
+  EXPECT_EQ(resumed.begin(plan, 2, true), 500U);
+  EXPECT_TRUE(resumed.is_completed(1, 0, 0, counts));
+  EXPECT_TRUE(resumed.is_completed(1, 0, 10, counts));
+  resumed.end();
+}
+
+TEST_F(SweepPlannerTest, ResumeIgnoresPartialLastRecord) {
+  {
+    SweepPlanner planner;
+    planner.begin(plan, 1, false);
+    planner.complete_chunk(0, 0, 0, 10, 1.0, make_counts(1), 100);
+    planner.end();
+  }
+  const auto checkpoint_path = dir.file(SweepPlanner::CHECKPOINT_FILENAME);
+  write_file(checkpoint_path, read_file(checkpoint_path) + R"({"type":"chunk","sweep":0,"bank_idx":0,"first_)");
+
+  SweepPlanner planner;
+  EXPECT_EQ(planner.begin(plan, 1, true), 100U);
+  SweepCounts counts;
+  EXPECT_TRUE(planner.is_completed(0, 0, 0, counts));
+  EXPECT_FALSE(planner.is_completed(0, 0, 10, counts));
+  planner.complete_chunk(0, 0, 10, 10, 1.0, make_counts(1), 200);
+  planner.end();
+
+  SweepPlanner resumed;
+  EXPECT_EQ(resumed.begin(plan, 1, true), 200U);
+  EXPECT_TRUE(resumed.is_completed(0, 0, 10, counts));
+  resumed.end();
+}
+
+TEST_F(SweepPlannerTest, ResumeWithoutCheckpoint) {
+  SweepPlanner planner;
+  EXPECT_EQ(planner.begin(plan, 1, true), 0U);
+  SweepCounts counts;
+  EXPECT_FALSE(planner.is_completed(0, 0, 0, counts));
+  planner.end();
+}
+
+TEST_F(SweepPlannerTest, ResumeWithDifferentPlanFails) {
+  {
+    SweepPlanner planner;
+    planner.begin(plan, 1, false);
+    planner.complete_chunk(0, 0, 0, 10, 1.0, make_counts(1), 100);
+    planner.end();
+  }
+  plan.row_stride = 2;
+  is_campaign_worker = true;
+  SweepPlanner planner;
+  EXPECT_THROW(planner.begin(plan, 1, true), TargetExit);
+}
+
+TEST_F(SweepPlannerTest, NewRunKeepsPreviousCheckpoint) {
+  {
+    SweepPlanner planner;
+    planner.begin(plan, 1, false);
+    planner.complete_chunk(0, 0, 0, 10, 1.0, make_counts(1), 100);
+    planner.end();
+  }
+  SweepPlanner planner;
+  EXPECT_EQ(planner.begin(plan, 1, false), 0U);
+  SweepCounts counts;
+  EXPECT_FALSE(planner.is_completed(0, 0, 0, counts));
+  planner.end();
+
+  size_t num_checkpoints = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(dir.get_path())) {
+    if (entry.path().filename().string().rfind("sweep-checkpoint", 0) == 0) num_checkpoints++;
+  }
+  EXPECT_EQ(num_checkpoints, 2U);
+}
@@ -0,0 +1,9 @@
+// The globals that rhoHammer defines in main.cpp and the library refers to.
+
+#include "main.hpp"
+
+thread_local ProgramArguments program_args;
+
+std::string get_output_path(const std::string &filename) {
+  return program_args.output_dir.empty() ? filename : program_args.output_dir + "/" + filename;
+}
@@ -0,0 +1,52 @@
+#ifndef ZENHAMMER_TESTS_TESTHELPER_HPP_
+#define ZENHAMMER_TESTS_TESTHELPER_HPP_
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+// A fresh directory for the files of a test, which is removed with all its files when the test ends.
+class TempDir {
+ private:
+  std::filesystem::path path;
+
+ public:
+  TempDir() {
+    std::string tmpl = (std::filesystem::temp_directory_path()/"rhoTests-XXXXXX").string();
+    if (mkdtemp(tmpl.data()) == nullptr) throw std::runtime_error("could not create a temporary directory");
+    path = tmpl;
+  }
+
+  ~TempDir() {
+    std::error_code ec;
+    std::filesystem::remove_all(path, ec);
+  }
+
+  TempDir(const TempDir &) = delete;
+  TempDir &operator=(const TempDir &) = delete;
+
+  [[nodiscard]] std::string get_path() const {
+    return path.string();
+  }
+
+  /// the path of the given file in this directory
+  [[nodiscard]] std::string file(const std::string &filename) const {
+    return (path/filename).string();
+  }
+};
+
+/// the whole content of the given file
+inline std::string read_file(const std::string &path) {
+  std::ifstream ifs(path, std::ios::in | std::ios::binary);
+  return {std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()};
+}
+
+/// overwrites the given file with the content
+inline void write_file(const std::string &path, const std::string &content) {
+  std::ofstream ofs(path, std::ios::out | std::ios::trunc | std::ios::binary);
+  ofs << content;
+}
+
+#endif //ZENHAMMER_TESTS_TESTHELPER_HPP_